@@ -0,0 +1,52 @@
+/* MOTOR MODEL (wheel gear motor, identified from logs)
+ *
+ * Wheel speed w (rad/s, signed) against the PWM duty u (-1..1):
+ *
+ *   turning:  tau * dw/dt = gain * u(t - dead_time) - coulomb * sgn(w) - w
+ *   still:    w stays 0 while |u| < deadband
+ *
+ * gain is the speed per unit duty without friction, coulomb the speed the
+ * Coulomb friction takes off, deadband the duty a still wheel needs to break
+ * away. The first order plus dead time fit (gain, tau, dead_time alone) is
+ * the same model with coulomb and deadband 0.
+ *
+ * HOST_SIM/tools/motor_ident.c fits one model per wheel to a robot log and
+ * writes them as motor_model_fit.h (MOTOR_MODEL_FIT_TABLE). The robot's
+ * feed-forward (ROBOT_PID_FEEDFORWARD, MCXN947_Project.c) and the twin's
+ * motor plants (MotorPlant_FromModel()) take them from there.
+ *
+ * Header only, no SDK dependency, like omni_gains.h.
+ */
+#ifndef MOTOR_MODEL_H_
+#define MOTOR_MODEL_H_
+
+#include <math.h>
+
+#define MOTOR_MODEL_WHEELS          4U
+
+typedef struct {
+    float gain;             /* rad/s per unit duty */
+    float tau;              /* Mechanical time constant (s) */
+    float dead_time;        /* s */
+    float coulomb;          /* rad/s */
+    float deadband;         /* Break-away duty (0..1) */
+} motor_model_t;
+
+/* Until a wheel is identified: the twin's motor plant (MOTOR_PLANT_DEFAULT_PARAMS,
+ * 15 rad/s at full duty, 50 ms, 5 % break-away), a guess for the 12 V gear motor.
+ * { gain, tau, dead_time, coulomb, deadband } */
+#define MOTOR_MODEL_DEFAULT         { 15.79f, 0.05f, 0.0f, 0.79f, 0.05f }
+
+/* Duty (-1..1) that holds `speed` (rad/s) once settled, 0 for standstill */
+static inline float motor_model_duty(const motor_model_t *m, float speed)
+{
+    float u;
+
+    if (speed == 0.0f || !(m->gain > 0.0f)) return 0.0f;
+
+    u = (fabsf(speed) + m->coulomb) / m->gain;
+    if (u > 1.0f) u = 1.0f;
+    return copysignf(u, speed);
+}
+
+#endif /* MOTOR_MODEL_H_ */
@@ -0,0 +1,151 @@
+/* OMNI GAINS (speed-scheduled wheel PID gains)
+ *
+ * The wheel PID (pid_compute() in omnidriver.c) takes Kp, Ki and Kd from a
+ * table indexed by the wheel's |target| speed, linearly interpolated between
+ * its points and held flat outside them. The robot uses it with
+ * ROBOT_PID_SCHEDULE=1 only.
+ *
+ * The table is changed at runtime, one point per RemoteGainPoint_t frame
+ * (omni_wire.h) from the remote. Points go into an edit copy; once the edit
+ * copy is a valid table (speeds strictly increasing, gains finite and not
+ * negative) it is published to the PID through two banks, so the PID
+ * interrupt always reads a whole table, never one half written. A table made
+ * invalid on the way (a point moved past its neighbour) keeps the last valid
+ * one in use until the remaining points arrive.
+ *
+ * Header only, no SDK dependency, like omni_wire.h. The robot runs the table,
+ * the remote keeps a copy of it to send, HOST_SIM/tools/pid_schedule_sim.c
+ * compares tables with fixed gains.
+ */
+#ifndef OMNI_GAINS_H_
+#define OMNI_GAINS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "omni_wire.h"
+
+#define OMNI_GAINS_MAX_POINTS       8U
+
+/* Default table: one point, the fixed gains of PID1..4 the robot has run
+ * on, so a schedule changes nothing until it is tuned on the robot from the
+ * remote. pid_schedule_sim has a table tuned on the twin's motor model as a
+ * starting point. { speed rad/s, Kp, Ki, Kd } */
+#define OMNI_GAINS_DEFAULT_POINTS   1U
+#define OMNI_GAINS_DEFAULT_TABLE    {                       \
+        { 0.0f,  35000.0f, 20000.0f, 0.1f },                \
+    }
+
+typedef struct {
+    float speed;            /* |wheel target| (rad/s) */
+    float kp;
+    float ki;
+    float kd;
+} omni_gain_point_t;
+
+typedef struct {
+    uint8_t points;
+    omni_gain_point_t point[OMNI_GAINS_MAX_POINTS];
+} omni_gain_table_t;
+
+typedef struct {
+    omni_gain_table_t bank[2];  /* bank[active] is in use, the other one is written */
+    volatile uint8_t active;
+    omni_gain_table_t edit;     /* Points as received */
+    uint8_t seq;                /* Of the last point taken */
+    bool seq_valid;
+    uint32_t updates;           /* Tables published */
+} omni_gains_t;
+
+OMNI_WIRE_ASSERT(OMNI_GAINS_MAX_POINTS <= 0xFFU, "Point index and count are bytes on the wire");
+
+static inline bool omni_gains_valid(const omni_gain_table_t *t)
+{
+    if (t->points == 0U || t->points > OMNI_GAINS_MAX_POINTS) return false;
+
+    for (uint32_t i = 0; i < t->points; i++)
+    {
+        const omni_gain_point_t *p = &t->point[i];
+        /* Comparisons are false for NaN, so these reject it too */
+        if (!(p->speed >= 0.0f) || !(p->kp >= 0.0f) || !(p->ki >= 0.0f) || !(p->kd >= 0.0f)) return false;
+        if (!(p->speed < 1.0e6f) || !(p->kp < 1.0e9f) || !(p->ki < 1.0e9f) || !(p->kd < 1.0e9f)) return false;
+        if (i > 0U && !(p->speed > t->point[i - 1U].speed)) return false;
+    }
+    return true;
+}
+
+/* Start from `table` (copied, must be valid) */
+static inline void omni_gains_init(omni_gains_t *g, const omni_gain_table_t *table)
+{
+    memset(g, 0, sizeof(omni_gains_t));
+    g->bank[0] = *table;
+    g->edit = *table;
+}
+
+/* Table the PID uses now */
+static inline const omni_gain_table_t *omni_gains_table(const omni_gains_t *g)
+{
+    return &g->bank[g->active];
+}
+
+/*
+ * Gains at `speed` (rad/s, not negative). One pass over at most
+ * OMNI_GAINS_MAX_POINTS points, a division only between two of them.
+ */
+static inline void omni_gains_lookup(const omni_gain_table_t *t, float speed, omni_gain_point_t *out)
+{
+    const omni_gain_point_t *hi = &t->point[0];
+
+    if (speed <= hi->speed)
+    {
+        *out = *hi;
+        return;
+    }
+    for (uint32_t i = 1; i < t->points; i++)
+    {
+        const omni_gain_point_t *lo = hi;
+        hi = &t->point[i];
+        if (speed < hi->speed)
+        {
+            float f = (speed - lo->speed) / (hi->speed - lo->speed);
+            out->speed = speed;
+            out->kp = lo->kp + f * (hi->kp - lo->kp);
+            out->ki = lo->ki + f * (hi->ki - lo->ki);
+            out->kd = lo->kd + f * (hi->kd - lo->kd);
+            return;
+        }
+    }
+    *out = *hi;
+}
+
+/*
+ * One point from the wire. Only one writer (the SPI completion callback); the
+ * PID interrupt may preempt it anywhere and still reads a whole table.
+ * Returns true if a new table went into use.
+ */
+static inline bool omni_gains_apply(omni_gains_t *g, const RemoteGainPoint_t *frame)
+{
+    if (g->seq_valid && frame->seq == g->seq) return false;    /* The bridge repeats a frame until the next one */
+    if (frame->index >= OMNI_GAINS_MAX_POINTS || frame->points == 0U || frame->points > OMNI_GAINS_MAX_POINTS ||
+        frame->index >= frame->points)
+    {
+        return false;
+    }
+
+    g->seq = frame->seq;
+    g->seq_valid = true;
+    g->edit.point[frame->index].speed = frame->speed;
+    g->edit.point[frame->index].kp = frame->kp;
+    g->edit.point[frame->index].ki = frame->ki;
+    g->edit.point[frame->index].kd = frame->kd;
+    g->edit.points = frame->points;
+    if (!omni_gains_valid(&g->edit)) return false;
+
+    uint8_t next = (uint8_t)(g->active ^ 1U);
+    g->bank[next] = g->edit;
+    g->active = next;
+    g->updates++;
+    return true;
+}
+
+#endif /* OMNI_GAINS_H_ */
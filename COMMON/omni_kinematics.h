@@ -0,0 +1,165 @@
+/* OMNI KINEMATICS (body velocity <-> wheel speeds, N wheels)
+ *
+ * Body velocity v = (vx, vy, phi) in m/s, m/s and rad/s; wheel speeds w in rad/s,
+ * signed, in motor order (M1, M2, ...). With J the N x 3 matrix of the layout,
+ * L its geometry constant and r the wheel radius:
+ *
+ *   inverse   w = J v / r
+ *   forward   v = r J+ w,   J+ = (J^T J)^-1 J^T
+ *
+ * J+ is the pseudo-inverse: the exact inverse for three wheels, the least squares
+ * fit over the wheels for four (rolling without slip). In the layouts below J^T J
+ * is diagonal, so J+ is J^T with each row divided by its diagonal element. Both
+ * matrices are constant initializers the compiler works out from the rows of J:
+ * omni_kin_inv_matrix (J / r) and omni_kin_fwd_matrix (r J+).
+ *
+ * OMNI_KIN_LAYOUT picks the layout at compile time:
+ *
+ *   OMNI_KIN_MECANUM4  4 mecanum wheels, rollers in an X, L = lx + ly (the rover):
+ *                      M1 front left, M2 rear left, M3 rear right, M4 front right
+ *   OMNI_KIN_OMNI3     3 omni wheels 120 degrees apart (kiwi), L = centre to wheel,
+ *                      M1 on the +x axis, M2 and M3 counterclockwise from it
+ *   OMNI_KIN_OMNI4     4 omni wheels at 45, 135, 225 and 315 degrees, L = centre to
+ *                      wheel, M1 front left of the +x axis, then counterclockwise
+ *
+ * An omni wheel at angle a drives along the tangent: w = (-sin(a) vx + cos(a) vy + L phi) / r.
+ *
+ * omni_kin_desaturate() brings a wheel speed vector under a limit by scaling every
+ * wheel by the same factor: the robot keeps the commanded direction and turn rate
+ * ratio, only slower. Clamping each wheel alone bends the direction as soon as one
+ * of them saturates.
+ *
+ * The includer defines OMNI_KIN_L and OMNI_KIN_R (m) first; omnidriver.h does for the
+ * robot. HOST_SIM/tools/kinematics_bench.c checks the matrices and times the
+ * functions. Header only, no SDK dependency, like motor_model.h.
+ */
+#ifndef OMNI_KINEMATICS_H_
+#define OMNI_KINEMATICS_H_
+
+#include <math.h>
+
+#define OMNI_KIN_MECANUM4           0
+#define OMNI_KIN_OMNI3              1
+#define OMNI_KIN_OMNI4              2
+
+#ifndef OMNI_KIN_LAYOUT
+#define OMNI_KIN_LAYOUT             OMNI_KIN_MECANUM4
+#endif
+
+#if !defined(OMNI_KIN_L) || !defined(OMNI_KIN_R)
+#error "omni_kinematics.h: define OMNI_KIN_L and OMNI_KIN_R (m) before including it"
+#endif
+
+/* Rows of J, ( vx, vy, phi ) per wheel */
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+#define OMNI_KIN_WHEELS             4U
+#define OMNI_KIN_NAME               "mecanum4"
+#define OMNI_KIN_ROW_0              ( 1.0f, -1.0f, -(OMNI_KIN_L))
+#define OMNI_KIN_ROW_1              ( 1.0f,  1.0f, -(OMNI_KIN_L))
+#define OMNI_KIN_ROW_2              ( 1.0f, -1.0f,  (OMNI_KIN_L))
+#define OMNI_KIN_ROW_3              ( 1.0f,  1.0f,  (OMNI_KIN_L))
+#elif OMNI_KIN_LAYOUT == OMNI_KIN_OMNI3
+#define OMNI_KIN_WHEELS             3U
+#define OMNI_KIN_NAME               "omni3"
+#define OMNI_KIN_ROW_0              ( 0.0f,         1.0f, (OMNI_KIN_L))   /*   0 deg */
+#define OMNI_KIN_ROW_1              (-0.8660254f, -0.5f,  (OMNI_KIN_L))   /* 120 deg */
+#define OMNI_KIN_ROW_2              ( 0.8660254f, -0.5f,  (OMNI_KIN_L))   /* 240 deg */
+#elif OMNI_KIN_LAYOUT == OMNI_KIN_OMNI4
+#define OMNI_KIN_WHEELS             4U
+#define OMNI_KIN_NAME               "omni4"
+#define OMNI_KIN_ROW_0              (-0.70710678f,  0.70710678f, (OMNI_KIN_L))    /*  45 deg */
+#define OMNI_KIN_ROW_1              (-0.70710678f, -0.70710678f, (OMNI_KIN_L))    /* 135 deg */
+#define OMNI_KIN_ROW_2              ( 0.70710678f, -0.70710678f, (OMNI_KIN_L))    /* 225 deg */
+#define OMNI_KIN_ROW_3              ( 0.70710678f,  0.70710678f, (OMNI_KIN_L))    /* 315 deg */
+#else
+#error "omni_kinematics.h: unknown OMNI_KIN_LAYOUT"
+#endif
+
+/* J(i, c): element c (0 vx, 1 vy, 2 phi) of row i */
+#define OMNI_KIN_APPLY(m, args)     m args
+#define OMNI_KIN_PICK_0(x, y, w)    (x)
+#define OMNI_KIN_PICK_1(x, y, w)    (y)
+#define OMNI_KIN_PICK_2(x, y, w)    (w)
+#define OMNI_KIN_J(i, c)            OMNI_KIN_APPLY(OMNI_KIN_PICK_##c, OMNI_KIN_ROW_##i)
+
+/* Diagonal of J^T J, and the rows of J / r and r J+ */
+#if OMNI_KIN_WHEELS == 4U
+#define OMNI_KIN_JTJ(c)             (OMNI_KIN_J(0, c) * OMNI_KIN_J(0, c) + OMNI_KIN_J(1, c) * OMNI_KIN_J(1, c) + \
+                                     OMNI_KIN_J(2, c) * OMNI_KIN_J(2, c) + OMNI_KIN_J(3, c) * OMNI_KIN_J(3, c))
+#define OMNI_KIN_FWD(c)             { OMNI_KIN_FWD_E(0, c), OMNI_KIN_FWD_E(1, c), OMNI_KIN_FWD_E(2, c), \
+                                      OMNI_KIN_FWD_E(3, c) }
+#else
+#define OMNI_KIN_JTJ(c)             (OMNI_KIN_J(0, c) * OMNI_KIN_J(0, c) + OMNI_KIN_J(1, c) * OMNI_KIN_J(1, c) + \
+                                     OMNI_KIN_J(2, c) * OMNI_KIN_J(2, c))
+#define OMNI_KIN_FWD(c)             { OMNI_KIN_FWD_E(0, c), OMNI_KIN_FWD_E(1, c), OMNI_KIN_FWD_E(2, c) }
+#endif
+#define OMNI_KIN_FWD_E(i, c)        ((OMNI_KIN_R) * OMNI_KIN_J(i, c) / OMNI_KIN_JTJ(c))
+#define OMNI_KIN_INV(i)             { OMNI_KIN_J(i, 0) / (OMNI_KIN_R), OMNI_KIN_J(i, 1) / (OMNI_KIN_R), \
+                                      OMNI_KIN_J(i, 2) / (OMNI_KIN_R) }
+
+typedef struct {
+    float vx;               /* m/s */
+    float vy;               /* m/s */
+    float phi;              /* rad/s */
+} omni_kin_twist_t;
+
+static const float omni_kin_inv_matrix[OMNI_KIN_WHEELS][3] = {
+    OMNI_KIN_INV(0), OMNI_KIN_INV(1), OMNI_KIN_INV(2),
+#if OMNI_KIN_WHEELS == 4U
+    OMNI_KIN_INV(3),
+#endif
+};
+
+static const float omni_kin_fwd_matrix[3][OMNI_KIN_WHEELS] = {
+    OMNI_KIN_FWD(0), OMNI_KIN_FWD(1), OMNI_KIN_FWD(2),
+};
+
+/* Wheel speeds (rad/s, signed) for body velocity v */
+static inline void omni_kin_inverse(const omni_kin_twist_t *v, float w[OMNI_KIN_WHEELS])
+{
+    for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+    {
+        w[i] = omni_kin_inv_matrix[i][0] * v->vx + omni_kin_inv_matrix[i][1] * v->vy +
+               omni_kin_inv_matrix[i][2] * v->phi;
+    }
+}
+
+/* Body velocity for wheel speeds w (rad/s, signed): least squares over the wheels */
+static inline void omni_kin_forward(const float w[OMNI_KIN_WHEELS], omni_kin_twist_t *v)
+{
+    float s[3] = {0.0f, 0.0f, 0.0f};
+
+    for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+    {
+        s[0] += omni_kin_fwd_matrix[0][i] * w[i];
+        s[1] += omni_kin_fwd_matrix[1][i] * w[i];
+        s[2] += omni_kin_fwd_matrix[2][i] * w[i];
+    }
+    v->vx = s[0];
+    v->vy = s[1];
+    v->phi = s[2];
+}
+
+/* Scales every wheel by the same factor so that none is above max (rad/s, > 0);
+ * returns the factor, 1 when none was */
+static inline float omni_kin_desaturate(float w[OMNI_KIN_WHEELS], float max)
+{
+    float peak = 0.0f;
+    float k;
+
+    for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+    {
+        float a = fabsf(w[i]);
+        if (a > peak) peak = a;
+    }
+    if (peak <= max) return 1.0f;
+
+    k = max / peak;
+    for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+    {
+        w[i] *= k;
+    }
+    return k;
+}
+
+#endif /* OMNI_KINEMATICS_H_ */
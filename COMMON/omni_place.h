@@ -0,0 +1,163 @@
+/* OMNI PLACE (hot code and buffers in the MCXN947's RAM banks)
+ *
+ * Flash runs through the cache, and a miss costs wait states right where they
+ * hurt: in the robot's control interrupts, in the SPI path of both boards and
+ * in LVGL's blend kernels on the remote. The MCUXpresso managed linker script
+ * (Debug/<project>_Debug.ld, generated from the project's memory map) already
+ * has a section per RAM bank, in the naming of cr_section_macros.h:
+ *
+ *   .ramfunc.$SRAMX    code, copied from flash by ResetISR and run from RAMX
+ *                      (96 KB on the code bus: no wait states, no cache)
+ *   .bss.$SRAMH        data in RAMH (32 KB, its own port on the bus matrix)
+ *   .noinit.$SRAMH     the same, not zeroed at reset
+ *
+ * OMNI_RAMX_CODE puts a function into RAMX, OMNI_SRAMH_BSS / OMNI_SRAMH_NOINIT
+ * an array into RAMH. The firmwares use them through the OMNI_PLACE_<group>_xxx
+ * macros below, one switch per placement decision, 0 = where the toolchain puts
+ * it (flash, .bss in SRAM):
+ *
+ *   OMNI_PLACE_ISR     interrupt paths: the robot's PID tick, encoder captures,
+ *                      telemetry; the remote's ADC and SPI interrupts;
+ *                      ESP_SPI.c and the us clock (TIMER_DRIVER.c) on both
+ *   OMNI_PLACE_PID     pid_compute() and the kinematics (omnidriver.c)
+ *   OMNI_PLACE_LVGL    LV_ATTRIBUTE_FAST_MEM (lv_conf.h): the blend kernels,
+ *                      masks and string helpers, about 40 KB of LVGL
+ *   OMNI_PLACE_BUFFERS RAMH: the robot's telemetry exchange buffers, which the
+ *                      eDMA moves, away from the stack and the control state;
+ *                      the remote's LVGL draw buffer, which the renderer and the
+ *                      panel SPI go through, away from the ESP link's buffers
+ *
+ * In the remote's dual-core mode (REMOTE_GUI_ON_CORE1) the mailbox takes the
+ * start of RAMH (RemoteMailbox.h) and LVGL runs on core1: core1 builds place
+ * nothing by default, so the draw buffer (30 KB) only goes to RAMH when LVGL
+ * runs on core0. Safe to include from assembly (lv_conf.h).
+ *
+ * OMNI_PLACE_PROFILE = 1 times the placed paths on the DWT cycle counter
+ * (omni_place_stat_t) and each firmware prints them with the placement in effect:
+ *
+ *   Place: pid tick     ramx/ramx   60000 calls,  1480 avg,  2212 max cycles
+ *
+ * A placement decision costs or saves the difference of its line between a build
+ * with its switch on and one with it off (-DOMNI_PLACE_PID=0).
+ *
+ * Calls between flash and RAMX go through the linker's long branch veneers, so
+ * a placed path keeps its callees with it where they are hot.
+ *
+ * Header only, no SDK dependency; host builds (HOST_SIM) place nothing and
+ * report "flash" / "sram".
+ */
+#ifndef OMNI_PLACE_H_
+#define OMNI_PLACE_H_
+
+#if !(defined(__arm__) && defined(__GNUC__)) || \
+    defined(CPU_MCXN947VDF_cm33_core1) || defined(CPU_MCXN947VKL_cm33_core1) || \
+    defined(CPU_MCXN947VNL_cm33_core1) || defined(CPU_MCXN947VPB_cm33_core1)
+#define OMNI_PLACE_DEFAULT          0
+#else
+#define OMNI_PLACE_DEFAULT          1
+#endif
+
+#ifndef OMNI_PLACE
+#define OMNI_PLACE                  OMNI_PLACE_DEFAULT
+#endif
+#ifndef OMNI_PLACE_ISR
+#define OMNI_PLACE_ISR              OMNI_PLACE
+#endif
+#ifndef OMNI_PLACE_PID
+#define OMNI_PLACE_PID              OMNI_PLACE
+#endif
+#ifndef OMNI_PLACE_LVGL
+#define OMNI_PLACE_LVGL             OMNI_PLACE
+#endif
+#ifndef OMNI_PLACE_BUFFERS
+#define OMNI_PLACE_BUFFERS          OMNI_PLACE
+#endif
+
+/* 1 = cycle counts of the placed paths on the debug console */
+#ifndef OMNI_PLACE_PROFILE
+#define OMNI_PLACE_PROFILE          0
+#endif
+
+#if defined(__arm__) && defined(__GNUC__)
+#define OMNI_RAMX_CODE              __attribute__((section(".ramfunc.$SRAMX")))
+#define OMNI_SRAMH_BSS              __attribute__((section(".bss.$SRAMH")))
+#define OMNI_SRAMH_NOINIT           __attribute__((section(".noinit.$SRAMH")))
+#else
+#define OMNI_RAMX_CODE
+#define OMNI_SRAMH_BSS
+#define OMNI_SRAMH_NOINIT
+#endif
+
+#if OMNI_PLACE_ISR
+#define OMNI_PLACE_ISR_CODE         OMNI_RAMX_CODE
+#define OMNI_PLACE_ISR_BANK         "ramx"
+#else
+#define OMNI_PLACE_ISR_CODE
+#define OMNI_PLACE_ISR_BANK         "flash"
+#endif
+
+#if OMNI_PLACE_PID
+#define OMNI_PLACE_PID_CODE         OMNI_RAMX_CODE
+#define OMNI_PLACE_PID_BANK         "ramx"
+#else
+#define OMNI_PLACE_PID_CODE
+#define OMNI_PLACE_PID_BANK         "flash"
+#endif
+
+#if OMNI_PLACE_LVGL
+#define OMNI_PLACE_LVGL_CODE        OMNI_RAMX_CODE
+#define OMNI_PLACE_LVGL_BANK        "ramx"
+#else
+#define OMNI_PLACE_LVGL_CODE
+#define OMNI_PLACE_LVGL_BANK        "flash"
+#endif
+
+#if OMNI_PLACE_BUFFERS
+#define OMNI_PLACE_BUFFERS_BSS      OMNI_SRAMH_BSS
+#define OMNI_PLACE_BUFFERS_NOINIT   OMNI_SRAMH_NOINIT
+#define OMNI_PLACE_BUFFERS_BANK     "ramh"
+#else
+#define OMNI_PLACE_BUFFERS_BSS
+#define OMNI_PLACE_BUFFERS_NOINIT
+#define OMNI_PLACE_BUFFERS_BANK     "sram"
+#endif
+
+/*******************************************************************************
+ * Profile: OMNI_PLACE_BEGIN(x) at the start of a path, OMNI_PLACE_END(x, &stat)
+ * at its end; both compile to nothing without OMNI_PLACE_PROFILE
+ ******************************************************************************/
+#if !defined(__ASSEMBLER__) && !defined(__ASSEMBLY__)
+
+#include <stdint.h>
+
+/* Cycles since the last report, from interrupts and read by the main loop: the
+ * sum holds 28 s of a path that takes all of a 150 MHz core */
+typedef struct {
+    volatile uint32_t calls;
+    volatile uint32_t cycles_sum;
+    volatile uint32_t cycles_max;
+} omni_place_stat_t;
+
+static inline void omni_place_add(omni_place_stat_t *stat, uint32_t cycles)
+{
+    stat->calls++;
+    stat->cycles_sum += cycles;
+    if (cycles > stat->cycles_max) stat->cycles_max = cycles;
+}
+
+/* The firmware's cycle counter (core_cm33.h), started by boot_profile_start() */
+#ifndef OMNI_PLACE_CYCLES
+#define OMNI_PLACE_CYCLES()         (DWT->CYCCNT)
+#endif
+
+#if OMNI_PLACE_PROFILE
+#define OMNI_PLACE_BEGIN(x)         uint32_t omni_place_##x = OMNI_PLACE_CYCLES()
+#define OMNI_PLACE_END(x, stat)     omni_place_add((stat), OMNI_PLACE_CYCLES() - omni_place_##x)
+#else
+#define OMNI_PLACE_BEGIN(x)
+#define OMNI_PLACE_END(x, stat)
+#endif
+
+#endif /* !__ASSEMBLER__ */
+
+#endif /* OMNI_PLACE_H_ */
@@ -0,0 +1,287 @@
+/* OMNI RECORD (robot control inputs, for a bit-exact replay)
+ *
+ * What the robot's control interrupts take in, in the order they took it,
+ * on the time base of the PID ticks (PID_TIMER, 12 kHz):
+ *
+ *   - every encoder capture (ctimer_capture_callback), the CTIMER0 capture
+ *     register as the firmware read it
+ *   - the CTIMER0 count check_stopped_motors() read, on the ticks where it
+ *     stopped a wheel that was turning
+ *   - every command or gain frame an SPI exchange brought in
+ *     (Robot_ExchangeDone), when it differs from the one before: the robot
+ *     takes a repeated frame as a no-op
+ *
+ * and, every few ticks, a digest of the control state, so that a replay can
+ * tell the first tick where it parted from the recording.
+ *
+ * The stream is OMNI_RECORD_MAGIC followed by events, a tag byte and its data:
+ *
+ *   0x01..0x0F         that many PID ticks
+ *   0x00 v             v PID ticks
+ *   0b1wwkkkkk v       capture on wheel w, k (0..31) ticks after the event before;
+ *                      v is the capture's period (to the wheel's capture before)
+ *                      minus the wheel's period before, zigzag coded
+ *   0x10 c32           CTIMER0 count the next tick's timeout check reads
+ *   0x11 frame         a frame as received, its first byte is its length (omni_wire.h)
+ *   0x12 d32           control state digest after the ticks so far
+ *   0x1F               end: the recorder's buffer ran full, nothing before it was lost
+ *
+ * v are varints (7 bits per byte, low first), c32 and d32 little endian.
+ * A capture costs 2-3 bytes, ticks between captures fold into its tag.
+ *
+ * RobotRecord.c writes it on the robot, HOST_SIM/tools/robot_replay.c reads
+ * it. Header only, no SDK dependency, like omni_wire.h.
+ */
+#ifndef OMNI_RECORD_H_
+#define OMNI_RECORD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "omni_wire.h"
+
+#define OMNI_RECORD_MAGIC           "ORC1"
+#define OMNI_RECORD_MAGIC_SIZE      4U
+#define OMNI_RECORD_WHEELS          4U
+#define OMNI_RECORD_MAX_EVENT       (7U + OMNI_WIRE_MAX_FRAME)  /* Longest write: ticks, then a frame */
+
+#define OMNI_RECORD_TAG_TICKS       0x00U
+#define OMNI_RECORD_TAG_COUNT       0x10U
+#define OMNI_RECORD_TAG_FRAME       0x11U
+#define OMNI_RECORD_TAG_DIGEST      0x12U
+#define OMNI_RECORD_TAG_END         0x1FU
+#define OMNI_RECORD_TAG_CAPTURE     0x80U
+#define OMNI_RECORD_CAPTURE_TICKS   31U     /* Ticks a capture tag can carry */
+
+/* FNV-1a, 32 bit */
+#define OMNI_RECORD_DIGEST_INIT     2166136261U
+
+typedef enum {
+    OMNI_RECORD_TICKS,
+    OMNI_RECORD_CAPTURE,
+    OMNI_RECORD_COUNT,
+    OMNI_RECORD_FRAME,
+    OMNI_RECORD_DIGEST,
+    OMNI_RECORD_END,
+} omni_record_kind_t;
+
+/* Writer or reader state: both sides follow the same captures */
+typedef struct {
+    uint32_t capture[OMNI_RECORD_WHEELS];   /* Last capture register value per wheel */
+    uint32_t period[OMNI_RECORD_WHEELS];    /* Its period */
+    uint32_t ticks;                         /* Writer: ticks not written yet; reader: ticks so far */
+} omni_record_state_t;
+
+typedef struct {
+    omni_record_kind_t kind;
+    uint32_t ticks;         /* TICKS: how many; CAPTURE: ticks before it */
+    uint32_t wheel;         /* CAPTURE */
+    uint32_t value;         /* CAPTURE: capture register; COUNT: CTIMER0 count; DIGEST: digest */
+    const uint8_t *frame;   /* FRAME: in the stream, frame[0] bytes */
+} omni_record_event_t;
+
+static inline uint32_t omni_record_digest(uint32_t digest, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        digest = (digest ^ p[i]) * 16777619U;
+    }
+    return digest;
+}
+
+/*******************************************************************************
+ * Writer: every function writes its event, after the ticks before it, to `out`
+ * (at most OMNI_RECORD_MAX_EVENT bytes) and returns the length written
+ ******************************************************************************/
+static inline size_t omni_record_put_varint(uint8_t *out, uint32_t v)
+{
+    size_t n = 0;
+
+    while (v >= 0x80U)
+    {
+        out[n++] = (uint8_t)(v | 0x80U);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+static inline size_t omni_record_put_u32(uint8_t *out, uint32_t v)
+{
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+    return 4U;
+}
+
+/* One more PID tick: written with the next event */
+static inline void omni_record_tick(omni_record_state_t *st)
+{
+    st->ticks++;
+}
+
+/* The ticks not written yet, as one event */
+static inline size_t omni_record_ticks(omni_record_state_t *st, uint8_t *out)
+{
+    uint32_t n = st->ticks;
+
+    st->ticks = 0;
+    if (n == 0U) return 0;
+    if (n <= 0x0FU)
+    {
+        out[0] = (uint8_t)n;
+        return 1U;
+    }
+    out[0] = OMNI_RECORD_TAG_TICKS;
+    return 1U + omni_record_put_varint(&out[1], n);
+}
+
+/* Capture register `capture` of `wheel` (0..3) */
+static inline size_t omni_record_capture(omni_record_state_t *st, uint32_t wheel, uint32_t capture, uint8_t *out)
+{
+    size_t n = 0;
+    uint32_t period = capture - st->capture[wheel];
+    int32_t d = (int32_t)(period - st->period[wheel]);
+
+    if (st->ticks > OMNI_RECORD_CAPTURE_TICKS) n = omni_record_ticks(st, out);
+
+    st->capture[wheel] = capture;
+    st->period[wheel] = period;
+    out[n++] = (uint8_t)(OMNI_RECORD_TAG_CAPTURE | (wheel << 5) | st->ticks);
+    st->ticks = 0;
+    return n + omni_record_put_varint(&out[n], ((uint32_t)d << 1) ^ (uint32_t)(d >> 31));
+}
+
+static inline size_t omni_record_count(omni_record_state_t *st, uint32_t count, uint8_t *out)
+{
+    size_t n = omni_record_ticks(st, out);
+
+    out[n++] = OMNI_RECORD_TAG_COUNT;
+    return n + omni_record_put_u32(&out[n], count);
+}
+
+/* `frame` holds a complete frame (omni_wire_frame_len() > 0) */
+static inline size_t omni_record_frame(omni_record_state_t *st, const uint8_t *frame, uint8_t *out)
+{
+    size_t n = omni_record_ticks(st, out);
+
+    out[n++] = OMNI_RECORD_TAG_FRAME;
+    memcpy(&out[n], frame, frame[0]);
+    return n + frame[0];
+}
+
+static inline size_t omni_record_digest_event(omni_record_state_t *st, uint32_t digest, uint8_t *out)
+{
+    size_t n = omni_record_ticks(st, out);
+
+    out[n++] = OMNI_RECORD_TAG_DIGEST;
+    return n + omni_record_put_u32(&out[n], digest);
+}
+
+static inline size_t omni_record_end(omni_record_state_t *st, uint8_t *out)
+{
+    size_t n = omni_record_ticks(st, out);
+
+    out[n++] = OMNI_RECORD_TAG_END;
+    return n;
+}
+
+/*******************************************************************************
+ * Reader
+ ******************************************************************************/
+static inline bool omni_record_get_varint(const uint8_t *buf, size_t len, size_t *pos, uint32_t *v)
+{
+    uint32_t r = 0;
+
+    for (uint32_t shift = 0; shift < 35U; shift += 7U)
+    {
+        if (*pos >= len) return false;
+        uint8_t b = buf[(*pos)++];
+        r |= (uint32_t)(b & 0x7FU) << shift;
+        if ((b & 0x80U) == 0U)
+        {
+            *v = r;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline bool omni_record_get_u32(const uint8_t *buf, size_t len, size_t *pos, uint32_t *v)
+{
+    if (len - *pos < 4U) return false;
+    *v = (uint32_t)buf[*pos] | ((uint32_t)buf[*pos + 1U] << 8) | ((uint32_t)buf[*pos + 2U] << 16) |
+         ((uint32_t)buf[*pos + 3U] << 24);
+    *pos += 4U;
+    return true;
+}
+
+/* The stream starts with the magic: returns its length, 0 if it doesn't */
+static inline size_t omni_record_header(const uint8_t *buf, size_t len)
+{
+    if (len < OMNI_RECORD_MAGIC_SIZE || memcmp(buf, OMNI_RECORD_MAGIC, OMNI_RECORD_MAGIC_SIZE) != 0) return 0;
+    return OMNI_RECORD_MAGIC_SIZE;
+}
+
+/* The event at buf[*pos], *pos moves past it. false at the end of the bytes, on a cut
+ * event or an unknown tag (*pos stays). st->ticks counts the ticks read so far. */
+static inline bool omni_record_next(omni_record_state_t *st, const uint8_t *buf, size_t len, size_t *pos,
+                                    omni_record_event_t *ev)
+{
+    size_t p = *pos;
+    uint8_t tag;
+
+    if (p >= len) return false;
+    tag = buf[p++];
+    memset(ev, 0, sizeof(*ev));
+
+    if (tag & OMNI_RECORD_TAG_CAPTURE)
+    {
+        uint32_t zz;
+        uint32_t w = (tag >> 5) & 0x03U;
+
+        if (!omni_record_get_varint(buf, len, &p, &zz)) return false;
+        ev->kind = OMNI_RECORD_CAPTURE;
+        ev->ticks = tag & OMNI_RECORD_CAPTURE_TICKS;
+        ev->wheel = w;
+        st->period[w] += (zz >> 1) ^ (0U - (zz & 1U));
+        st->capture[w] += st->period[w];
+        ev->value = st->capture[w];
+    }
+    else if (tag <= 0x0FU)
+    {
+        ev->kind = OMNI_RECORD_TICKS;
+        ev->ticks = tag;
+        if (tag == OMNI_RECORD_TAG_TICKS && !omni_record_get_varint(buf, len, &p, &ev->ticks)) return false;
+    }
+    else if (tag == OMNI_RECORD_TAG_COUNT || tag == OMNI_RECORD_TAG_DIGEST)
+    {
+        ev->kind = (tag == OMNI_RECORD_TAG_COUNT) ? OMNI_RECORD_COUNT : OMNI_RECORD_DIGEST;
+        if (!omni_record_get_u32(buf, len, &p, &ev->value)) return false;
+    }
+    else if (tag == OMNI_RECORD_TAG_FRAME)
+    {
+        if (omni_wire_frame_len(&buf[p], len - p) == 0) return false;
+        ev->kind = OMNI_RECORD_FRAME;
+        ev->frame = &buf[p];
+        p += buf[p];
+    }
+    else if (tag == OMNI_RECORD_TAG_END)
+    {
+        ev->kind = OMNI_RECORD_END;
+    }
+    else
+    {
+        return false;
+    }
+
+    st->ticks += ev->ticks;
+    *pos = p;
+    return true;
+}
+
+#endif /* OMNI_RECORD_H_ */
@@ -0,0 +1,217 @@
+/* OMNI SYNC (remote <-> robot clock synchronization)
+ *
+ * Two-way time transfer, NTP style, carried in the command and telemetry
+ * frames (omni_wire.h) and based on the 64-bit microsecond clock of each MCU
+ * (us_clock_now() in TIMER_DRIVER):
+ *
+ *   t1  remote clocks command n out        RemoteCommand_t.timestamp
+ *   t2  robot receives command n first     sent back as hold = t3 - t2
+ *   t3  robot fills a telemetry frame      RobotTelemetry_t.timestamp, sync_cmd_count = n
+ *   t4  remote receives that telemetry
+ *
+ *   delay  = (t4 - t1) - (t3 - t2)         round trip without the robot's hold
+ *   offset = (t2 - t1) - delay / 2         robot clock - remote clock
+ *
+ * No frame can arrive before it was sent, so the true offset is within
+ * delay / 2 of that. Waiting on the way (a bridge MISO waiting for the next
+ * poll, air retries) only makes delay larger: of every window the sample with
+ * the smallest delay is kept (NTP clock filter), the drift is the slope of the
+ * last OMNI_SYNC_HISTORY window minima and the offset is carried forward with
+ * it between windows.
+ *
+ * Frames carry the low 32 bits of the clocks (wrap after 71 min). Offsets are
+ * unwrapped against the previous one, so robot and remote stamps convert
+ * exactly as long as they are within 35 min of the conversion.
+ *
+ * Header only, no SDK dependency, like omni_wire.h. The estimator runs on the
+ * remote; the robot only stamps its frames.
+ */
+#ifndef OMNI_SYNC_H_
+#define OMNI_SYNC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "omni_wire.h"
+
+#define OMNI_SYNC_SENT_SLOTS        32U         /* Commands whose t1 is kept (bit mask below) */
+#define OMNI_SYNC_WINDOW_US         1000000U    /* One filtered sample per window */
+#define OMNI_SYNC_HISTORY           8U          /* Window minima the drift is taken over */
+#define OMNI_SYNC_WANDER_PPB        20000       /* Drift change allowed for between windows (20 ppm) */
+#define OMNI_SYNC_TOLERANCE_PPB     20000000    /* Until the drift is known: two +-1 % clocks */
+#define OMNI_SYNC_HOLD_NONE         0xFFFFU     /* sync_hold_us: no command to echo */
+
+typedef struct {
+    uint64_t at_us;         /* Remote clock, middle of the exchange */
+    int64_t offset_us;      /* Robot clock - remote clock */
+    uint32_t delay_us;      /* Round trip without the robot's hold */
+} omni_sync_sample_t;
+
+typedef struct {
+    int64_t offset_us;      /* Robot clock - remote clock, now */
+    uint32_t bound_us;      /* The true offset is within +- bound_us */
+    int32_t drift_ppb;      /* Robot clock rate - remote clock rate */
+} omni_sync_estimate_t;
+
+typedef struct {
+    /* t1 of the last commands, slot = counter % OMNI_SYNC_SENT_SLOTS */
+    uint64_t sent_us[OMNI_SYNC_SENT_SLOTS];
+    uint16_t sent_count[OMNI_SYNC_SENT_SLOTS];
+    uint32_t sent_valid;
+
+    omni_sync_sample_t window;          /* Smallest delay of the open window */
+    uint64_t window_start_us;           /* t4 of its first sample (midpoints come out of order) */
+    bool window_open;
+
+    omni_sync_sample_t history[OMNI_SYNC_HISTORY];
+    uint32_t history_count;
+    uint32_t history_newest;
+    int32_t drift_ppb;
+    uint32_t drift_bound_ppb;
+
+    /* One-way times of the last sample, the current offset applied (valid once synced) */
+    int32_t cmd_latency_us;             /* Remote t1 -> robot t2 */
+    int32_t tel_latency_us;             /* Robot t3 -> remote t4 */
+    uint32_t samples;
+    uint32_t unmatched;                 /* Echo of a command no longer (or never) kept */
+} omni_sync_t;
+
+OMNI_WIRE_ASSERT(OMNI_SYNC_SENT_SLOTS <= 32U && (OMNI_SYNC_SENT_SLOTS & (OMNI_SYNC_SENT_SLOTS - 1U)) == 0U,
+                 "OMNI_SYNC_SENT_SLOTS: power of two, one bit each in sent_valid");
+
+/* Robot: hold time for sync_hold_us, OMNI_SYNC_HOLD_NONE if it doesn't fit */
+static inline uint16_t omni_sync_hold_us(uint32_t t3, uint32_t t2)
+{
+    uint32_t hold = t3 - t2;
+    return (hold < OMNI_SYNC_HOLD_NONE) ? (uint16_t)hold : (uint16_t)OMNI_SYNC_HOLD_NONE;
+}
+
+static inline void omni_sync_init(omni_sync_t *s)
+{
+    *s = (omni_sync_t){0};
+}
+
+/* Remote: command `count` (header counter) goes out at t1 */
+static inline void omni_sync_sent(omni_sync_t *s, uint16_t count, uint64_t t1)
+{
+    uint32_t slot = count % OMNI_SYNC_SENT_SLOTS;
+
+    s->sent_us[slot] = t1;
+    s->sent_count[slot] = count;
+    s->sent_valid |= 1UL << slot;
+}
+
+/* Sample the estimate is carried forward from, NULL before the first one */
+static inline const omni_sync_sample_t *omni_sync_base(const omni_sync_t *s)
+{
+    if (s->history_count != 0U) return &s->history[s->history_newest];
+    return s->window_open ? &s->window : NULL;
+}
+
+/* Offset and error bound at remote time `now_us`; false until the first sample */
+static inline bool omni_sync_get(const omni_sync_t *s, uint64_t now_us, omni_sync_estimate_t *out)
+{
+    const omni_sync_sample_t *base = omni_sync_base(s);
+    if (base == NULL) return false;
+
+    int64_t age = (int64_t)(now_us - base->at_us);
+    uint64_t span = (uint64_t)((age < 0) ? -age : age);
+    bool drift_known = (s->history_count >= 2U);
+    int32_t drift = drift_known ? s->drift_ppb : 0;
+    uint64_t uncertainty = drift_known ? (uint64_t)s->drift_bound_ppb + OMNI_SYNC_WANDER_PPB
+                                       : (uint64_t)OMNI_SYNC_TOLERANCE_PPB;
+    uint64_t bound = base->delay_us / 2U + 1U + span * uncertainty / 1000000000U;
+
+    out->offset_us = base->offset_us + age * drift / 1000000000;
+    out->bound_us = (bound < UINT32_MAX) ? (uint32_t)bound : UINT32_MAX;
+    out->drift_ppb = drift;
+    return true;
+}
+
+static inline void omni_sync_commit(omni_sync_t *s, const omni_sync_sample_t *sample)
+{
+    uint32_t newest = (s->history_count == 0U) ? 0U : (s->history_newest + 1U) % OMNI_SYNC_HISTORY;
+
+    s->history[newest] = *sample;
+    s->history_newest = newest;
+    if (s->history_count < OMNI_SYNC_HISTORY) s->history_count++;
+    if (s->history_count < 2U) return;
+
+    /* Slope from the oldest kept minimum; both ends are off by at most delay / 2 */
+    const omni_sync_sample_t *oldest =
+        &s->history[(newest + OMNI_SYNC_HISTORY + 1U - s->history_count) % OMNI_SYNC_HISTORY];
+    int64_t dt = (int64_t)(sample->at_us - oldest->at_us);
+    if (dt <= 0) return;
+
+    s->drift_ppb = (int32_t)((sample->offset_us - oldest->offset_us) * 1000000000 / dt);
+    s->drift_bound_ppb = (uint32_t)(((uint64_t)oldest->delay_us + sample->delay_us) / 2U * 1000000000U / (uint64_t)dt);
+}
+
+/* Remote: telemetry received at t4; true if it gave a sample */
+static inline bool omni_sync_receive(omni_sync_t *s, const RobotTelemetry_t *tel, uint64_t t4)
+{
+    uint16_t count = tel->sync_cmd_count;
+    uint32_t slot = count % OMNI_SYNC_SENT_SLOTS;
+    uint32_t hold = tel->sync_hold_us;
+
+    if (hold == OMNI_SYNC_HOLD_NONE) return false;
+    if (!(s->sent_valid & (1UL << slot)) || s->sent_count[slot] != count)
+    {
+        s->unmatched++;
+        return false;
+    }
+
+    uint64_t t1 = s->sent_us[slot];
+    uint32_t t3 = tel->timestamp;
+    uint32_t t2 = t3 - hold;
+    uint64_t rtt = t4 - t1;
+    if (t4 < t1 || rtt > UINT32_MAX) return false;
+
+    omni_sync_sample_t sample;
+    uint32_t delay = (rtt > hold) ? (uint32_t)rtt - hold : 0U;
+    uint32_t offset32 = (t2 - (uint32_t)t1) - delay / 2U;
+    const omni_sync_sample_t *prev = s->window_open ? &s->window : omni_sync_base(s);
+
+    /* Frames only carry 32 bits: take the offset nearest to the previous one */
+    sample.at_us = t1 + rtt / 2U;
+    sample.offset_us = (prev != NULL) ? prev->offset_us + (int32_t)(offset32 - (uint32_t)prev->offset_us)
+                                      : (int64_t)(int32_t)offset32;
+    sample.delay_us = delay;
+    s->samples++;
+
+    omni_sync_estimate_t est;
+    if (omni_sync_get(s, t1, &est))
+    {
+        s->cmd_latency_us = (int32_t)(t2 - (uint32_t)t1 - (uint32_t)est.offset_us);
+        s->tel_latency_us = (int32_t)((uint32_t)t4 - (t3 - (uint32_t)est.offset_us));
+    }
+
+    if (s->window_open && (int64_t)(t4 - s->window_start_us) >= (int64_t)OMNI_SYNC_WINDOW_US)
+    {
+        omni_sync_commit(s, &s->window);
+        s->window_open = false;
+    }
+    if (!s->window_open)
+    {
+        s->window = sample;
+        s->window_start_us = t4;
+        s->window_open = true;
+    }
+    else if (sample.delay_us < s->window.delay_us)
+    {
+        s->window = sample;
+    }
+    return true;
+}
+
+/* Remote: a robot stamp (telemetry timestamp, low 32 bits) on the remote clock near `now_us` */
+static inline bool omni_sync_to_remote(const omni_sync_t *s, uint32_t robot_us, uint64_t now_us, uint64_t *remote_us)
+{
+    omni_sync_estimate_t est;
+    if (!omni_sync_get(s, now_us, &est)) return false;
+
+    uint32_t remote32 = robot_us - (uint32_t)est.offset_us;
+    *remote_us = now_us + (int64_t)(int32_t)(remote32 - (uint32_t)now_us);
+    return true;
+}
+
+#endif /* OMNI_SYNC_H_ */
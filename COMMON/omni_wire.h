@@ -0,0 +1,211 @@
+/* OMNI WIRE (shared by the remote, the robot and both bridges)
+ *
+ * The frames exchanged over SPI and ESP-NOW, defined once for every node.
+ * Every frame starts with a 32-bit little-endian header word:
+ *
+ *   bits  0- 7  frame length in bytes, header included
+ *   bits  8-23  packet counter
+ *   bits 24-31  frame type (OMNI_WIRE_TYPE_*)
+ *
+ * so the first byte on the wire is the length prefix: the bridges forward only
+ * that many bytes over the air, whatever the master clocked. The type stays in
+ * the top byte, as in the original `(header >> 24) == 0xC5` check.
+ *
+ * Frames are packed structs read and written in place (zero copy): every node
+ * is little-endian and the layout is pinned by the checks below, so a field
+ * change that would break one side fails the build of all of them.
+ *
+ * Header only, no SDK dependency: the MCU projects add COMMON/ to their include
+ * path, the bridges get it through the omni_wire IDF component.
+ */
+#ifndef OMNI_WIRE_H_
+#define OMNI_WIRE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__)
+#error "omni_wire.h: frames are read in place, every node must be little-endian"
+#endif
+
+#ifdef __cplusplus
+#define OMNI_WIRE_ASSERT(expr, msg) static_assert(expr, msg)
+#else
+#define OMNI_WIRE_ASSERT(expr, msg) _Static_assert(expr, msg)
+#endif
+
+/* Largest frame: size of the SPI and air buffers on every node */
+#define OMNI_WIRE_MAX_FRAME         40U
+#define OMNI_WIRE_HEADER_SIZE       4U
+
+/* Frame types */
+#define OMNI_WIRE_TYPE_COMMAND      0xC5U   // Remote -> Robot
+#define OMNI_WIRE_TYPE_TELEMETRY    0xA1U   // Robot -> Remote
+#define OMNI_WIRE_TYPE_FLEET        0xF1U   // Remote bridge -> robot bridges, air only (fleet_link.h)
+#define OMNI_WIRE_TYPE_GAINS        0xC6U   // Remote -> Robot, one PID gain table point (omni_gains.h)
+#define OMNI_WIRE_TYPE_FLEET_TAG    0xF2U   // Robot id behind a frame, fleet mode only (FleetTag_t)
+
+/* Robot ids (fleet mode, fleet_link.h): 0..15, or one of these */
+#define OMNI_WIRE_ROBOT_ALL         0xFFU   // Command: every robot
+#define OMNI_WIRE_ROBOT_NONE        0xFEU   // Command: nobody (only polls the bridge for telemetry)
+
+/* Header word */
+#define OMNI_WIRE_HEADER(type, count, len) \
+    (((uint32_t)(type) << 24) | (((uint32_t)(count) & 0xFFFFU) << 8) | ((uint32_t)(len) & 0xFFU))
+#define OMNI_WIRE_HEADER_TYPE(h)    ((uint8_t)((h) >> 24))
+#define OMNI_WIRE_HEADER_COUNT(h)   ((uint16_t)((h) >> 8))
+#define OMNI_WIRE_HEADER_LEN(h)     ((uint8_t)(h))
+
+/* Command (Remote -> Robot) */
+typedef struct __attribute__((packed)) {
+    uint32_t header;        // OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_COMMAND, counter, sizeof)
+    float vx;               // Linear Velocity X (m/s)
+    float vy;               // Linear Velocity Y (m/s)
+    float phi;              // Angular Velocity (rad/s)
+    uint32_t buttons;       // Button states (bitmask)
+    uint32_t timestamp;     // Remote clock (us, low 32 bits) when clocked out, t1 of omni_sync.h
+} RemoteCommand_t;
+
+/* Gain table point (Remote -> Robot), sent in place of a command; the robot keeps
+ * its last command meanwhile and echoes the header counter in sync_cmd_count, as
+ * for a command, which tells the remote it has the point. Not carried by the
+ * fleet beacons. */
+typedef struct __attribute__((packed)) {
+    uint32_t header;        // OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_GAINS, counter, sizeof)
+    uint8_t seq;            // Taken once, the bridge repeats frames
+    uint8_t index;          // Table point
+    uint8_t points;         // Points in the table from now on
+    uint8_t reserved;
+    float speed;            // |wheel target| of this point (rad/s)
+    float kp;
+    float ki;
+    float kd;
+} RemoteGainPoint_t;
+
+/* Telemetry (Robot -> Remote) */
+typedef struct __attribute__((packed)) {
+    uint32_t packet_header; // OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_TELEMETRY, counter, sizeof)
+
+    /* Motor Speeds (rad/s) */
+    float speed_m1;
+    float speed_m2;
+    float speed_m3;
+    float speed_m4;
+
+    /* Motor Currents (ADC Raw Values) */
+    uint16_t adc_m1;
+    uint16_t adc_m2;
+    uint16_t adc_m3;
+    uint16_t adc_m4;
+
+    /* Clock sync (omni_sync.h) */
+    uint16_t sync_cmd_count; // Counter of the last command (or gain point) received
+    uint16_t sync_hold_us;  // Since that command arrived, OMNI_SYNC_HOLD_NONE if none
+    uint32_t timestamp;     // Robot clock (us, low 32 bits) when filled
+} RobotTelemetry_t;
+
+/* Fleet tag (fleet mode, fleet_link.h). The frames above carry no robot id: where
+ * one is needed it follows the frame, outside its length, on the remote's SPI link
+ * (the robot a command is for, the one a telemetry frame came from) and in the
+ * robot bridges' slot frames. The robots and the point-to-point link never see it. */
+typedef struct __attribute__((packed)) {
+    uint8_t type;           // OMNI_WIRE_TYPE_FLEET_TAG
+    uint8_t robot_id;       // 0..15, or OMNI_WIRE_ROBOT_ALL / OMNI_WIRE_ROBOT_NONE on a command
+    uint8_t reserved[2];
+} FleetTag_t;
+
+/* Bytes an MCU clocks per SPI exchange: the longer of its own frame and the one it receives */
+#define OMNI_WIRE_EXCHANGE_SIZE \
+    ((sizeof(RobotTelemetry_t) > sizeof(RemoteCommand_t)) ? sizeof(RobotTelemetry_t) : sizeof(RemoteCommand_t))
+
+/* Fleet mode: what the remote and its bridge clock, the longer frame and its tag */
+#define OMNI_WIRE_FLEET_EXCHANGE_SIZE   (OMNI_WIRE_EXCHANGE_SIZE + sizeof(FleetTag_t))
+
+/* Layout checks */
+OMNI_WIRE_ASSERT(sizeof(RemoteCommand_t) == 24U, "RemoteCommand_t size changed");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, header) == 0U, "RemoteCommand_t.header");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, vx) == 4U, "RemoteCommand_t.vx");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, vy) == 8U, "RemoteCommand_t.vy");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, phi) == 12U, "RemoteCommand_t.phi");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, buttons) == 16U, "RemoteCommand_t.buttons");
+OMNI_WIRE_ASSERT(offsetof(RemoteCommand_t, timestamp) == 20U, "RemoteCommand_t.timestamp");
+
+OMNI_WIRE_ASSERT(sizeof(RemoteGainPoint_t) == 24U, "RemoteGainPoint_t size changed");
+OMNI_WIRE_ASSERT(offsetof(RemoteGainPoint_t, seq) == 4U, "RemoteGainPoint_t.seq");
+OMNI_WIRE_ASSERT(offsetof(RemoteGainPoint_t, speed) == 8U, "RemoteGainPoint_t.speed");
+OMNI_WIRE_ASSERT(offsetof(RemoteGainPoint_t, kd) == 20U, "RemoteGainPoint_t.kd");
+
+OMNI_WIRE_ASSERT(sizeof(RobotTelemetry_t) == 36U, "RobotTelemetry_t size changed");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, packet_header) == 0U, "RobotTelemetry_t.packet_header");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, speed_m1) == 4U, "RobotTelemetry_t.speed_m1");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, speed_m4) == 16U, "RobotTelemetry_t.speed_m4");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, adc_m1) == 20U, "RobotTelemetry_t.adc_m1");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, adc_m4) == 26U, "RobotTelemetry_t.adc_m4");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, sync_cmd_count) == 28U, "RobotTelemetry_t.sync_cmd_count");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, sync_hold_us) == 30U, "RobotTelemetry_t.sync_hold_us");
+OMNI_WIRE_ASSERT(offsetof(RobotTelemetry_t, timestamp) == 32U, "RobotTelemetry_t.timestamp");
+
+OMNI_WIRE_ASSERT(sizeof(FleetTag_t) == 4U, "FleetTag_t size changed");
+
+/* The ESP32 SPI slave DMA moves whole words; the length must fit the prefix byte */
+OMNI_WIRE_ASSERT((sizeof(RemoteCommand_t) % 4U) == 0U, "RemoteCommand_t must be a multiple of 4 bytes");
+OMNI_WIRE_ASSERT((sizeof(RemoteGainPoint_t) % 4U) == 0U, "RemoteGainPoint_t must be a multiple of 4 bytes");
+OMNI_WIRE_ASSERT((sizeof(RobotTelemetry_t) % 4U) == 0U, "RobotTelemetry_t must be a multiple of 4 bytes");
+OMNI_WIRE_ASSERT(OMNI_WIRE_EXCHANGE_SIZE <= OMNI_WIRE_MAX_FRAME, "Frames must fit OMNI_WIRE_MAX_FRAME");
+OMNI_WIRE_ASSERT(OMNI_WIRE_FLEET_EXCHANGE_SIZE <= OMNI_WIRE_MAX_FRAME, "A tagged frame must fit the buffers too");
+OMNI_WIRE_ASSERT(OMNI_WIRE_MAX_FRAME <= 0xFFU, "Frame length is a single byte");
+
+/* Length of the frame at `buf` from its prefix, 0 if it isn't a frame
+ * (too short, longer than the `avail` bytes received, or an idle bus of zeros) */
+static inline size_t omni_wire_frame_len(const uint8_t *buf, size_t avail)
+{
+    if (avail < OMNI_WIRE_HEADER_SIZE) return 0;
+
+    size_t len = buf[0];
+    if (len < OMNI_WIRE_HEADER_SIZE || len > avail || len > OMNI_WIRE_MAX_FRAME) return 0;
+    return len;
+}
+
+/* In-place views: NULL unless `buf` holds a complete frame of that type */
+static inline const RemoteCommand_t *omni_wire_command(const uint8_t *buf, size_t avail)
+{
+    if (omni_wire_frame_len(buf, avail) != sizeof(RemoteCommand_t) || buf[3] != OMNI_WIRE_TYPE_COMMAND) return NULL;
+    return (const RemoteCommand_t *)buf;
+}
+
+static inline const RemoteGainPoint_t *omni_wire_gain_point(const uint8_t *buf, size_t avail)
+{
+    if (omni_wire_frame_len(buf, avail) != sizeof(RemoteGainPoint_t) || buf[3] != OMNI_WIRE_TYPE_GAINS) return NULL;
+    return (const RemoteGainPoint_t *)buf;
+}
+
+static inline const RobotTelemetry_t *omni_wire_telemetry(const uint8_t *buf, size_t avail)
+{
+    if (omni_wire_frame_len(buf, avail) != sizeof(RobotTelemetry_t) || buf[3] != OMNI_WIRE_TYPE_TELEMETRY) return NULL;
+    return (const RobotTelemetry_t *)buf;
+}
+
+/* Robot id of the fleet tag behind the frame at `buf`, OMNI_WIRE_ROBOT_NONE if there is none */
+static inline uint8_t omni_wire_fleet_id(const uint8_t *buf, size_t avail)
+{
+    size_t len = omni_wire_frame_len(buf, avail);
+
+    if (len == 0 || avail - len < sizeof(FleetTag_t) || buf[len] != OMNI_WIRE_TYPE_FLEET_TAG) return OMNI_WIRE_ROBOT_NONE;
+    return ((const FleetTag_t *)(buf + len))->robot_id;
+}
+
+/* Puts the fleet tag behind the frame at `buf` (room for sizeof(FleetTag_t) more),
+ * returns the bytes of frame and tag */
+static inline size_t omni_wire_set_fleet_id(uint8_t *buf, uint8_t robot_id)
+{
+    size_t len = buf[0];
+    FleetTag_t *tag = (FleetTag_t *)(buf + len);
+
+    tag->type = OMNI_WIRE_TYPE_FLEET_TAG;
+    tag->robot_id = robot_id;
+    tag->reserved[0] = 0;
+    tag->reserved[1] = 0;
+    return len + sizeof(FleetTag_t);
+}
+
+#endif /* OMNI_WIRE_H_ */
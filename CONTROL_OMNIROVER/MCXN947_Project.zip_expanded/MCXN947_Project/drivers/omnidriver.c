@@ -11,6 +11,7 @@
 #include "GPIO_DRIVER.h"
 #include "PWM_DRIVER.h"
 #include "ADC_DRIVER.h"
+#include "omni_place.h"
 #include <math.h>
 #include <stdlib.h>
 
@@ -21,6 +22,10 @@ gpio_pin_config_t gpio_output = {
 	.outputLogic = 0U
 };
 
+#if PID_SCHEDULE_PROFILE
+PID_SCHEDULE_STATS pid_schedule_profile;
+#endif
+
 
 //Functions
 
@@ -48,7 +53,7 @@ void MOTOR_init(MOTOR_T *motor){
 
 }
 
-void MOTOR_run(MOTOR_T *motor, uint32_t duty_cyle, MOTOR_DIRECTION direction){
+OMNI_PLACE_PID_CODE void MOTOR_run(MOTOR_T *motor, uint32_t duty_cyle, MOTOR_DIRECTION direction){
 
 	if(motor == NULL){
 		PRINTF("INVALID INPUT FOR MOTOR POINTER (NULL)");
@@ -75,7 +80,7 @@ void MOTOR_run(MOTOR_T *motor, uint32_t duty_cyle, MOTOR_DIRECTION direction){
  *
  * This function abstracts the core logic from the TIMER_1 callback.
  */
-void MOTOR_SetPwmDutyCycle(MOTOR_T *motor, uint16_t dutyCycle)
+OMNI_PLACE_PID_CODE void MOTOR_SetPwmDutyCycle(MOTOR_T *motor, uint16_t dutyCycle)
 {
     // The core logic is: update the duty cycle, then set the Load Okay (LDOK) bit.
 
@@ -153,7 +158,7 @@ void ENABLE_SetDirection(ENABLE_PIN *enable){
 	return;
 }
 
-void ENABLE_SetOutput(ENABLE_PIN *enable, uint32_t output){
+OMNI_PLACE_PID_CODE void ENABLE_SetOutput(ENABLE_PIN *enable, uint32_t output){
 
 	switch(enable->PORT)
     {
@@ -202,17 +207,137 @@ void MOTOR_ADC_Read(MOTOR_T * motor)
 
 
 //CONTROL
-float pid_compute(MOTOR_T* motor)
+
+/* Gains for the wheel's target speed from its table. Ki*integral is kept across a
+ * Ki change (bumpless), otherwise every target change would kick the output; the
+ * 2DOF form integrates Ki*e, which keeps it by itself. */
+OMNI_PLACE_PID_CODE static void pid_schedule(PID_CONFIG* pid, float speed)
+{
+    omni_gain_point_t g;
+
+#if PID_SCHEDULE_PROFILE
+    uint32_t start = DWT->CYCCNT;
+#endif
+    omni_gains_lookup(omni_gains_table(pid->gains), speed, &g);
+#if PID_SCHEDULE_PROFILE
+    uint32_t cycles = DWT->CYCCNT - start;
+    pid_schedule_profile.lookups++;
+    pid_schedule_profile.cycles_sum += cycles;
+    if(cycles > pid_schedule_profile.cycles_max){
+    	pid_schedule_profile.cycles_max = cycles;
+    }
+#endif
+
+    if(pid->form == PID_FORM_CLASSIC && g.ki > 0.0f && g.ki != pid->Ki){
+    	pid->integral_err *= pid->Ki / g.ki;
+    }
+    pid->Kp = g.kp;
+    pid->Ki = g.ki;
+    pid->Kd = g.kd;
+}
+
+/* PWM counts the motor model gives for the target; the integral only makes up the model's error */
+OMNI_PLACE_PID_CODE static float pid_feedforward(const PID_CONFIG* pid, float target)
+{
+    if(pid->model == NULL){
+    	return 0.0f;
+    }
+    return motor_model_duty(pid->model, target) * MAX_PWM_DEFINITION;
+}
+
+/*
+ * PID_FORM_2DOF, measured: signed wheel speed.
+ *   u = Kp*(b*r - y) + I + D,  D = -Kd*dy/dt through a first order filter (Tf)
+ *   I += Ki*(r - y)*dt + (u_applied - u)*dt/Tt
+ * No derivative kick and less overshoot on a joystick step, and the integral
+ * follows the PWM actually applied (saturated, or 0 while released) instead of
+ * winding up. Through zero speed nothing is reset: a released wheel's integral
+ * bleeds off with Tt, a reversal brakes and drives on with the same state.
+ */
+OMNI_PLACE_PID_CODE static float pid_compute_2dof(MOTOR_T* motor, float measured, float dt)
+{
+    PID_CONFIG* pid = motor->PID;
+    float tt = pid->Tt;
+    float output;
+    float applied;
+
+    if(tt <= 0.0f){
+    	tt = (pid->Ki > 0.0f) ? pid->Kp / pid->Ki : 0.0f;
+    }
+
+    pid->derivative = (pid->Tf * pid->derivative - pid->Kd * (measured - pid->previous_meas)) / (pid->Tf + dt);
+    pid->previous_meas = measured;
+
+    output = pid_feedforward(pid, motor->target) + pid->Kp * (pid->b * motor->target - measured) +
+             pid->integral_err + pid->derivative;
+
+    if(motor->target == 0 && motor->speed < PID_SPIN_STILL){
+    	applied = 0;    // Stopped: released, as the classic form does
+    } else {
+    	applied = MIN(output, MAX_PWM_DEFINITION);
+    	applied = MAX(applied, MIN_PWM_DEFINITION);
+    }
+
+    pid->integral_err += pid->Ki * (motor->target - measured) * dt;
+    if(tt > 0.0f){
+    	pid->integral_err += (applied - output) * MIN(dt / tt, 1.0f);
+    }
+    pid->last_output = applied;
+
+    if(applied < 0){
+    	motor->direction = MOTOR_BACKWARDS;
+    	MOTOR_run(motor, (uint32_t)(-applied), MOTOR_BACKWARDS);
+    } else {
+    	motor->direction = MOTOR_FORWARD;
+    	MOTOR_run(motor, (uint32_t)applied, MOTOR_FORWARD);
+    }
+    return applied;
+}
+
+/* The encoder gives |w| only. A wheel keeps turning the same way until it has
+ * nearly stopped, whatever it is driven; only then it follows the drive. Taking
+ * the sign from the drive alone turned every overshoot into full forward and
+ * full reverse on alternate periods. Driven against its turn it can only slow
+ * down, so getting faster again means it went through zero between two edges
+ * (the speed only updates on an edge and may never read near 0 on a reversal).
+ * The 2DOF form and the classic one with PID_CLASSIC_SPIN use it. */
+OMNI_PLACE_PID_CODE static void pid_track_spin(MOTOR_T* motor)
+{
+    if(motor->direction == motor->spin || motor->speed < motor->spin_min){
+    	motor->spin_min = motor->speed;
+    }
+    if(motor->speed < PID_SPIN_STILL || motor->speed > motor->spin_min * PID_SPIN_REVERSED + PID_SPIN_STILL){
+    	motor->spin = motor->direction;
+    	motor->spin_min = motor->speed;
+    }
+}
+
+OMNI_PLACE_PID_CODE float pid_compute(MOTOR_T* motor)
 {
     float output;
     float error;
     float dt =  1.0f / ( PID_TIMER_FREQ);
+    MOTOR_DIRECTION sign = motor->direction;
 
-    if(abs(motor->target) < 0.01){
+    /* The classic loop's abs() takes the int part: every target under 1 rad/s is 0 */
+    if(fabsf(motor->target) < ((motor->PID->form == PID_FORM_CLASSIC && !PID_CLASSIC_SPIN) ? 1.0f : 0.01f)){
     	motor->target = 0;
     }
 
-    if(motor->direction == MOTOR_FORWARD){
+    if(motor->PID->gains != NULL){
+    	pid_schedule(motor->PID, fabsf(motor->target));
+    }
+
+    if(motor->PID->form == PID_FORM_2DOF){
+    	pid_track_spin(motor);
+    	return pid_compute_2dof(motor, (motor->spin == MOTOR_FORWARD) ? motor->speed : -motor->speed, dt);
+    }
+
+#if PID_CLASSIC_SPIN
+    pid_track_spin(motor);
+    sign = motor->spin;
+#endif
+    if(sign == MOTOR_FORWARD){
     	error = motor->target - motor->speed;
     } else {
     	error = motor->target + motor->speed;
@@ -226,8 +351,9 @@ float pid_compute(MOTOR_T* motor)
     motor->PID->integral_err = MAX(motor->PID->integral_err, motor->PID->min_integral);
 
     /* Calculate the pid control value by location formula */
-    /* u(k) = e(k)*Kp + (e(k)-e(k-1))*Kd + integral*Ki */
-    output = error * motor->PID->Kp +
+    /* u(k) = ff + e(k)*Kp + (e(k)-e(k-1))*Kd + integral*Ki */
+    output = pid_feedforward(motor->PID, motor->target) +
+             error * motor->PID->Kp +
              ( (error - motor->PID->previous_err1) / dt ) * motor->PID->Kd +
 			 motor->PID->integral_err * motor->PID->Ki;
 
@@ -237,14 +363,21 @@ float pid_compute(MOTOR_T* motor)
 
 
     if(output > 0){
-    	output = abs(output);
+    	motor->PID->last_output = output;
+    	output = fabsf(output);
     	motor->direction = MOTOR_FORWARD;
     	MOTOR_run(motor, output, MOTOR_FORWARD);
     } else if(motor->target == 0){
+    	motor->PID->last_output = 0;
     	motor->direction = MOTOR_FORWARD;
 		MOTOR_run(motor, 0, MOTOR_FORWARD);
+#if PID_CLASSIC_SPIN
+		/* Released, it coasts: what it summed meanwhile would kick the next start */
+		motor->PID->integral_err = 0;
+#endif
 	}else {
-    	output = abs(output);
+    	motor->PID->last_output = output;
+    	output = fabsf(output);
     	motor->direction = MOTOR_BACKWARDS;
     	MOTOR_run(motor, output, MOTOR_BACKWARDS);
     }
@@ -259,48 +392,30 @@ float pid_compute(MOTOR_T* motor)
 // =============================================================================
 // KINEMATICS FUNCTION
 // =============================================================================
-void ROBOT_compute_kinematics(ROBOT_T *robot)
+OMNI_PLACE_PID_CODE void ROBOT_compute_kinematics(ROBOT_T *robot)
 {
     if(robot == NULL){
     	PRINTF("NULL ROBOT POINTER");
     	return;
     }
 
-    float vx = robot->vx;
-    float vy = robot->vy;
-    float w  = robot->phi; // Angular velocity
-    float L  = ROBOT_LX + ROBOT_LY; // Geometric constant
-    float R  = WHEEL_RADIUS;
-
-    // Inverse Kinematics for 4-Wheel Mecanum (Standard X Config)
-    // Wheel 1 (Front Left):  1/R * (Vy + Vx - w*L)
-    // Wheel 2 (Front Right): 1/R * (Vy - Vx + w*L)
-    // Wheel 3 (Rear Left):   1/R * (Vy - Vx - w*L)
-    // Wheel 4 (Rear Right):  1/R * (Vy + Vx + w*L)
-
-    // NOTE: Verify your motor numbering layout! Assuming:
-    // M1 = Front Left
-    // M2 = Rear Left
-    // M3 = Rear Right
-    // M4 = Front Right
-
-    // Targets in Rad/s
-    float t1 = (vx - vy - w * L) / R;
-    float t2 = (vx + vy + w * L) / R;
-    float t3 = (vx + vy - w * L) / R;
-    float t4 = (vx - vy + w * L) / R;
-
-    // Safety Clamp (Max 15 rad/s per your spec, limiting to 10 for safety)
-    #define MAX_TARGET_SPEED 10.0f
-    if(t1 > MAX_TARGET_SPEED) t1 = MAX_TARGET_SPEED; else if(t1 < -MAX_TARGET_SPEED) t1 = -MAX_TARGET_SPEED;
-    if(t2 > MAX_TARGET_SPEED) t2 = MAX_TARGET_SPEED; else if(t2 < -MAX_TARGET_SPEED) t2 = -MAX_TARGET_SPEED;
-    if(t3 > MAX_TARGET_SPEED) t3 = MAX_TARGET_SPEED; else if(t3 < -MAX_TARGET_SPEED) t3 = -MAX_TARGET_SPEED;
-    if(t4 > MAX_TARGET_SPEED) t4 = MAX_TARGET_SPEED; else if(t4 < -MAX_TARGET_SPEED) t4 = -MAX_TARGET_SPEED;
-
-    robot->M1->target = t1;
-    robot->M4->target = t2;
-    robot->M2->target = t3;
-    robot->M3->target = t4;
+    MOTOR_T *motors[4] = {robot->M1, robot->M2, robot->M3, robot->M4};
+    omni_kin_twist_t v = {robot->vx, robot->vy, robot->phi};
+    float w[OMNI_KIN_WHEELS];
+    float max = (robot->max_target > 0.0f) ? robot->max_target : MAX_TARGET_SPEED;
+
+    // Inverse kinematics of the layout (omni_kinematics.h), targets in rad/s in motor order
+    omni_kin_inverse(&v, w);
+
+    // Over MAX_TARGET_SPEED (unless the robot sets its own): all wheels slow down alike,
+    // the robot keeps the commanded direction
+    (void)omni_kin_desaturate(w, max);
+
+    for(uint32_t i = 0; i < 4U; i++){
+    	if(motors[i] != NULL){
+    		motors[i]->target = (i < OMNI_KIN_WHEELS) ? w[i] : 0.0f;
+    	}
+    }
 }
 
 
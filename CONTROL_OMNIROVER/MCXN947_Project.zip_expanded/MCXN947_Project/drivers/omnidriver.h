@@ -13,6 +13,8 @@
 #include "fsl_lpadc.h"
 #include "fsl_port.h"
 #include "fsl_debug_console.h"
+#include "omni_gains.h"
+#include "motor_model.h"
 
 
 #define PID_TIMER_TICKS    1000
@@ -20,11 +22,31 @@
 #define PID_TIMER_FREQ     (float)(PID_TIMER_SRC_FREQ/PID_TIMER_TICKS)
 #define MAX_PWM_DEFINITION 65535
 #define MIN_PWM_DEFINITION -65535
+#define PID_SPIN_STILL     0.2f     // rad/s: below it the wheel may turn either way (MOTOR_T.spin)
+#define PID_SPIN_REVERSED  1.2f     // Driven against spin, speed back above this times its low: it reversed
+
+// Classic PID (PID_FORM_CLASSIC) changes not tried on the motors yet. 1 = the speed sign from the
+// wheel's spin (MOTOR_T.spin) instead of the last drive, targets under 1 rad/s kept, the integral
+// cleared while a wheel is released. 0 = the loop the robot has always run
+#ifndef PID_CLASSIC_SPIN
+#define PID_CLASSIC_SPIN   0
+#endif
+
+// 1 = time the gain lookup of every pid_compute() on the DWT cycle counter (pid_schedule_profile)
+#ifndef PID_SCHEDULE_PROFILE
+#define PID_SCHEDULE_PROFILE 0
+#endif
 
 // Robot Physical Constants (Meters)
 #define ROBOT_LX           0.125f   // 12.5 cm - Dist from center to wheel along X
 #define ROBOT_LY           0.1575f  // 15.75 cm - Dist from center to wheel along Y
 #define WHEEL_RADIUS       0.05f    // Example: 5cm (Update this to your actual wheel radius!)
+#define MAX_TARGET_SPEED   10.0f    // rad/s: fastest wheel target (15 rad/s per the spec, 10 for safety)
+
+// Wheel layout (omni_kinematics.h, OMNI_KIN_LAYOUT, mecanum by default) and its geometry
+#define OMNI_KIN_L         (ROBOT_LX + ROBOT_LY)
+#define OMNI_KIN_R         WHEEL_RADIUS
+#include "omni_kinematics.h"
 
 // Communication Limits
 #define MAX_LINEAR_SPEED   0.5f     // m/s (Safe limit)
@@ -36,6 +58,11 @@ typedef enum {
   MOTOR_BACKWARDS,
 } MOTOR_DIRECTION;
 
+typedef enum {
+  PID_FORM_CLASSIC,  // P and D on the error, integral of the error clamped, output 0 at target 0
+  PID_FORM_2DOF,     // Setpoint weight b, filtered D on the measurement, back-calculation anti-windup
+} PID_FORM;
+
 
 typedef struct _ENCODER_PIN{
 	uint32_t PORT;
@@ -69,12 +96,34 @@ typedef struct _PID_CONFIG{ //Struct to configure the PID parameters
     float previous_err1; // e(k)
     float previous_err2; // e(k-1)
     float integral_err;  // Sum of error
-    float last_output;  // PID output in last control period
+    float last_output;  // PID output in last control period (signed PWM counts, as applied)
     float max_integral; // PID maximum integral value limitation
     float min_integral; // PID minimum integral value limitation
 
+    omni_gains_t *gains; // Speed-scheduled Kp/Ki/Kd (omni_gains.h), NULL = the fixed ones above
+
+    PID_FORM form;
+    // PID_FORM_2DOF: integral_err holds Ki*sum(e*dt), in PWM counts like the output
+    float b;             // Setpoint weight of the P term (1 = P on the error)
+    float Tf;            // Derivative filter time constant (s)
+    float Tt;            // Anti-windup tracking time constant (s), 0 = Kp/Ki
+    float derivative;    // Filtered D term
+    float previous_meas; // Signed speed in the last control period
+
+    const motor_model_t *model; // Feed-forward: the duty this motor needs for the target, NULL = none
+
 } PID_CONFIG;
 
+#if PID_SCHEDULE_PROFILE
+typedef struct _PID_SCHEDULE_STATS{
+	volatile uint32_t lookups;
+	volatile uint32_t cycles_sum;
+	volatile uint32_t cycles_max;
+} PID_SCHEDULE_STATS;
+
+extern PID_SCHEDULE_STATS pid_schedule_profile;
+#endif
+
 /**
  * @brief Structure to hold ADC configuration for the motor (e.g. Current Sensing)
  */
@@ -101,7 +150,9 @@ typedef struct _MOTOR_T{
 
     float current; //Current of the motor
 
-    MOTOR_DIRECTION direction;
+    MOTOR_DIRECTION direction; //Last driven
+    MOTOR_DIRECTION spin;      //Way the wheel turns (speed is |w|), see pid_compute()
+    float spin_min;            //Lowest speed since it is driven against spin
     ENABLE_PIN *MINA;    //The enable clockwise
     ENABLE_PIN *MINB;    //The enable counterclockwise
     ENCODER_PIN *ENC_A;   //Encoder A pin
@@ -118,10 +169,11 @@ typedef struct _ROBOT_T{
 	float vx;
 	float vy;
 	float phi;
+	float max_target;  // Fastest wheel target (rad/s), 0 = MAX_TARGET_SPEED
 	MOTOR_T *M1;
 	MOTOR_T *M2;
 	MOTOR_T *M3;
-	MOTOR_T *M4;
+	MOTOR_T *M4;       // Unused with a three wheel layout (OMNI_KIN_WHEELS)
 
 } ROBOT_T;
 
@@ -18,6 +18,17 @@ const uint32_t g_LpadcResultShift = 3U;
 // Flag to ensure global initialization happens only once
 static bool g_isAdcInitialized = false;
 
+// Calibration runs in steps from poll_ADC_calibration(), read_ADC() waits for it
+typedef enum {
+    ADC_CAL_OFFSET,
+    ADC_CAL_GAIN,
+    ADC_CAL_DONE
+} adc_cal_step_t;
+
+static ADC_Type * g_calAdcBase = NULL;
+static adc_cal_step_t g_calStep = ADC_CAL_OFFSET;
+static volatile bool g_isAdcCalibrated = false;
+
 void init_ADC(ADC_Type * adc_base, SPC_Type * spc_base, VREF_Type * vref_base, uint32_t user_channel, uint32_t user_cmdid){
 
     lpadc_config_t mLpadcConfigStruct;
@@ -50,9 +61,11 @@ void init_ADC(ADC_Type * adc_base, SPC_Type * spc_base, VREF_Type * vref_base, u
 
         LPADC_Init(adc_base, &mLpadcConfigStruct);
 
-        // Calibration takes time, do it only once
-        LPADC_DoOffsetCalibration(adc_base);
-        LPADC_DoAutoCalibration(adc_base);
+        // Calibration takes time, do it only once: LPADC_DoOffsetCalibration() and
+        // LPADC_DoAutoCalibration() without their busy waits, see poll_ADC_calibration()
+        LPADC_EnableOffsetCalibration(adc_base, true);
+        g_calAdcBase = adc_base;
+        g_calStep = ADC_CAL_OFFSET;
 
         g_isAdcInitialized = true;
     }
@@ -87,6 +100,11 @@ uint32_t read_ADC(ADC_Type * adc_base, uint32_t user_cmdid)
     uint32_t triggerId = user_cmdid - 1U;
     uint32_t triggerMask = (1U << triggerId);
 
+    if (!g_isAdcCalibrated)
+    {
+        return 0U;
+    }
+
     // Trigger the specific conversion
     LPADC_DoSoftwareTrigger(adc_base, triggerMask);
 
@@ -101,3 +119,38 @@ uint32_t read_ADC(ADC_Type * adc_base, uint32_t user_cmdid)
     uint32_t adcRaw = (mLpadcResultConfigStruct.convValue >> g_LpadcResultShift);
     return adcRaw;
 }
+
+bool poll_ADC_calibration(void)
+{
+    if (g_calAdcBase == NULL)
+    {
+        return false;
+    }
+
+    switch (g_calStep)
+    {
+        case ADC_CAL_OFFSET:
+            if ((LPADC_GetStatusFlags(g_calAdcBase) & (uint32_t)kLPADC_CalibrationReadyFlag) == 0U)
+            {
+                return false;
+            }
+            // Offset done: request the gain calibration
+            LPADC_PrepareAutoCalibration(g_calAdcBase);
+            g_calStep = ADC_CAL_GAIN;
+            return false;
+
+        case ADC_CAL_GAIN:
+            // Both sides measured; the SDK computes and writes the gain from there
+            if ((g_calAdcBase->GCC[0] & g_calAdcBase->GCC[1] & ADC_GCC_RDY_MASK) == 0U)
+            {
+                return false;
+            }
+            (void)LPADC_FinishAutoCalibration(g_calAdcBase);
+            g_calStep = ADC_CAL_DONE;
+            g_isAdcCalibrated = true;
+            return true;
+
+        default:
+            return true;
+    }
+}
@@ -14,4 +14,8 @@
 void init_ADC(ADC_Type * adc_base, SPC_Type * spc_base, VREF_Type * vref_base, uint32_t user_channel, uint32_t user_cmdid);
 uint32_t read_ADC(ADC_Type * adc_base, uint32_t user_cmdid);
 
+/* The first init_ADC() only starts the calibration (offset, then gain); call this from the
+ * main loop until it returns true. read_ADC() returns 0 until then. */
+bool poll_ADC_calibration(void);
+
 #endif /* ADC_DRIVER_H_ */
@@ -7,26 +7,62 @@
  */
 
 #include "ESP_SPI.h"
+#include "omni_place.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+typedef struct
+{
+    uint8_t *txData;
+    uint8_t *rxData;
+    uint32_t size;
+    esp_spi_callback_t callback;
+    void *userData;
+} esp_spi_frame_t;
 
 /*******************************************************************************
  * Variables
  ******************************************************************************/
 /* Driver State */
 static LPSPI_Type *g_espSpiBase = NULL;
+static bool g_useEdma = false;
+
+/* Frame queue: g_frameQueue[g_queueHead] is the frame on the bus */
+static esp_spi_frame_t g_frameQueue[ESP_SPI_QUEUE_LEN];
+static volatile uint32_t g_queueHead = 0;
+static volatile uint32_t g_queueCount = 0;
+static volatile bool g_isMasterTransferCompleted = true;
+
+/* Interrupt transport */
 static uint8_t *g_masterRxData = NULL;
 static uint8_t *g_masterTxData = NULL;
 
+static volatile uint32_t g_masterTransferSize = ESP_SPI_TRANSFER_SIZE;
 static volatile uint32_t g_masterTxCount = 0;
 static volatile uint32_t g_masterRxCount = 0;
 static volatile uint8_t g_masterRxWatermark = 0;
 static volatile uint8_t g_masterFifoSize = 0;
-static volatile bool g_isMasterTransferCompleted = true;
+static volatile bool g_masterPcsReleased = false;
+
+#if ESP_SPI_USE_EDMA
+/* eDMA transport */
+static uint32_t g_masterPcsFlags = 0;
+static lpspi_master_edma_handle_t g_masterEdmaHandle;
+static edma_handle_t g_masterRxEdmaHandle;
+static edma_handle_t g_masterTxEdmaHandle;
+#endif
+
+/*******************************************************************************
+ * Prototypes
+ ******************************************************************************/
+static void ESP_SPI_StartFrame(void);
 
 /*******************************************************************************
  * Code
  ******************************************************************************/
 
-void ESP_SPI_Init(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs)
+static void ESP_SPI_ConfigureMaster(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs)
 {
     lpspi_master_config_t masterConfig;
 
@@ -74,67 +110,118 @@ void ESP_SPI_Init(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whic
     LPSPI_SelectTransferPCS(g_espSpiBase, whichPcs);
     LPSPI_SetPCSContinous(g_espSpiBase, true);
 
+    /* Nothing queued */
+    g_queueHead = 0;
+    g_queueCount = 0;
+    g_isMasterTransferCompleted = true;
+}
+
+void ESP_SPI_Init(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs)
+{
+    g_useEdma = false;
+    ESP_SPI_ConfigureMaster(base, srcClock_Hz, whichPcs);
+
     /* Note: NVIC Enable (EnableIRQ) must be handled by the application or upper layer
        as it requires the specific IRQn_Type which depends on the instance used. */
 }
 
-void ESP_SPI_StartTransfer(uint8_t *txData, uint8_t *rxData)
+/* Frame on the bus is done: start the next one, then hand the buffers back (IRQ context) */
+OMNI_PLACE_ISR_CODE static void ESP_SPI_FrameDone(status_t status)
 {
-    /* Wait for previous transfer to complete if called prematurely */
-    while (!g_isMasterTransferCompleted) {}
+    esp_spi_frame_t done;
+    uint32_t primask = DisableGlobalIRQ();
 
-    g_masterTxData = txData;
-    g_masterRxData = rxData;
-    g_masterTxCount = 0;
-    g_masterRxCount = 0;
-    g_isMasterTransferCompleted = false;
+    done = g_frameQueue[g_queueHead];
+    g_queueHead = (g_queueHead + 1U) % ESP_SPI_QUEUE_LEN;
+    g_queueCount--;
 
-    /* Flush FIFOs before starting */
-    LPSPI_FlushFifo(g_espSpiBase, true, true);
-    LPSPI_ClearStatusFlags(g_espSpiBase, kLPSPI_AllStatusFlag);
+    if (g_queueCount != 0U)
+    {
+        ESP_SPI_StartFrame();
+    }
+    else
+    {
+        g_isMasterTransferCompleted = true;
+    }
+    EnableGlobalIRQ(primask);
 
-    /* Ensure continuous mode is set for the start of transfer */
-    LPSPI_SetPCSContinous(g_espSpiBase, true);
+    if (done.callback != NULL)
+    {
+        done.callback(done.txData, done.rxData, done.size, status, done.userData);
+    }
+}
 
-    /* Fill up the TX data in FIFO initially */
-    while ((LPSPI_GetTxFifoCount(g_espSpiBase) < g_masterFifoSize) &&
+/*
+ * Interrupt transport
+ */
+
+/* Push TX bytes while the FIFO has room, then end the frame (PCS continuous off).
+ * If the FIFO is full when the last byte is in, the PCS release waits for the next
+ * RX interrupt instead of spinning here: there is always one, the bytes still in the
+ * FIFO have to come back. */
+OMNI_PLACE_ISR_CODE static void ESP_SPI_FillTxFifo(void)
+{
+    while ((g_masterTxCount < g_masterTransferSize) &&
+           (LPSPI_GetTxFifoCount(g_espSpiBase) < g_masterFifoSize) &&
            (g_masterTxCount - g_masterRxCount < g_masterFifoSize))
     {
         /* Write the word to TX register */
         LPSPI_WriteData(g_espSpiBase, g_masterTxData[g_masterTxCount]);
         ++g_masterTxCount;
-
-        if (g_masterTxCount == ESP_SPI_TRANSFER_SIZE)
-        {
-            /* Wait for room in FIFO for TCR write if needed (though we just write data here) */
-            while (LPSPI_GetTxFifoCount(g_espSpiBase) == g_masterFifoSize)
-            {
-            }
-            /* Set the PCS back to discontinuous to finish the transfer if all tx data pushed. */
-            LPSPI_SetPCSContinous(g_espSpiBase, false);
-            break;
-        }
     }
 
-    /* Enable RX Interrupt to handle the rest of the transfer in ISR */
-    LPSPI_EnableInterrupts(g_espSpiBase, kLPSPI_RxInterruptEnable);
+    if ((g_masterTxCount == g_masterTransferSize) && !g_masterPcsReleased &&
+        (LPSPI_GetTxFifoCount(g_espSpiBase) < g_masterFifoSize))
+    {
+        /* Set the PCS back to discontinuous to finish the transfer if all tx data pushed. */
+        LPSPI_SetPCSContinous(g_espSpiBase, false);
+        g_masterPcsReleased = true;
+    }
 }
 
-bool ESP_SPI_IsTransferCompleted(void)
+OMNI_PLACE_ISR_CODE static void ESP_SPI_StartFrameIrq(const esp_spi_frame_t *frame)
 {
-    return g_isMasterTransferCompleted;
+    uint32_t rxWatermark = g_masterRxWatermark;
+
+    g_masterTxData = frame->txData;
+    g_masterRxData = frame->rxData;
+    g_masterTransferSize = frame->size;
+    g_masterTxCount = 0;
+    g_masterRxCount = 0;
+    g_masterPcsReleased = false;
+
+    /* Only the RX FIFO: the PCS release of the previous frame may not have left the TX
+     * FIFO yet, flushing it would merge both frames into one CS period */
+    LPSPI_FlushFifo(g_espSpiBase, false, true);
+    LPSPI_ClearStatusFlags(g_espSpiBase, kLPSPI_AllStatusFlag);
+
+    /* The end of the last frame lowered the RX watermark, restore it */
+    if (rxWatermark >= frame->size)
+    {
+        rxWatermark = frame->size - 1U;
+    }
+    g_espSpiBase->FCR = (g_espSpiBase->FCR & (~LPSPI_FCR_RXWATER_MASK)) | LPSPI_FCR_RXWATER(rxWatermark);
+
+    /* Ensure continuous mode is set for the start of transfer */
+    LPSPI_SetPCSContinous(g_espSpiBase, true);
+
+    /* Fill up the TX data in FIFO initially */
+    ESP_SPI_FillTxFifo();
+
+    /* Enable RX Interrupt to handle the rest of the transfer in ISR */
+    LPSPI_EnableInterrupts(g_espSpiBase, kLPSPI_RxInterruptEnable);
 }
 
-void ESP_SPI_MasterIRQHandler(void)
+OMNI_PLACE_ISR_CODE void ESP_SPI_MasterIRQHandler(void)
 {
-    if (g_espSpiBase == NULL)
+    if ((g_espSpiBase == NULL) || g_useEdma)
     {
         return;
     }
 
     /* Reading RX FIFO */
     LPSPI_DisableInterrupts(g_espSpiBase, kLPSPI_RxInterruptEnable);
-    if (g_masterRxCount < ESP_SPI_TRANSFER_SIZE)
+    if (g_masterRxCount < g_masterTransferSize)
     {
         while (LPSPI_GetRxFifoCount(g_espSpiBase))
         {
@@ -142,7 +229,7 @@ void ESP_SPI_MasterIRQHandler(void)
             g_masterRxData[g_masterRxCount] = LPSPI_ReadData(g_espSpiBase);
             g_masterRxCount++;
 
-            if (g_masterRxCount == ESP_SPI_TRANSFER_SIZE)
+            if (g_masterRxCount == g_masterTransferSize)
             {
                 break;
             }
@@ -150,47 +237,156 @@ void ESP_SPI_MasterIRQHandler(void)
     }
 
     /* Update rxWatermark dynamically */
-    if ((ESP_SPI_TRANSFER_SIZE - g_masterRxCount) <= g_masterRxWatermark)
+    if ((g_masterTransferSize - g_masterRxCount) <= g_masterRxWatermark)
     {
         g_espSpiBase->FCR =
             (g_espSpiBase->FCR & (~LPSPI_FCR_RXWATER_MASK)) |
-            LPSPI_FCR_RXWATER(((ESP_SPI_TRANSFER_SIZE - g_masterRxCount) > 1U) ?
-                              ((ESP_SPI_TRANSFER_SIZE - g_masterRxCount) - 1U) : (0U));
+            LPSPI_FCR_RXWATER(((g_masterTransferSize - g_masterRxCount) > 1U) ?
+                              ((g_masterTransferSize - g_masterRxCount) - 1U) : (0U));
     }
 
-    /* Writing TX FIFO */
-    if (g_masterTxCount < ESP_SPI_TRANSFER_SIZE)
+    /* Writing TX FIFO (and the PCS release once everything is in) */
+    ESP_SPI_FillTxFifo();
+
+    /* Check completion: the next queued frame re-enables the interrupt */
+    if ((g_masterRxCount == g_masterTransferSize) && g_masterPcsReleased)
     {
-        while ((LPSPI_GetTxFifoCount(g_espSpiBase) < g_masterFifoSize) &&
-               (g_masterTxCount - g_masterRxCount < g_masterFifoSize))
-        {
-            LPSPI_WriteData(g_espSpiBase, g_masterTxData[g_masterTxCount]);
-            ++g_masterTxCount;
+        ESP_SPI_FrameDone(kStatus_Success);
+    }
+    else
+    {
+        /* Re-enable interrupts if not finished */
+        LPSPI_EnableInterrupts(g_espSpiBase, kLPSPI_RxInterruptEnable);
+    }
+    SDK_ISR_EXIT_BARRIER;
+}
 
-            if (g_masterTxCount == ESP_SPI_TRANSFER_SIZE)
-            {
-                while ((uint32_t)g_masterFifoSize == LPSPI_GetTxFifoCount(g_espSpiBase))
-                {
-                }
-                /* End of transfer signal */
-                LPSPI_SetPCSContinous(g_espSpiBase, false);
-                break;
-            }
+/*
+ * eDMA transport
+ */
+#if ESP_SPI_USE_EDMA
+OMNI_PLACE_ISR_CODE static void ESP_SPI_EdmaCallback(LPSPI_Type *base, lpspi_master_edma_handle_t *handle, status_t status,
+                                 void *userData)
+{
+    (void)base;
+    (void)handle;
+    (void)userData;
+
+    ESP_SPI_FrameDone(status);
+}
+
+void ESP_SPI_InitEDMA(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs,
+                      const esp_spi_edma_config_t *dma)
+{
+    edma_config_t edmaConfig;
+
+    g_useEdma = true;
+    g_masterPcsFlags = (uint32_t)whichPcs << LPSPI_MASTER_PCS_SHIFT;
+    ESP_SPI_ConfigureMaster(base, srcClock_Hz, whichPcs);
+
+    EDMA_GetDefaultConfig(&edmaConfig);
+    EDMA_Init(dma->base, &edmaConfig);
+    EDMA_CreateHandle(&g_masterRxEdmaHandle, dma->base, dma->rxChannel);
+    EDMA_CreateHandle(&g_masterTxEdmaHandle, dma->base, dma->txChannel);
+#if defined(FSL_FEATURE_EDMA_HAS_CHANNEL_MUX) && FSL_FEATURE_EDMA_HAS_CHANNEL_MUX
+    EDMA_SetChannelMux(dma->base, dma->rxChannel, dma->rxRequest);
+    EDMA_SetChannelMux(dma->base, dma->txChannel, dma->txRequest);
+#endif
+
+    LPSPI_MasterTransferCreateHandleEDMA(g_espSpiBase, &g_masterEdmaHandle, ESP_SPI_EdmaCallback, NULL,
+                                         &g_masterRxEdmaHandle, &g_masterTxEdmaHandle);
+}
+
+OMNI_PLACE_ISR_CODE static status_t ESP_SPI_StartFrameEdma(const esp_spi_frame_t *frame)
+{
+    lpspi_transfer_t xfer;
+
+    xfer.txData = frame->txData;
+    xfer.rxData = frame->rxData;
+    xfer.dataSize = frame->size;
+    xfer.configFlags = g_masterPcsFlags | kLPSPI_MasterPcsContinuous;
+
+    return LPSPI_MasterTransferEDMA(g_espSpiBase, &g_masterEdmaHandle, &xfer);
+}
+#endif
+
+/* Start the frame at the head of the queue (IRQs disabled) */
+OMNI_PLACE_ISR_CODE static void ESP_SPI_StartFrame(void)
+{
+#if ESP_SPI_USE_EDMA
+    if (g_useEdma)
+    {
+        status_t status = ESP_SPI_StartFrameEdma(&g_frameQueue[g_queueHead]);
+        if (status != kStatus_Success)
+        {
+            /* Refused (bad arguments): report it and go on with the next one */
+            ESP_SPI_FrameDone(status);
         }
+        return;
+    }
+#endif
+    ESP_SPI_StartFrameIrq(&g_frameQueue[g_queueHead]);
+}
+
+/*
+ * Frame queue
+ */
+OMNI_PLACE_ISR_CODE status_t ESP_SPI_QueueTransfer(uint8_t *txData, uint8_t *rxData, uint32_t size, esp_spi_callback_t callback,
+                               void *userData)
+{
+    esp_spi_frame_t *frame;
+    uint32_t primask;
+
+    /* Both transports need both buffers; refused here, the callbacks stay in queue order */
+    if ((txData == NULL) || (rxData == NULL))
+    {
+        return kStatus_InvalidArgument;
     }
 
-    /* Check completion */
-    if ((g_masterTxCount == ESP_SPI_TRANSFER_SIZE) && (g_masterRxCount == ESP_SPI_TRANSFER_SIZE))
+    /* Only the bytes of the frame are clocked, the slave takes short transactions */
+    if ((size == 0U) || (size > ESP_SPI_TRANSFER_SIZE))
     {
-        g_isMasterTransferCompleted = true;
+        size = ESP_SPI_TRANSFER_SIZE;
     }
 
-    /* Re-enable interrupts if not finished */
-    if (g_masterRxCount < ESP_SPI_TRANSFER_SIZE)
+    primask = DisableGlobalIRQ();
+    if (g_queueCount == ESP_SPI_QUEUE_LEN)
     {
-        LPSPI_EnableInterrupts(g_espSpiBase, kLPSPI_RxInterruptEnable);
+        EnableGlobalIRQ(primask);
+        return kStatus_LPSPI_Busy;
     }
-    SDK_ISR_EXIT_BARRIER;
+
+    frame = &g_frameQueue[(g_queueHead + g_queueCount) % ESP_SPI_QUEUE_LEN];
+    frame->txData = txData;
+    frame->rxData = rxData;
+    frame->size = size;
+    frame->callback = callback;
+    frame->userData = userData;
+
+    g_isMasterTransferCompleted = false;
+    if (g_queueCount++ == 0U)
+    {
+        ESP_SPI_StartFrame();
+    }
+    EnableGlobalIRQ(primask);
+
+    return kStatus_Success;
+}
+
+void ESP_SPI_StartTransfer(uint8_t *txData, uint8_t *rxData, uint32_t size)
+{
+    /* Wait for room in the queue if called prematurely */
+    while (ESP_SPI_QueueTransfer(txData, rxData, size, NULL, NULL) == kStatus_LPSPI_Busy) {}
+}
+
+bool ESP_SPI_IsTransferCompleted(void)
+{
+    return g_isMasterTransferCompleted;
+}
+
+uint32_t ESP_SPI_GetQueuedCount(void)
+{
+    return g_queueCount;
 }
 
 void PrepareTxBuffer(uint8_t *txBuffer, uint32_t packetCount)
@@ -4,6 +4,13 @@
  * Abstracted SPI Master Driver for MCXN947
  * Handles 8MHz SPI communication with ESP32 slave
  * Independent of board-specific app.h
+ *
+ * Frames are queued (ESP_SPI_QUEUE_LEN deep) and moved by one of two transports,
+ * chosen by the init function:
+ * - ESP_SPI_Init():     LPSPI interrupt, the FIFO is refilled from the RX watermark IRQ
+ * - ESP_SPI_InitEDMA(): two eDMA channels move the bytes, the CPU only sees the completion
+ *                       (needs the SDK edma and lpspi_edma components and ESP_SPI_USE_EDMA 1)
+ * The completion of a frame starts the next queued one and then calls its callback.
  */
 
 #ifndef ESP_SPI_H_
@@ -13,16 +20,45 @@
 #include <stdbool.h>
 #include "fsl_lpspi.h"
 
+/* 1 = build the eDMA transport (add the edma and lpspi_edma SDK components first) */
+#ifndef ESP_SPI_USE_EDMA
+#define ESP_SPI_USE_EDMA          0
+#endif
+
+#if ESP_SPI_USE_EDMA
+#include "fsl_lpspi_edma.h"
+#endif
+
 /* Definitions from the working example */
-#define ESP_SPI_TRANSFER_SIZE     40U    /*! Transfer dataSize - 20 bytes for reduced payload */
+#define ESP_SPI_TRANSFER_SIZE     40U    /*! Largest transfer (buffer size); each transfer clocks only its own size */
 #define ESP_SPI_BAUDRATE          8000000U /*! Transfer baudrate - 8MHz */
+#define ESP_SPI_QUEUE_LEN         4U     /*! Frames queued at most, the one on the bus included */
+
+/*! @brief Frame completion callback, called from the LPSPI or eDMA interrupt.
+ *
+ * The buffers belong to the caller again when this runs. It may queue the next frame.
+ */
+typedef void (*esp_spi_callback_t)(uint8_t *txData, uint8_t *rxData, uint32_t size, status_t status,
+                                   void *userData);
+
+#if ESP_SPI_USE_EDMA
+/*! @brief eDMA resources of the ESP link. */
+typedef struct
+{
+    DMA_Type *base;      /*!< eDMA instance, e.g. DMA0. */
+    uint32_t rxChannel;  /*!< Channel for LPSPI RX -> memory. */
+    uint32_t txChannel;  /*!< Channel for memory -> LPSPI TX. */
+    int32_t rxRequest;   /*!< Request source of the RX channel, e.g. kDma0RequestMuxLpFlexcomm1Rx. */
+    int32_t txRequest;   /*!< Request source of the TX channel, e.g. kDma0RequestMuxLpFlexcomm1Tx. */
+} esp_spi_edma_config_t;
+#endif
 
 /*******************************************************************************
  * API Prototypes
  ******************************************************************************/
 
 /*!
- * @brief Initialize the LPSPI peripheral for ESP32 communication.
+ * @brief Initialize the LPSPI peripheral for ESP32 communication (interrupt transport).
  *
  * @param base        LPSPI peripheral base address (e.g., LPSPI1).
  * @param srcClock_Hz Source clock frequency for the LPSPI peripheral.
@@ -30,20 +66,61 @@
  */
 void ESP_SPI_Init(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs);
 
+#if ESP_SPI_USE_EDMA
 /*!
- * @brief Start a non-blocking transfer.
- * * @param txData Pointer to the transmission buffer (must be at least ESP_SPI_TRANSFER_SIZE bytes).
- * @param rxData Pointer to the reception buffer (must be at least ESP_SPI_TRANSFER_SIZE bytes).
+ * @brief Initialize the LPSPI peripheral for ESP32 communication (eDMA transport).
+ *
+ * Initializes the eDMA instance as well. The LPSPI interrupt is not used; its handler may
+ * still call ESP_SPI_MasterIRQHandler(), which then returns right away.
+ *
+ * @param base        LPSPI peripheral base address (e.g., LPSPI1).
+ * @param srcClock_Hz Source clock frequency for the LPSPI peripheral.
+ * @param whichPcs    The Chip Select (PCS) pin to use (e.g., kLPSPI_Pcs0).
+ * @param dma         Channels and request sources to use.
  */
-void ESP_SPI_StartTransfer(uint8_t *txData, uint8_t *rxData);
+void ESP_SPI_InitEDMA(LPSPI_Type *base, uint32_t srcClock_Hz, lpspi_which_pcs_t whichPcs,
+                      const esp_spi_edma_config_t *dma);
+#endif
 
 /*!
- * @brief Check if the current transfer is complete.
+ * @brief Queue a transfer, never waits.
+ *
+ * Starts right away if the bus is idle, otherwise when the frames queued before it are done.
  *
- * @return true if transfer is finished, false otherwise.
+ * @param txData   Pointer to the transmission buffer (must be at least size bytes).
+ * @param rxData   Pointer to the reception buffer (must be at least size bytes).
+ * @param size     Bytes to clock, 1 to ESP_SPI_TRANSFER_SIZE (e.g. OMNI_WIRE_EXCHANGE_SIZE).
+ * @param callback Called when the frame is done, may be NULL.
+ * @param userData Passed to the callback.
+ * @return kStatus_Success, kStatus_InvalidArgument for a NULL buffer, or kStatus_LPSPI_Busy if
+ *         ESP_SPI_QUEUE_LEN frames are already queued.
+ */
+status_t ESP_SPI_QueueTransfer(uint8_t *txData, uint8_t *rxData, uint32_t size, esp_spi_callback_t callback,
+                               void *userData);
+
+/*!
+ * @brief Start a non-blocking transfer without completion callback.
+ *
+ * Same as ESP_SPI_QueueTransfer(), but waits while the queue is full.
+ *
+ * @param txData Pointer to the transmission buffer (must be at least size bytes).
+ * @param rxData Pointer to the reception buffer (must be at least size bytes).
+ * @param size   Bytes to clock, 1 to ESP_SPI_TRANSFER_SIZE (e.g. OMNI_WIRE_EXCHANGE_SIZE).
+ */
+void ESP_SPI_StartTransfer(uint8_t *txData, uint8_t *rxData, uint32_t size);
+
+/*!
+ * @brief Check if all queued transfers are complete.
+ *
+ * @return true if the bus is idle and nothing is queued, false otherwise.
  */
 bool ESP_SPI_IsTransferCompleted(void);
 
+/*!
+ * @brief Frames queued or on the bus.
+ */
+uint32_t ESP_SPI_GetQueuedCount(void);
+
 /*!
  * @brief Interrupt Handler for the ESP SPI driver.
  * * This function must be called from the actual LPSPI IRQ handler (e.g., LP_FLEXCOMM1_IRQHandler).
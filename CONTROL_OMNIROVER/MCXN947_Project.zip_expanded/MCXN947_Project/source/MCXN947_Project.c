@@ -22,8 +22,11 @@
 #include "ADC_DRIVER.h"
 #include "ESP_SPI.h"     // Include the SPI driver
 #include "RobotTelemetry.h" // Include the new struct definition
+#include "RobotRecord.h"
+#include "omni_place.h"
 #include "fsl_lpi2c.h"
 #include "mpu9250_driver.h"
+#include "imu_calib.h"
 #include "fsl_debug_console.h"
 
 //*Definitions*/
@@ -46,6 +49,50 @@
 // If no pulse is received for 0.2s, speed is set to 0.
 #define TIMEOUT_COUNTS          30000000U
 
+// 1 = PID gains from the speed-scheduled table (omni_gains.h, changed from the remote),
+// 0 = the fixed Kp/Ki/Kd of PID1..4 (no table has been tuned on the motors yet)
+#ifndef ROBOT_PID_SCHEDULE
+#define ROBOT_PID_SCHEDULE      0
+#endif
+
+// Wheel PID form (omnidriver.h): PID_FORM_CLASSIC or PID_FORM_2DOF (so far tried on the motor model only)
+#ifndef ROBOT_PID_FORM
+#define ROBOT_PID_FORM          PID_FORM_CLASSIC
+#endif
+
+// PID_FORM_2DOF: setpoint weight, derivative filter (s), tracking time (s, 0 = Kp/Ki)
+#ifndef ROBOT_PID_B
+#define ROBOT_PID_B             1.0f
+#endif
+#ifndef ROBOT_PID_TF
+#define ROBOT_PID_TF            0.001f
+#endif
+#ifndef ROBOT_PID_TT
+#define ROBOT_PID_TT            0.0f
+#endif
+
+// 1 = add the duty the wheel's motor model (motor_model.h) gives for its target to the PID output
+#ifndef ROBOT_PID_FEEDFORWARD
+#define ROBOT_PID_FEEDFORWARD   0
+#endif
+
+// 1 = the models HOST_SIM/tools/motor_ident.c wrote (motor_model_fit.h next to this file),
+// 0 = MOTOR_MODEL_DEFAULT for every wheel
+#ifndef ROBOT_MOTOR_MODEL_FIT
+#define ROBOT_MOTOR_MODEL_FIT   0
+#endif
+
+// 1 = print the PWM and signed speed of every wheel, averaged over ROBOT_MOTOR_TRACE_TICKS PID
+// periods, as "MOT,t_us,pwm1,mrad_s1,...,pwm4,mrad_s4": the log format of motor_ident
+#ifndef ROBOT_MOTOR_TRACE
+#define ROBOT_MOTOR_TRACE       0
+#endif
+#define ROBOT_MOTOR_TRACE_TICKS 120U    // 10 ms: 100 lines of up to 90 characters per s fit 115200 baud
+#define ROBOT_MOTOR_TRACE_DEPTH 8U      // Lines the main loop may fall behind
+
+// PID_SCHEDULE_PROFILE and OMNI_PLACE_PROFILE report on the debug console every N us
+#define PID_PROFILE_REPORT_US   5000000U
+
 //*Variables*/
 uint32_t count = 0;
 float result = 0;
@@ -210,6 +257,25 @@ PWM_CTRL_t pwm_ctrl_M4 = {.pwm_base = PWM1,
 						  .pwm_mode = kPWM_SignedCenterAligned };
 
 
+// ***************************************************************
+// * MOTOR MODELS (feed-forward, ROBOT_PID_FEEDFORWARD)
+// ***************************************************************
+
+#if ROBOT_MOTOR_MODEL_FIT
+#include "motor_model_fit.h"
+const motor_model_t motorModel[MOTOR_MODEL_WHEELS] = MOTOR_MODEL_FIT_TABLE;
+#else
+const motor_model_t motorModel[MOTOR_MODEL_WHEELS] = {
+	MOTOR_MODEL_DEFAULT, MOTOR_MODEL_DEFAULT, MOTOR_MODEL_DEFAULT, MOTOR_MODEL_DEFAULT
+};
+#endif
+
+#if ROBOT_PID_FEEDFORWARD
+#define PID_MODEL(wheel)        (&motorModel[(wheel)])
+#else
+#define PID_MODEL(wheel)        NULL
+#endif
+
 // ***************************************************************
 // * PID STRUCTURES (4 Motors)
 // ***************************************************************
@@ -223,7 +289,12 @@ PID_CONFIG PID1 = {
 	    .integral_err  = 0,  // Sum of error
 	    .last_output   = 0,  // PID output in last control period
 	    .max_integral  = MAX_PWM_DEFINITION, // PID maximum integral value limitation
-	    .min_integral  = -MAX_PWM_DEFINITION // PID minimum integral value limitation
+	    .min_integral  = -MAX_PWM_DEFINITION, // PID minimum integral value limitation
+	    .form = ROBOT_PID_FORM,
+	    .b    = ROBOT_PID_B,
+	    .Tf   = ROBOT_PID_TF,
+	    .Tt   = ROBOT_PID_TT,
+	    .model = PID_MODEL(0)
 };
 
 PID_CONFIG PID2 = {
@@ -235,7 +306,12 @@ PID_CONFIG PID2 = {
 	    .integral_err  = 0,  // Sum of error
 	    .last_output   = 0,  // PID output in last control period
 	    .max_integral  = MAX_PWM_DEFINITION, // PID maximum integral value limitation
-	    .min_integral  = -MAX_PWM_DEFINITION // PID minimum integral value limitation
+	    .min_integral  = -MAX_PWM_DEFINITION, // PID minimum integral value limitation
+	    .form = ROBOT_PID_FORM,
+	    .b    = ROBOT_PID_B,
+	    .Tf   = ROBOT_PID_TF,
+	    .Tt   = ROBOT_PID_TT,
+	    .model = PID_MODEL(1)
 };
 
 PID_CONFIG PID3 = {
@@ -247,7 +323,12 @@ PID_CONFIG PID3 = {
 	    .integral_err  = 0,  // Sum of error
 	    .last_output   = 0,  // PID output in last control period
 	    .max_integral  = MAX_PWM_DEFINITION, // PID maximum integral value limitation
-	    .min_integral  = -MAX_PWM_DEFINITION // PID minimum integral value limitation
+	    .min_integral  = -MAX_PWM_DEFINITION, // PID minimum integral value limitation
+	    .form = ROBOT_PID_FORM,
+	    .b    = ROBOT_PID_B,
+	    .Tf   = ROBOT_PID_TF,
+	    .Tt   = ROBOT_PID_TT,
+	    .model = PID_MODEL(2)
 };
 
 PID_CONFIG PID4 = {
@@ -259,7 +340,12 @@ PID_CONFIG PID4 = {
 	    .integral_err  = 0,  // Sum of error
 	    .last_output   = 0,  // PID output in last control period
 	    .max_integral  = MAX_PWM_DEFINITION, // PID maximum integral value limitation
-	    .min_integral  = -MAX_PWM_DEFINITION // PID minimum integral value limitation
+	    .min_integral  = -MAX_PWM_DEFINITION, // PID minimum integral value limitation
+	    .form = ROBOT_PID_FORM,
+	    .b    = ROBOT_PID_B,
+	    .Tf   = ROBOT_PID_TF,
+	    .Tt   = ROBOT_PID_TT,
+	    .model = PID_MODEL(3)
 };
 
 // ***************************************************************
@@ -317,12 +403,47 @@ ROBOT_T ROBOT = {
 	.M4 = &M4
 };
 mpu9250_handle_t imuRobot;
+imu_calib_t imuCalib;
+
+// Gain table shared by the four wheel PIDs; points arrive in Robot_ExchangeDone()
+omni_gains_t pidGains;
+static const omni_gain_table_t pidGainsDefault = {
+	.points = OMNI_GAINS_DEFAULT_POINTS,
+	.point = OMNI_GAINS_DEFAULT_TABLE
+};
+
+#if ROBOT_MOTOR_TRACE
+// Lines averaged in the PID interrupt, printed by the main loop
+typedef struct {
+	uint32_t t_us;
+	int32_t pwm[4];
+	int32_t mrad_s[4];
+} motor_trace_line_t;
+
+static motor_trace_line_t motorTrace[ROBOT_MOTOR_TRACE_DEPTH];
+static volatile uint32_t motorTraceHead = 0;   // Written by the PID interrupt
+static volatile uint32_t motorTraceTail = 0;   // Written by the main loop
+static volatile uint32_t motorTraceLost = 0;
+#endif
+
+#if OMNI_PLACE_PROFILE
+// Cycles of the control interrupts, with the RAM placement they run from (omni_place.h)
+static omni_place_stat_t placePidTick;      // PID_TIMER, the whole tick
+static omni_place_stat_t placePidCompute;   // its kinematics and the four pid_compute()
+static omni_place_stat_t placeCapture;      // ctimer_capture_callback
+#endif
 //*Prototypes*/
 void init_hardware(void);
 float counts_to_rad_s(uint32_t period_counts);
 float counts_to_hertz(uint32_t period_counts);
 float counts_to_rps(uint32_t period_counts);
 void check_stopped_motors(void);
+void imu_calib_start(void);
+void imu_calib_step(void);
+void pid_gains_report(void);
+void place_report(void);
+void motor_trace_tick(void);
+void motor_trace_print(void);
 float rad_s_to_counts(float rads);
 
 //ROBOT FUNCTIONS
@@ -332,34 +453,49 @@ float dimension_speed(uint8_t raw_byte);
 //CALLBACKS
 
 /* 1. SPI ISR Redirect */
-void LP_FLEXCOMM1_IRQHandler(void)
+OMNI_PLACE_ISR_CODE void LP_FLEXCOMM1_IRQHandler(void)
 {
     ESP_SPI_MasterIRQHandler();
 }
 
 /* 2. Callback Implementation */
-void TIMER_0(void){
+OMNI_PLACE_ISR_CODE void TIMER_0(void){
     /* Trigger the telemetry packet sending */
     Robot_SendTelemetry();
 }
 
-void PID_TIMER(void){
+OMNI_PLACE_ISR_CODE void PID_TIMER(void){
+	OMNI_PLACE_BEGIN(tick);
 
 	check_stopped_motors();
+	OMNI_PLACE_BEGIN(pid);
 	ROBOT_compute_kinematics(&ROBOT);
 	pid_compute(&M1);
 	pid_compute(&M2);
 	pid_compute(&M3);
 	pid_compute(&M4);
+	OMNI_PLACE_END(pid, &placePidCompute);
+#if ROBOT_MOTOR_TRACE
+	motor_trace_tick();
+#endif
+#if ROBOT_RECORD
+	Robot_RecordTick();
+#endif
+	OMNI_PLACE_END(tick, &placePidTick);
 }
 
-void ctimer_capture_callback(uint32_t flags)
+OMNI_PLACE_ISR_CODE void ctimer_capture_callback(uint32_t flags)
 {
+    OMNI_PLACE_BEGIN(capture);
+
     // --- MOTOR 1 (Channel 0) ---
     if ((flags & kCTIMER_Capture0Flag) != 0U)
     {
         static uint32_t prev0 = 0;
         uint32_t curr0 = CTIMER_GetCaptureValue(CTIMER0, kCTIMER_Capture_0);
+#if ROBOT_RECORD
+        Robot_RecordCapture(0U, curr0);
+#endif
 
         // Save timestamp for timeout logic
         g_last_time_M1 = curr0;
@@ -373,6 +509,9 @@ void ctimer_capture_callback(uint32_t flags)
     {
         static uint32_t prev1 = 0;
         uint32_t curr1 = CTIMER_GetCaptureValue(CTIMER0, kCTIMER_Capture_1);
+#if ROBOT_RECORD
+        Robot_RecordCapture(1U, curr1);
+#endif
 
         g_last_time_M2 = curr1;
 
@@ -385,6 +524,9 @@ void ctimer_capture_callback(uint32_t flags)
     {
         static uint32_t prev2 = 0;
         uint32_t curr2 = CTIMER_GetCaptureValue(CTIMER0, kCTIMER_Capture_2);
+#if ROBOT_RECORD
+        Robot_RecordCapture(2U, curr2);
+#endif
 
         g_last_time_M3 = curr2;
 
@@ -397,12 +539,16 @@ void ctimer_capture_callback(uint32_t flags)
     {
         static uint32_t prev3 = 0;
         uint32_t curr3 = CTIMER_GetCaptureValue(CTIMER0, kCTIMER_Capture_3);
+#if ROBOT_RECORD
+        Robot_RecordCapture(3U, curr3);
+#endif
 
         g_last_time_M4 = curr3;
 
         M4.speed = counts_to_rad_s((curr3 - prev3));
         prev3 = curr3;
     }
+    OMNI_PLACE_END(capture, &placeCapture);
 }
 
 
@@ -413,7 +559,16 @@ void ctimer_capture_callback(uint32_t flags)
 
 int main(void)
 {
+	/* Boot profile: timeline on the console BOOT_REPORT_US after reset */
+	boot_profile_start();
+#if ROBOT_RECORD
+	Robot_RecordInit();
+#endif
+	uint8_t bootStage = boot_begin("clocks, pins");
 	init_hardware();
+	boot_end(bootStage);
+
+	bootStage = boot_begin("pwm, i2c, timers");
     /* Structure of initialize PWM */
     init_pwm();
 
@@ -424,9 +579,19 @@ int main(void)
     // Habilitar el reloj para el LPI2C0
     LPI2C_MasterInit(LPI2C_MASTER_BASE, &masterConfig, LPI2C_MASTER_CLOCK_FREQ);
 
+#if !ROBOT_SPI_DATA_READY
+	/* 2.4 kHz telemetry poll (with the data-ready line the bridge paces the exchanges) */
 	init_LPTMR_12MHz(LPTMR0, 5000);
 	lptmr_attach_callback(LPTMR0, TIMER_0);
-
+#endif
+
+	omni_gains_init(&pidGains, &pidGainsDefault);
+#if ROBOT_PID_SCHEDULE
+	PID1.gains = &pidGains;
+	PID2.gains = &pidGains;
+	PID3.gains = &pidGains;
+	PID4.gains = &pidGains;
+#endif
 	init_LPTMR_12MHz(LPTMR1, PID_TIMER_TICKS);
 	lptmr_attach_callback(LPTMR1, PID_TIMER);
 
@@ -454,6 +619,26 @@ int main(void)
 	// Start the timer
 	CTIMER_StartTimer(CTIMER0);
 
+	// Microsecond clock for the telemetry timestamps and the clock sync
+	init_us_clock(CTIMER4, CLOCK_GetCTimerClkFreq(4U));
+	boot_end(bootStage);
+
+	/* IMU reset first: its 200 ms power-up runs while the rest starts, the main loop finishes it */
+	uint8_t imuStage = boot_begin("imu power-up");
+	imuRobot.i2cBase = LPI2C_MASTER_BASE;
+	status_t imuStatus = MPU9250_InitStart(&imuRobot, LPI2C_MASTER_BASE, us_clock_now());
+	if (imuStatus == kStatus_Success) {
+		imuStatus = kStatus_Busy;
+	} else {
+		boot_end(imuStage);
+		PRINTF("ERROR: No se detecto la IMU. Revise conexion.\r\n");
+	}
+
+	/* The first MOTOR_init starts the ADC calibration, the main loop finishes it too */
+	uint8_t adcStage = boot_begin("adc calibration");
+	bool adcReady = false;
+	bootStage = boot_begin("motors, spi");
+
 	//MOTOR 1
 	MOTOR_init(&M1);
     //MOTOR 2
@@ -464,29 +649,57 @@ int main(void)
 	MOTOR_init(&M4);
 
 	/* 3. Initialize SPI Driver BEFORE starting timers */
+#if ESP_SPI_USE_EDMA
+	/* eDMA moves the telemetry exchange, channels 0/1 of DMA0 */
+	const esp_spi_edma_config_t espDma = {DMA0, 0U, 1U, kDma0RequestMuxLpFlexcomm1Rx, kDma0RequestMuxLpFlexcomm1Tx};
+	ESP_SPI_InitEDMA(LPSPI1, LPSPI_MASTER_CLK_FREQ, EXAMPLE_LPSPI_MASTER_PCS_FOR_INIT, &espDma);
+#else
 	ESP_SPI_Init(LPSPI1, LPSPI_MASTER_CLK_FREQ, EXAMPLE_LPSPI_MASTER_PCS_FOR_INIT);
+#endif
 
 	/* 4. Enable SPI Interrupts in NVIC */
 	EnableIRQ(LP_FLEXCOMM1_IRQn);
 
+#if ROBOT_SPI_DATA_READY
+	Robot_SpiReadyInit();
+#else
 	LPTMR_StartTimer(LPTMR0);
+#endif
 	LPTMR_StartTimer(LPTMR1); //PID_TIMER
-	imuRobot.i2cBase = LPI2C_MASTER_BASE;
-	MPU9250_Calibrate(&imuRobot);
-	status_t imuStatus = MPU9250_Init(&imuRobot, LPI2C_MASTER_BASE);
-
-	    if (imuStatus == kStatus_Success) {
-	        PRINTF("IMU Detectada. Calibrando (NO MOVER EL ROBOT)...\r\n");
-	        MPU9250_Calibrate(&imuRobot);
-	        PRINTF("Calibracion IMU Finalizada.\r\n");
-	    } else {
-	        PRINTF("ERROR: No se detecto la IMU. Revise conexion.\r\n");
-	    }
+	boot_end(bootStage);
+	boot_mark("control running");
+
 	while (1U)
 	{
-		if(MPU9250_ReadSensor(&imuRobot) == kStatus_Success){
+		if (imuStatus == kStatus_Busy) {
+			imuStatus = MPU9250_InitPoll(&imuRobot, us_clock_now());
+			if (imuStatus == kStatus_Success) {
+				boot_end(imuStage);
+				/* No blocking calibration: offsets from flash, refined while the wheels stand still */
+				imu_calib_start();
+			} else if (imuStatus != kStatus_Busy) {
+				boot_end(imuStage);
+				PRINTF("ERROR: No se detecto la IMU. Revise conexion.\r\n");
+			}
+		} else if(MPU9250_ReadSensor(&imuRobot) == kStatus_Success){
+			imu_calib_step();
+		}
 
+		if (!adcReady && poll_ADC_calibration()) {
+			adcReady = true;
+			boot_end(adcStage);
 		}
+		boot_report_poll();
+		pid_gains_report();
+#if OMNI_PLACE_PROFILE
+		place_report();
+#endif
+#if ROBOT_MOTOR_TRACE
+		motor_trace_print();
+#endif
+#if ROBOT_RECORD
+		Robot_RecordPrint();
+#endif
 	}
 }
 
@@ -515,6 +728,10 @@ void init_hardware(void){
 	CLOCK_AttachClk(kPLL0_to_CTIMER0);
 	CLOCK_SetClkDiv(kCLOCK_DivCtimer0Clk, 1U);
 
+	/* FRO 12M for CTIMER4, the microsecond clock (us_clock_now) */
+	CLOCK_SetClkDiv(kCLOCK_DivCtimer4Clk, 1U);
+	CLOCK_AttachClk(kFRO12M_to_CTIMER4);
+
 	CLOCK_EnableClock(kCLOCK_Port0);
 	CLOCK_EnableClock(kCLOCK_Gpio0);
 
@@ -601,7 +818,7 @@ float dimension_rotation(uint8_t raw_byte)
     return scaled_result;
 }
 
-float counts_to_hertz(uint32_t period_counts)
+OMNI_PLACE_ISR_CODE float counts_to_hertz(uint32_t period_counts)
 {
     if (period_counts < 100) return 0.0f;
 
@@ -611,7 +828,7 @@ float counts_to_hertz(uint32_t period_counts)
 }
 
 // Calculates the Speed of the WHEEL (Output Shaft)
-float counts_to_rad_s(uint32_t period_counts)
+OMNI_PLACE_ISR_CODE float counts_to_rad_s(uint32_t period_counts)
 {
     if (period_counts < 100) return 0.0f;
 
@@ -653,10 +870,20 @@ float counts_to_rps(uint32_t period_counts)
     return pulse_hz / edges_per_rev;
 }
 
-void check_stopped_motors(void)
+OMNI_PLACE_ISR_CODE void check_stopped_motors(void)
 {
     uint32_t now = CTIMER_GetTimerCountValue(CTIMER0);
 
+#if ROBOT_RECORD
+    // When this tick ran decides whether a turning wheel stops here: the replay needs the count
+    if (((now - g_last_time_M1) > TIMEOUT_COUNTS && M1.speed != 0.0f) ||
+        ((now - g_last_time_M2) > TIMEOUT_COUNTS && M2.speed != 0.0f) ||
+        ((now - g_last_time_M3) > TIMEOUT_COUNTS && M3.speed != 0.0f) ||
+        ((now - g_last_time_M4) > TIMEOUT_COUNTS && M4.speed != 0.0f)) {
+        Robot_RecordTimeout(now);
+    }
+#endif
+
     // If time since last interrupt > threshold, assume speed is 0
     // Casting M1.speed to float(0) or setting a flag
     if ((now - g_last_time_M1) > TIMEOUT_COUNTS) M1.speed = 0.0f;
@@ -665,8 +892,182 @@ void check_stopped_motors(void)
     if ((now - g_last_time_M4) > TIMEOUT_COUNTS) M4.speed = 0.0f;
 }
 
+void imu_calib_start(void)
+{
+	ImuCalib_Init(&imuCalib);
+	PRINTF("IMU Detectada. Calibrando con el robot quieto\r\n");
+}
 
+/* Main loop, after every IMU read: feed the estimator with the raw sample */
+void imu_calib_step(void)
+{
+	MOTOR_T *motors[4] = {&M1, &M2, &M3, &M4};
+	int16_t raw[IMU_CALIB_AXES];
+	imu_calib_offsets_t off;
+	uint64_t now = us_clock_now();
+	bool still = true;
+	bool wasValid;
+
+	for (uint32_t i = 0; i < 4U; i++) {
+		if (fabsf(motors[i]->speed) >= IMU_CALIB_STILL_RAD_S || motors[i]->target != 0.0f) {
+			still = false;
+		}
+	}
+	for (uint32_t i = 0; i < 3U; i++) {
+		raw[i] = (int16_t)(imuRobot.accelRaw[i] + imuRobot.accelOffset[i]);
+		raw[3U + i] = (int16_t)(imuRobot.gyroRaw[i] + imuRobot.gyroOffset[i]);
+	}
+#if ROBOT_IMU_TRACE
+	PRINTF("IMU,%lu,%d,%d,%d,%d,%d,%d,%d\r\n", (unsigned long)now, raw[0], raw[1], raw[2], raw[3], raw[4], raw[5],
+	       still ? 1 : 0);
+#endif
+	wasValid = imuCalib.n >= IMU_CALIB_MIN_SAMPLES;
+	if (!ImuCalib_Add(&imuCalib, raw, still, now) || !ImuCalib_Get(&imuCalib, &off)) {
+		return;
+	}
+	if (!wasValid) {
+		PRINTF("Calibracion IMU lista (%lu muestras)\r\n", (unsigned long)imuCalib.n);
+	}
+	for (uint32_t i = 0; i < 3U; i++) {
+		imuRobot.accelOffset[i] = off.accel[i];
+		imuRobot.gyroOffset[i] = off.gyro[i];
+	}
+}
+
+/* Main loop: print the gain table once a new one is in use, and the lookup cost */
+void pid_gains_report(void)
+{
+	static uint32_t reported = 0;
+
+	if (pidGains.updates != reported) {
+		const omni_gain_table_t *t = omni_gains_table(&pidGains);
+
+		reported = pidGains.updates;
+		PRINTF("PID gains: new table (%u points)\r\n", (unsigned)t->points);
+		for (uint32_t i = 0; i < t->points; i++) {
+			PRINTF("  %ld mrad/s: Kp %ld Ki %ld Kd/1000 %ld\r\n", (long)(t->point[i].speed * 1000.0f),
+			       (long)t->point[i].kp, (long)t->point[i].ki, (long)(t->point[i].kd * 1000.0f));
+		}
+#if !ROBOT_PID_SCHEDULE
+		PRINTF("  (not used: built with ROBOT_PID_SCHEDULE=0)\r\n");
+#endif
+	}
+
+#if PID_SCHEDULE_PROFILE
+	static uint64_t reportUs = 0;
+	uint64_t now = us_clock_now();
+
+	if (now - reportUs >= PID_PROFILE_REPORT_US) {
+		uint32_t primask = DisableGlobalIRQ();
+		uint32_t lookups = pid_schedule_profile.lookups;
+		uint32_t sum = pid_schedule_profile.cycles_sum;
+		uint32_t max = pid_schedule_profile.cycles_max;
+		pid_schedule_profile.lookups = 0;
+		pid_schedule_profile.cycles_sum = 0;
+		pid_schedule_profile.cycles_max = 0;
+		EnableGlobalIRQ(primask);
+
+		reportUs = now;
+		PRINTF("PID gain lookup: %lu lookups, %lu cycles avg, %lu max\r\n", (unsigned long)lookups,
+		       (unsigned long)(lookups ? sum / lookups : 0U), (unsigned long)max);
+	}
+#endif
+}
+
+#if OMNI_PLACE_PROFILE
+/* Main loop: cycles of every placed path since the last report, with the bank it runs from.
+ * A placement's delta is its line in a build with its switch on against one with it off. */
+void place_report(void)
+{
+	static const struct {
+		const char *name;
+		const char *bank;
+		omni_place_stat_t *stat;
+	} sites[] = {
+		{"pid tick", OMNI_PLACE_ISR_BANK "/" OMNI_PLACE_PID_BANK, &placePidTick},
+		{"pid compute", OMNI_PLACE_PID_BANK, &placePidCompute},
+		{"capture", OMNI_PLACE_ISR_BANK, &placeCapture},
+		{"telemetry", OMNI_PLACE_ISR_BANK "/" OMNI_PLACE_BUFFERS_BANK, &robot_place_telemetry},
+		{"spi done", OMNI_PLACE_ISR_BANK "/" OMNI_PLACE_BUFFERS_BANK, &robot_place_exchange},
+	};
+	static uint64_t reportUs = 0;
+	uint64_t now = us_clock_now();
+
+	if (now - reportUs < PID_PROFILE_REPORT_US) {
+		return;
+	}
+	reportUs = now;
+
+	for (uint32_t i = 0; i < sizeof(sites) / sizeof(sites[0]); i++) {
+		omni_place_stat_t *s = sites[i].stat;
+		uint32_t primask = DisableGlobalIRQ();
+		uint32_t calls = s->calls;
+		uint32_t sum = s->cycles_sum;
+		uint32_t max = s->cycles_max;
+		s->calls = 0;
+		s->cycles_sum = 0;
+		s->cycles_max = 0;
+		EnableGlobalIRQ(primask);
+
+		PRINTF("Place: %-12s %-10s %6lu calls, %5lu avg, %5lu max cycles\r\n", sites[i].name, sites[i].bank,
+		       (unsigned long)calls, (unsigned long)(calls ? sum / calls : 0U), (unsigned long)max);
+	}
+}
+#endif
 
+#if ROBOT_MOTOR_TRACE
+/* PID interrupt: sums the applied PWM and the signed speed of every wheel, queues their mean
+ * every ROBOT_MOTOR_TRACE_TICKS periods (dropped if the main loop is that far behind) */
+void motor_trace_tick(void)
+{
+	static MOTOR_T *const motors[4] = {&M1, &M2, &M3, &M4};
+	static float pwmSum[4];
+	static float speedSum[4];
+	static uint32_t ticks = 0;
+
+	for (uint32_t i = 0; i < 4U; i++) {
+		pwmSum[i] += motors[i]->PID->last_output;
+		speedSum[i] += (motors[i]->spin == MOTOR_FORWARD) ? motors[i]->speed : -motors[i]->speed;
+	}
+	if (++ticks < ROBOT_MOTOR_TRACE_TICKS) {
+		return;
+	}
+	ticks = 0;
 
+	if (motorTraceHead - motorTraceTail < ROBOT_MOTOR_TRACE_DEPTH) {
+		motor_trace_line_t *line = &motorTrace[motorTraceHead % ROBOT_MOTOR_TRACE_DEPTH];
 
+		line->t_us = (uint32_t)us_clock_now();
+		for (uint32_t i = 0; i < 4U; i++) {
+			line->pwm[i] = (int32_t)lrintf(pwmSum[i] / ROBOT_MOTOR_TRACE_TICKS);
+			line->mrad_s[i] = (int32_t)lrintf(speedSum[i] * 1000.0f / ROBOT_MOTOR_TRACE_TICKS);
+		}
+		motorTraceHead++;
+	} else {
+		motorTraceLost++;
+	}
+	for (uint32_t i = 0; i < 4U; i++) {
+		pwmSum[i] = 0.0f;
+		speedSum[i] = 0.0f;
+	}
+}
+
+/* Main loop: the queued lines, integers only (the console's printf has no float) */
+void motor_trace_print(void)
+{
+	static uint32_t lostReported = 0;
+
+	while (motorTraceTail != motorTraceHead) {
+		const motor_trace_line_t *l = &motorTrace[motorTraceTail % ROBOT_MOTOR_TRACE_DEPTH];
 
+		PRINTF("MOT,%lu,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld\r\n", (unsigned long)l->t_us, (long)l->pwm[0],
+		       (long)l->mrad_s[0], (long)l->pwm[1], (long)l->mrad_s[1], (long)l->pwm[2], (long)l->mrad_s[2],
+		       (long)l->pwm[3], (long)l->mrad_s[3]);
+		motorTraceTail++;
+	}
+	if (motorTraceLost != lostReported) {
+		lostReported = motorTraceLost;
+		PRINTF("Motor trace: %lu lines lost\r\n", (unsigned long)lostReported);
+	}
+}
+#endif
@@ -0,0 +1,170 @@
+/* source/RobotRecord.c */
+#include "RobotRecord.h"
+
+#if ROBOT_RECORD
+#include <string.h>
+#include "omnidriver.h"
+#include "omni_record.h"
+
+extern MOTOR_T M1, M2, M3, M4;
+extern ROBOT_T ROBOT;
+
+/* Written by the control interrupts, read by the main loop. Recording stops once an
+ * event does not fit, so what was recorded is always an unbroken start of the session. */
+static uint8_t recordBuf[ROBOT_RECORD_BYTES];
+static volatile uint32_t recordHead = 0;   // Bytes written since boot
+static volatile uint32_t recordTail = 0;   // Bytes read since boot
+static volatile bool recordFull = false;
+
+static omni_record_state_t recordState;
+static uint8_t recordFrame[OMNI_WIRE_MAX_FRAME];   // Last frame recorded
+static uint32_t recordTicks = 0;                   // Since the last digest
+
+/* With the interrupts off */
+static void Robot_RecordPut(const uint8_t *data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        recordBuf[(recordHead + i) & (ROBOT_RECORD_BYTES - 1U)] = data[i];
+    }
+    recordHead += len;
+}
+
+/* With the interrupts off: the event, or the end marker if it does not fit */
+static void Robot_RecordCommit(const uint8_t *event, uint32_t len)
+{
+    if (ROBOT_RECORD_BYTES - (recordHead - recordTail) < len + 1U)
+    {
+        const uint8_t end = OMNI_RECORD_TAG_END;
+
+        Robot_RecordPut(&end, 1U);
+        recordFull = true;
+        return;
+    }
+    Robot_RecordPut(event, len);
+}
+
+/* What the next PID tick starts from: the wheels' targets, speeds and PID state, the command */
+static uint32_t Robot_RecordDigest(void)
+{
+    static MOTOR_T *const motors[4] = {&M1, &M2, &M3, &M4};
+    uint32_t digest = OMNI_RECORD_DIGEST_INIT;
+
+    for (uint32_t i = 0; i < 4U; i++)
+    {
+        const MOTOR_T *m = motors[i];
+        const PID_CONFIG *pid = m->PID;
+        const float state[] = {m->target, m->speed, m->spin_min, pid->Kp, pid->Ki, pid->Kd,
+                               pid->previous_err1, pid->previous_err2, pid->integral_err, pid->last_output,
+                               pid->derivative, pid->previous_meas};
+        const uint8_t way[] = {(uint8_t)m->direction, (uint8_t)m->spin};
+
+        digest = omni_record_digest(digest, state, sizeof(state));
+        digest = omni_record_digest(digest, way, sizeof(way));
+    }
+    digest = omni_record_digest(digest, &ROBOT.vx, sizeof(ROBOT.vx));
+    digest = omni_record_digest(digest, &ROBOT.vy, sizeof(ROBOT.vy));
+    return omni_record_digest(digest, &ROBOT.phi, sizeof(ROBOT.phi));
+}
+
+void Robot_RecordInit(void)
+{
+    Robot_RecordPut((const uint8_t *)OMNI_RECORD_MAGIC, OMNI_RECORD_MAGIC_SIZE);
+}
+
+void Robot_RecordCapture(uint32_t wheel, uint32_t capture)
+{
+    uint8_t event[OMNI_RECORD_MAX_EVENT];
+    uint32_t primask = DisableGlobalIRQ();
+
+    if (!recordFull)
+    {
+        Robot_RecordCommit(event, (uint32_t)omni_record_capture(&recordState, wheel, capture, event));
+    }
+    EnableGlobalIRQ(primask);
+}
+
+void Robot_RecordTimeout(uint32_t count)
+{
+    uint8_t event[OMNI_RECORD_MAX_EVENT];
+    uint32_t primask = DisableGlobalIRQ();
+
+    if (!recordFull)
+    {
+        Robot_RecordCommit(event, (uint32_t)omni_record_count(&recordState, count, event));
+    }
+    EnableGlobalIRQ(primask);
+}
+
+void Robot_RecordFrame(const uint8_t *frame)
+{
+    uint8_t event[OMNI_RECORD_MAX_EVENT];
+    uint32_t primask = DisableGlobalIRQ();
+
+    /* The bridge repeats a frame until the next one, the robot takes it once */
+    if (!recordFull && memcmp(frame, recordFrame, frame[0]) != 0)
+    {
+        memcpy(recordFrame, frame, frame[0]);
+        Robot_RecordCommit(event, (uint32_t)omni_record_frame(&recordState, frame, event));
+    }
+    EnableGlobalIRQ(primask);
+}
+
+void Robot_RecordTick(void)
+{
+    uint8_t event[OMNI_RECORD_MAX_EVENT];
+    uint32_t primask = DisableGlobalIRQ();
+
+    omni_record_tick(&recordState);
+    if (!recordFull && ++recordTicks >= ROBOT_RECORD_CHECK_TICKS)
+    {
+        recordTicks = 0;
+        Robot_RecordCommit(event, (uint32_t)omni_record_digest_event(&recordState, Robot_RecordDigest(), event));
+    }
+    EnableGlobalIRQ(primask);
+}
+
+uint32_t Robot_RecordRead(uint8_t *dst, uint32_t max)
+{
+    uint32_t n = recordHead - recordTail;
+
+    if (n > max)
+    {
+        n = max;
+    }
+    for (uint32_t i = 0; i < n; i++)
+    {
+        dst[i] = recordBuf[(recordTail + i) & (ROBOT_RECORD_BYTES - 1U)];
+    }
+    recordTail += n;
+    return n;
+}
+
+void Robot_RecordPrint(void)
+{
+    static const char hex[] = "0123456789abcdef";
+    uint8_t bytes[ROBOT_RECORD_LINE_BYTES];
+    char line[2U * ROBOT_RECORD_LINE_BYTES + 1U];
+
+    for (;;)
+    {
+        uint32_t offset = recordTail;
+        uint32_t pending = recordHead - offset;
+
+        /* Full lines; the rest once the recording has ended */
+        if (pending == 0U || (pending < ROBOT_RECORD_LINE_BYTES && !recordFull))
+        {
+            return;
+        }
+
+        uint32_t n = Robot_RecordRead(bytes, ROBOT_RECORD_LINE_BYTES);
+        for (uint32_t i = 0; i < n; i++)
+        {
+            line[2U * i] = hex[bytes[i] >> 4];
+            line[2U * i + 1U] = hex[bytes[i] & 0x0FU];
+        }
+        line[2U * n] = '\0';
+        PRINTF("REC,%lu,%s\r\n", (unsigned long)offset, line);
+    }
+}
+#endif
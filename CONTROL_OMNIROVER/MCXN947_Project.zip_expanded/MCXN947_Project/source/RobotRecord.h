@@ -0,0 +1,35 @@
+/* source/RobotRecord.h */
+#ifndef ROBOT_RECORD_H_
+#define ROBOT_RECORD_H_
+
+#include <stdint.h>
+
+/* 1 = record the inputs of the control interrupts (captures, stopped-wheel timeouts, received
+ * frames) and a digest of the control state, COMMON/omni_record.h, into a RAM buffer; the main
+ * loop prints it on the debug console as "REC,offset,hex" for HOST_SIM/tools/robot_replay.c */
+#ifndef ROBOT_RECORD
+#define ROBOT_RECORD 0
+#endif
+
+#define ROBOT_RECORD_BYTES       65536U  // Buffer, a power of 2: absorbs what the console is behind
+#define ROBOT_RECORD_CHECK_TICKS 120U    // PID ticks per state digest (10 ms)
+#define ROBOT_RECORD_LINE_BYTES  32U     // Per "REC" line
+
+#if ROBOT_RECORD
+/* Call first in main(), before any control interrupt is enabled */
+void Robot_RecordInit(void);
+
+/* Control interrupts: the inputs as they come in */
+void Robot_RecordCapture(uint32_t wheel, uint32_t capture);
+void Robot_RecordTimeout(uint32_t count);
+void Robot_RecordFrame(const uint8_t *frame);
+/* End of every PID tick */
+void Robot_RecordTick(void);
+
+/* Main loop: takes up to max recorded bytes, returns how many */
+uint32_t Robot_RecordRead(uint8_t *dst, uint32_t max);
+/* Main loop: prints what was recorded, in full lines until the recording has ended */
+void Robot_RecordPrint(void);
+#endif
+
+#endif /* ROBOT_RECORD_H_ */
@@ -3,36 +3,74 @@
 #include "ESP_SPI.h"
 #include "omnidriver.h"
 #include "ADC_DRIVER.h"
+#include "TIMER_DRIVER.h"
+#include "omni_sync.h"
+#include "RobotRecord.h"
+#if ROBOT_SPI_DATA_READY
+#include "GPIO_DRIVER.h"
+#endif
 
 /* External references to your Global Objects */
 extern MOTOR_T M1, M2, M3, M4;
 extern ROBOT_T ROBOT; // [NEW] Access the global ROBOT structure
+extern omni_gains_t pidGains;
 
-/* Buffers for SPI Driver */
-static uint8_t telemetryTxBuffer[ESP_SPI_TRANSFER_SIZE];
-static uint8_t telemetryRxBuffer[ESP_SPI_TRANSFER_SIZE];
+/* Buffers for SPI Driver: two exchanges, one can be on the bus while the next is filled.
+ * The eDMA moves them: in RAMH with OMNI_PLACE_BUFFERS, off the port of the stack and the control state */
+typedef struct {
+    uint8_t tx[ESP_SPI_TRANSFER_SIZE];
+    uint8_t rx[ESP_SPI_TRANSFER_SIZE];
+    volatile bool busy;     // Queued or on the bus, owned by the SPI driver
+} TelemetrySlot_t;
+
+static TelemetrySlot_t telemetrySlots[2] OMNI_PLACE_BUFFERS_BSS;
 
 static uint32_t packet_counter = 0;
-static uint32_t software_tick = 0;
 
-void Robot_SendTelemetry(void)
+/* Last command for the clock sync: its counter and when it first came in (t2) */
+static volatile uint16_t sync_cmd_count = 0;
+static volatile uint32_t sync_cmd_rx_us = 0;
+static volatile bool sync_cmd_seen = false;
+
+#if OMNI_PLACE_PROFILE
+omni_place_stat_t robot_place_telemetry;
+omni_place_stat_t robot_place_exchange;
+#endif
+
+/* Exchange done (LPSPI or eDMA interrupt): apply the command that came back */
+OMNI_PLACE_ISR_CODE static void Robot_ExchangeDone(uint8_t *txData, uint8_t *rxData, uint32_t size, status_t status,
+                                                   void *userData)
 {
-    /* Increment internal timebase */
-    software_tick++;
+    OMNI_PLACE_BEGIN(done);
+    TelemetrySlot_t *slot = (TelemetrySlot_t *)userData;
+    (void)txData;
 
-    /* 1. Check if SPI is busy. If so, skip this cycle. */
-    if (!ESP_SPI_IsTransferCompleted())
+    /* Read in place; NULL unless a complete command frame (length prefix and type 0xC5) came in */
+    const RemoteCommand_t *rx_cmd = (status == kStatus_Success) ? omni_wire_command(rxData, size) : NULL;
+    const RemoteGainPoint_t *rx_gains = (status == kStatus_Success) ? omni_wire_gain_point(rxData, size) : NULL;
+
+    if (rx_cmd != NULL || rx_gains != NULL)
     {
-        return;
+#if ROBOT_RECORD
+        Robot_RecordFrame(rxData);
+#endif
+
+        /* The bridge repeats a frame until the next one lands: stamp its first arrival.
+         * A gain point is echoed too, that is how the remote learns the robot has it. */
+        uint16_t count = OMNI_WIRE_HEADER_COUNT((rx_cmd != NULL) ? rx_cmd->header : rx_gains->header);
+        if (!sync_cmd_seen || count != sync_cmd_count)
+        {
+            if (!sync_cmd_seen)
+            {
+                boot_mark("first command");
+            }
+            sync_cmd_rx_us = (uint32_t)us_clock_now();
+            sync_cmd_count = count;
+            sync_cmd_seen = true;
+        }
     }
 
-    /* -----------------------------------------------------------
-     * STEP A: PROCESS RECEIVED DATA (From Previous Transaction)
-     * ----------------------------------------------------------- */
-    RemoteCommand_t *rx_cmd = (RemoteCommand_t *)telemetryRxBuffer;
-
-    /* Check for the specific Header Byte (0xC5) to verify data integrity */
-    if ((rx_cmd->header >> 24) == 0xC5)
+    if (rx_cmd != NULL)
     {
         /* Update Robot Velocities directly */
         ROBOT.vx  = rx_cmd->vx;
@@ -42,19 +80,51 @@ void Robot_SendTelemetry(void)
         /* Optional: Handle buttons here */
         // if (rx_cmd->buttons & 0x01) { ... }
     }
+    else if (rx_gains != NULL)
+    {
+        /* A gain table point in place of a command: the last command stays */
+        (void)omni_gains_apply(&pidGains, rx_gains);
+    }
     else
     {
         /* Optional: Safety logic if no valid packet received for X cycles */
         // ROBOT.vx = 0; ROBOT.vy = 0; ROBOT.phi = 0;
     }
 
+    slot->busy = false;
+    OMNI_PLACE_END(done, &robot_place_exchange);
+}
+
+OMNI_PLACE_ISR_CODE void Robot_SendTelemetry(void)
+{
+    OMNI_PLACE_BEGIN(send);
+    TelemetrySlot_t *slot;
+
+    /* -----------------------------------------------------------
+     * STEP A: TAKE A FREE BUFFER
+     * The command of each exchange is applied by its completion
+     * callback; if both buffers are still queued, skip this cycle.
+     * ----------------------------------------------------------- */
+    if (!telemetrySlots[0].busy)
+    {
+        slot = &telemetrySlots[0];
+    }
+    else if (!telemetrySlots[1].busy)
+    {
+        slot = &telemetrySlots[1];
+    }
+    else
+    {
+        return;
+    }
+
     /* -----------------------------------------------------------
      * STEP B: PREPARE NEW TELEMETRY PACKET
      * ----------------------------------------------------------- */
-    RobotTelemetry_t *packet = (RobotTelemetry_t *)telemetryTxBuffer;
+    RobotTelemetry_t *packet = (RobotTelemetry_t *)slot->tx;
 
-    /* Header Construction */
-    packet->packet_header = (TELEMETRY_PACKET_ID << 24) | (packet_counter & 0x00FFFFFF);
+    /* Header Construction: [ID (8b) | Counter (16b) | Length (8b)] */
+    packet->packet_header = OMNI_WIRE_HEADER(TELEMETRY_PACKET_ID, packet_counter, sizeof(RobotTelemetry_t));
 
     /* Fill Speed Data */
     packet->speed_m1 = M1.speed;
@@ -83,15 +153,49 @@ void Robot_SendTelemetry(void)
         M4.ADC->last_raw_value = packet->adc_m4;
     } else { packet->adc_m4 = 0; }
 
-    /* Fill Timestamp/Flags */
-    packet->timestamp = software_tick;
-    packet->reserved_flags = 0;
+    /* Fill Timestamp and Clock Sync: echo the last command and how long we have had it */
+    uint32_t primask = DisableGlobalIRQ();
+    uint32_t now = (uint32_t)us_clock_now();
+    packet->sync_cmd_count = sync_cmd_count;
+    packet->sync_hold_us = sync_cmd_seen ? omni_sync_hold_us(now, sync_cmd_rx_us) : (uint16_t)OMNI_SYNC_HOLD_NONE;
+    EnableGlobalIRQ(primask);
+    packet->timestamp = now;
 
     /* -----------------------------------------------------------
-     * STEP C: START SPI TRANSFER
+     * STEP C: QUEUE SPI TRANSFER
      * ----------------------------------------------------------- */
-    /* This sends 'telemetryTxBuffer' AND receives into 'telemetryRxBuffer' simultaneously */
-    ESP_SPI_StartTransfer(telemetryTxBuffer, telemetryRxBuffer);
+    /* This sends 'slot->tx' AND receives into 'slot->rx' simultaneously.
+     * Only the 36 byte exchange is clocked, not the whole buffer. */
+    slot->busy = true;
+    if (ESP_SPI_QueueTransfer(slot->tx, slot->rx, OMNI_WIRE_EXCHANGE_SIZE, Robot_ExchangeDone, slot) != kStatus_Success)
+    {
+        slot->busy = false;
+        return;
+    }
 
     packet_counter++;
+    OMNI_PLACE_END(send, &robot_place_telemetry);
+}
+
+#if ROBOT_SPI_DATA_READY
+/* Data-ready edge (GPIO10_IRQHandler): the bridge has a transaction armed, exchange now */
+OMNI_PLACE_ISR_CODE static void Robot_SpiReadyHandler(void)
+{
+    if (GPIO_PinGetInterruptFlag(ROBOT_SPI_READY_GPIO, ROBOT_SPI_READY_PIN) == 0U)
+    {
+        return;
+    }
+    GPIO_PinClearInterruptFlag(ROBOT_SPI_READY_GPIO, ROBOT_SPI_READY_PIN);
+
+    Robot_SendTelemetry();
+}
+
+void Robot_SpiReadyInit(void)
+{
+    uint32_t pin = ROBOT_SPI_READY_PIN;
+
+    /* Plain GPIO input, rising edge on GPIO10 */
+    PORT1_Setup(pin, NULL);
+    init_interrupts(ROBOT_SPI_READY_GPIO, &pin, 1, Robot_SpiReadyHandler);
 }
+#endif
@@ -4,46 +4,38 @@
 
 #include <stdint.h>
 
+/* RobotTelemetry_t (Robot -> Remote, 36 bytes) and RemoteCommand_t (Remote -> Robot, 24 bytes)
+ * are shared with the remote and the bridges: COMMON/omni_wire.h */
+#include "omni_wire.h"
+#include "omni_place.h"
+
 /* Packet Headers */
-#define TELEMETRY_PACKET_ID 0xA1  // Robot -> Remote
-#define REMOTE_PACKET_HEADER 0xC5 // Remote -> Robot
-
-/* * Telemetry Structure (Robot -> Remote)
- * Size: 36 bytes (Fits in 40-byte SPI buffer)
- */
-typedef struct __attribute__((packed)) {
-    uint32_t packet_header;     // [ID (8b) | Counter (24b)]
-
-    /* Motor Speeds (rad/s) */
-    float speed_m1;
-    float speed_m2;
-    float speed_m3;
-    float speed_m4;
-
-    /* Motor Currents (ADC Raw Values) */
-    uint16_t adc_m1;
-    uint16_t adc_m2;
-    uint16_t adc_m3;
-    uint16_t adc_m4;
-
-    /* Extra Telemetry */
-    uint32_t reserved_flags;
-    uint32_t timestamp;         // Software tick
-} RobotTelemetry_t;
-
-/* * Command Structure (Remote -> Robot)
- * Size: 24 Bytes
- */
-typedef struct __attribute__((packed)) {
-    uint32_t header;        // 0xC5 + Packet Counter
-    float vx;               // Linear Velocity X (m/s)
-    float vy;               // Linear Velocity Y (m/s)
-    float phi;              // Angular Velocity (rad/s)
-    uint32_t buttons;       // Button states
-    uint32_t timestamp;     // Time reference
-} RemoteCommand_t;
+#define TELEMETRY_PACKET_ID  OMNI_WIRE_TYPE_TELEMETRY // Robot -> Remote
+#define REMOTE_PACKET_HEADER OMNI_WIRE_TYPE_COMMAND   // Remote -> Robot
+
+/* Exchange trigger:
+ * 0 = poll the bridge from LPTMR0 (2.4 kHz)
+ * 1 = exchange on the rising edge of the bridge's data-ready line: right after a command
+ *     lands, and at its keep-alive rate otherwise (SPI_DATA_READY in ESP32_WIFI/RX/main/main.c) */
+#ifndef ROBOT_SPI_DATA_READY
+#define ROBOT_SPI_DATA_READY 0
+#endif
+
+#define ROBOT_SPI_READY_GPIO GPIO1
+#define ROBOT_SPI_READY_PIN  23U    // P1_23 <- bridge GPIO5 (GPIO10_IRQHandler)
 
 /* Public API */
 void Robot_SendTelemetry(void);
 
+#if OMNI_PLACE_PROFILE
+/* Cycles of Robot_SendTelemetry() (a queued exchange) and of the exchange done callback */
+extern omni_place_stat_t robot_place_telemetry;
+extern omni_place_stat_t robot_place_exchange;
+#endif
+
+#if ROBOT_SPI_DATA_READY
+/* Data-ready input and its interrupt; call after ESP_SPI_Init() */
+void Robot_SpiReadyInit(void);
+#endif
+
 #endif /* ROBOT_TELEMETRY_H_ */
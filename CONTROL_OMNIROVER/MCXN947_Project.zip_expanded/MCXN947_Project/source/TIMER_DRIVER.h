@@ -13,8 +13,49 @@
 #include "fsl_debug_console.h"
 
 #define CLOCK_SOURCE_LPTMR 12000000U
+#define US_CLOCK_HZ 1000000U
+/* Match register of the us clock's CTIMER that ends us_clock_sleep_until(), its
+ * interrupt enable and its flag */
+#define US_CLOCK_WAKE_MATCH kCTIMER_Match_3
+#define US_CLOCK_WAKE_MATCH_IRQ kCTIMER_Match3InterruptEnable
+#define US_CLOCK_WAKE_MATCH_FLAG kCTIMER_Match3Flag
 
 void init_LPTMR_12MHz(LPTMR_Type* lptmr_base, uint32_t period_ticks);
 void lptmr_attach_callback(LPTMR_Type* lptmr_base, void* callback);
 
+/* 64-bit microsecond monotonic clock: a free running CTIMER prescaled to 1 MHz,
+ * its 32-bit count widened in software. Safe from any interrupt; must be read at
+ * least once per wrap of the counter (71 min), the SPI exchanges do that. */
+void init_us_clock(CTIMER_Type* ctimer_base, uint32_t src_clock_hz);
+uint64_t us_clock_now(void);
+
+/* Tickless idle: WFI until the us clock reaches wake_us (a match interrupt on its
+ * CTIMER) or any other interrupt comes, whichever is first, and right away if
+ * *event (may be NULL) is already set. *event is checked with interrupts masked, so
+ * an interrupt that sets it can't slip in before the WFI; the handler of the one
+ * that woke the core runs when this returns. Returns the us spent in WFI. A wake_us
+ * more than one counter wrap ahead wakes early, callers check the time and sleep again. */
+uint32_t us_clock_sleep_until(uint64_t wake_us, volatile bool* event);
+
+/* Boot profiler: init stages timed on the DWT cycle counter, which runs before any
+ * timer has a clock, in us since boot_profile_start(). Stages may overlap (init state
+ * machines polled from the main loop); boot_report() prints them as a timeline. A
+ * stage across a core clock change is timed at the clock it started with. Safe from
+ * interrupts; boot_us() must run at least once per counter wrap (28 s at 150 MHz). */
+#define BOOT_STAGES_MAX 16U
+#define BOOT_STAGE_NONE 0xFFU
+
+/* boot_report_poll() prints the timeline this long after boot_profile_start(), 0 = never */
+#ifndef BOOT_REPORT_US
+#define BOOT_REPORT_US 1000000U
+#endif
+
+void boot_profile_start(void);
+uint32_t boot_us(void);
+uint8_t boot_begin(const char* name);
+void boot_end(uint8_t stage);
+void boot_mark(const char* name);
+void boot_report(void);
+void boot_report_poll(void);
+
 #endif /* TIMER_DRIVER_H_ */
@@ -0,0 +1,120 @@
+/*
+ * imu_calib.c
+ *
+ * Main loop only (the MPU9250 read is the main loop's idle point).
+ */
+
+#include "imu_calib.h"
+#include <string.h>
+#include <math.h>
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+static int16_t Round16(float v)
+{
+    if (v > 32767.0f) return 32767;
+    if (v < -32768.0f) return -32768;
+    return (int16_t)((v < 0.0f) ? v - 0.5f : v + 0.5f);
+}
+
+/* Sample off the reference by more than the gyro noise: the robot moves */
+static bool Moving(const imu_calib_t *c, const int16_t raw[IMU_CALIB_AXES])
+{
+    if (!c->refValid)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        int32_t d = (int32_t)raw[3U + i] - c->ref.gyro[i];
+        if (d > IMU_CALIB_GYRO_MOTION || d < -IMU_CALIB_GYRO_MOTION)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*******************************************************************************
+ * Estimator
+ ******************************************************************************/
+void ImuCalib_Init(imu_calib_t *c)
+{
+    memset(c, 0, sizeof(imu_calib_t));
+}
+
+bool ImuCalib_Add(imu_calib_t *c, const int16_t raw[IMU_CALIB_AXES], bool wheelsStill, uint64_t nowUs)
+{
+    if (wheelsStill && Moving(c, raw))
+    {
+        c->rejected++;
+        wheelsStill = false;
+    }
+    if (!wheelsStill)
+    {
+        c->still = false;
+        return false;
+    }
+    if (!c->still)
+    {
+        c->still = true;
+        c->stillSinceUs = nowUs;
+    }
+    if (nowUs - c->stillSinceUs < IMU_CALIB_SETTLE_US)
+    {
+        return false;
+    }
+
+    /* Welford; past the window the old samples fade out with weight (N-1)/N per sample */
+    if (c->n < IMU_CALIB_WINDOW)
+    {
+        c->n++;
+    }
+    for (uint32_t i = 0; i < IMU_CALIB_AXES; i++)
+    {
+        imu_calib_axis_t *a = &c->axis[i];
+        float x = (float)raw[i];
+        float delta = x - a->mean;
+
+        if (c->n == IMU_CALIB_WINDOW)
+        {
+            a->m2 *= (float)(IMU_CALIB_WINDOW - 1U) / (float)IMU_CALIB_WINDOW;
+        }
+        a->mean += delta / (float)c->n;
+        a->m2 += delta * (x - a->mean);
+    }
+    c->total++;
+
+    /* Motion is judged against the estimate once it has some weight */
+    if (c->n >= IMU_CALIB_MIN_SAMPLES / 10U)
+    {
+        (void)ImuCalib_Get(c, &c->ref);
+        c->refValid = true;
+    }
+    return true;
+}
+
+bool ImuCalib_Get(const imu_calib_t *c, imu_calib_offsets_t *out)
+{
+    if (c->n < IMU_CALIB_MIN_SAMPLES / 10U)
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        out->accel[i] = Round16(c->axis[i].mean);
+        out->gyro[i] = Round16(c->axis[3U + i].mean);
+    }
+    out->accel[2] = Round16(c->axis[2].mean - (float)IMU_CALIB_ACCEL_1G);
+    return c->n >= IMU_CALIB_MIN_SAMPLES;
+}
+
+float ImuCalib_StdDev(const imu_calib_t *c, uint32_t axis)
+{
+    if (axis >= IMU_CALIB_AXES || c->n < 2U)
+    {
+        return 0.0f;
+    }
+    return sqrtf(c->axis[axis].m2 / (float)(c->n - 1U));
+}
@@ -0,0 +1,86 @@
+/*
+ * imu_calib.h
+ *
+ * Background calibration of the MPU9250 offsets, replacing the blocking
+ * MPU9250_Calibrate() at boot (1000 reads, the robot must not move).
+ *
+ * - Boot: the robot can drive right away, with uncalibrated offsets until
+ *   the wheels have stood still long enough.
+ * - Running: every sample taken while the wheels stand still goes into a
+ *   running mean and variance per axis (Welford). Samples only count once
+ *   the wheels have been still for IMU_CALIB_SETTLE_US, and a gyro reading
+ *   far from the current offset (robot picked up or pushed) restarts that
+ *   wait. The estimate forgets slowly (IMU_CALIB_WINDOW), so it follows
+ *   temperature drift.
+ * - The driver's offsets are updated from it.
+ *
+ * The offsets are not kept across boots: the tree has no flash driver.
+ * The estimator doesn't use the SDK and builds on Linux
+ * (HOST_SIM/tools/imu_calib_replay.c feeds it recorded traces).
+ */
+
+#ifndef IMU_CALIB_H_
+#define IMU_CALIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* 1 = print every raw sample on the debug console as "IMU,t_us,ax,ay,az,gx,gy,gz,still",
+ * the trace format of imu_calib_replay */
+#ifndef ROBOT_IMU_TRACE
+#define ROBOT_IMU_TRACE             0
+#endif
+
+#define IMU_CALIB_AXES              6U          /* ax, ay, az, gx, gy, gz */
+#define IMU_CALIB_ACCEL_1G          16384       /* MPU9250_ACCEL_1G: +-2 g, the robot stands flat */
+#define IMU_CALIB_MIN_SAMPLES       1000U       /* Before the estimate replaces the offsets (CALIB_SAMPLE) */
+#define IMU_CALIB_WINDOW            20000U      /* Newest sample weighs at least 1/N */
+#define IMU_CALIB_SETTLE_US         300000U     /* Wheels still this long before samples count */
+#define IMU_CALIB_STILL_RAD_S       0.05f       /* Wheel speed below which a wheel is still */
+#define IMU_CALIB_GYRO_MOTION       262         /* 2 dps (131 LSB/dps at +-250 dps) off the offset: moving */
+
+/* Offsets as the driver subtracts them (accel Z without the 1 g) */
+typedef struct {
+    int16_t accel[3];
+    int16_t gyro[3];
+} imu_calib_offsets_t;
+
+typedef struct {
+    float mean;
+    float m2;               /* Sum of squared deviations (Welford) */
+} imu_calib_axis_t;
+
+typedef struct {
+    imu_calib_axis_t axis[IMU_CALIB_AXES];
+    uint32_t n;             /* Samples in the estimate, at most IMU_CALIB_WINDOW */
+    uint32_t total;         /* Samples taken, ever */
+    uint32_t rejected;      /* Gyro said the robot moves while the wheels stood still */
+
+    bool still;
+    uint64_t stillSinceUs;
+
+    /* Offsets in use: motion reference */
+    imu_calib_offsets_t ref;
+    bool refValid;
+} imu_calib_t;
+
+/*******************************************************************************
+ * Estimator (no SDK)
+ ******************************************************************************/
+
+void ImuCalib_Init(imu_calib_t *c);
+
+/*
+ * One sample, raw (no offsets applied). wheelsStill: every wheel below
+ * IMU_CALIB_STILL_RAD_S and no command moving it.
+ * Returns true if it went into the estimate.
+ */
+bool ImuCalib_Add(imu_calib_t *c, const int16_t raw[IMU_CALIB_AXES], bool wheelsStill, uint64_t nowUs);
+
+/* Offsets of the estimate; false before IMU_CALIB_MIN_SAMPLES */
+bool ImuCalib_Get(const imu_calib_t *c, imu_calib_offsets_t *out);
+
+/* Standard deviation of an axis' samples (LSB) */
+float ImuCalib_StdDev(const imu_calib_t *c, uint32_t axis);
+
+#endif /* IMU_CALIB_H_ */
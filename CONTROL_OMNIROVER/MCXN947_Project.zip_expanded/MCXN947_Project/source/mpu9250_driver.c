@@ -14,6 +14,16 @@
 #define ACCEL_XOUT_H        0x3B
 #define CALIB_SAMPLE        1000U
 
+/* Arranque: espera tras el reset y tras despertar */
+#define MPU9250_RESET_US    100000U
+#define MPU9250_WAKE_US     100000U
+
+enum {
+    MPU9250_INIT_RESET,
+    MPU9250_INIT_WAKE,
+    MPU9250_INIT_DONE
+};
+
 /* --- Funciones Privadas (Helpers) --- */
 
 static status_t MPU_WriteReg(LPI2C_Type *base, uint8_t reg, uint8_t value)
@@ -48,9 +58,21 @@ static status_t MPU_ReadRegs(LPI2C_Type *base, uint8_t reg, uint8_t *data, uint8
 /* --- Funciones Públicas --- */
 
 status_t MPU9250_Init(mpu9250_handle_t *handle, LPI2C_Type *base)
+{
+    uint64_t nowUs = 0;
+    status_t status = MPU9250_InitStart(handle, base, nowUs);
+
+    while (status == kStatus_Success && (status = MPU9250_InitPoll(handle, nowUs)) == kStatus_Busy) {
+        uint32_t waitUs = (uint32_t)(handle->initDueUs - nowUs);
+        SDK_DelayAtLeastUs(waitUs, CLOCK_GetFreq(kCLOCK_CoreSysClk));
+        nowUs += waitUs;
+    }
+    return status;
+}
+
+status_t MPU9250_InitStart(mpu9250_handle_t *handle, LPI2C_Type *base, uint64_t nowUs)
 {
     status_t status;
-    uint8_t whoami = 0;
 
     /* Guardar referencia del periférico I2C */
     handle->i2cBase = base;
@@ -64,11 +86,25 @@ status_t MPU9250_Init(mpu9250_handle_t *handle, LPI2C_Type *base)
     /* Resetear el MPU */
     status = MPU_WriteReg(handle->i2cBase, PWR_MGMT_1_REG, 0x80);
     if (status != kStatus_Success) return status;
-    SDK_DelayAtLeastUs(100000, CLOCK_GetFreq(kCLOCK_CoreSysClk));
+    handle->initStep = MPU9250_INIT_RESET;
+    handle->initDueUs = nowUs + MPU9250_RESET_US;
+    return kStatus_Success;
+}
 
-    /* Despertar y seleccionar reloj (Auto select) */
-    MPU_WriteReg(handle->i2cBase, PWR_MGMT_1_REG, 0x01);
-    SDK_DelayAtLeastUs(100000, CLOCK_GetFreq(kCLOCK_CoreSysClk));
+status_t MPU9250_InitPoll(mpu9250_handle_t *handle, uint64_t nowUs)
+{
+    uint8_t whoami = 0;
+
+    if (handle->initStep == MPU9250_INIT_DONE) return kStatus_Success;
+    if (nowUs < handle->initDueUs) return kStatus_Busy;
+
+    if (handle->initStep == MPU9250_INIT_RESET) {
+        /* Despertar y seleccionar reloj (Auto select) */
+        MPU_WriteReg(handle->i2cBase, PWR_MGMT_1_REG, 0x01);
+        handle->initStep = MPU9250_INIT_WAKE;
+        handle->initDueUs = nowUs + MPU9250_WAKE_US;
+        return kStatus_Busy;
+    }
 
     /* Configurar DLPF (~41Hz) */
     MPU_WriteReg(handle->i2cBase, CONFIG_REG, 0x03);
@@ -76,6 +112,7 @@ status_t MPU9250_Init(mpu9250_handle_t *handle, LPI2C_Type *base)
 
     /* Verificar ID */
     MPU_ReadRegs(handle->i2cBase, WHO_AM_I_REG, &whoami, 1);
+    handle->initStep = MPU9250_INIT_DONE;
 
     if (whoami != 0x71 && whoami != 0x73) {
         return kStatus_Fail; // ID Incorrecto
@@ -36,13 +36,22 @@ typedef struct {
     int32_t accelOffset[3];
     int32_t gyroOffset[3];
 
+    /* Arranque no bloqueante (MPU9250_InitStart / MPU9250_InitPoll) */
+    uint8_t initStep;
+    uint64_t initDueUs;
+
 } mpu9250_handle_t;
 
 /* Prototipos de Funciones */
 
-/* Inicializa el sensor, configura DLPF y verifica WHO_AM_I */
+/* Inicializa el sensor, configura DLPF y verifica WHO_AM_I (Bloqueante, 200 ms) */
 status_t MPU9250_Init(mpu9250_handle_t *handle, LPI2C_Type *base);
 
+/* El mismo arranque sin esperas: InitStart resetea el sensor, InitPoll sigue cuando
+ * vence cada espera (nowUs: us_clock_now). InitPoll devuelve kStatus_Busy mientras arranca. */
+status_t MPU9250_InitStart(mpu9250_handle_t *handle, LPI2C_Type *base, uint64_t nowUs);
+status_t MPU9250_InitPoll(mpu9250_handle_t *handle, uint64_t nowUs);
+
 /* Realiza la rutina de calibración (Bloqueante) */
 void MPU9250_Calibrate(mpu9250_handle_t *handle);
 
@@ -4,7 +4,12 @@
 #include "esp_log.h"
 #include "esp_event.h"
 #include "driver/gpio.h"
-#include "driver/spi_slave.h"
+#include "spi_bridge.h"
+#include "bridge_stats.h"
+#include "air_link_esp.h"
+#include "bridge_frames.h"
+#include "omni_wire.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "esp_now.h"
@@ -14,13 +19,29 @@
 #include "nvs_flash.h"
 
 #define ESP_CHANNEL 1
-#define SPI_PAYLOAD_SIZE 40 
+
+/* 1 = log every 100th frame (float formatting, for bring-up only). Counters: bridge_stats */
+#define BRIDGE_LOG_FRAMES 0
+
+/* Air link: telemetry goes out once per SPI frame (kHz), so no redundancy by default */
+#define AIR_REPEAT        1     // Copies of every frame
+#define AIR_PARITY_GROUP  0     // One XOR parity frame every N frames (0 = off)
+
+/* 1 = data-ready line to the robot: it exchanges when a command lands instead of
+ * polling at 2.4 kHz (must match ROBOT_SPI_DATA_READY in RobotTelemetry.h) */
+#define SPI_DATA_READY    0
+#define TELEMETRY_MIN_HZ  100   // Data-ready mode: exchanges per s at least, for telemetry (tick: 10 ms)
+
+/* Fleet mode (fleet_link.h): -1 = the only robot, talks to peer_mac. 0..15 = id of this
+ * robot in the remote's fleet (FLEET_ROBOTS in TX main.c), telemetry only in its slot */
+#define FLEET_ROBOT_ID    -1
 
 // Pin Config (ESP32-C3 Super Mini)
 #define SPI_MOSI_GPIO 8
 #define SPI_MISO_GPIO 9
 #define SPI_CLK_GPIO  4
 #define SPI_CS_GPIO   3
+#define SPI_READY_GPIO 5  // Data-ready to the robot (P1_23), only with SPI_DATA_READY
 
 static const char *TAG = "RobotBridge";
 
@@ -29,105 +50,113 @@ static const char *TAG = "RobotBridge";
 static uint8_t peer_mac[ESP_NOW_ETH_ALEN] = {0x8c, 0xd0, 0xb2, 0xa7, 0xed, 0xe4}; 
 
 /* --- DATA STRUCTURES --- */
-
-/* Command: Remote -> Robot (Via SPI RX -> ESP-NOW TX) */
-typedef struct __attribute__((packed)) {
-    uint32_t header;        
-    float vx;               
-    float vy;               
-    float phi;              
-    uint32_t buttons;       
-    uint32_t timestamp;     
-} RemoteCommand_t;
-
-/* Telemetry: Robot -> Remote (Via ESP-NOW RX -> SPI TX) */
-typedef struct __attribute__((packed)) {
-    uint32_t packet_header; 
-    float speed_m1;
-    float speed_m2;
-    float speed_m3;
-    float speed_m4;
-    uint16_t adc_m1;
-    uint16_t adc_m2;
-    uint16_t adc_m3;
-    uint16_t adc_m4;
-    uint32_t reserved_flags;
-    uint32_t timestamp;
-} RobotTelemetry_t;
+/* RemoteCommand_t / RobotTelemetry_t and the frame header: COMMON/omni_wire.h */
 
 /* Global Storage */
-/* 1. Command received from Air, waiting to be sent to Robot MCU via MISO */
-static RemoteCommand_t latest_command_from_remote = {0}; 
-static portMUX_TYPE data_mutex = portMUX_INITIALIZER_UNLOCKED;
+/* Command received from Air is handed straight to the SPI bridge (MISO) */
+static air_link_t air;
+static bridge_frames_t bridge;  // Frame path: bridge_frames.c
 
-/* 2. Telemetry received from Robot MCU via MOSI, saved for record keeping */
+/* Telemetry received from Robot MCU via MOSI, saved for record keeping */
 static RobotTelemetry_t last_sent_telemetry = {0}; 
 
-/* SPI Buffers */
-WORD_ALIGNED_ATTR uint8_t spi_tx_buf[SPI_PAYLOAD_SIZE]; // MISO
-WORD_ALIGNED_ATTR uint8_t spi_rx_buf[SPI_PAYLOAD_SIZE]; // MOSI
+#if FLEET_ROBOT_ID >= 0
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+/* WiFi task (beacons), SPI task (telemetry) and slot timer share the fleet state */
+static portMUX_TYPE fleet_mutex = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t slot_timer;
+
+static void fleet_lock(void *ctx){
+    portENTER_CRITICAL(&fleet_mutex);
+}
+
+static void fleet_unlock(void *ctx){
+    portEXIT_CRITICAL(&fleet_mutex);
+}
+
+/* A beacon came: our slot counted from its arrival */
+static void start_slot(uint32_t in_us, void *ctx){
+    esp_timer_stop(slot_timer);
+    esp_timer_start_once(slot_timer, in_us);
+}
+#endif
 
 /* --- CALLBACKS --- */
 
+static void set_miso(const void *data, size_t len, void *ctx){
+    spi_bridge_set_miso(data, len);
+}
+
+/* Newest command (fleet: beacon) from the air link (duplicates and late frames already dropped) */
+static void air_deliver(const uint8_t *payload, size_t len, void *ctx){
+    /* Becomes the MISO payload of the next armed transaction, no SPI task involved */
+    bridge_frames_air(&bridge, payload, len);
+    BRIDGE_STATS_INC(air_frames_in);
+}
+
+#if FLEET_ROBOT_ID >= 0
+/* Slot timer (esp_timer task): the newest telemetry of our robot, once per superframe */
+static void slot_cb(void *arg){
+    bridge_stats.air_send_err += bridge_frames_timer(&bridge);
+}
+#endif
+
+static void air_log(const char *tag){
+    air_link_esp_log(&air, tag);
+#if FLEET_ROBOT_ID >= 0
+    fleet_robot_stats_t s;
+    portENTER_CRITICAL(&fleet_mutex);
+    s = bridge.fleet_robot.stats;
+    portEXIT_CRITICAL(&fleet_mutex);
+    ESP_LOGI(tag, "FLEET | robot %d | beacons %lu lost %lu | cmd %lu | slots %lu empty %lu none %lu",
+             FLEET_ROBOT_ID, (unsigned long)s.beacons, (unsigned long)s.beacons_lost, (unsigned long)s.commands,
+             (unsigned long)s.slots, (unsigned long)s.slots_empty, (unsigned long)s.no_slot);
+#endif
+}
+
 /* Received Data from Remote via ESP-NOW */
 void recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len){
-    if (len == SPI_PAYLOAD_SIZE) { 
-        taskENTER_CRITICAL(&data_mutex);
-        memcpy(&latest_command_from_remote, data, sizeof(RemoteCommand_t));
-        taskEXIT_CRITICAL(&data_mutex);
+    if (air_link_receive(&air, data, len) == AIR_LINK_RX_INVALID) {
+        BRIDGE_STATS_INC(crc_errors);
     }
 }
 
 /* Send Complete Callback */
 void send_cb(const uint8_t *mac, esp_now_send_status_t status) {
-    // Optional: Add error counting here if needed
+    if(status == ESP_NOW_SEND_SUCCESS) BRIDGE_STATS_INC(air_frames_out);
+    else BRIDGE_STATS_INC(air_send_fail);
 }
 
-/* --- MAIN SPI TASK --- */
-static void spi_slave_task(void *pv){
-    spi_slave_transaction_t t;
-    esp_err_t ret;
-    static uint32_t transaction_count = 0;
+/* --- SPI FRAME HANDLER --- */
+/* Called by the SPI bridge task for every frame from the Robot MCU (Master).
+ * Its transaction is armed again when this returns: it has to be done within the master's period (417 us). */
+static void on_spi_frame(const uint8_t *frame, size_t len){
+    // A. Send immediately via ESP-NOW (No extra task); fleet: keep the newest, it goes out in our slot
+    int air_err = bridge_frames_spi(&bridge, frame, len);
+    if(air_err < 0){
+        BRIDGE_STATS_INC(spi_frames_bad);
+        return;
+    }
+    bridge_stats.air_send_err += air_err;
 
-    ESP_LOGI(TAG, "SPI Slave Task Started. Waiting for Master...");
-
-    while(1){
-        /* 1. PREPARE DATA FOR MISO (Command to Robot) */
-        // Load the latest command we got from the Remote into the SPI TX buffer
-        memset(spi_tx_buf, 0, SPI_PAYLOAD_SIZE);
-        taskENTER_CRITICAL(&data_mutex);
-        memcpy(spi_tx_buf, &latest_command_from_remote, sizeof(RemoteCommand_t));
-        taskEXIT_CRITICAL(&data_mutex);
-
-        /* 2. SETUP TRANSACTION */
-        memset(&t, 0, sizeof(t));
-        t.length = SPI_PAYLOAD_SIZE * 8; // Bits
-        t.tx_buffer = spi_tx_buf;
-        t.rx_buffer = spi_rx_buf;
-        
-        /* 3. WAIT FOR TRANSACTION (Blocking) */
-        // The task sleeps here until the Robot MCU (Master) pulls CS low
-        ret = spi_slave_transmit(SPI2_HOST, &t, portMAX_DELAY);
-
-        if(ret == ESP_OK){
-            /* 4. HANDLE RECEIVED DATA (Telemetry from Robot) */
-            
-            // A. Save the packet to information structure as requested
-            memcpy(&last_sent_telemetry, spi_rx_buf, sizeof(RobotTelemetry_t));
-
-            // B. Send immediately via ESP-NOW (No extra task)
-            esp_err_t wifi_ret = esp_now_send(peer_mac, spi_rx_buf, SPI_PAYLOAD_SIZE);
-            
-            /* 5. LOGGING (Throttled) */
-            transaction_count++;
-            if(transaction_count % 100 == 0){
-                ESP_LOGI(TAG, "SYNC | CMD_VX: %.2f | TEL_M1: %.2f | ESP-NOW: %s", 
-                         latest_command_from_remote.vx, 
-                         last_sent_telemetry.speed_m1,
-                         (wifi_ret == ESP_OK) ? "OK" : "FAIL");
-            }
-        }
+    // B. Save the packet to information structure as requested
+    const RobotTelemetry_t *tel = omni_wire_telemetry(frame, len);
+    if(tel) memcpy(&last_sent_telemetry, tel, sizeof(RobotTelemetry_t));
+
+#if BRIDGE_LOG_FRAMES
+    /* LOGGING (Throttled) */
+    static uint32_t transaction_count = 0;
+    transaction_count++;
+    if(transaction_count % 100 == 0){
+        RemoteCommand_t cmd;
+        spi_bridge_get_miso(&cmd, sizeof(cmd));
+        ESP_LOGI(TAG, "SYNC | CMD_VX: %.2f | TEL_M1: %.2f | ESP-NOW: %s", 
+                 cmd.vx, 
+                 last_sent_telemetry.speed_m1,
+                 (air_err == 0) ? "OK" : "FAIL");
     }
+#endif
 }
 
 /* --- INITIALIZATION --- */
@@ -142,33 +171,53 @@ void app_main(void){
     esp_wifi_start();
     
     // 2. ESP-NOW Init
+#if FLEET_ROBOT_ID >= 0
+    /* Any remote bridge's beacons drive us; telemetry is broadcast in our slot,
+     * one copy (a repeat or parity frame would run into the next slot) */
+    const uint8_t *air_peer = broadcast_mac;
+    const esp_timer_create_args_t slot_args = {.callback = slot_cb, .name = "slot"};
+    esp_timer_create(&slot_args, &slot_timer);
+    air_link_esp_init(&air, air_peer, 1, 0, air_deliver);
+    const bridge_frames_config_t bcfg = {.role = BRIDGE_ROBOT, .fleet_id = FLEET_ROBOT_ID, .air = &air,
+                                         .set_miso = set_miso, .start_slot = start_slot,
+                                         .lock = fleet_lock, .unlock = fleet_unlock};
+#else
+    const uint8_t *air_peer = peer_mac;
+    air_link_esp_init(&air, air_peer, AIR_REPEAT, AIR_PARITY_GROUP, air_deliver);
+    const bridge_frames_config_t bcfg = {.role = BRIDGE_ROBOT, .fleet_id = -1, .air = &air, .set_miso = set_miso};
+#endif
+    bridge_frames_init(&bridge, &bcfg);
     esp_now_init();
     esp_now_register_recv_cb(recv_cb);
     esp_now_register_send_cb(send_cb);
     
-    // 3. Register Peer (Remote Control)
+    // 3. Register Peer (Remote Control, or broadcast in fleet mode)
     esp_now_peer_info_t peer = {};
-    memcpy(peer.peer_addr, peer_mac, 6);
+    memcpy(peer.peer_addr, air_peer, 6);
     peer.channel = ESP_CHANNEL;
     peer.encrypt = false;
     esp_now_add_peer(&peer);
 
-    // 4. SPI Slave Init
-    spi_bus_config_t buscfg = {
-        .mosi_io_num=SPI_MOSI_GPIO, 
-        .miso_io_num=SPI_MISO_GPIO, 
-        .sclk_io_num=SPI_CLK_GPIO, 
-        .quadwp_io_num=-1, 
-        .quadhd_io_num=-1
-    };
-    spi_slave_interface_config_t slvcfg = {
-        .mode=0, 
-        .spics_io_num=SPI_CS_GPIO, 
-        .queue_size=3, 
-        .flags=0
+    // 4. SPI Slave Init + Task (one transaction armed: each exchange gets the newest command of the previous one)
+    spi_bridge_config_t spicfg = {
+        .host=SPI2_HOST,
+        .mosi_gpio=SPI_MOSI_GPIO,
+        .miso_gpio=SPI_MISO_GPIO,
+        .sclk_gpio=SPI_CLK_GPIO,
+        .cs_gpio=SPI_CS_GPIO,
+        .on_frame=on_spi_frame,
+        .task_prio=5,
+        .trans_armed=1,
+#if SPI_DATA_READY
+        .ready_gpio=SPI_READY_GPIO,
+        .ready_keepalive_ms=1000 / TELEMETRY_MIN_HZ
+#else
+        .ready_gpio=-1
+#endif
     };
-    spi_slave_initialize(SPI2_HOST, &buscfg, &slvcfg, SPI_DMA_CH_AUTO);
+    spi_bridge_start(&spicfg);
 
-    // 5. Start Single Task
-    xTaskCreate(spi_slave_task, "spi", 4096, NULL, 5, NULL);
+    // 5. Periodic counter summary (low priority)
+    bridge_stats_set_log_hook(air_log);
+    bridge_stats_start();
 }
\ No newline at end of file
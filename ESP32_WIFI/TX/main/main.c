@@ -4,7 +4,12 @@
 #include "esp_log.h"
 #include "esp_event.h"
 #include "driver/gpio.h"
-#include "driver/spi_slave.h"
+#include "spi_bridge.h"
+#include "bridge_stats.h"
+#include "air_link_esp.h"
+#include "bridge_frames.h"
+#include "omni_wire.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "esp_now.h"
 #include "esp_wifi.h"
@@ -15,7 +20,17 @@
 #include "freertos/queue.h"
 
 #define ESP_CHANNEL 1
-#define SPI_PAYLOAD_SIZE 40 
+
+/* 1 = log every frame (float formatting, for bring-up only). Counters: bridge_stats */
+#define BRIDGE_LOG_FRAMES 0
+
+/* Air link: commands are few and a lost one keeps the robot on the old command, send them twice */
+#define AIR_REPEAT        2     // Copies of every frame
+#define AIR_PARITY_GROUP  0     // One XOR parity frame every N frames (0 = off)
+
+/* Fleet mode (fleet_link.h): 0 = one robot, at peer_mac. N = robots 0..N-1 over broadcast,
+ * every robot bridge with its own FLEET_ROBOT_ID (RX main.c) */
+#define FLEET_ROBOTS      0
 
 // Pin Config
 #define SPI_MOSI_GPIO 8
@@ -28,77 +43,126 @@ static const char *TAG = "RobotBridge";
 /* TARGET: MAC Address of the REMOTE CONTROL ESP32 */
 static uint8_t peer_mac[ESP_NOW_ETH_ALEN] = {0xdc, 0x06, 0x75, 0x67, 0x93, 0x0c}; 
 
-/* Structures */
-typedef struct __attribute__((packed)) {
-    uint32_t header; float vx; float vy; float phi; uint32_t buttons; uint32_t timestamp;
-} RemoteCommand_t;
-
-typedef struct __attribute__((packed)) {
-    uint32_t header; float s1; float s2; float s3; float s4; uint16_t a1; uint16_t a2; uint16_t a3; uint16_t a4; uint32_t flags; uint32_t ts;
-} RobotTelemetry_t;
+/* Structures: RemoteCommand_t / RobotTelemetry_t and the frame header are in COMMON/omni_wire.h */
 
 /* Global Storage */
-static RemoteCommand_t latest_command = {0}; 
-static portMUX_TYPE data_mutex = portMUX_INITIALIZER_UNLOCKED;
 static QueueHandle_t send_queue;
+static air_link_t air;
+static bridge_frames_t bridge;  // Frame path: bridge_frames.c
+
+#if FLEET_ROBOTS
+static const uint8_t broadcast_mac[ESP_NOW_ETH_ALEN] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
+
+/* SPI task (commands, MISO), WiFi task (telemetry) and beacon timer share the fleet state */
+static portMUX_TYPE fleet_mutex = portMUX_INITIALIZER_UNLOCKED;
+static air_link_t fleet_air[FLEET_MAX_ROBOTS];  // One receiver per robot bridge: own sequence numbers
 
-/* SPI Buffers */
-WORD_ALIGNED_ATTR uint8_t spi_tx_buf[SPI_PAYLOAD_SIZE];
-WORD_ALIGNED_ATTR uint8_t spi_rx_buf[SPI_PAYLOAD_SIZE];
+static void fleet_lock(void *ctx){
+    portENTER_CRITICAL(&fleet_mutex);
+}
+
+static void fleet_unlock(void *ctx){
+    portEXIT_CRITICAL(&fleet_mutex);
+}
+#endif
 
 /* Callbacks */
+static void set_miso(const void *data, size_t len, void *ctx){
+    spi_bridge_set_miso(data, len);
+}
+
+/* Newest frame from the air link (duplicates and late frames already dropped) */
+static void air_deliver(const uint8_t *payload, size_t len, void *ctx){
+    /* We are the Robot, so we RECEIVE Commands from the Remote -> next MISO payload */
+    bridge_frames_air(&bridge, payload, len);
+    BRIDGE_STATS_INC(air_frames_in);
+}
+
+#if FLEET_ROBOTS
+/* Telemetry of one robot: waits for the MCU's next exchanges */
+static void fleet_deliver(const uint8_t *payload, size_t len, void *ctx){
+    bridge_frames_fleet_air(&bridge, payload, len);
+    BRIDGE_STATS_INC(air_frames_in);
+}
+
+/* Beacon timer (esp_timer task): the newest command of every robot, then the telemetry slots */
+static void beacon_cb(void *arg){
+    bridge_stats.air_send_err += bridge_frames_timer(&bridge);
+}
+#else
+/* Frames from the MCU go out from send_task, the SPI task re-arms meanwhile */
+static int queue_frame(const uint8_t *frame, size_t len, void *ctx){
+    uint8_t packet[OMNI_WIRE_MAX_FRAME];
+
+    memcpy(packet, frame, len);
+    if(xQueueSend(send_queue, &packet, 0) != pdTRUE) BRIDGE_STATS_INC(queue_drops);
+    return 0;
+}
+#endif
+
+static void air_log(const char *tag){
+    air_link_esp_log(&air, tag);
+#if FLEET_ROBOTS
+    fleet_remote_stats_t s;
+    uint32_t tel = 0;
+    portENTER_CRITICAL(&fleet_mutex);
+    s = bridge.fleet_remote.stats;
+    portEXIT_CRITICAL(&fleet_mutex);
+    for(int i = 0; i < FLEET_MAX_ROBOTS; i++) tel += s.tel_in[i];
+    ESP_LOGI(tag, "FLEET | robots %u beacons %lu | cmd %lu bad %lu | tel %lu replaced %lu bad %lu | senders %u",
+             (unsigned)FLEET_ROBOTS, (unsigned long)s.beacons, (unsigned long)s.cmd_in, (unsigned long)s.cmd_bad,
+             (unsigned long)tel, (unsigned long)s.tel_replaced, (unsigned long)s.tel_bad, (unsigned)bridge.fleet_remote.senders);
+    for(int i = 0; i < bridge.fleet_remote.senders; i++) air_link_esp_log(&fleet_air[i], tag);
+#endif
+}
+
 void recv_cb(const esp_now_recv_info_t *info, const uint8_t *data, int len){
-    /* FIX: Accept 40 bytes (SPI_PAYLOAD_SIZE), even if struct is smaller */
-    if (len == SPI_PAYLOAD_SIZE) { 
-        taskENTER_CRITICAL(&data_mutex);
-        /* We are the Robot, so we RECEIVE Commands from the Remote */
-        memcpy(&latest_command, data, sizeof(RemoteCommand_t));
-        taskEXIT_CRITICAL(&data_mutex);
+    /* Fleet: every robot bridge numbers its frames on its own */
+    air_link_t *link = bridge_frames_receiver(&bridge, info->src_addr);
+    if(link == NULL) return;
+
+    /* Air frames are one length prefixed bridge frame plus the air link header */
+    if (air_link_receive(link, data, len) == AIR_LINK_RX_INVALID) {
+        BRIDGE_STATS_INC(crc_errors);
     }
 }
 
-void send_cb(const uint8_t *mac, esp_now_send_status_t status) {}
+void send_cb(const uint8_t *mac, esp_now_send_status_t status) {
+    if(status == ESP_NOW_SEND_SUCCESS) BRIDGE_STATS_INC(air_frames_out);
+    else BRIDGE_STATS_INC(air_send_fail);
+}
 
 /* Tasks */
-static void spi_slave_task(void *pv){
-    spi_slave_transaction_t t;
-    esp_err_t ret;
-    uint8_t packet[SPI_PAYLOAD_SIZE];
-
-    while(1){
-        /* 1. Prepare MISO (Command to Robot MCU) */
-        memset(spi_tx_buf, 0, SPI_PAYLOAD_SIZE);
-        taskENTER_CRITICAL(&data_mutex);
-        memcpy(spi_tx_buf, &latest_command, sizeof(RemoteCommand_t));
-        taskEXIT_CRITICAL(&data_mutex);
-
-        /* 2. Transaction */
-        memset(&t, 0, sizeof(t));
-        t.length = SPI_PAYLOAD_SIZE * 8;
-        t.tx_buffer = spi_tx_buf;
-        t.rx_buffer = spi_rx_buf;
-        
-        ret = spi_slave_transmit(SPI2_HOST, &t, portMAX_DELAY);
-
-        if(ret == ESP_OK){
-            /* 3. Handle MOSI (Telemetry from Robot MCU) -> Send to Air */
-            memcpy(packet, spi_rx_buf, SPI_PAYLOAD_SIZE);
-            xQueueSend(send_queue, &packet, 0);
-
-        ESP_LOGI(TAG, "SYNC | CMD_VX: %.2f | CMD_VY: %.2f | CMD_PHI: %.2f | TEL_M1: %.2f", 
-                    latest_command.vx, latest_command.vy, latest_command.phi,
-                    ((RobotTelemetry_t*)packet)->s1);
-            
-        }
+/* SPI bridge frame handler: its transaction is armed again when this returns */
+static void on_spi_frame(const uint8_t *frame, size_t len){
+    /* Point to point: the frame is queued for send_task. Fleet: the command waits for the
+     * next beacon and the next waiting telemetry frame becomes the MISO payload. */
+    int air_err = bridge_frames_spi(&bridge, frame, len);
+    if(air_err < 0){
+        BRIDGE_STATS_INC(spi_frames_bad);
+        return;
     }
+    bridge_stats.air_send_err += air_err;
+
+#if BRIDGE_LOG_FRAMES
+    RemoteCommand_t latest_command;
+    spi_bridge_get_miso(&latest_command, sizeof(latest_command));
+    const RobotTelemetry_t *tel = omni_wire_telemetry(frame, len);
+    ESP_LOGI(TAG, "SYNC | CMD_VX: %.2f | CMD_VY: %.2f | CMD_PHI: %.2f | TEL_M1: %.2f", 
+                latest_command.vx, latest_command.vy, latest_command.phi,
+                tel ? tel->speed_m1 : 0.0f);
+#endif
 }
 
+#if !FLEET_ROBOTS
 static void send_task(void *pv){
-    uint8_t packet[SPI_PAYLOAD_SIZE];
+    uint8_t packet[OMNI_WIRE_MAX_FRAME];
     while(xQueueReceive(send_queue, &packet, portMAX_DELAY)){
-        esp_now_send(peer_mac, packet, SPI_PAYLOAD_SIZE);
+        /* Queue items are fixed size, the length prefix says how much of it is the frame */
+        bridge_stats.air_send_err += air_link_send(&air, packet, omni_wire_frame_len(packet, sizeof(packet)));
     }
 }
+#endif
 
 /* Init */
 void app_main(void){
@@ -110,22 +174,50 @@ void app_main(void){
     esp_wifi_set_mode(WIFI_MODE_STA);
     esp_wifi_start();
     
+#if FLEET_ROBOTS
+    /* Beacons go out once: the robot bridges time their slots from its arrival,
+     * a repeated or rebuilt copy would arrive late and shift them */
+    air_link_esp_init(&air, broadcast_mac, 1, 0, air_deliver);
+    const uint8_t *air_peer = broadcast_mac;
+    for(int i = 0; i < FLEET_MAX_ROBOTS; i++) {
+        air_link_esp_init(&fleet_air[i], broadcast_mac, 1, 0, fleet_deliver);
+    }
+    const bridge_frames_config_t bcfg = {.role = BRIDGE_REMOTE, .fleet_robots = FLEET_ROBOTS, .air = &air,
+                                         .fleet_air = fleet_air, .set_miso = set_miso,
+                                         .lock = fleet_lock, .unlock = fleet_unlock};
+#else
+    air_link_esp_init(&air, peer_mac, AIR_REPEAT, AIR_PARITY_GROUP, air_deliver);
+    const uint8_t *air_peer = peer_mac;
+    const bridge_frames_config_t bcfg = {.role = BRIDGE_REMOTE, .air = &air, .set_miso = set_miso, .send = queue_frame};
+#endif
+    bridge_frames_init(&bridge, &bcfg);
     esp_now_init();
     esp_now_register_recv_cb(recv_cb);
     esp_now_register_send_cb(send_cb);
     
     esp_now_peer_info_t peer = {};
-    memcpy(peer.peer_addr, peer_mac, 6);
+    memcpy(peer.peer_addr, air_peer, 6);
     peer.channel = ESP_CHANNEL;
     peer.encrypt = false;
     esp_now_add_peer(&peer);
 
-    send_queue = xQueueCreate(10, SPI_PAYLOAD_SIZE);
-
-    spi_bus_config_t buscfg = {.mosi_io_num=8, .miso_io_num=9, .sclk_io_num=4, .quadwp_io_num=-1, .quadhd_io_num=-1};
-    spi_slave_interface_config_t slvcfg = {.mode=0, .spics_io_num=3, .queue_size=3, .flags=0};
-    spi_slave_initialize(SPI2_HOST, &buscfg, &slvcfg, SPI_DMA_CH_AUTO);
-
-    xTaskCreate(spi_slave_task, "spi", 4096, NULL, 5, NULL);
+    send_queue = xQueueCreate(10, OMNI_WIRE_MAX_FRAME);
+
+    /* One armed transaction: the remote gets the telemetry of its previous exchange. The fleet
+     * remote clocks one exchange per robot back to back, each needs its own. */
+    spi_bridge_config_t spicfg = {.host=SPI2_HOST, .mosi_gpio=SPI_MOSI_GPIO, .miso_gpio=SPI_MISO_GPIO, .sclk_gpio=SPI_CLK_GPIO, .cs_gpio=SPI_CS_GPIO, .on_frame=on_spi_frame, .task_prio=5,
+                                  .trans_armed=FLEET_ROBOTS ? FLEET_ROBOTS : 1, .ready_gpio=-1};
+    spi_bridge_start(&spicfg);
+
+#if FLEET_ROBOTS
+    /* Superframe of the longest beacon (every robot and the all-robots command) */
+    const esp_timer_create_args_t beacon_args = {.callback = beacon_cb, .name = "beacon"};
+    esp_timer_handle_t beacon_timer;
+    esp_timer_create(&beacon_args, &beacon_timer);
+    esp_timer_start_periodic(beacon_timer, bridge_frames_superframe_us(&bridge));
+#else
     xTaskCreate(send_task, "send", 4096, NULL, 5, NULL);
+#endif
+    bridge_stats_set_log_hook(air_log);
+    bridge_stats_start();
 }
\ No newline at end of file
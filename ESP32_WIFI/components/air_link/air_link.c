@@ -0,0 +1,206 @@
+/* AIR LINK (shared by the RX and TX bridges) */
+#include <string.h>
+#include "air_link.h"
+
+#define TYPE(kind, idx, group)  ((kind) | ((idx) << 2) | ((group) ? ((group) - 1) << 5 : 0))
+#define KIND(type)              ((type) & 0x03)
+#define INDEX(type)             (((type) >> 2) & 0x07)
+#define GROUP(type)             (((type) >> 5) ? ((type) >> 5) + 1 : 0)
+
+/* Serial number arithmetic: a is newer than b */
+static inline bool seq_newer(uint16_t a, uint16_t b) {
+    return (int16_t)(a - b) > 0;
+}
+
+static void xor_into(uint8_t *dst, const uint8_t *src, size_t len) {
+    for(size_t i = 0; i < len; i++) dst[i] ^= src[i];
+}
+
+/* XOR of everything but magic/type/seq: tx_us and payload */
+static void acc_frame(uint8_t *acc, const uint8_t *frame, size_t payload_len) {
+    size_t ofs = offsetof(air_link_hdr_t, tx_us);
+    xor_into(acc + ofs, frame + ofs, sizeof(air_link_hdr_t) - ofs + payload_len);
+}
+
+static void deliver(air_link_t *link, const uint8_t *frame, size_t payload_len, uint32_t now) {
+    const air_link_hdr_t *hdr = (const air_link_hdr_t *)frame;
+
+    if(link->rx_started && (uint16_t)(hdr->seq - link->rx_last) > 1) {
+        link->stats.rx_lost += (uint16_t)(hdr->seq - link->rx_last) - 1;
+    }
+    link->rx_started = true;
+    link->rx_last = hdr->seq;
+    link->stats.rx_delivered++;
+
+    link->lat[link->lat_idx++ & (AIR_LINK_LAT_SAMPLES - 1)] = now - hdr->tx_us;
+
+    link->cfg.deliver(frame + sizeof(air_link_hdr_t), payload_len, link->cfg.ctx);
+}
+
+/* --- API --- */
+
+void air_link_init(air_link_t *link, const air_link_config_t *cfg) {
+    memset(link, 0, sizeof(air_link_t));
+    link->cfg = *cfg;
+    if(link->cfg.repeat == 0) link->cfg.repeat = 1;
+    if(link->cfg.repeat > AIR_LINK_MAX_REPEAT) link->cfg.repeat = AIR_LINK_MAX_REPEAT;
+    if(link->cfg.parity_group > AIR_LINK_MAX_GROUP) link->cfg.parity_group = AIR_LINK_MAX_GROUP;
+    if(link->cfg.parity_group == 1) link->cfg.parity_group = 0; /* Same as repeat = 2 */
+}
+
+int air_link_send(air_link_t *link, const uint8_t *payload, size_t payload_len) {
+    uint8_t frame[sizeof(air_link_hdr_t) + AIR_LINK_MAX_PAYLOAD];
+    air_link_hdr_t *hdr = (air_link_hdr_t *)frame;
+    size_t len = AIR_LINK_FRAME_SIZE(payload_len);
+    int errors = 0;
+
+    if(payload_len == 0 || payload_len > AIR_LINK_MAX_PAYLOAD) {
+        link->stats.tx_errors++;
+        return 1;
+    }
+
+    hdr->magic = AIR_LINK_MAGIC;
+    hdr->type = TYPE(AIR_LINK_DATA, link->par_cnt, link->cfg.parity_group);
+    hdr->seq = link->tx_seq++;
+    hdr->tx_us = link->cfg.now_us();
+    memcpy(frame + sizeof(air_link_hdr_t), payload, payload_len);
+
+    link->stats.tx_frames++;
+    for(uint8_t i = 0; i < link->cfg.repeat; i++) {
+        link->stats.tx_copies++;
+        if(link->cfg.send(frame, len, link->cfg.ctx) != 0) errors++;
+    }
+
+    if(link->cfg.parity_group) {
+        air_link_hdr_t *par = (air_link_hdr_t *)link->par_buf;
+        if(link->par_cnt == 0) {
+            memset(link->par_buf, 0, sizeof(link->par_buf));
+            par->seq = hdr->seq;
+            link->par_len = 0;
+        }
+        acc_frame(link->par_buf, frame, payload_len);
+        if(payload_len > link->par_len) link->par_len = (uint8_t)payload_len;
+
+        if(++link->par_cnt == link->cfg.parity_group) {
+            par->magic = AIR_LINK_MAGIC;
+            par->type = TYPE(AIR_LINK_PARITY, 0, link->cfg.parity_group);
+            link->par_cnt = 0;
+            link->stats.tx_parity++;
+            if(link->cfg.send(link->par_buf, AIR_LINK_FRAME_SIZE(link->par_len), link->cfg.ctx) != 0) errors++;
+        }
+    }
+
+    link->stats.tx_errors += errors;
+    return errors;
+}
+
+air_link_rx_t air_link_receive(air_link_t *link, const uint8_t *frame, size_t len) {
+    const air_link_hdr_t *hdr = (const air_link_hdr_t *)frame;
+    uint32_t now = link->cfg.now_us();
+
+    if(len <= sizeof(air_link_hdr_t) || len > AIR_LINK_FRAME_SIZE(AIR_LINK_MAX_PAYLOAD) || hdr->magic != AIR_LINK_MAGIC) {
+        link->stats.rx_invalid++;
+        return AIR_LINK_RX_INVALID;
+    }
+    link->stats.rx_copies++;
+
+    size_t payload_len = len - sizeof(air_link_hdr_t);
+    uint8_t group = GROUP(hdr->type);
+
+    if(KIND(hdr->type) == AIR_LINK_PARITY) {
+        if(group == 0 || hdr->seq != link->grp_base || link->grp_mask == 0) return AIR_LINK_RX_PARITY;
+
+        /* Exactly one frame of the group missing: parity ^ the others = the missing one */
+        uint8_t missing = (uint8_t)~link->grp_mask & (uint8_t)((1U << group) - 1);
+        if(missing == 0 || (missing & (missing - 1))) return AIR_LINK_RX_PARITY;
+
+        uint8_t idx = 0;
+        while(!(missing & (1U << idx))) idx++;
+
+        /* The parity frame is as long as the longest frame of the group: shorter ones were
+         * accumulated zero-padded, so the rebuilt frame is zero-padded the same way */
+        uint8_t rebuilt[sizeof(air_link_hdr_t) + AIR_LINK_MAX_PAYLOAD];
+        memcpy(rebuilt, link->grp_acc, len);
+        acc_frame(rebuilt, frame, payload_len);
+        air_link_hdr_t *rhdr = (air_link_hdr_t *)rebuilt;
+        rhdr->magic = AIR_LINK_MAGIC;
+        rhdr->type = TYPE(AIR_LINK_DATA, idx, group);
+        rhdr->seq = link->grp_base + idx;
+        link->grp_mask |= missing;
+
+        /* Only useful if nothing newer got through in the meantime */
+        if(!link->rx_started || seq_newer(rhdr->seq, link->rx_last)) {
+            link->stats.rx_recovered++;
+            deliver(link, rebuilt, payload_len, now);
+        }
+        return AIR_LINK_RX_PARITY;
+    }
+
+    /* Track the parity group of this frame */
+    if(group) {
+        uint8_t idx = INDEX(hdr->type);
+        uint16_t base = hdr->seq - idx;
+        if(base != link->grp_base || link->grp_mask == 0) {
+            link->grp_base = base;
+            link->grp_mask = 0;
+            memset(link->grp_acc, 0, sizeof(link->grp_acc));
+        }
+        if(!(link->grp_mask & (1U << idx))) {
+            link->grp_mask |= 1U << idx;
+            acc_frame(link->grp_acc, frame, payload_len);
+        }
+    }
+
+    if(link->rx_started && hdr->seq == link->rx_last) {
+        link->stats.rx_duplicates++;
+        return AIR_LINK_RX_DUPLICATE;
+    }
+    if(link->rx_started && !seq_newer(hdr->seq, link->rx_last)) {
+        if((uint16_t)(link->rx_last - hdr->seq) < AIR_LINK_RESYNC_GAP) {
+            link->stats.rx_stale++;
+            return AIR_LINK_RX_STALE;
+        }
+        /* Far behind: the sender restarted, follow it */
+        link->stats.rx_resync++;
+        link->rx_started = false;
+    }
+
+    deliver(link, frame, payload_len, now);
+    return AIR_LINK_RX_DELIVERED;
+}
+
+void air_link_get_stats(const air_link_t *link, air_link_stats_t *out) {
+    memcpy(out, &link->stats, sizeof(air_link_stats_t));
+}
+
+void air_link_get_latency(const air_link_t *link, air_link_latency_t *out) {
+    uint32_t d[AIR_LINK_LAT_SAMPLES];
+    uint32_t n = link->lat_idx < AIR_LINK_LAT_SAMPLES ? link->lat_idx : AIR_LINK_LAT_SAMPLES;
+
+    memset(out, 0, sizeof(air_link_latency_t));
+    out->samples = n;
+    if(n == 0) return;
+
+    /* Relative to the fastest frame: removes the unknown clock offset between the bridges */
+    uint32_t floor_us = link->lat[0];
+    for(uint32_t i = 0; i < n; i++) {
+        d[i] = link->lat[i];
+        if((int32_t)(d[i] - floor_us) < 0) floor_us = d[i];
+    }
+    for(uint32_t i = 0; i < n; i++) d[i] -= floor_us;
+
+    /* Insertion sort, 256 samples at most and only when a report is asked for */
+    for(uint32_t i = 1; i < n; i++) {
+        uint32_t v = d[i];
+        uint32_t j = i;
+        while(j > 0 && d[j - 1] > v) {
+            d[j] = d[j - 1];
+            j--;
+        }
+        d[j] = v;
+    }
+
+    out->p50_us = d[n / 2];
+    out->p99_us = d[(n * 99) / 100];
+    out->max_us = d[n - 1];
+}
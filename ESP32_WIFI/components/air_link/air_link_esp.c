@@ -0,0 +1,39 @@
+/* AIR LINK over ESP-NOW */
+#include "air_link_esp.h"
+#include "esp_now.h"
+#include "esp_timer.h"
+#include "esp_log.h"
+
+static int esp_send(const uint8_t *frame, size_t len, void *ctx) {
+    return esp_now_send((const uint8_t *)ctx, frame, len) == ESP_OK ? 0 : -1;
+}
+
+static uint32_t esp_now_us(void) {
+    return (uint32_t)esp_timer_get_time();
+}
+
+void air_link_esp_init(air_link_t *link, const uint8_t *peer_mac, uint8_t repeat, uint8_t parity_group,
+                       void (*deliver)(const uint8_t *payload, size_t len, void *ctx)) {
+    air_link_config_t cfg = {
+        .repeat = repeat,
+        .parity_group = parity_group,
+        .send = esp_send,
+        .now_us = esp_now_us,
+        .deliver = deliver,
+        .ctx = (void *)peer_mac
+    };
+    air_link_init(link, &cfg);
+}
+
+void air_link_esp_log(const air_link_t *link, const char *tag) {
+    air_link_stats_t s;
+    air_link_latency_t lat;
+    air_link_get_stats(link, &s);
+    air_link_get_latency(link, &lat);
+
+    ESP_LOGI(tag, "AIR | tx %lu x%u par %lu err %lu | rx %lu dup %lu stale %lu recov %lu lost %lu | lat p50 %lu p99 %lu max %lu us",
+             (unsigned long)s.tx_frames, link->cfg.repeat, (unsigned long)s.tx_parity, (unsigned long)s.tx_errors,
+             (unsigned long)s.rx_delivered, (unsigned long)s.rx_duplicates, (unsigned long)s.rx_stale,
+             (unsigned long)s.rx_recovered, (unsigned long)s.rx_lost,
+             (unsigned long)lat.p50_us, (unsigned long)lat.p99_us, (unsigned long)lat.max_us);
+}
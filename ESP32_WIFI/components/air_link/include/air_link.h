@@ -0,0 +1,124 @@
+/* AIR LINK (shared by the RX and TX bridges)
+ *
+ * Reliability layer on top of ESP-NOW for the bridge frames:
+ * - every frame gets a sequence number and the sender timestamp
+ * - the receiver drops duplicates and frames older than the last delivered one
+ *   (only the newest command matters)
+ * - optional k-times repetition and/or XOR parity over groups of frames
+ * - payloads are variable length (up to AIR_LINK_MAX_PAYLOAD), only the bytes
+ *   passed to air_link_send() go on air. A parity frame is as long as the
+ *   longest frame of its group, so a frame rebuilt from it is delivered
+ *   zero-padded to that length (the bridge frames carry their own length).
+ * - delivery latency percentiles for the tail
+ *
+ * The core has no ESP-IDF dependency: the transport and the clock are
+ * callbacks, so it can run on Linux over a lossy UDP loopback as well.
+ * One context sends and one context receives; they don't share state.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#define AIR_LINK_MAGIC          0xA5
+#define AIR_LINK_MAX_PAYLOAD    240     // ESP-NOW frame (250 bytes) minus the header; fleet beacons use it all
+#define AIR_LINK_MAX_REPEAT     4
+#define AIR_LINK_MAX_GROUP      8
+#define AIR_LINK_LAT_SAMPLES    256     // Latency window (power of 2)
+#define AIR_LINK_RESYNC_GAP     256     // A frame this much "older" means the sender restarted
+
+/* air_link_hdr_t.type: kind (bits 0-1), index in the parity group (bits 2-4),
+ * parity group size - 1 (bits 5-7, 0 = no parity) */
+#define AIR_LINK_DATA           0x1
+#define AIR_LINK_PARITY         0x2
+
+typedef struct __attribute__((packed)) {
+    uint8_t magic;      // AIR_LINK_MAGIC
+    uint8_t type;       // See above
+    uint16_t seq;       // Data: frame sequence. Parity: sequence of the first frame of the group
+    uint32_t tx_us;     // Sender time of the first copy (parity: XOR over the group)
+} air_link_hdr_t;
+
+#define AIR_LINK_FRAME_SIZE(payload_len) (sizeof(air_link_hdr_t) + (payload_len))
+
+typedef struct {
+    uint8_t repeat;         // Copies of every frame (1 = no repetition)
+    uint8_t parity_group;   // Send one XOR parity frame every N frames (2..8, 0 = off)
+
+    /* Transport: send one frame, return 0 on success */
+    int (*send)(const uint8_t *frame, size_t len, void *ctx);
+    /* Microsecond clock */
+    uint32_t (*now_us)(void);
+    /* Newest payload, called from the receiving context */
+    void (*deliver)(const uint8_t *payload, size_t len, void *ctx);
+    void *ctx;
+} air_link_config_t;
+
+typedef struct {
+    /* Sender */
+    uint32_t tx_frames;
+    uint32_t tx_copies;
+    uint32_t tx_parity;
+    uint32_t tx_errors;     // Transport refused a copy (or the payload length was invalid)
+
+    /* Receiver */
+    uint32_t rx_copies;
+    uint32_t rx_delivered;
+    uint32_t rx_duplicates;
+    uint32_t rx_stale;      // Older than the last delivered frame
+    uint32_t rx_recovered;  // Rebuilt from a parity frame
+    uint32_t rx_lost;       // Sequence gaps seen at delivery
+    uint32_t rx_invalid;
+    uint32_t rx_resync;     // Sender restarted its sequence
+} air_link_stats_t;
+
+/* Delivery latency of the last AIR_LINK_LAT_SAMPLES frames.
+ * The two bridges don't share a clock, so the values are relative to the
+ * fastest frame of the window (the one-way delay floor). */
+typedef struct {
+    uint32_t samples;
+    uint32_t p50_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} air_link_latency_t;
+
+typedef struct {
+    air_link_config_t cfg;
+    air_link_stats_t stats;
+
+    /* Sender */
+    uint16_t tx_seq;
+    uint8_t par_cnt;
+    uint8_t par_len;        // Longest payload of the current parity group
+    uint8_t par_buf[sizeof(air_link_hdr_t) + AIR_LINK_MAX_PAYLOAD];
+
+    /* Receiver */
+    bool rx_started;
+    uint16_t rx_last;
+    uint16_t grp_base;
+    uint8_t grp_mask;
+    uint8_t grp_acc[sizeof(air_link_hdr_t) + AIR_LINK_MAX_PAYLOAD];
+    uint32_t lat[AIR_LINK_LAT_SAMPLES];
+    uint32_t lat_idx;
+} air_link_t;
+
+typedef enum {
+    AIR_LINK_RX_DELIVERED,
+    AIR_LINK_RX_DUPLICATE,
+    AIR_LINK_RX_STALE,
+    AIR_LINK_RX_PARITY,     // Parity frame consumed (may have delivered a recovered frame)
+    AIR_LINK_RX_INVALID,
+} air_link_rx_t;
+
+void air_link_init(air_link_t *link, const air_link_config_t *cfg);
+
+/* Send a payload of 1..AIR_LINK_MAX_PAYLOAD bytes (repeated / followed by parity as configured).
+ * Returns the number of copies the transport refused. */
+int air_link_send(air_link_t *link, const uint8_t *payload, size_t len);
+
+/* Feed one received frame */
+air_link_rx_t air_link_receive(air_link_t *link, const uint8_t *frame, size_t len);
+
+void air_link_get_stats(const air_link_t *link, air_link_stats_t *out);
+void air_link_get_latency(const air_link_t *link, air_link_latency_t *out);
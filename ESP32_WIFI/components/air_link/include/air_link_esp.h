@@ -0,0 +1,12 @@
+/* AIR LINK over ESP-NOW (bridge side of air_link.h) */
+#pragma once
+
+#include "air_link.h"
+
+/* Set up `link` to send to `peer_mac` with esp_now_send() and the esp_timer clock.
+ * `deliver` gets the newest payload of every frame passed to air_link_receive(). */
+void air_link_esp_init(air_link_t *link, const uint8_t *peer_mac, uint8_t repeat, uint8_t parity_group,
+                       void (*deliver)(const uint8_t *payload, size_t len, void *ctx));
+
+/* Log the link counters and the latency tail (integers only) */
+void air_link_esp_log(const air_link_t *link, const char *tag);
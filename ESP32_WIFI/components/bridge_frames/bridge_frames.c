@@ -0,0 +1,111 @@
+/* BRIDGE FRAMES (frame path of the RX and TX bridges) */
+#include <string.h>
+#include "bridge_frames.h"
+#include "omni_wire.h"
+
+static inline void fleet_lock(bridge_frames_t *b) {
+    if(b->cfg.lock) b->cfg.lock(b->cfg.ctx);
+}
+
+static inline void fleet_unlock(bridge_frames_t *b) {
+    if(b->cfg.unlock) b->cfg.unlock(b->cfg.ctx);
+}
+
+static inline bool is_fleet(const bridge_frames_t *b) {
+    return (b->cfg.role == BRIDGE_REMOTE) ? (b->cfg.fleet_robots != 0) : (b->cfg.fleet_id >= 0);
+}
+
+void bridge_frames_init(bridge_frames_t *b, const bridge_frames_config_t *cfg) {
+    memset(b, 0, sizeof(bridge_frames_t));
+    b->cfg = *cfg;
+
+    if(cfg->role == BRIDGE_REMOTE && cfg->fleet_robots) {
+        const fleet_schedule_t sched = {.slots = cfg->fleet_robots, .slot_us = FLEET_SLOT_US, .guard_us = FLEET_GUARD_US};
+        fleet_remote_init(&b->fleet_remote, &sched);
+    }
+    if(cfg->role == BRIDGE_ROBOT && cfg->fleet_id >= 0) {
+        fleet_robot_init(&b->fleet_robot, (uint8_t)cfg->fleet_id);
+    }
+}
+
+int bridge_frames_spi(bridge_frames_t *b, const uint8_t *frame, size_t len) {
+    /* The master clocks the longest frame of the exchange, only the frame itself goes on */
+    size_t frame_len = omni_wire_frame_len(frame, len);
+    if(frame_len == 0) return -1;
+
+    if(!is_fleet(b)) {
+        if(b->cfg.send) return b->cfg.send(frame, frame_len, b->cfg.ctx);
+        return air_link_send(b->cfg.air, frame, frame_len);
+    }
+
+    if(b->cfg.role == BRIDGE_REMOTE) {
+        /* Command for one robot: goes out with the next beacon. One telemetry frame per
+         * exchange comes back, nothing (an idle bus of zeros) once all were taken. */
+        uint8_t packet[FLEET_SLOT_FRAME_SIZE];
+        size_t tel_len;
+
+        fleet_lock(b);
+        (void)fleet_remote_command(&b->fleet_remote, frame, len);
+        tel_len = fleet_remote_next(&b->fleet_remote, packet);
+        fleet_unlock(b);
+        b->cfg.set_miso(packet, tel_len, b->cfg.ctx);
+    } else {
+        /* Keep the newest, it goes out in our slot */
+        fleet_lock(b);
+        fleet_robot_telemetry(&b->fleet_robot, frame, frame_len);
+        fleet_unlock(b);
+    }
+    return 0;
+}
+
+air_link_t *bridge_frames_receiver(bridge_frames_t *b, const uint8_t *src_addr) {
+    if(b->cfg.role != BRIDGE_REMOTE || !is_fleet(b)) return b->cfg.air;
+
+    fleet_lock(b);
+    int idx = fleet_remote_sender(&b->fleet_remote, src_addr);
+    fleet_unlock(b);
+    return (idx < 0) ? NULL : &b->cfg.fleet_air[idx];
+}
+
+void bridge_frames_air(bridge_frames_t *b, const uint8_t *payload, size_t len) {
+    if(b->cfg.role == BRIDGE_REMOTE || !is_fleet(b)) {
+        /* Becomes the MISO payload of the next armed transaction, no SPI task involved */
+        b->cfg.set_miso(payload, len, b->cfg.ctx);
+        return;
+    }
+
+    /* Beacon: our command, and our slot counted from now */
+    fleet_beacon_rx_t rx;
+    fleet_lock(b);
+    bool beacon = fleet_robot_beacon(&b->fleet_robot, payload, len, &rx);
+    fleet_unlock(b);
+    if(!beacon) return;
+
+    if(rx.has_cmd) b->cfg.set_miso(&rx.cmd, sizeof(rx.cmd), b->cfg.ctx);
+    if(rx.has_slot && b->cfg.start_slot) b->cfg.start_slot(rx.slot_in_us, b->cfg.ctx);
+}
+
+void bridge_frames_fleet_air(bridge_frames_t *b, const uint8_t *payload, size_t len) {
+    /* Telemetry of one robot: waits for the MCU's next exchanges */
+    fleet_lock(b);
+    fleet_remote_telemetry(&b->fleet_remote, payload, len);
+    fleet_unlock(b);
+}
+
+int bridge_frames_timer(bridge_frames_t *b) {
+    uint8_t out[FLEET_BEACON_MAX];
+    size_t len;
+
+    if(!is_fleet(b)) return 0;
+
+    fleet_lock(b);
+    if(b->cfg.role == BRIDGE_REMOTE) len = fleet_remote_beacon(&b->fleet_remote, out);
+    else len = fleet_robot_slot(&b->fleet_robot, out);
+    fleet_unlock(b);
+
+    return len ? air_link_send(b->cfg.air, out, len) : 0;
+}
+
+uint32_t bridge_frames_superframe_us(const bridge_frames_t *b) {
+    return fleet_superframe_us(&b->fleet_remote.sched, b->fleet_remote.sched.slots + 1);
+}
@@ -0,0 +1,77 @@
+/* BRIDGE FRAMES (frame path of the RX and TX bridges)
+ *
+ * What a bridge does with a frame, in both directions and in both modes:
+ *
+ *   remote bridge:  SPI frame (command) -> air link, or the fleet's newest command per robot
+ *                   air payload (telemetry) -> next MISO payload, or the fleet's telemetry queue
+ *                   beacon timer -> beacon on air
+ *   robot bridge:   SPI frame (telemetry) -> air link, or kept for our slot
+ *                   air payload (command, or beacon) -> next MISO payload (and our slot timer)
+ *                   slot timer -> slot frame on air
+ *
+ * Like air_link.c and fleet_link.c no ESP-IDF dependency: the SPI slave,
+ * ESP-NOW, the timers and the locking are callbacks or stay in the bridges'
+ * main.c, so the twin (HOST_SIM) runs the same frame path.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "air_link.h"
+#include "fleet_link.h"
+
+typedef enum {
+    BRIDGE_REMOTE,          // TX: SPI slave of the remote MCU
+    BRIDGE_ROBOT,           // RX: SPI slave of a robot MCU
+} bridge_role_t;
+
+typedef struct {
+    bridge_role_t role;
+    uint8_t fleet_robots;   // Remote bridge: robots 0..N-1 in the fleet, 0 = point to point
+    int fleet_id;           // Robot bridge: our robot id in the fleet, -1 = point to point
+
+    air_link_t *air;        // Our frames out; frames in except on a fleet remote bridge
+    air_link_t *fleet_air;  // Fleet remote bridge: FLEET_MAX_ROBOTS receivers, one per robot bridge
+
+    /* Next MISO payload for the MCU (spi_bridge_set_miso) */
+    void (*set_miso)(const void *data, size_t len, void *ctx);
+    /* Point to point remote bridge: hands an MCU frame to the sending task, returns
+     * the copies refused. NULL = air_link_send() from the SPI task. */
+    int (*send)(const uint8_t *frame, size_t len, void *ctx);
+    /* Fleet robot bridge: (re)start the one-shot slot timer */
+    void (*start_slot)(uint32_t in_us, void *ctx);
+    /* Fleet: the SPI task, the WiFi task and the timer share the fleet state. NULL = one context */
+    void (*lock)(void *ctx);
+    void (*unlock)(void *ctx);
+    void *ctx;
+} bridge_frames_config_t;
+
+typedef struct {
+    bridge_frames_config_t cfg;
+    fleet_remote_t fleet_remote;
+    fleet_robot_t fleet_robot;
+} bridge_frames_t;
+
+/* The air links are initialised by the caller (transport, repeat, parity) */
+void bridge_frames_init(bridge_frames_t *b, const bridge_frames_config_t *cfg);
+
+/* Frame from the MCU, `len` as clocked. Returns the air link copies refused,
+ * -1 if it doesn't hold a bridge frame. */
+int bridge_frames_spi(bridge_frames_t *b, const uint8_t *frame, size_t len);
+
+/* Receiver for a frame from `src_addr` (FLEET_ADDR_LEN bytes): every robot bridge
+ * numbers its frames on its own. NULL once the fleet has FLEET_MAX_ROBOTS senders. */
+air_link_t *bridge_frames_receiver(bridge_frames_t *b, const uint8_t *src_addr);
+
+/* Newest payload of `air` (its deliver callback) */
+void bridge_frames_air(bridge_frames_t *b, const uint8_t *payload, size_t len);
+
+/* Newest payload of one of `fleet_air` (their deliver callback) */
+void bridge_frames_fleet_air(bridge_frames_t *b, const uint8_t *payload, size_t len);
+
+/* Fleet timer fired: the beacon (remote bridge) or our slot frame (robot bridge) goes
+ * out. Returns the air link copies refused. */
+int bridge_frames_timer(bridge_frames_t *b);
+
+/* Fleet remote bridge: beacon period, for the longest beacon (every robot and the all-robots command) */
+uint32_t bridge_frames_superframe_us(const bridge_frames_t *b);
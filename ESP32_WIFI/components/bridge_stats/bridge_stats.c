@@ -0,0 +1,87 @@
+/* BRIDGE STATS (shared by the RX and TX bridges) */
+#include <string.h>
+#include <stdbool.h>
+#include "bridge_stats.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+bridge_stats_t bridge_stats = {.gap_min_us = UINT32_MAX};
+
+static int64_t last_frame_us = 0;
+static int64_t last_log_us = 0;
+static volatile bool gap_reset = false;  // Set by the reader, applied by the SPI task
+
+static bridge_stats_t prev;
+static void (*log_hook)(const char *tag) = NULL;
+
+void bridge_stats_set_log_hook(void (*hook)(const char *tag)) {
+    log_hook = hook;
+}
+
+void bridge_stats_spi_frame(void) {
+    int64_t now = esp_timer_get_time();
+
+    bridge_stats.spi_frames_in++;
+
+    if(gap_reset) {
+        bridge_stats.gap_min_us = UINT32_MAX;
+        bridge_stats.gap_max_us = 0;
+        gap_reset = false;
+    }
+    else if(last_frame_us) {
+        uint32_t gap = (uint32_t)(now - last_frame_us);
+        if(gap < bridge_stats.gap_min_us) bridge_stats.gap_min_us = gap;
+        if(gap > bridge_stats.gap_max_us) bridge_stats.gap_max_us = gap;
+    }
+    last_frame_us = now;
+}
+
+void bridge_stats_snapshot(bridge_stats_t *out) {
+    memcpy(out, (const void *)&bridge_stats, sizeof(bridge_stats_t));
+}
+
+bool bridge_stats_log(const char *tag) {
+    int64_t now = esp_timer_get_time();
+    if(last_log_us && now - last_log_us < BRIDGE_STATS_MIN_LOG_MS * 1000LL) return false;
+
+    bridge_stats_t s;
+    bridge_stats_snapshot(&s);
+    uint32_t dt_ms = last_log_us ? (uint32_t)((now - last_log_us) / 1000) : 0;
+    last_log_us = now;
+
+    uint32_t spi_rate = dt_ms ? (s.spi_frames_in - prev.spi_frames_in) * 1000U / dt_ms : 0;
+
+    /* Integers only: no float formatting on the bridges */
+    ESP_LOGI(tag, "STATS | SPI in %lu (%lu/s) bad %lu retry %lu gap %lu..%lu us | AIR in %lu out %lu fail %lu err %lu | drop %lu crc %lu",
+             (unsigned long)s.spi_frames_in, (unsigned long)spi_rate, (unsigned long)s.spi_frames_bad,
+             (unsigned long)s.spi_ready_retry,
+             (unsigned long)(s.gap_min_us == UINT32_MAX ? 0 : s.gap_min_us), (unsigned long)s.gap_max_us,
+             (unsigned long)s.air_frames_in, (unsigned long)s.air_frames_out,
+             (unsigned long)s.air_send_fail, (unsigned long)s.air_send_err,
+             (unsigned long)s.queue_drops, (unsigned long)s.crc_errors);
+
+    if(log_hook) log_hook(tag);
+
+    prev = s;
+    gap_reset = true;
+    return true;
+}
+
+#if BRIDGE_STATS_LOG_PERIOD_MS
+static void stats_task(void *pv) {
+    while(1) {
+        vTaskDelay(pdMS_TO_TICKS(BRIDGE_STATS_LOG_PERIOD_MS));
+        bridge_stats_log("BridgeStats");
+    }
+}
+#endif
+
+esp_err_t bridge_stats_start(void) {
+#if BRIDGE_STATS_LOG_PERIOD_MS
+    /* Lowest priority: never competes with the SPI and ESP-NOW work */
+    if(xTaskCreate(stats_task, "stats", 3072, NULL, 1, NULL) != pdPASS) return ESP_ERR_NO_MEM;
+#endif
+    return ESP_OK;
+}
@@ -0,0 +1,62 @@
+/* BRIDGE STATS (shared by the RX and TX bridges)
+ *
+ * Plain binary counters instead of per-packet logging. Every counter has a
+ * single writer context (SPI task, WiFi task, ...), so updates are ordinary
+ * increments: no locks and no atomics (the ESP32-C3 has no atomic
+ * instructions). Readers take a snapshot, which may mix values of
+ * neighbouring frames but never blocks a writer.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/* Period of the summary line in ms, 0 = only on demand (bridge_stats_log()) */
+#ifndef BRIDGE_STATS_LOG_PERIOD_MS
+#define BRIDGE_STATS_LOG_PERIOD_MS 5000
+#endif
+
+/* Minimum time between two summaries, also for on-demand dumps */
+#define BRIDGE_STATS_MIN_LOG_MS 1000
+
+typedef struct {
+    /* Writer: SPI task */
+    volatile uint32_t spi_frames_in;    // MOSI frames from the MCU
+    volatile uint32_t spi_frames_bad;   // MOSI frames without a valid length prefix (not forwarded)
+    volatile uint32_t spi_ready_retry;  // Data-ready raised again, the master missed the edge
+    volatile uint32_t queue_drops;      // Frames dropped because a queue was full
+    volatile uint32_t gap_min_us;       // Min/max time between SPI frames since the last summary
+    volatile uint32_t gap_max_us;
+
+    /* Writer: the task calling esp_now_send() (SPI task on RX, send task on TX,
+     * esp_timer task for both in fleet mode) */
+    volatile uint32_t air_send_err;     // esp_now_send() refused the frame
+
+    /* Writer: WiFi task (ESP-NOW callbacks) */
+    volatile uint32_t air_frames_in;    // ESP-NOW frames accepted
+    volatile uint32_t air_frames_out;   // ESP-NOW frames acknowledged by the peer
+    volatile uint32_t air_send_fail;    // ESP-NOW frames not acknowledged
+    volatile uint32_t crc_errors;       // ESP-NOW frames rejected (bad length/CRC)
+} bridge_stats_t;
+
+extern bridge_stats_t bridge_stats;
+
+/* Count a counter owned by the calling context */
+#define BRIDGE_STATS_INC(field) (bridge_stats.field++)
+
+/* Start the summary task (only if BRIDGE_STATS_LOG_PERIOD_MS != 0) */
+esp_err_t bridge_stats_start(void);
+
+/* Record an SPI frame: frame counter and inter-frame gap (SPI task only) */
+void bridge_stats_spi_frame(void);
+
+/* Copy the counters */
+void bridge_stats_snapshot(bridge_stats_t *out);
+
+/* Extra summary printed after the counters (e.g. air link latency) */
+void bridge_stats_set_log_hook(void (*hook)(const char *tag));
+
+/* Log a one-line summary, rate-limited to BRIDGE_STATS_MIN_LOG_MS.
+ * Returns false if it was skipped. */
+bool bridge_stats_log(const char *tag);
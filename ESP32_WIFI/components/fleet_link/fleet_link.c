@@ -0,0 +1,194 @@
+/* FLEET LINK (remote bridge and robot bridges in fleet mode) */
+#include <string.h>
+#include "fleet_link.h"
+#include "air_link.h"
+
+#define ALL_SLOT    FLEET_MAX_ROBOTS    // cmd[] entry of OMNI_WIRE_ROBOT_ALL
+
+_Static_assert(FLEET_BEACON_MAX <= AIR_LINK_MAX_PAYLOAD, "A full beacon must fit one air_link frame");
+_Static_assert(FLEET_BEACON_MAX <= 0xFF, "Beacon length is the header's length byte");
+_Static_assert(FLEET_MAX_ROBOTS <= 32, "One bit per robot in tel_pending");
+_Static_assert(FLEET_SLOT_FRAME_SIZE <= OMNI_WIRE_FLEET_EXCHANGE_SIZE, "A tagged telemetry frame must fit the remote's exchange");
+
+/* m/s or rad/s -> thousandths, saturated */
+static int16_t to_milli(float v) {
+    float m = v * 1000.0f;
+    if(m > 32767.0f) return 32767;
+    if(m < -32767.0f) return -32767;
+    return (int16_t)((m < 0.0f) ? m - 0.5f : m + 0.5f);
+}
+
+uint32_t fleet_superframe_us(const fleet_schedule_t *sched, uint8_t entries) {
+    return FLEET_AIRTIME_US(FLEET_BEACON_SIZE(entries)) + sched->guard_us + (uint32_t)sched->slots * sched->slot_us;
+}
+
+/* --- Remote bridge --- */
+
+void fleet_remote_init(fleet_remote_t *fr, const fleet_schedule_t *sched) {
+    memset(fr, 0, sizeof(fleet_remote_t));
+    fr->sched = *sched;
+    if(fr->sched.slots == 0) fr->sched.slots = 1;
+    if(fr->sched.slots > FLEET_MAX_ROBOTS) fr->sched.slots = FLEET_MAX_ROBOTS;
+    memset(fr->cmd_age, FLEET_CMD_MAX_AGE, sizeof(fr->cmd_age));
+}
+
+bool fleet_remote_command(fleet_remote_t *fr, const uint8_t *frame, size_t len) {
+    const RemoteCommand_t *cmd = omni_wire_command(frame, len);
+    uint8_t id = omni_wire_fleet_id(frame, len);
+    uint32_t slot;
+
+    if(cmd == NULL) {
+        fr->stats.cmd_bad++;
+        return false;
+    }
+    if(id == OMNI_WIRE_ROBOT_ALL) slot = ALL_SLOT;
+    else if(id < FLEET_MAX_ROBOTS) slot = id;
+    else return false;  /* OMNI_WIRE_ROBOT_NONE or no tag: the MCU only polls for telemetry */
+
+    fleet_cmd_t *e = &fr->cmd[slot];
+    e->robot_id = id;
+    e->count = OMNI_WIRE_HEADER_COUNT(cmd->header);
+    e->vx_mm_s = to_milli(cmd->vx);
+    e->vy_mm_s = to_milli(cmd->vy);
+    e->phi_mrad_s = to_milli(cmd->phi);
+    e->timestamp = cmd->timestamp;
+    fr->cmd_age[slot] = 0;
+    fr->stats.cmd_in++;
+    return true;
+}
+
+size_t fleet_remote_beacon(fleet_remote_t *fr, uint8_t *out) {
+    fleet_beacon_t *b = (fleet_beacon_t *)out;
+    fleet_cmd_t *e = (fleet_cmd_t *)(out + sizeof(fleet_beacon_t));
+    uint8_t entries = 0;
+
+    for(uint32_t i = 0; i <= FLEET_MAX_ROBOTS; i++) {
+        if(fr->cmd_age[i] >= FLEET_CMD_MAX_AGE) continue;
+        fr->cmd_age[i]++;
+        memcpy(&e[entries++], &fr->cmd[i], sizeof(fleet_cmd_t));
+    }
+
+    size_t len = FLEET_BEACON_SIZE(entries);
+    b->header = OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_FLEET, fr->beacon_count++, len);
+    b->slots = fr->sched.slots;
+    b->entries = entries;
+    b->slot_us = fr->sched.slot_us;
+    b->guard_us = fr->sched.guard_us;
+    b->reserved = 0;
+    fr->stats.beacons++;
+    return len;
+}
+
+int fleet_remote_sender(fleet_remote_t *fr, const uint8_t *addr) {
+    for(int i = 0; i < fr->senders; i++) {
+        if(memcmp(fr->sender[i], addr, FLEET_ADDR_LEN) == 0) return i;
+    }
+    if(fr->senders == FLEET_MAX_ROBOTS) {
+        fr->stats.senders_full++;
+        return -1;
+    }
+    memcpy(fr->sender[fr->senders], addr, FLEET_ADDR_LEN);
+    return fr->senders++;
+}
+
+void fleet_remote_telemetry(fleet_remote_t *fr, const uint8_t *payload, size_t len) {
+    const RobotTelemetry_t *tel = omni_wire_telemetry(payload, len);
+    uint8_t id = omni_wire_fleet_id(payload, len);
+
+    if(tel == NULL || id >= FLEET_MAX_ROBOTS) {
+        fr->stats.tel_bad++;
+        return;
+    }
+
+    memcpy(&fr->tel[id], tel, sizeof(RobotTelemetry_t));
+    fr->stats.tel_in[id]++;
+
+    /* Already waiting: the newer frame takes its place in the order */
+    if(fr->tel_pending & (1UL << id)) {
+        fr->stats.tel_replaced++;
+        return;
+    }
+    fr->tel_order[(fr->tel_head + fr->tel_count) % FLEET_MAX_ROBOTS] = id;
+    fr->tel_count++;
+    fr->tel_pending |= 1UL << id;
+}
+
+size_t fleet_remote_next(fleet_remote_t *fr, uint8_t *out) {
+    if(fr->tel_count == 0) return 0;
+
+    uint8_t id = fr->tel_order[fr->tel_head];
+    fr->tel_head = (fr->tel_head + 1) % FLEET_MAX_ROBOTS;
+    fr->tel_count--;
+    fr->tel_pending &= ~(1UL << id);
+    memcpy(out, &fr->tel[id], sizeof(RobotTelemetry_t));
+    return omni_wire_set_fleet_id(out, id);
+}
+
+/* --- Robot bridge --- */
+
+void fleet_robot_init(fleet_robot_t *fr, uint8_t id) {
+    memset(fr, 0, sizeof(fleet_robot_t));
+    fr->id = id;
+}
+
+bool fleet_robot_beacon(fleet_robot_t *fr, const uint8_t *payload, size_t len, fleet_beacon_rx_t *out) {
+    const fleet_beacon_t *b = (const fleet_beacon_t *)payload;
+
+    memset(out, 0, sizeof(fleet_beacon_rx_t));
+    if(len < sizeof(fleet_beacon_t) || OMNI_WIRE_HEADER_TYPE(b->header) != OMNI_WIRE_TYPE_FLEET) return false;
+    if(OMNI_WIRE_HEADER_LEN(b->header) != FLEET_BEACON_SIZE(b->entries) || FLEET_BEACON_SIZE(b->entries) > len) return false;
+
+    uint16_t count = OMNI_WIRE_HEADER_COUNT(b->header);
+    if(fr->beacon_seen && (uint16_t)(count - fr->beacon_count) > 1) {
+        fr->stats.beacons_lost += (uint16_t)(count - fr->beacon_count) - 1;
+    }
+    fr->beacon_seen = true;
+    fr->beacon_count = count;
+    fr->stats.beacons++;
+
+    /* Our own entry wins over the one for everybody */
+    const fleet_cmd_t *e = (const fleet_cmd_t *)(payload + sizeof(fleet_beacon_t));
+    const fleet_cmd_t *mine = NULL;
+    for(uint32_t i = 0; i < b->entries; i++) {
+        if(e[i].robot_id == fr->id) mine = &e[i];
+        else if(e[i].robot_id == OMNI_WIRE_ROBOT_ALL && mine == NULL) mine = &e[i];
+    }
+    if(mine != NULL) {
+        RemoteCommand_t *cmd = &out->cmd;
+        cmd->header = OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_COMMAND, mine->count, sizeof(RemoteCommand_t));
+        cmd->vx = mine->vx_mm_s / 1000.0f;
+        cmd->vy = mine->vy_mm_s / 1000.0f;
+        cmd->phi = mine->phi_mrad_s / 1000.0f;
+        cmd->buttons = 0;
+        cmd->timestamp = mine->timestamp;
+        out->has_cmd = true;
+        fr->stats.commands++;
+    }
+
+    if(fr->id < b->slots) {
+        out->has_slot = true;
+        out->slot_in_us = b->guard_us + (uint32_t)fr->id * b->slot_us;
+    } else {
+        fr->stats.no_slot++;
+    }
+    return true;
+}
+
+void fleet_robot_telemetry(fleet_robot_t *fr, const uint8_t *frame, size_t len) {
+    const RobotTelemetry_t *tel = omni_wire_telemetry(frame, len);
+    if(tel == NULL) return;
+
+    memcpy(&fr->tel, tel, sizeof(RobotTelemetry_t));
+    fr->tel_fresh = true;
+}
+
+size_t fleet_robot_slot(fleet_robot_t *fr, uint8_t *out) {
+    if(!fr->tel_fresh) {
+        fr->stats.slots_empty++;
+        return 0;
+    }
+    fr->tel_fresh = false;
+    fr->stats.slots++;
+    memcpy(out, &fr->tel, sizeof(RobotTelemetry_t));
+    return omni_wire_set_fleet_id(out, fr->id);
+}
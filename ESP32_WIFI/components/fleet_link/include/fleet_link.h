@@ -0,0 +1,180 @@
+/* FLEET LINK (one remote driving up to FLEET_MAX_ROBOTS rovers)
+ *
+ * Fleet mode replaces the fixed peer of each bridge with ESP-NOW broadcast:
+ *
+ *   remote bridge --beacon-->            every robot bridge
+ *                 <--telemetry, slot k-- robot bridge k
+ *
+ * The remote MCU addresses every command with the fleet tag behind it
+ * (FleetTag_t, omni_wire.h). The remote bridge keeps the newest one per robot and broadcasts all of them in
+ * one beacon per superframe. Each robot bridge takes its own entry (or the
+ * OMNI_WIRE_ROBOT_ALL one) as the next MISO payload and sends the newest
+ * telemetry of its robot in its own slot, timed from the beacon's arrival:
+ *
+ *   | beacon | guard | slot 0 | slot 1 | ... | slot N-1 | beacon | ...
+ *
+ * Broadcasts are not retried and carrier sense only spreads simultaneous
+ * senders out, so N bridges sending whenever their robot clocks a frame
+ * would queue behind each other on the channel; in their slots they never
+ * overlap. Every robot gets one telemetry frame per superframe out, whose
+ * length grows with N: airtime of the beacon + guard + N slots.
+ *
+ * The remote bridge hands the telemetry on to its MCU one frame per SPI
+ * exchange, the newest of every robot, robots in arrival order. The robot
+ * bridge tags its slot frames with the robot id, the remote bridge passes
+ * the tag on and the remote aggregates the fleet from it. The frames
+ * themselves stay the classic ones: the robots never see an id.
+ *
+ * Like air_link.c no ESP-IDF dependency: timers, the radio and locking stay
+ * in the bridges' main.c, so the twin (HOST_SIM) runs the same code.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "omni_wire.h"
+
+#define FLEET_MAX_ROBOTS        16
+#define FLEET_ADDR_LEN          6       // Link-layer address of a sender (ESP_NOW_ETH_ALEN)
+#define FLEET_CMD_MAX_AGE       8       // Beacons a command is repeated in without an update from the MCU
+
+/* Schedule defaults, sized for the ESP-NOW default rate (1 Mbps):
+ * a telemetry frame is on air for FLEET_AIRTIME_US(40) = 920 us */
+#define FLEET_SLOT_US           1200
+#define FLEET_GUARD_US          1000    // Beacon decoded and the slot timer started (esp_timer latency)
+
+/* Air time of an air_link frame with `payload_len` bytes at 1 Mbps: long preamble
+ * (192 us) + 802.11 header, ESP-NOW action frame and FCS (43 bytes) + air_link header */
+#define FLEET_AIRTIME_US(payload_len)   (192U + (43U + 8U + (uint32_t)(payload_len)) * 8U)
+
+/* Beacon (remote bridge -> every robot bridge) */
+typedef struct __attribute__((packed)) {
+    uint32_t header;        // OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_FLEET, superframe counter, length)
+    uint8_t slots;          // Telemetry slots after this beacon: robot ids 0..slots-1
+    uint8_t entries;        // fleet_cmd_t that follow
+    uint16_t slot_us;
+    uint16_t guard_us;      // Beacon received -> start of slot 0
+    uint16_t reserved;
+} fleet_beacon_t;
+
+/* One command of a beacon, RemoteCommand_t in fixed point. No buttons: 17
+ * entries of 13 bytes just fit one ESP-NOW frame (none is wired on the remote yet). */
+typedef struct __attribute__((packed)) {
+    uint8_t robot_id;       // Or OMNI_WIRE_ROBOT_ALL
+    uint16_t count;         // Header counter of the MCU's frame (clock sync echo)
+    int16_t vx_mm_s;
+    int16_t vy_mm_s;
+    int16_t phi_mrad_s;
+    uint32_t timestamp;     // RemoteCommand_t.timestamp
+} fleet_cmd_t;
+
+/* Slot frame (robot bridge -> remote bridge), also what the remote MCU gets on MISO:
+ * the robot's telemetry and the fleet tag with its id */
+#define FLEET_SLOT_FRAME_SIZE       (sizeof(RobotTelemetry_t) + sizeof(FleetTag_t))
+
+#define FLEET_BEACON_SIZE(entries)  (sizeof(fleet_beacon_t) + (entries) * sizeof(fleet_cmd_t))
+#define FLEET_BEACON_MAX            FLEET_BEACON_SIZE(FLEET_MAX_ROBOTS + 1)
+
+typedef struct {
+    uint8_t slots;          // Robots in the fleet (1..FLEET_MAX_ROBOTS)
+    uint16_t slot_us;
+    uint16_t guard_us;
+} fleet_schedule_t;
+
+typedef struct {
+    uint32_t beacons;
+    uint32_t cmd_in;        // Commands from the MCU
+    uint32_t cmd_bad;       // MCU frames that were not a command
+    uint32_t tel_in[FLEET_MAX_ROBOTS];
+    uint32_t tel_replaced;  // Newer telemetry of the same robot came before the MCU took it
+    uint32_t tel_bad;
+    uint32_t senders_full;  // Frames from more senders than FLEET_MAX_ROBOTS
+} fleet_remote_stats_t;
+
+/* Remote bridge */
+typedef struct {
+    fleet_schedule_t sched;
+    fleet_remote_stats_t stats;
+    uint16_t beacon_count;
+
+    /* Newest command per robot, [FLEET_MAX_ROBOTS] is the OMNI_WIRE_ROBOT_ALL one */
+    fleet_cmd_t cmd[FLEET_MAX_ROBOTS + 1];
+    uint8_t cmd_age[FLEET_MAX_ROBOTS + 1];  // Beacons sent since the update, FLEET_CMD_MAX_AGE = none
+
+    /* Telemetry for the MCU: newest frame per robot, robot ids in arrival order */
+    RobotTelemetry_t tel[FLEET_MAX_ROBOTS];
+    uint8_t tel_order[FLEET_MAX_ROBOTS];
+    uint32_t tel_pending;   // Bit per robot in tel_order
+    uint8_t tel_head;
+    uint8_t tel_count;
+
+    /* Robot bridges in the order first heard, for one air_link receiver each */
+    uint8_t sender[FLEET_MAX_ROBOTS][FLEET_ADDR_LEN];
+    uint8_t senders;
+} fleet_remote_t;
+
+typedef struct {
+    uint32_t beacons;
+    uint32_t beacons_lost;  // Gaps in the superframe counter
+    uint32_t commands;      // Beacons with an entry for us
+    uint32_t slots;         // Slots we had telemetry for
+    uint32_t slots_empty;   // Slots without new telemetry since the last one
+    uint32_t no_slot;       // Beacons with fewer slots than our id
+} fleet_robot_stats_t;
+
+/* Robot bridge */
+typedef struct {
+    uint8_t id;
+    fleet_robot_stats_t stats;
+    bool beacon_seen;
+    uint16_t beacon_count;
+    RobotTelemetry_t tel;   // Newest from the robot
+    bool tel_fresh;
+} fleet_robot_t;
+
+/* What a beacon means for one robot bridge */
+typedef struct {
+    bool has_cmd;
+    RemoteCommand_t cmd;    // Next MISO payload for the robot
+    bool has_slot;
+    uint32_t slot_in_us;    // From the beacon's arrival to the start of our slot
+} fleet_beacon_rx_t;
+
+/* Superframe length: beacon air time for `entries` commands + guard + all slots */
+uint32_t fleet_superframe_us(const fleet_schedule_t *sched, uint8_t entries);
+
+/* --- Remote bridge --- */
+
+void fleet_remote_init(fleet_remote_t *fr, const fleet_schedule_t *sched);
+
+/* Exchange from the remote MCU (`len` as clocked, the fleet tag follows the frame);
+ * false if it isn't a command for a fleet robot */
+bool fleet_remote_command(fleet_remote_t *fr, const uint8_t *frame, size_t len);
+
+/* Next beacon into `out` (FLEET_BEACON_MAX bytes), returns its length. Commands
+ * not updated for FLEET_CMD_MAX_AGE beacons are left out: their robot keeps
+ * the last one it got, as with a silent remote outside fleet mode. */
+size_t fleet_remote_beacon(fleet_remote_t *fr, uint8_t *out);
+
+/* Receiver index of the sender at `addr`, learnt on first sight; -1 once FLEET_MAX_ROBOTS are known */
+int fleet_remote_sender(fleet_remote_t *fr, const uint8_t *addr);
+
+/* Slot frame delivered by a robot bridge's air_link receiver */
+void fleet_remote_telemetry(fleet_remote_t *fr, const uint8_t *payload, size_t len);
+
+/* Next telemetry frame for the MCU, tagged, into `out` (FLEET_SLOT_FRAME_SIZE), 0 if none is waiting */
+size_t fleet_remote_next(fleet_remote_t *fr, uint8_t *out);
+
+/* --- Robot bridge --- */
+
+void fleet_robot_init(fleet_robot_t *fr, uint8_t id);
+
+/* Payload delivered by the air link; false if it isn't a beacon */
+bool fleet_robot_beacon(fleet_robot_t *fr, const uint8_t *payload, size_t len, fleet_beacon_rx_t *out);
+
+/* Frame from the robot MCU (only telemetry is kept, the newest) */
+void fleet_robot_telemetry(fleet_robot_t *fr, const uint8_t *frame, size_t len);
+
+/* Our slot started: slot frame to send into `out` (FLEET_SLOT_FRAME_SIZE), 0 if nothing new */
+size_t fleet_robot_slot(fleet_robot_t *fr, uint8_t *out);
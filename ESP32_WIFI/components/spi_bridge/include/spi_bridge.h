@@ -0,0 +1,55 @@
+/* SPI BRIDGE (shared by the RX and TX bridges)
+ *
+ * Always-armed SPI slave link to the MCXN947. The driver copies a transaction
+ * when it is queued and the DMA reads the tx_buffer it pointed at then, so
+ * what the master gets on MISO is fixed at arming: every transaction queued
+ * in front of the next one makes that one's payload an exchange older, and a
+ * new payload can't be swapped into a queued one. One transaction is kept
+ * armed and armed again with the latest payload as soon as the last frame is
+ * handled, so the master gets the payload that was the latest at its
+ * previous exchange. A master that clocks exchanges back to back (the fleet
+ * remote, one per robot) needs one armed per exchange of its burst.
+ *
+ * Data-ready mode (ready_gpio >= 0): the master only clocks when told.
+ * One transaction is armed when a new MISO payload lands, or when
+ * ready_keepalive_ms passed without an exchange (so the master's frames
+ * still get out at that minimum rate), and the line goes high; it drops as
+ * soon as the master has clocked it. The master gets every payload in the
+ * exchange right after it lands, with no stale pre-armed ones in front.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "driver/spi_slave.h"
+#include "spi_bridge_miso.h"    // SPI_BRIDGE_PAYLOAD_SIZE, SPI_BRIDGE_TRANS_CNT
+
+/* Called from the SPI task with every frame received on MOSI.
+ * `len` is what the master clocked (it ended the transaction with CS),
+ * the frame is only valid during the call. */
+typedef void (*spi_bridge_frame_cb_t)(const uint8_t *frame, size_t len);
+
+typedef struct {
+    spi_host_device_t host;
+    int mosi_gpio;
+    int miso_gpio;
+    int sclk_gpio;
+    int cs_gpio;
+    spi_bridge_frame_cb_t on_frame;
+    UBaseType_t task_prio;
+    uint8_t trans_armed;            // Transactions kept armed (1..SPI_BRIDGE_TRANS_CNT, 0 = 1)
+    int ready_gpio;                 // Data-ready output to the master, -1 = none (always armed)
+    uint32_t ready_keepalive_ms;    // Data-ready mode: longest time without an exchange
+} spi_bridge_config_t;
+
+/* Initialize the SPI slave, arm all transactions and start the SPI task */
+esp_err_t spi_bridge_start(const spi_bridge_config_t *cfg);
+
+/* Make `data` the MISO payload of the next transactions to be armed.
+ * Safe to call from the ESP-NOW receive callback; it never waits for the SPI task. */
+void spi_bridge_set_miso(const void *data, size_t len);
+
+/* Copy the current MISO payload (e.g. for logging) */
+void spi_bridge_get_miso(void *dst, size_t len);
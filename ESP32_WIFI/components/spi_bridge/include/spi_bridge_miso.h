@@ -0,0 +1,53 @@
+/* SPI BRIDGE MISO PAYLOADS (the buffer pool behind spi_bridge.c)
+ *
+ * MISO payloads live in a small pool of DMA buffers. The writer (the ESP-NOW
+ * callback) copies a new payload into a free buffer and publishes it as the
+ * latest one; arming a transaction only references the latest buffer, so
+ * nothing is copied or cleared per transaction. A buffer stays reserved while
+ * an armed transaction references it and is released with its result.
+ *
+ * Every published payload gets a sequence number: in data-ready mode it tells
+ * whether the master has clocked the newest one.
+ *
+ * No ESP-IDF dependency: the lock is a callback, so the twin (HOST_SIM) arms
+ * its SPI links from the same pool.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Longest transaction the master may clock; it usually clocks less (length prefixed frames) */
+#define SPI_BRIDGE_PAYLOAD_SIZE 40
+
+/* Most transactions kept armed (spi_bridge_config_t.trans_armed): one per
+ * exchange of the fleet remote's burst, FLEET_MAX_ROBOTS */
+#define SPI_BRIDGE_TRANS_CNT    16
+
+/* Every armed transaction may hold one buffer, plus the latest one, the one
+ * being written and one held by spi_bridge_miso_get() */
+#define SPI_BRIDGE_MISO_CNT     (SPI_BRIDGE_TRANS_CNT + 3)
+
+typedef struct {
+    uint8_t buf[SPI_BRIDGE_MISO_CNT][SPI_BRIDGE_PAYLOAD_SIZE] __attribute__((aligned(4)));
+    volatile uint8_t refs[SPI_BRIDGE_MISO_CNT];
+    volatile int latest;
+    volatile uint32_t seq;      // Payloads published so far
+    void (*lock)(void);         // NULL = one context
+    void (*unlock)(void);
+} spi_bridge_miso_t;
+
+/* Zero payload as the latest one */
+void spi_bridge_miso_init(spi_bridge_miso_t *m, void (*lock)(void), void (*unlock)(void));
+
+/* Writer (one context): `data`, zero-padded, becomes the latest payload. Returns its sequence number. */
+uint32_t spi_bridge_miso_set(spi_bridge_miso_t *m, const void *data, size_t len);
+
+/* Arming: references the latest payload, returns its buffer index (m->buf[]) and its sequence number in `seq` */
+int spi_bridge_miso_take(spi_bridge_miso_t *m, uint32_t *seq);
+
+/* The transaction holding buffer `idx` is done */
+void spi_bridge_miso_release(spi_bridge_miso_t *m, int idx);
+
+/* Copy of the latest payload (e.g. for logging) */
+void spi_bridge_miso_get(spi_bridge_miso_t *m, void *dst, size_t len);
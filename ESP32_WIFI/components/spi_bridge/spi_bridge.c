@@ -0,0 +1,177 @@
+/* SPI BRIDGE (shared by the RX and TX bridges)
+ *
+ * MISO payloads come from the pool of spi_bridge_miso.c: arming a transaction
+ * points its tx_buffer at the latest buffer, the task releases it with the
+ * transaction's result. trans_armed transactions are queued at a time (see
+ * spi_bridge.h), the one just done is re-armed after its frame is handled.
+ *
+ * In data-ready mode the task parks with nothing armed once the master has
+ * clocked the newest payload.
+ */
+#include <string.h>
+#include "spi_bridge.h"
+#include "bridge_stats.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "driver/gpio.h"
+#include "hal/gpio_ll.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "SpiBridge";
+
+static spi_bridge_config_t bridge_cfg;
+static portMUX_TYPE miso_mutex = portMUX_INITIALIZER_UNLOCKED;
+
+/* SPI Buffers */
+static spi_bridge_miso_t miso;
+WORD_ALIGNED_ATTR static uint8_t mosi_bufs[SPI_BRIDGE_TRANS_CNT][SPI_BRIDGE_PAYLOAD_SIZE];
+
+static spi_slave_transaction_t trans[SPI_BRIDGE_TRANS_CNT];
+static TaskHandle_t bridge_task = NULL;
+
+/* --- CALLBACKS --- */
+
+/* Register write only: also used from the IRAM post_trans_cb */
+static inline void IRAM_ATTR ready_line(uint32_t level) {
+    gpio_ll_set_level(&GPIO, bridge_cfg.ready_gpio, level);
+}
+
+/* Transaction done (ISR): drop data-ready right away, not when the task gets to the frame */
+static void IRAM_ATTR post_trans_cb(spi_slave_transaction_t *t) {
+    if(bridge_cfg.ready_gpio >= 0) ready_line(0);
+}
+
+/* --- HELPERS --- */
+
+static void miso_lock(void) {
+    portENTER_CRITICAL(&miso_mutex);
+}
+
+static void miso_unlock(void) {
+    portEXIT_CRITICAL(&miso_mutex);
+}
+
+/* Returns the sequence number of the payload it armed */
+static uint32_t arm_transaction(spi_slave_transaction_t *t) {
+    uint32_t seq;
+    int idx = spi_bridge_miso_take(&miso, &seq);
+
+    t->tx_buffer = miso.buf[idx];
+    t->user = (void *)(intptr_t)idx;
+    spi_slave_queue_trans(bridge_cfg.host, t, portMAX_DELAY);
+    return seq;
+}
+
+/* Result of a transaction: its MISO buffer may be reused */
+static void transaction_done(spi_slave_transaction_t *t) {
+    spi_bridge_miso_release(&miso, (int)(intptr_t)t->user);
+    bridge_stats_spi_frame();
+    if(bridge_cfg.on_frame) bridge_cfg.on_frame(t->rx_buffer, t->trans_len / 8);
+}
+
+/* --- MAIN SPI TASK --- */
+static void spi_bridge_task(void *pv) {
+    spi_slave_transaction_t *done;
+
+    ESP_LOGI(TAG, "SPI Slave armed (%u transactions). Waiting for Master...", (unsigned)bridge_cfg.trans_armed);
+
+    while(1) {
+        /* With more than one armed, the others stay armed while this one is handled */
+        if(spi_slave_get_trans_result(bridge_cfg.host, &done, portMAX_DELAY) != ESP_OK) continue;
+
+        transaction_done(done);
+        arm_transaction(done);
+    }
+}
+
+/* --- DATA-READY SPI TASK --- */
+static void spi_bridge_ready_task(void *pv) {
+    spi_slave_transaction_t *done;
+    TickType_t keepalive = pdMS_TO_TICKS(bridge_cfg.ready_keepalive_ms);
+    uint32_t clocked_seq = miso.seq;
+
+    if(keepalive == 0) keepalive = 1;
+    ESP_LOGI(TAG, "SPI Slave in data-ready mode (GPIO %d, keep-alive %lu ms). Waiting for Master...",
+             bridge_cfg.ready_gpio, (unsigned long)bridge_cfg.ready_keepalive_ms);
+
+    while(1) {
+        /* Parked with nothing armed until a new payload lands or the keep-alive is due.
+         * A payload that landed during the last exchange is armed at once (its wake-up is dropped). */
+        if(miso.seq == clocked_seq) ulTaskNotifyTake(pdTRUE, keepalive);
+        else ulTaskNotifyTake(pdTRUE, 0);
+
+        uint32_t armed_seq = arm_transaction(&trans[0]);
+        ready_line(1);
+
+        /* A master that missed the edge (busy, or its interrupt was masked) gets a new one */
+        while(spi_slave_get_trans_result(bridge_cfg.host, &done, keepalive) != ESP_OK) {
+            ready_line(0);
+            ready_line(1);
+            BRIDGE_STATS_INC(spi_ready_retry);
+        }
+
+        clocked_seq = armed_seq;
+        transaction_done(done);
+    }
+}
+
+/* --- API --- */
+
+esp_err_t spi_bridge_start(const spi_bridge_config_t *cfg) {
+    bridge_cfg = *cfg;
+    if(bridge_cfg.trans_armed == 0) bridge_cfg.trans_armed = 1;
+    if(bridge_cfg.trans_armed > SPI_BRIDGE_TRANS_CNT) bridge_cfg.trans_armed = SPI_BRIDGE_TRANS_CNT;
+    spi_bridge_miso_init(&miso, miso_lock, miso_unlock);
+
+    spi_bus_config_t buscfg = {
+        .mosi_io_num = cfg->mosi_gpio,
+        .miso_io_num = cfg->miso_gpio,
+        .sclk_io_num = cfg->sclk_gpio,
+        .quadwp_io_num = -1,
+        .quadhd_io_num = -1
+    };
+    spi_slave_interface_config_t slvcfg = {
+        .mode = 0,
+        .spics_io_num = cfg->cs_gpio,
+        .queue_size = bridge_cfg.trans_armed,
+        .flags = 0,
+        .post_trans_cb = post_trans_cb
+    };
+    esp_err_t ret = spi_slave_initialize(cfg->host, &buscfg, &slvcfg, SPI_DMA_CH_AUTO);
+    if(ret != ESP_OK) return ret;
+
+    bool ready_mode = (cfg->ready_gpio >= 0);
+    if(ready_mode) {
+        gpio_config_t io = {
+            .pin_bit_mask = 1ULL << cfg->ready_gpio,
+            .mode = GPIO_MODE_OUTPUT,
+        };
+        ret = gpio_config(&io);
+        if(ret != ESP_OK) return ret;
+        ready_line(0);
+    }
+
+    for(int i = 0; i < bridge_cfg.trans_armed; i++) {
+        memset(&trans[i], 0, sizeof(trans[i]));
+        trans[i].length = SPI_BRIDGE_PAYLOAD_SIZE * 8; // Bits, upper bound: trans_len has what was clocked
+        trans[i].rx_buffer = mosi_bufs[i];
+        /* Data-ready mode arms one at a time, from its task */
+        if(!ready_mode) arm_transaction(&trans[i]);
+    }
+
+    if(xTaskCreate(ready_mode ? spi_bridge_ready_task : spi_bridge_task, "spi", 4096, NULL,
+                   cfg->task_prio, &bridge_task) != pdPASS) return ESP_ERR_NO_MEM;
+    return ESP_OK;
+}
+
+void spi_bridge_set_miso(const void *data, size_t len) {
+    (void)spi_bridge_miso_set(&miso, data, len);
+
+    /* Data-ready mode: the task arms it (right away if parked) */
+    if(bridge_cfg.ready_gpio >= 0 && bridge_task != NULL) xTaskNotifyGive(bridge_task);
+}
+
+void spi_bridge_get_miso(void *dst, size_t len) {
+    spi_bridge_miso_get(&miso, dst, len);
+}
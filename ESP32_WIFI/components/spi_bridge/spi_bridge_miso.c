@@ -0,0 +1,69 @@
+/* SPI BRIDGE MISO PAYLOADS */
+#include <string.h>
+#include "spi_bridge_miso.h"
+
+static inline void miso_lock(spi_bridge_miso_t *m) {
+    if(m->lock) m->lock();
+}
+
+static inline void miso_unlock(spi_bridge_miso_t *m) {
+    if(m->unlock) m->unlock();
+}
+
+void spi_bridge_miso_init(spi_bridge_miso_t *m, void (*lock)(void), void (*unlock)(void)) {
+    memset(m, 0, sizeof(spi_bridge_miso_t));
+    m->lock = lock;
+    m->unlock = unlock;
+}
+
+uint32_t spi_bridge_miso_set(spi_bridge_miso_t *m, const void *data, size_t len) {
+    if(len > SPI_BRIDGE_PAYLOAD_SIZE) len = SPI_BRIDGE_PAYLOAD_SIZE;
+
+    /* Single writer: a buffer that is neither the latest nor referenced can't be picked by anyone else */
+    int idx = -1;
+    miso_lock(m);
+    for(int i = 0; i < SPI_BRIDGE_MISO_CNT; i++) {
+        if(i != m->latest && m->refs[i] == 0) {
+            idx = i;
+            break;
+        }
+    }
+    uint32_t seq = m->seq;
+    miso_unlock(m);
+    if(idx < 0) return seq; /* Can't happen with SPI_BRIDGE_MISO_CNT buffers */
+
+    memcpy(m->buf[idx], data, len);
+    memset(m->buf[idx] + len, 0, SPI_BRIDGE_PAYLOAD_SIZE - len);
+
+    miso_lock(m);
+    m->latest = idx;
+    seq = ++m->seq;
+    miso_unlock(m);
+    return seq;
+}
+
+int spi_bridge_miso_take(spi_bridge_miso_t *m, uint32_t *seq) {
+    miso_lock(m);
+    int idx = m->latest;
+    *seq = m->seq;
+    m->refs[idx]++;
+    miso_unlock(m);
+    return idx;
+}
+
+void spi_bridge_miso_release(spi_bridge_miso_t *m, int idx) {
+    miso_lock(m);
+    m->refs[idx]--;
+    miso_unlock(m);
+}
+
+void spi_bridge_miso_get(spi_bridge_miso_t *m, void *dst, size_t len) {
+    uint32_t seq;
+
+    if(len > SPI_BRIDGE_PAYLOAD_SIZE) len = SPI_BRIDGE_PAYLOAD_SIZE;
+
+    /* Hold the buffer so the writer doesn't reuse it while it's copied */
+    int idx = spi_bridge_miso_take(m, &seq);
+    memcpy(dst, m->buf[idx], len);
+    spi_bridge_miso_release(m, idx);
+}
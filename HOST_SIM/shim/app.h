@@ -0,0 +1,12 @@
+/* Host build: see mcu_sim.h */
+#ifndef _APP_H_
+#define _APP_H_
+
+#include "mcu_sim.h"
+
+#define DEMO_LPADC_BASE             ADC0
+#define DEMO_LPADC_IRQn             ADC0_IRQn
+#define DEMO_LPADC_IRQ_HANDLER_FUNC ADC0_IRQHandler
+#define DEMO_LPADC_VREF_SOURCE      kLPADC_ReferenceVoltageAlt3
+
+#endif /* _APP_H_ */
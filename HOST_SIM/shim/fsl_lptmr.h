@@ -0,0 +1,2 @@
+/* Host build: see mcu_sim.h */
+#include "mcu_sim.h"
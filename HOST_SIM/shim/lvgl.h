@@ -0,0 +1,18 @@
+/*
+ * Host build: the twin runs the remote with REMOTE_GUI_ON_CORE1=1, so the
+ * command path never calls LVGL. Only the types named by the GUI headers.
+ */
+#ifndef LVGL_H
+#define LVGL_H
+
+#include <stdint.h>
+
+typedef struct _lv_display_t lv_display_t;
+typedef struct {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+} lv_area_t;
+
+#endif /*LVGL_H*/
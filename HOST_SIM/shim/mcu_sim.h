@@ -0,0 +1,488 @@
+/*
+ * mcu_sim.h
+ *
+ * Host (Linux) stand-in for the parts of the MCUXpresso SDK the firmware
+ * sources use, so the real application files compile unchanged with gcc.
+ * Every SDK header the firmware includes (fsl_*.h, board.h, app.h, ...) is a
+ * one-line file in this directory that pulls this one in.
+ *
+ * Peripherals are modelled at the API the application calls, not at the
+ * register level: setup calls compile to nothing, the calls that move data
+ * (PWM duty, enable pins, ADC results, encoder captures, LPTMR periods, the
+ * eDMA transfers of the ESP SPI link) end up in sim/mcu_sim.c and
+ * sim/robot_board.c.
+ */
+
+#ifndef MCU_SIM_H_
+#define MCU_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * omnidriver.c/.h live next to the real SDK headers, and a quoted #include
+ * looks in the including file's directory first. The build force-includes
+ * this header (-include mcu_sim.h) so those copies see their guard already
+ * defined and compile to nothing.
+ */
+#define FSL_COMMON_H_
+#define FSL_COMMON_ARM_H_
+#define _FSL_CLOCK_H_
+#define _FSL_RESET_H_
+#define FSL_CTIMER_H_
+#define FSL_GPIO_H_
+#define FSL_LPADC_H_
+#define FSL_LP_FLEXCOMM_H_
+#define FSL_LPI2C_H_
+#define FSL_LPSPI_H_
+#define FSL_LPSPI_EDMA_H_
+#define FSL_EDMA_H_
+#define FSL_LPTMR_H_
+#define FSL_LPUART_H_
+#define FSL_PORT_H_
+#define FSL_PWM_H_
+#define FSL_SPC_H_
+#define FSL_VREF_H_
+
+/*******************************************************************************
+ * fsl_common.h
+ ******************************************************************************/
+typedef int32_t status_t;
+#define kStatus_Success             0
+#define kStatus_Fail                1
+#define kStatus_InvalidArgument     4
+#define kStatus_Busy                7
+
+#ifndef MIN
+#define MIN(a, b)                   (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)                   (((a) > (b)) ? (a) : (b))
+#endif
+
+#define PRINTF                      printf
+#define PUTCHAR                     putchar
+#define SDK_ISR_EXIT_BARRIER
+#define __DSB()
+#define __ISB()
+#define __DMB()                     __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#define __WFI()                     Sim_Wfi()
+
+typedef enum {
+    LP_FLEXCOMM1_IRQn, FLEXCOMM9_IRQn, ADC0_IRQn, LPTMR0_IRQn, LPTMR1_IRQn,
+} IRQn_Type;
+
+#define EnableIRQ(irq)              ((void)(irq))
+
+/* A node is one thread, its interrupts run from the simulation loop: nothing to mask there.
+ * The CTIMER4 wake match is the exception: it fires while the remote sleeps masked in
+ * us_clock_sleep_until(), and its handler runs once the mask is lifted, as on the board. */
+extern uint32_t g_simPrimask;
+void Sim_IrqUnmasked(void);
+static inline uint32_t DisableGlobalIRQ(void)
+{
+    uint32_t primask = g_simPrimask;
+    g_simPrimask = 1U;
+    return primask;
+}
+static inline void EnableGlobalIRQ(uint32_t primask)
+{
+    g_simPrimask = primask;
+    if (primask == 0U)
+    {
+        Sim_IrqUnmasked();
+    }
+}
+
+extern uint32_t SystemCoreClock;
+
+/* Sleeps (remote main loop) and ends the node when the run is over */
+void SDK_DelayAtLeastUs(uint32_t delayTime_us, uint32_t coreClock_Hz);
+
+/* Sleeps like SDK_DelayAtLeastUs() until the next interrupt the node would wake on:
+ * the CTIMER match of us_clock_sleep_until() or the end of the eDMA transfer in flight */
+void Sim_Wfi(void);
+
+/* core_cm33.h cycle counter (boot profiler): counts the node's clock at SystemCoreClock */
+typedef struct {
+    uint32_t CTRL;
+    uint32_t CYCCNT;
+} DWT_Type;
+typedef struct {
+    uint32_t DEMCR;
+} DCB_Type;
+
+DWT_Type *Sim_Dwt(void);
+extern DCB_Type g_simDcb;
+#define DWT                         (Sim_Dwt())
+#define DCB                         (&g_simDcb)
+#define DWT_CTRL_CYCCNTENA_Msk      0x1U
+#define DCB_DEMCR_TRCENA_Msk        (1UL << 24)
+
+/*******************************************************************************
+ * Peripheral instances (only compared or passed through by the application)
+ ******************************************************************************/
+typedef struct { uint32_t id; } GPIO_Type;
+typedef struct { uint32_t id; } PORT_Type;
+typedef struct { uint32_t id; } PWM_Type;
+typedef struct {
+    uint32_t id;
+    volatile uint32_t STAT;
+    volatile uint32_t GCC[2];
+} ADC_Type;
+typedef struct { uint32_t id; } SPC_Type;
+typedef struct { uint32_t id; } VREF_Type;
+typedef struct {
+    uint32_t id;
+    volatile uint32_t CFGR1;
+    volatile uint32_t FCR;
+    volatile uint32_t IER;
+} LPSPI_Type;
+typedef struct { uint32_t id; } DMA_Type;
+typedef struct { uint32_t id; } LPTMR_Type;
+typedef struct { uint32_t id; } CTIMER_Type;
+typedef struct { uint32_t id; } LPI2C_Type;
+typedef struct { uint32_t id; } LPUART_Type;
+
+typedef struct {
+    volatile uint32_t CPBOOT;
+    volatile uint32_t CPUCTRL;
+    volatile uint32_t PWM1SUBCTL;
+} SYSCON_Type;
+
+typedef struct {
+    volatile uint32_t CTIMER0CAP0;
+    volatile uint32_t CTIMER0CAP1;
+    volatile uint32_t CTIMER0CAP2;
+    volatile uint32_t CTIMER0CAP3;
+} INPUTMUX_Type;
+
+extern GPIO_Type g_simGpio[5];
+extern PWM_Type g_simPwm[2];
+extern ADC_Type g_simAdc[2];
+extern SPC_Type g_simSpc;
+extern VREF_Type g_simVref;
+extern LPSPI_Type g_simLpspi[10];
+extern DMA_Type g_simDma[2];
+extern LPTMR_Type g_simLptmr[2];
+extern CTIMER_Type g_simCtimer[5];
+extern SYSCON_Type g_simSyscon;
+extern INPUTMUX_Type g_simInputmux;
+extern LPUART_Type g_simLpuart4;
+
+#define GPIO0                       (&g_simGpio[0])
+#define GPIO1                       (&g_simGpio[1])
+#define GPIO2                       (&g_simGpio[2])
+#define GPIO3                       (&g_simGpio[3])
+#define GPIO4                       (&g_simGpio[4])
+#define PWM0                        (&g_simPwm[0])
+#define PWM1                        (&g_simPwm[1])
+#define ADC0                        (&g_simAdc[0])
+#define ADC1                        (&g_simAdc[1])
+#define SPC0                        (&g_simSpc)
+#define VREF0                       (&g_simVref)
+#define LPSPI1                      (&g_simLpspi[1])
+#define LPSPI9                      (&g_simLpspi[9])
+#define DMA0                        (&g_simDma[0])
+#define DMA1                        (&g_simDma[1])
+#define LPTMR0                      (&g_simLptmr[0])
+#define LPTMR1                      (&g_simLptmr[1])
+#define CTIMER0                     (&g_simCtimer[0])
+#define CTIMER4                     (&g_simCtimer[4])
+#define SYSCON                      (&g_simSyscon)
+#define INPUTMUX                    (&g_simInputmux)
+#define LPI2C7_BASE                 0x400C7000U
+#define LPUART4                     (&g_simLpuart4)
+
+#define SYSCON_CPBOOT_CPBOOT_MASK           0xFFFFFFFFU
+#define SYSCON_CPUCTRL_PROT(x)              ((uint32_t)(x) << 16)
+#define SYSCON_CPUCTRL_CPU1CLKEN_MASK       0x8U
+#define SYSCON_CPUCTRL_CPU1RSTEN_MASK       0x20U
+#define SYSCON_PWM1SUBCTL_CLK0_EN_MASK      0x1U
+#define SYSCON_PWM1SUBCTL_CLK1_EN_MASK      0x2U
+#define SYSCON_PWM1SUBCTL_CLK2_EN_MASK      0x4U
+#define INPUTMUX_CTIMER0CAP0_INP(x)         ((uint32_t)(x))
+#define INPUTMUX_CTIMER0CAP1_INP(x)         ((uint32_t)(x))
+#define INPUTMUX_CTIMER0CAP2_INP(x)         ((uint32_t)(x))
+#define INPUTMUX_CTIMER0CAP3_INP(x)         ((uint32_t)(x))
+
+/*******************************************************************************
+ * Clocks, power, board (setup only)
+ ******************************************************************************/
+#define CLOCK_EnableClock(...)                      ((void)0)
+#define CLOCK_SetClkDiv(...)                        ((void)0)
+#define CLOCK_AttachClk(...)                        ((void)0)
+#define CLOCK_SetupClockCtrl(...)                   ((void)0)
+#define CLOCK_GetLPFlexCommClkFreq(n)               12000000U
+#define CLOCK_GetCTimerClkFreq(n)                   12000000U
+#define SPC_EnableActiveModeAnalogModules(...)      ((void)0)
+
+typedef struct { uint32_t dummy; } vref_config_t;
+#define VREF_GetDefaultConfig(...)                  ((void)0)
+#define VREF_Init(...)                              ((void)0)
+
+#define BOARD_InitHardware()                        ((void)0)
+#define BOARD_InitBootPins()                        ((void)0)
+#define BOARD_InitBootClocks()                      ((void)0)
+#define BOARD_InitDebugConsole()                    ((void)0)
+#define BOARD_DEBUG_UART_BASEADDR                   ((uintptr_t)LPUART4)
+
+/*******************************************************************************
+ * GPIO / PORT
+ ******************************************************************************/
+typedef enum { kGPIO_DigitalInput, kGPIO_DigitalOutput } gpio_pin_direction_t;
+
+typedef struct {
+    gpio_pin_direction_t pinDirection;
+    uint8_t outputLogic;
+} gpio_pin_config_t;
+
+void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config);
+uint8_t GPIO_PinGetInterruptFlag(GPIO_Type *base, uint32_t pin);
+void GPIO_PinClearInterruptFlag(GPIO_Type *base, uint32_t pin);
+
+/*******************************************************************************
+ * PWM
+ ******************************************************************************/
+typedef enum { kPWM_Module_0, kPWM_Module_1, kPWM_Module_2, kPWM_Module_3 } pwm_submodule_t;
+typedef enum { kPWM_PwmB, kPWM_PwmA, kPWM_PwmX } pwm_channels_t;
+typedef enum {
+    kPWM_SignedCenterAligned, kPWM_CenterAligned, kPWM_SignedEdgeAligned, kPWM_EdgeAligned
+} pwm_mode_t;
+
+void PWM_UpdatePwmDutycycleHighAccuracy(PWM_Type *base, pwm_submodule_t subModule,
+                                        pwm_channels_t pwmSignal, pwm_mode_t currPwmMode,
+                                        uint16_t dutyCycle);
+void PWM_SetPwmLdok(PWM_Type *base, uint8_t subModulesToUpdate, bool value);
+
+/*******************************************************************************
+ * LPADC (remote joysticks)
+ ******************************************************************************/
+typedef enum { kLPADC_PowerLevelAlt1, kLPADC_PowerLevelAlt2, kLPADC_PowerLevelAlt3, kLPADC_PowerLevelAlt4 } lpadc_power_level_mode_t;
+typedef enum { kLPADC_ReferenceVoltageAlt1, kLPADC_ReferenceVoltageAlt2, kLPADC_ReferenceVoltageAlt3 } lpadc_reference_voltage_source_t;
+typedef enum { kLPADC_ConversionAverage1, kLPADC_ConversionAverage128 = 7 } lpadc_conversion_average_mode_t;
+typedef enum {
+    kLPADC_SampleChannelSingleEndSideA, kLPADC_SampleChannelSingleEndSideB
+} lpadc_sample_channel_mode_t;
+#define kLPADC_FIFO0WatermarkInterruptEnable    0x1U
+
+typedef struct {
+    bool enableAnalogPreliminary;
+    lpadc_power_level_mode_t powerLevelMode;
+    lpadc_reference_voltage_source_t referenceVoltageSource;
+    lpadc_conversion_average_mode_t conversionAverageMode;
+} lpadc_config_t;
+
+typedef struct {
+    uint32_t channelNumber;
+    lpadc_sample_channel_mode_t sampleChannelMode;
+    uint32_t chainedNextCommandNumber;
+} lpadc_conv_command_config_t;
+
+typedef struct {
+    uint32_t targetCommandId;
+    bool enableHardwareTrigger;
+} lpadc_conv_trigger_config_t;
+
+typedef struct {
+    uint32_t commandIdSource;
+    uint32_t convValue;
+} lpadc_conv_result_t;
+
+#define LPADC_Init(...)                             ((void)0)
+#define LPADC_DoOffsetCalibration(...)              ((void)0)
+#define LPADC_DoAutoCalibration(...)                ((void)0)
+#define LPADC_EnableInterrupts(...)                 ((void)0)
+/* Calibration in steps: every step is done as soon as it is started */
+#define kLPADC_CalibrationReadyFlag                 (1UL << 10)
+#define ADC_GCC_RDY_MASK                            (1UL << 24)
+void LPADC_EnableOffsetCalibration(ADC_Type *base, bool enable);
+uint32_t LPADC_GetStatusFlags(ADC_Type *base);
+void LPADC_PrepareAutoCalibration(ADC_Type *base);
+status_t LPADC_FinishAutoCalibration(ADC_Type *base);
+void LPADC_GetDefaultConfig(lpadc_config_t *config);
+void LPADC_GetDefaultConvCommandConfig(lpadc_conv_command_config_t *config);
+void LPADC_SetConvCommandConfig(ADC_Type *base, uint32_t commandId, const lpadc_conv_command_config_t *config);
+void LPADC_GetDefaultConvTriggerConfig(lpadc_conv_trigger_config_t *config);
+void LPADC_SetConvTriggerConfig(ADC_Type *base, uint32_t triggerId, const lpadc_conv_trigger_config_t *config);
+void LPADC_DoSoftwareTrigger(ADC_Type *base, uint32_t triggerIdMask);
+bool LPADC_GetConvResult(ADC_Type *base, lpadc_conv_result_t *result, uint8_t index);
+
+/*******************************************************************************
+ * LPSPI (ESP_SPI.c). The FIFOs hold words and TCR writes as on the chip,
+ * Sim_LpspiClock() shifts them (interrupt transport); the eDMA transport
+ * moves whole frames, see below.
+ ******************************************************************************/
+typedef enum { kLPSPI_Pcs0, kLPSPI_Pcs1 } lpspi_which_pcs_t;
+typedef enum { kLPSPI_MasterPcs0, kLPSPI_MasterPcs1 } lpspi_master_pcs_t;
+
+#define kStatus_LPSPI_Busy                  400
+#define kStatus_LPSPI_Error                 401
+#define kLPSPI_RxInterruptEnable            0x2U
+#define kLPSPI_AllInterruptEnable           0x3F03U
+#define kLPSPI_AllStatusFlag                0x3F03U
+#define LPSPI_MASTER_PCS_SHIFT              (4U)
+#define kLPSPI_MasterPcsContinuous          (1U << 20)
+#define LPSPI_CFGR1_NOSTALL_MASK            0x8U
+#define LPSPI_FCR_RXWATER_MASK              0x70000U
+#define LPSPI_FCR_RXWATER(x)                (((uint32_t)(x) << 16) & LPSPI_FCR_RXWATER_MASK)
+
+typedef struct {
+    uint32_t baudRate;
+    lpspi_which_pcs_t whichPcs;
+    uint32_t pcsToSckDelayInNanoSec;
+    uint32_t lastSckToPcsDelayInNanoSec;
+    uint32_t betweenTransferDelayInNanoSec;
+} lpspi_master_config_t;
+
+typedef struct {
+    const uint8_t *txData;
+    uint8_t *rxData;
+    volatile size_t dataSize;
+    uint32_t configFlags;
+} lpspi_transfer_t;
+
+#define LPSPI_MasterGetDefaultConfig(cfg)           ((void)memset((cfg), 0, sizeof(*(cfg))))
+#define LPSPI_MasterInit(base, cfg, clk)            ((void)(cfg), (void)(clk))
+#define LPSPI_GetRxFifoSize(base)                   ((uint8_t)4U)
+#define LPSPI_SetFifoWatermarks(base, tx, rx)       ((void)(tx), (base)->FCR = LPSPI_FCR_RXWATER(rx))
+#define LPSPI_Enable(...)                           ((void)0)
+#define LPSPI_ClearStatusFlags(...)                 ((void)0)
+#define LPSPI_EnableInterrupts(base, mask)          ((base)->IER |= (mask))
+#define LPSPI_DisableInterrupts(base, mask)         ((base)->IER &= ~(uint32_t)(mask))
+#define LPSPI_SelectTransferPCS(...)                ((void)0)
+
+uint32_t LPSPI_GetRxFifoCount(LPSPI_Type *base);
+uint32_t LPSPI_GetTxFifoCount(LPSPI_Type *base);
+void LPSPI_FlushFifo(LPSPI_Type *base, bool flushTxFifo, bool flushRxFifo);
+void LPSPI_SetPCSContinous(LPSPI_Type *base, bool IsContinous);
+void LPSPI_WriteData(LPSPI_Type *base, uint32_t data);
+uint32_t LPSPI_ReadData(LPSPI_Type *base);
+
+/*******************************************************************************
+ * eDMA + fsl_lpspi_edma.h: one transfer in flight per handle, see
+ * LPSPI_MasterTransferEDMA() in mcu_sim.c
+ ******************************************************************************/
+#define FSL_FEATURE_EDMA_HAS_CHANNEL_MUX            (1)
+#define kDma0RequestMuxLpFlexcomm1Rx                71U
+#define kDma0RequestMuxLpFlexcomm1Tx                72U
+
+typedef struct { uint32_t dummy; } edma_config_t;
+typedef struct { DMA_Type *base; uint32_t channel; } edma_handle_t;
+
+#define EDMA_GetDefaultConfig(cfg)                  ((void)(cfg))
+#define EDMA_Init(...)                              ((void)0)
+#define EDMA_SetChannelMux(...)                     ((void)0)
+#define EDMA_CreateHandle(h, dma, ch)               ((void)((h)->base = (dma), (h)->channel = (ch)))
+
+typedef struct _lpspi_master_edma_handle lpspi_master_edma_handle_t;
+typedef void (*lpspi_master_edma_transfer_callback_t)(LPSPI_Type *base, lpspi_master_edma_handle_t *handle,
+                                                      status_t status, void *userData);
+struct _lpspi_master_edma_handle {
+    lpspi_master_edma_transfer_callback_t callback;
+    void *userData;
+    volatile bool busy;
+};
+
+void LPSPI_MasterTransferCreateHandleEDMA(LPSPI_Type *base, lpspi_master_edma_handle_t *handle,
+                                          lpspi_master_edma_transfer_callback_t callback, void *userData,
+                                          edma_handle_t *edmaRxRegToRxDataHandle,
+                                          edma_handle_t *edmaTxDataToTxRegHandle);
+status_t LPSPI_MasterTransferEDMA(LPSPI_Type *base, lpspi_master_edma_handle_t *handle,
+                                  lpspi_transfer_t *transfer);
+
+/*******************************************************************************
+ * LPTMR (TIMER_DRIVER.c)
+ ******************************************************************************/
+typedef struct {
+    uint32_t timerMode;
+    uint32_t pinSelect;
+    uint32_t pinPolarity;
+    bool enableFreeRunning;
+    bool bypassPrescaler;
+    uint32_t prescalerClockSource;
+    uint32_t value;
+} lptmr_config_t;
+
+#define kLPTMR_TimerModeTimeCounter     0U
+#define kLPTMR_PinSelectInput_0         0U
+#define kLPTMR_PinPolarityActiveHigh    0U
+#define kLPTMR_PrescalerClock_0         0U
+#define kLPTMR_Prescale_Glitch_0        0U
+#define kLPTMR_TimerCompareFlag         0x80U
+#define kLPTMR_TimerInterruptEnable     0x40U
+
+#define LPTMR_Init(base, config)                    ((void)(base), (void)(config))
+#define LPTMR_ClearStatusFlags(...)                 ((void)0)
+#define LPTMR_EnableInterrupts(...)                 ((void)0)
+void LPTMR_SetTimerPeriod(LPTMR_Type *base, uint32_t ticks);
+void LPTMR_StartTimer(LPTMR_Type *base);
+
+/*******************************************************************************
+ * CTIMER (CTIMER0 encoder captures, CTIMER4 the microsecond clock of TIMER_DRIVER)
+ ******************************************************************************/
+typedef enum {
+    kCTIMER_Match0Flag = 0x01U, kCTIMER_Match1Flag = 0x02U,
+    kCTIMER_Match2Flag = 0x04U, kCTIMER_Match3Flag = 0x08U,
+    kCTIMER_Capture0Flag = 0x10U, kCTIMER_Capture1Flag = 0x20U,
+    kCTIMER_Capture2Flag = 0x40U, kCTIMER_Capture3Flag = 0x80U,
+} ctimer_interrupt_flag_t;
+typedef enum {
+    kCTIMER_Match0InterruptEnable = 0x001U, kCTIMER_Match1InterruptEnable = 0x008U,
+    kCTIMER_Match2InterruptEnable = 0x040U, kCTIMER_Match3InterruptEnable = 0x200U,
+} ctimer_interrupt_enable_t;
+typedef enum { kCTIMER_Capture_0, kCTIMER_Capture_1, kCTIMER_Capture_2, kCTIMER_Capture_3 } ctimer_capture_channel_t;
+typedef enum { kCTIMER_Capture_RiseEdge = 1, kCTIMER_Capture_FallEdge, kCTIMER_Capture_BothEdge } ctimer_capture_edge_t;
+typedef enum { kCTIMER_SingleCallback, kCTIMER_MultipleCallback } ctimer_callback_type_t;
+typedef enum { kCTIMER_Match_0, kCTIMER_Match_1, kCTIMER_Match_2, kCTIMER_Match_3 } ctimer_match_t;
+typedef enum { kCTIMER_Output_NoAction, kCTIMER_Output_Clear, kCTIMER_Output_Set, kCTIMER_Output_Toggle } ctimer_match_output_control_t;
+typedef void (*ctimer_callback_t)(uint32_t flags);
+typedef struct { uint32_t prescale; } ctimer_config_t;
+typedef struct {
+    uint32_t matchValue;
+    bool enableCounterReset;
+    bool enableCounterStop;
+    ctimer_match_output_control_t outControl;
+    bool outPinInitState;
+    bool enableInterrupt;
+} ctimer_match_config_t;
+
+#define CTIMER_GetDefaultConfig(...)                ((void)0)
+#define CTIMER_Init(base, config)                   ((void)(base), (void)(config))
+#define CTIMER_SetupCapture(...)                    ((void)0)
+#define CTIMER_StartTimer(...)                      ((void)0)
+void CTIMER_RegisterCallBack(CTIMER_Type *base, ctimer_callback_t *cb_func, ctimer_callback_type_t cb_type);
+uint32_t CTIMER_GetCaptureValue(CTIMER_Type *base, ctimer_capture_channel_t capture);
+uint32_t CTIMER_GetTimerCountValue(CTIMER_Type *base);
+void CTIMER_SetupMatch(CTIMER_Type *base, ctimer_match_t matchChannel, const ctimer_match_config_t *config);
+/* Match interrupts are modelled on CTIMER4 only: its MCR interrupt bits and IR flags */
+void CTIMER_EnableInterrupts(CTIMER_Type *base, uint32_t mask);
+void CTIMER_DisableInterrupts(CTIMER_Type *base, uint32_t mask);
+uint32_t CTIMER_GetStatusFlags(CTIMER_Type *base);
+void CTIMER_ClearStatusFlags(CTIMER_Type *base, uint32_t mask);
+/* CTIMER_RegisterCallBack() of CTIMER4 (robot_board.c has the encoder CTIMER) */
+void Sim_UsClockRegisterCallBack(ctimer_callback_t *cb_func, ctimer_callback_type_t cb_type);
+
+/*******************************************************************************
+ * LPI2C (the IMU driver is replaced, see mpu9250_driver.h)
+ ******************************************************************************/
+typedef struct { uint32_t baudRate_Hz; } lpi2c_master_config_t;
+#define LPI2C_MasterGetDefaultConfig(cfg)           ((void)(cfg))
+#define LPI2C_MasterInit(...)                       ((void)0)
+
+/*******************************************************************************
+ * LPUART (debug console input, g_simHooks.console_getchar)
+ ******************************************************************************/
+enum {
+    kLPUART_RxOverrunFlag = 0x80000U,
+    kLPUART_RxDataRegFullFlag = 0x200000U,
+};
+
+uint32_t LPUART_GetStatusFlags(LPUART_Type *base);
+status_t LPUART_ClearStatusFlags(LPUART_Type *base, uint32_t mask);
+uint8_t LPUART_ReadByte(LPUART_Type *base);
+
+#endif /* MCU_SIM_H_ */
@@ -0,0 +1,642 @@
+/*
+ * mcu_sim.c
+ *
+ * SDK stand-ins shared by both boards: peripheral instances, the delay, the
+ * LPSPI eDMA transfer under the real ESP_SPI.c and the remote's joystick
+ * LPADC and the debug console input. The robot's peripherals are in
+ * robot_board.c.
+ */
+
+#include "mcu_sim.h"
+#include "app.h"
+#include "ESP_SPI.h"
+#include "sim_hooks.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define SIM_LPADC_CMD_COUNT     16U
+#define SIM_LPADC_FIFO_SIZE     16U
+#define SIM_WFI_MAX_US          1000U   /* __WFI() with nothing due: the node looks again after this */
+#define SIM_LPSPI_FIFO_SIZE     4U      /* LPSPI_GetRxFifoSize() */
+#define SIM_LPSPI_TCR_CONT      0x100U  /* TX FIFO entries above a byte are TCR writes */
+#define SIM_LPSPI_TCR_END       0x200U
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+uint32_t SystemCoreClock = 150000000U;
+
+GPIO_Type g_simGpio[5];
+PWM_Type g_simPwm[2];
+ADC_Type g_simAdc[2];
+SPC_Type g_simSpc;
+VREF_Type g_simVref;
+LPSPI_Type g_simLpspi[10];
+DMA_Type g_simDma[2];
+LPTMR_Type g_simLptmr[2] = {{0}, {1}};
+CTIMER_Type g_simCtimer[5];
+SYSCON_Type g_simSyscon;
+INPUTMUX_Type g_simInputmux;
+LPUART_Type g_simLpuart4 = {4};
+DCB_Type g_simDcb;
+
+SimHooks_t g_simHooks = {
+    .now_us = Sim_MonotonicUs,
+};
+
+/* LPSPI FIFOs (interrupt transport): TX words and TCR writes, RX words */
+typedef struct {
+    uint16_t tx[SIM_LPSPI_FIFO_SIZE];
+    uint32_t txHead;
+    uint32_t txCount;
+    uint8_t rx[SIM_LPSPI_FIFO_SIZE];
+    uint32_t rxHead;
+    uint32_t rxCount;
+    bool cont;          /* TCR CONT of the words shifted now */
+    bool pcs;           /* PCS asserted */
+    bool inIrq;
+    bool irqWrote;      /* The interrupt running wrote a word */
+    SimLpspiStats_t stats;
+} sim_lpspi_t;
+
+static sim_lpspi_t s_lpspi[10];
+
+/* The LPSPI eDMA transfer in flight, done when the clock reaches s_dmaDoneUs */
+static lpspi_master_edma_handle_t *s_dmaHandle;
+static LPSPI_Type *s_dmaBase;
+static uint64_t s_dmaDoneUs;
+static uint64_t s_dmaChainUs;   /* In a completion callback: a frame started now follows on the wire */
+
+static lpadc_conv_command_config_t s_adcCmd[SIM_LPADC_CMD_COUNT];
+static lpadc_conv_trigger_config_t s_adcTrigger;
+static lpadc_conv_result_t s_adcFifo[SIM_LPADC_FIFO_SIZE];
+static uint32_t s_adcFifoHead;
+static uint32_t s_adcFifoCount;
+
+static int s_uartRx = -1;        /* Byte in the data register, -1 = empty */
+
+/* CTIMER4 (us clock) match registers: value (the low 32 bits of the node's clock they
+ * fire at), the count they were set at, the MCR interrupt bits, the IR flags, the NVIC
+ * pending bit and the callbacks of the SDK's handler */
+static uint32_t s_ctMatch[4];
+static uint32_t s_ctMatchSet[4];
+static uint32_t s_ctMcr;
+static uint32_t s_ctFired;      /* Matches passed since set: a match fires once per setup here */
+static uint32_t s_ctIr;
+static bool s_ctPending;
+static ctimer_callback_t *s_ctCb;
+static ctimer_callback_type_t s_ctCbType;
+
+uint32_t g_simPrimask;
+
+static void CtimerService(void);
+
+/* Defined by the remote firmware (app.h), absent when only the robot is linked */
+extern void DEMO_LPADC_IRQ_HANDLER_FUNC(void) __attribute__((weak));
+extern void ESP_SPI_MasterIRQHandler(void) __attribute__((weak));
+
+/*******************************************************************************
+ * Clock / delay
+ ******************************************************************************/
+uint64_t Sim_MonotonicUs(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000U + (uint64_t)ts.tv_nsec / 1000U;
+}
+
+/* The register value a read returns; a write (CYCCNT = 0) restarts the count from it */
+DWT_Type *Sim_Dwt(void)
+{
+    static DWT_Type dwt;
+    static uint32_t baseCycles;
+    static uint64_t baseUs;
+    static uint32_t lastRead;
+    uint64_t now = g_simHooks.now_us();
+
+    if (dwt.CYCCNT != lastRead)
+    {
+        baseCycles = dwt.CYCCNT;
+        baseUs = now;
+    }
+    dwt.CYCCNT = baseCycles + (uint32_t)((now - baseUs) * (SystemCoreClock / 1000000U));
+    lastRead = dwt.CYCCNT;
+    return &dwt;
+}
+
+uint32_t Sim_SpiFrameUs(uint32_t len)
+{
+    return (len * 8U * 1000000U + ESP_SPI_BAUDRATE - 1U) / ESP_SPI_BAUDRATE;
+}
+
+void SDK_DelayAtLeastUs(uint32_t delayTime_us, uint32_t coreClock_Hz)
+{
+    (void)coreClock_Hz;
+
+    if (g_simHooks.idle != NULL && !g_simHooks.idle(delayTime_us))
+    {
+        exit(0);
+    }
+    Sim_DmaService();
+    CtimerService();
+}
+
+void Sim_Wfi(void)
+{
+    uint64_t now = g_simHooks.now_us();
+    uint32_t us = SIM_WFI_MAX_US;
+
+    for (uint32_t m = 0; m < 4U; m++)
+    {
+        if ((s_ctMcr & (1U << (m * 3U))) != 0U && (s_ctMatch[m] - (uint32_t)now) < us)
+        {
+            us = s_ctMatch[m] - (uint32_t)now;
+        }
+    }
+    if (s_dmaHandle != NULL)
+    {
+        us = (s_dmaDoneUs <= now) ? 0U : (uint32_t)MIN(s_dmaDoneUs - now, (uint64_t)us);
+    }
+    SDK_DelayAtLeastUs(us, SystemCoreClock);
+}
+
+/*******************************************************************************
+ * fsl_ctimer.h, CTIMER4: the match interrupt of the us clock
+ ******************************************************************************/
+/* CTIMER_GenericIRQHandler(4) of the SDK, which calls the instance's callback without
+ * checking one was registered: a NULL read and a jump to address 0 on the board */
+static void CtimerIrq(void)
+{
+    uint32_t flags = s_ctIr;
+
+    s_ctPending = false;
+    s_ctIr = 0U;
+    if (s_ctCb == NULL)
+    {
+        fprintf(stderr, "mcu_sim: CTIMER4 interrupt without a callback (HardFault on the board)\n");
+        abort();
+    }
+    if (s_ctCbType == kCTIMER_SingleCallback)
+    {
+        if (s_ctCb[0] != NULL)
+        {
+            s_ctCb[0](flags);
+        }
+        return;
+    }
+    for (uint32_t i = 0; i < 8U; i++)
+    {
+        if ((flags & (1U << i)) != 0U && s_ctCb[i] != NULL)
+        {
+            s_ctCb[i](flags);
+        }
+    }
+}
+
+/* A match the count has reached raises its flag, and the interrupt if enabled; the
+ * handler runs now unless the node has interrupts masked (then at EnableGlobalIRQ()) */
+static void CtimerService(void)
+{
+    uint32_t now = (uint32_t)g_simHooks.now_us();
+
+    for (uint32_t m = 0; m < 4U; m++)
+    {
+        if ((s_ctFired & (1U << m)) != 0U || (now - s_ctMatchSet[m]) < (s_ctMatch[m] - s_ctMatchSet[m]))
+        {
+            continue;
+        }
+        s_ctFired |= 1U << m;
+        s_ctIr |= 1U << m;
+        if ((s_ctMcr & (1U << (m * 3U))) != 0U)
+        {
+            s_ctPending = true;
+        }
+    }
+    if (s_ctPending && g_simPrimask == 0U)
+    {
+        CtimerIrq();
+    }
+}
+
+void Sim_IrqUnmasked(void)
+{
+    CtimerService();
+}
+
+void CTIMER_SetupMatch(CTIMER_Type *base, ctimer_match_t matchChannel, const ctimer_match_config_t *config)
+{
+    uint32_t m = (uint32_t)matchChannel;
+
+    if (base != CTIMER4)
+    {
+        return;
+    }
+    s_ctMatch[m] = config->matchValue;
+    s_ctMatchSet[m] = (uint32_t)g_simHooks.now_us();
+    s_ctMcr &= ~(1U << (m * 3U));
+    if (config->enableInterrupt)
+    {
+        s_ctMcr |= 1U << (m * 3U);
+    }
+    s_ctIr &= ~(1U << m);
+    s_ctFired &= ~(1U << m);
+}
+
+void CTIMER_EnableInterrupts(CTIMER_Type *base, uint32_t mask)
+{
+    if (base == CTIMER4)
+    {
+        s_ctMcr |= mask & 0x249U;
+    }
+}
+
+void CTIMER_DisableInterrupts(CTIMER_Type *base, uint32_t mask)
+{
+    if (base == CTIMER4)
+    {
+        s_ctMcr &= ~(mask & 0x249U);
+    }
+}
+
+uint32_t CTIMER_GetStatusFlags(CTIMER_Type *base)
+{
+    return (base == CTIMER4) ? s_ctIr : 0U;
+}
+
+/* Clears the flags; the NVIC stays pending, its handler then finds none */
+void CTIMER_ClearStatusFlags(CTIMER_Type *base, uint32_t mask)
+{
+    if (base == CTIMER4)
+    {
+        s_ctIr &= ~mask;
+    }
+}
+
+void Sim_UsClockRegisterCallBack(ctimer_callback_t *cb_func, ctimer_callback_type_t cb_type)
+{
+    s_ctCb = cb_func;
+    s_ctCbType = cb_type;
+}
+
+/*******************************************************************************
+ * LPSPI FIFOs: the TCR writes of LPSPI_SetPCSContinous() take a TX FIFO entry
+ * as on the chip, and a write with CONT clear ends the PCS period when it
+ * reaches the shifter. Without CONT the PCS ends after every word.
+ ******************************************************************************/
+static sim_lpspi_t *Lpspi(LPSPI_Type *base)
+{
+    return &s_lpspi[base - g_simLpspi];
+}
+
+static void LpspiPushTx(sim_lpspi_t *spi, uint16_t entry)
+{
+    if (spi->txCount == SIM_LPSPI_FIFO_SIZE)
+    {
+        spi->stats.txOverflows++;
+        return;
+    }
+    spi->tx[(spi->txHead + spi->txCount) % SIM_LPSPI_FIFO_SIZE] = entry;
+    spi->txCount++;
+}
+
+static void LpspiEndPcs(sim_lpspi_t *spi)
+{
+    if (spi->pcs)
+    {
+        spi->pcs = false;
+        spi->stats.frames++;
+    }
+}
+
+/* TCR writes at the head of the TX FIFO */
+static void LpspiTcr(sim_lpspi_t *spi)
+{
+    while ((spi->txCount != 0U) && (spi->tx[spi->txHead] > 0xFFU))
+    {
+        spi->cont = (spi->tx[spi->txHead] == SIM_LPSPI_TCR_CONT);
+        if (!spi->cont)
+        {
+            LpspiEndPcs(spi);
+        }
+        spi->txHead = (spi->txHead + 1U) % SIM_LPSPI_FIFO_SIZE;
+        spi->txCount--;
+    }
+}
+
+uint32_t LPSPI_GetRxFifoCount(LPSPI_Type *base)
+{
+    return Lpspi(base)->rxCount;
+}
+
+uint32_t LPSPI_GetTxFifoCount(LPSPI_Type *base)
+{
+    return Lpspi(base)->txCount;
+}
+
+void LPSPI_FlushFifo(LPSPI_Type *base, bool flushTxFifo, bool flushRxFifo)
+{
+    sim_lpspi_t *spi = Lpspi(base);
+
+    if (flushTxFifo)
+    {
+        spi->txCount = 0U;
+    }
+    if (flushRxFifo)
+    {
+        spi->rxCount = 0U;
+    }
+}
+
+void LPSPI_SetPCSContinous(LPSPI_Type *base, bool IsContinous)
+{
+    sim_lpspi_t *spi = Lpspi(base);
+
+    if (!IsContinous && spi->inIrq && !spi->irqWrote)
+    {
+        spi->stats.pcsDeferred++;
+    }
+    LpspiPushTx(spi, IsContinous ? SIM_LPSPI_TCR_CONT : SIM_LPSPI_TCR_END);
+}
+
+void LPSPI_WriteData(LPSPI_Type *base, uint32_t data)
+{
+    sim_lpspi_t *spi = Lpspi(base);
+
+    spi->irqWrote = true;
+    LpspiPushTx(spi, (uint16_t)(data & 0xFFU));
+}
+
+uint32_t LPSPI_ReadData(LPSPI_Type *base)
+{
+    sim_lpspi_t *spi = Lpspi(base);
+    uint8_t data;
+
+    if (spi->rxCount == 0U)
+    {
+        spi->stats.rxUnderflows++;
+        return 0U;
+    }
+    data = spi->rx[spi->rxHead];
+    spi->rxHead = (spi->rxHead + 1U) % SIM_LPSPI_FIFO_SIZE;
+    spi->rxCount--;
+    return data;
+}
+
+uint32_t Sim_LpspiClock(LPSPI_Type *base, uint32_t bytes)
+{
+    sim_lpspi_t *spi = Lpspi(base);
+    uint32_t shifted = 0U;
+
+    LpspiTcr(spi);
+    while ((shifted < bytes) && (spi->txCount != 0U) && (spi->rxCount < SIM_LPSPI_FIFO_SIZE))
+    {
+        uint8_t tx = (uint8_t)spi->tx[spi->txHead];
+        bool first = !spi->pcs;
+        uint8_t rx = 0U;
+
+        spi->txHead = (spi->txHead + 1U) % SIM_LPSPI_FIFO_SIZE;
+        spi->txCount--;
+        spi->pcs = true;
+        if (g_simHooks.spi_byte != NULL)
+        {
+            rx = g_simHooks.spi_byte(tx, first);
+        }
+        spi->rx[(spi->rxHead + spi->rxCount) % SIM_LPSPI_FIFO_SIZE] = rx;
+        spi->rxCount++;
+        shifted++;
+
+        if (!spi->cont)
+        {
+            LpspiEndPcs(spi);
+        }
+        LpspiTcr(spi);
+    }
+
+    /* RX data flag: more words than the watermark */
+    if (((base->IER & kLPSPI_RxInterruptEnable) != 0U) &&
+        (spi->rxCount > ((base->FCR & LPSPI_FCR_RXWATER_MASK) >> 16U)) && (g_simPrimask == 0U) && !spi->inIrq &&
+        (ESP_SPI_MasterIRQHandler != NULL))
+    {
+        spi->stats.irqs++;
+        spi->inIrq = true;
+        spi->irqWrote = false;
+        ESP_SPI_MasterIRQHandler();
+        spi->inIrq = false;
+        LpspiTcr(spi);
+    }
+    return shifted;
+}
+
+void Sim_LpspiStats(LPSPI_Type *base, SimLpspiStats_t *stats)
+{
+    *stats = Lpspi(base)->stats;
+}
+
+/*******************************************************************************
+ * fsl_lpspi_edma.h: the frame is exchanged with the slave when it starts, the
+ * completion callback runs Sim_SpiFrameUs() later from Sim_DmaService()
+ ******************************************************************************/
+void LPSPI_MasterTransferCreateHandleEDMA(LPSPI_Type *base, lpspi_master_edma_handle_t *handle,
+                                          lpspi_master_edma_transfer_callback_t callback, void *userData,
+                                          edma_handle_t *edmaRxRegToRxDataHandle,
+                                          edma_handle_t *edmaTxDataToTxRegHandle)
+{
+    (void)base;
+    (void)edmaRxRegToRxDataHandle;
+    (void)edmaTxDataToTxRegHandle;
+    memset(handle, 0, sizeof(*handle));
+    handle->callback = callback;
+    handle->userData = userData;
+}
+
+status_t LPSPI_MasterTransferEDMA(LPSPI_Type *base, lpspi_master_edma_handle_t *handle,
+                                  lpspi_transfer_t *transfer)
+{
+    if ((transfer->txData == NULL) || (transfer->rxData == NULL) || (transfer->dataSize == 0U))
+    {
+        return kStatus_InvalidArgument;
+    }
+    /* As the SDK: a second transfer on a busy handle is refused, ESP_SPI.c must not try */
+    if (handle->busy)
+    {
+        return kStatus_LPSPI_Busy;
+    }
+
+    handle->busy = true;
+    s_dmaHandle = handle;
+    s_dmaBase = base;
+    s_dmaDoneUs = ((s_dmaChainUs != 0U) ? s_dmaChainUs : g_simHooks.now_us()) +
+                  Sim_SpiFrameUs((uint32_t)transfer->dataSize);
+
+    if (g_simHooks.spi_xfer != NULL)
+    {
+        g_simHooks.spi_xfer(transfer->txData, transfer->rxData, (uint32_t)transfer->dataSize);
+    }
+    return kStatus_Success;
+}
+
+void Sim_DmaService(void)
+{
+    /* The callback may start the next queued frame, which is due one frame time later:
+     * a queue the main loop filled all completes during its delay, as on the board */
+    while ((s_dmaHandle != NULL) && (g_simHooks.now_us() >= s_dmaDoneUs))
+    {
+        lpspi_master_edma_handle_t *handle = s_dmaHandle;
+
+        s_dmaHandle = NULL;
+        handle->busy = false;
+        s_dmaChainUs = s_dmaDoneUs;
+        if (handle->callback != NULL)
+        {
+            handle->callback(s_dmaBase, handle, kStatus_Success, handle->userData);
+        }
+        s_dmaChainUs = 0U;
+    }
+}
+
+/*******************************************************************************
+ * LPADC: a software trigger runs the command chain and raises the IRQ
+ ******************************************************************************/
+void LPADC_GetDefaultConfig(lpadc_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+}
+
+void LPADC_GetDefaultConvCommandConfig(lpadc_conv_command_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+}
+
+void LPADC_SetConvCommandConfig(ADC_Type *base, uint32_t commandId, const lpadc_conv_command_config_t *config)
+{
+    (void)base;
+    if (commandId < SIM_LPADC_CMD_COUNT)
+    {
+        s_adcCmd[commandId] = *config;
+    }
+}
+
+void LPADC_EnableOffsetCalibration(ADC_Type *base, bool enable)
+{
+    if (enable)
+    {
+        base->STAT |= kLPADC_CalibrationReadyFlag;
+    }
+}
+
+uint32_t LPADC_GetStatusFlags(ADC_Type *base)
+{
+    return base->STAT;
+}
+
+void LPADC_PrepareAutoCalibration(ADC_Type *base)
+{
+    base->GCC[0] |= ADC_GCC_RDY_MASK;
+    base->GCC[1] |= ADC_GCC_RDY_MASK;
+}
+
+status_t LPADC_FinishAutoCalibration(ADC_Type *base)
+{
+    (void)base;
+    return kStatus_Success;
+}
+
+void LPADC_GetDefaultConvTriggerConfig(lpadc_conv_trigger_config_t *config)
+{
+    memset(config, 0, sizeof(*config));
+}
+
+void LPADC_SetConvTriggerConfig(ADC_Type *base, uint32_t triggerId, const lpadc_conv_trigger_config_t *config)
+{
+    (void)base;
+    if (triggerId == 0U)
+    {
+        s_adcTrigger = *config;
+    }
+}
+
+void LPADC_DoSoftwareTrigger(ADC_Type *base, uint32_t triggerIdMask)
+{
+    uint32_t cmdId = s_adcTrigger.targetCommandId;
+    uint32_t guard = 0;
+
+    (void)base;
+    if ((triggerIdMask & 1U) == 0U)
+    {
+        return;
+    }
+
+    while (cmdId != 0U && cmdId < SIM_LPADC_CMD_COUNT && guard++ < SIM_LPADC_CMD_COUNT)
+    {
+        const lpadc_conv_command_config_t *cmd = &s_adcCmd[cmdId];
+        uint16_t raw = 2048U;
+
+        if (g_simHooks.adc_input != NULL)
+        {
+            raw = g_simHooks.adc_input(cmd->channelNumber,
+                                       cmd->sampleChannelMode == kLPADC_SampleChannelSingleEndSideB);
+        }
+
+        if (s_adcFifoCount < SIM_LPADC_FIFO_SIZE)
+        {
+            lpadc_conv_result_t *res = &s_adcFifo[(s_adcFifoHead + s_adcFifoCount) % SIM_LPADC_FIFO_SIZE];
+            res->commandIdSource = cmdId;
+            res->convValue = (uint32_t)raw << 3U; /* 16-bit result register, 12-bit converter */
+            s_adcFifoCount++;
+        }
+        cmdId = cmd->chainedNextCommandNumber;
+    }
+
+    if (DEMO_LPADC_IRQ_HANDLER_FUNC != NULL)
+    {
+        DEMO_LPADC_IRQ_HANDLER_FUNC();
+    }
+}
+
+bool LPADC_GetConvResult(ADC_Type *base, lpadc_conv_result_t *result, uint8_t index)
+{
+    (void)base;
+    (void)index;
+    if (s_adcFifoCount == 0U)
+    {
+        return false;
+    }
+    *result = s_adcFifo[s_adcFifoHead];
+    s_adcFifoHead = (s_adcFifoHead + 1U) % SIM_LPADC_FIFO_SIZE;
+    s_adcFifoCount--;
+    return true;
+}
+
+/*******************************************************************************
+ * LPUART: the data register holds the next byte of g_simHooks.console_getchar
+ ******************************************************************************/
+uint32_t LPUART_GetStatusFlags(LPUART_Type *base)
+{
+    (void)base;
+    if (s_uartRx < 0 && g_simHooks.console_getchar != NULL)
+    {
+        s_uartRx = g_simHooks.console_getchar();
+    }
+    return (s_uartRx >= 0) ? (uint32_t)kLPUART_RxDataRegFullFlag : 0U;
+}
+
+status_t LPUART_ClearStatusFlags(LPUART_Type *base, uint32_t mask)
+{
+    (void)base;
+    (void)mask;
+    return kStatus_Success;
+}
+
+uint8_t LPUART_ReadByte(LPUART_Type *base)
+{
+    uint8_t c = (uint8_t)s_uartRx;
+
+    (void)base;
+    s_uartRx = -1;
+    return c;
+}
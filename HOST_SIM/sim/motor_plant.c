@@ -0,0 +1,42 @@
+/*
+ * motor_plant.c
+ */
+
+#include "motor_plant.h"
+#include <math.h>
+
+void MotorPlant_Init(motor_plant_t *m, const motor_plant_params_t *params)
+{
+    m->p = *params;
+    m->omega = 0.0f;
+    m->current = 0.0f;
+}
+
+/* drive = noLoadSpeed * (|u| - f) / (1 - f) is gain * |u| - coulomb */
+void MotorPlant_FromModel(motor_plant_params_t *params, const motor_model_t *model)
+{
+    params->frictionDuty = (model->gain > 0.0f) ? model->coulomb / model->gain : 0.0f;
+    params->noLoadSpeed = model->gain - model->coulomb;
+    params->tau = model->tau;
+}
+
+void MotorPlant_Step(motor_plant_t *m, float duty, float dt)
+{
+    float mag = fabsf(duty);
+    float drive = 0.0f;
+
+    if (mag > 1.0f) mag = 1.0f;
+
+    /* Below the break-away duty the motor only keeps turning if it already does */
+    if (mag > m->p.frictionDuty)
+    {
+        drive = (mag - m->p.frictionDuty) / (1.0f - m->p.frictionDuty);
+    }
+    drive = copysignf(drive, duty) * m->p.noLoadSpeed;
+
+    /* Exact step of tau * dw/dt = drive - w */
+    m->omega += (drive - m->omega) * (1.0f - expf(-dt / m->p.tau));
+
+    /* Winding current: applied voltage minus back-EMF, both as a fraction of full scale */
+    m->current = m->p.stallCurrent * (copysignf(mag, duty) - m->omega / m->p.noLoadSpeed);
+}
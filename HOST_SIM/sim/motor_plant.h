@@ -0,0 +1,44 @@
+/*
+ * motor_plant.h
+ *
+ * Gear motor + wheel as seen by the robot firmware: signed duty in, output
+ * shaft speed and winding current out. First order mechanics with a
+ * static friction deadband, back-EMF limited current.
+ */
+
+#ifndef MOTOR_PLANT_H_
+#define MOTOR_PLANT_H_
+
+#include "motor_model.h"
+
+typedef struct {
+    float noLoadSpeed;      /* Output shaft speed at 100 % duty (rad/s) */
+    float tau;              /* Mechanical time constant (s) */
+    float stallCurrent;     /* Current at 100 % duty, shaft blocked (A) */
+    float frictionDuty;     /* Duty needed to break away (0..1) */
+} motor_plant_params_t;
+
+typedef struct {
+    motor_plant_params_t p;
+    float omega;            /* Signed output shaft speed (rad/s) */
+    float current;          /* Signed winding current (A) */
+} motor_plant_t;
+
+/* 12 V gear motor with the 2249 CPR output encoder the robot uses */
+#define MOTOR_PLANT_DEFAULT_PARAMS { 15.0f, 0.05f, 2.5f, 0.05f }
+
+void MotorPlant_Init(motor_plant_t *m, const motor_plant_params_t *params);
+
+/*!
+ * @brief Speed, time constant and friction from an identified model (motor_model.h).
+ *
+ * The plant's friction takes the same duty off a turning and a still wheel, so the
+ * model's coulomb sets it; its deadband and dead time are not modelled.
+ * stallCurrent is left as it is.
+ */
+void MotorPlant_FromModel(motor_plant_params_t *params, const motor_model_t *model);
+
+/*! @brief Advance by dt seconds with a constant duty (-1..1) */
+void MotorPlant_Step(motor_plant_t *m, float duty, float dt);
+
+#endif /* MOTOR_PLANT_H_ */
@@ -0,0 +1,487 @@
+/*
+ * robot_board.c
+ *
+ * SDK and board driver stand-ins of the robot (GPIO_DRIVER with its pin
+ * interrupts, PWM_DRIVER, ADC_DRIVER, LPTMR, CTIMER, MPU9250) on top of
+ * four motor plants.
+ */
+
+#include "robot_board.h"
+#include "sim_hooks.h"
+#include "GPIO_DRIVER.h"
+#include "PWM_DRIVER.h"
+#include "ADC_DRIVER.h"
+#include "mpu9250_driver.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define SIM_PORTS               5U
+#define SIM_PWM_SUBMODULES      4U
+#define SIM_LPTMRS              2U
+#define SIM_STEP_NS             20000U      /* Plant integration step */
+#define SIM_PI                  3.14159265359f
+
+/* counts_to_rad_s() takes one capture interval as 1 / OUTPUT_COUNTS_CPR of a turn */
+#define SIM_EDGES_PER_RAD       (ROBOT_BOARD_ENCODER_CPR / (2.0f * SIM_PI))
+
+typedef struct {
+    bool attached;
+    motor_plant_t plant;
+    uint32_t submodule;
+    ENABLE_PIN ina;
+    ENABLE_PIN inb;
+    uint32_t adcCmd;
+    float edgeAcc;
+} sim_wheel_t;
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static sim_wheel_t s_wheel[ROBOT_BOARD_WHEELS];
+static uint8_t s_pin[SIM_PORTS][32];
+static uint32_t s_pinIrqRising[SIM_PORTS];     /* init_interrupts() pins */
+static uint32_t s_pinIrqFlags[SIM_PORTS];
+static void (*s_pinIrqHandler)(void);
+static uint16_t s_dutyPending[SIM_PWM_SUBMODULES];
+static uint16_t s_duty[SIM_PWM_SUBMODULES];
+
+static uint64_t s_nowNs;
+static uint32_t s_lptmrPeriod[SIM_LPTMRS];
+static bool s_lptmrRunning[SIM_LPTMRS];
+static uint64_t s_lptmrNextNs[SIM_LPTMRS];
+
+static ctimer_callback_t s_ctimerCb;
+static uint32_t s_capture[ROBOT_BOARD_WHEELS];
+static bool s_ctimerHeld;                       /* RobotBoard_SetCtimerCount() */
+static uint32_t s_ctimerCount;
+
+static robot_board_tick_hook_t s_tickHook;
+
+/* TIMER_DRIVER.c */
+extern void LPTMR0_IRQHandler(void) __attribute__((weak));
+extern void LPTMR1_IRQHandler(void) __attribute__((weak));
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+static inline uint32_t CtimerTicks(uint64_t ns)
+{
+    return (uint32_t)((ns * (ROBOT_BOARD_CTIMER_HZ / 1000000U)) / 1000U);
+}
+
+static uint64_t LptmrPeriodNs(uint32_t lptmr)
+{
+    return ((uint64_t)s_lptmrPeriod[lptmr] * 1000000000U) / ROBOT_BOARD_LPTMR_HZ;
+}
+
+static float WheelDuty(const sim_wheel_t *w)
+{
+    uint8_t a = s_pin[w->ina.PORT % SIM_PORTS][w->ina.PIN % 32U];
+    uint8_t b = s_pin[w->inb.PORT % SIM_PORTS][w->inb.PIN % 32U];
+    float duty = (float)s_duty[w->submodule % SIM_PWM_SUBMODULES] / 65535.0f;
+
+    /* MOTOR_run(): MOTOR_FORWARD drives INB, MOTOR_BACKWARDS drives INA */
+    if (a == b)
+    {
+        return 0.0f;
+    }
+    return b ? duty : -duty;
+}
+
+/* Integrate the plants over [s_nowNs, s_nowNs + dtNs] and raise the encoder captures */
+static void StepPlants(uint64_t dtNs)
+{
+    float dt = (float)dtNs * 1e-9f;
+
+    for (uint32_t i = 0; i < ROBOT_BOARD_WHEELS; i++)
+    {
+        sim_wheel_t *w = &s_wheel[i];
+        float before;
+        float edges;
+
+        if (!w->attached)
+        {
+            continue;
+        }
+
+        before = w->plant.omega;
+        MotorPlant_Step(&w->plant, WheelDuty(w), dt);
+        edges = 0.5f * fabsf(before + w->plant.omega) * dt * SIM_EDGES_PER_RAD;
+        if (edges <= 0.0f)
+        {
+            continue;
+        }
+
+        /* Both edges of channel A are captured, the direction is not */
+        float acc = w->edgeAcc + edges;
+        for (float k = 1.0f; k <= floorf(acc); k += 1.0f)
+        {
+            s_capture[i] = CtimerTicks(s_nowNs + (uint64_t)((float)dtNs * ((k - w->edgeAcc) / edges)));
+            if (s_ctimerCb != NULL)
+            {
+                s_ctimerCb((uint32_t)kCTIMER_Capture0Flag << i);
+            }
+        }
+        w->edgeAcc = acc - floorf(acc);
+    }
+
+    s_nowNs += dtNs;
+}
+
+static void AdvanceTo(uint64_t ns)
+{
+    while (s_nowNs < ns)
+    {
+        uint64_t dt = ns - s_nowNs;
+        StepPlants(dt > SIM_STEP_NS ? SIM_STEP_NS : dt);
+    }
+}
+
+/*******************************************************************************
+ * Board API
+ ******************************************************************************/
+void RobotBoard_Init(const motor_plant_params_t *params)
+{
+    memset(s_wheel, 0, sizeof(s_wheel));
+    memset(s_pin, 0, sizeof(s_pin));
+    memset(s_pinIrqRising, 0, sizeof(s_pinIrqRising));
+    memset(s_pinIrqFlags, 0, sizeof(s_pinIrqFlags));
+    s_pinIrqHandler = NULL;
+    memset(s_duty, 0, sizeof(s_duty));
+    memset(s_dutyPending, 0, sizeof(s_dutyPending));
+    memset(s_lptmrRunning, 0, sizeof(s_lptmrRunning));
+    s_nowNs = 0;
+    s_ctimerHeld = false;
+
+    for (uint32_t i = 0; i < ROBOT_BOARD_WHEELS; i++)
+    {
+        MotorPlant_Init(&s_wheel[i].plant, params);
+    }
+}
+
+void RobotBoard_AttachWheel(uint32_t wheel, const MOTOR_T *motor)
+{
+    sim_wheel_t *w = &s_wheel[wheel];
+
+    w->attached = true;
+    w->submodule = motor->PWM->submodule;
+    w->ina = *motor->MINA;
+    w->inb = *motor->MINB;
+    w->adcCmd = (motor->ADC != NULL) ? motor->ADC->commandId : 0U;
+}
+
+void RobotBoard_SetTickHook(robot_board_tick_hook_t hook)
+{
+    s_tickHook = hook;
+}
+
+void RobotBoard_RunUntil(uint64_t t_us)
+{
+    uint64_t target = t_us * 1000U;
+
+    for (;;)
+    {
+        uint32_t next = SIM_LPTMRS;
+
+        for (uint32_t i = 0; i < SIM_LPTMRS; i++)
+        {
+            if (s_lptmrRunning[i] && (next == SIM_LPTMRS || s_lptmrNextNs[i] < s_lptmrNextNs[next]))
+            {
+                next = i;
+            }
+        }
+
+        if (next == SIM_LPTMRS || s_lptmrNextNs[next] > target)
+        {
+            AdvanceTo(target);
+            Sim_DmaService();
+            return;
+        }
+
+        AdvanceTo(s_lptmrNextNs[next]);
+        s_lptmrNextNs[next] += LptmrPeriodNs(next);
+
+        /* A transfer that ended before this tick completes first */
+        Sim_DmaService();
+
+        if (next == 0U && LPTMR0_IRQHandler != NULL)
+        {
+            LPTMR0_IRQHandler();
+        }
+        else if (next == 1U && LPTMR1_IRQHandler != NULL)
+        {
+            LPTMR1_IRQHandler();
+        }
+
+        if (s_tickHook != NULL)
+        {
+            s_tickHook(next);
+        }
+    }
+}
+
+uint64_t RobotBoard_NowUs(void)
+{
+    return s_nowNs / 1000U;
+}
+
+const motor_plant_t *RobotBoard_GetWheel(uint32_t wheel)
+{
+    return &s_wheel[wheel].plant;
+}
+
+float RobotBoard_GetDuty(uint32_t wheel)
+{
+    return WheelDuty(&s_wheel[wheel]);
+}
+
+void RobotBoard_SetInput(uint32_t port, uint32_t pin, bool level)
+{
+    uint8_t *state = &s_pin[port % SIM_PORTS][pin % 32U];
+    bool rising = level && (*state == 0U);
+
+    *state = level;
+    if (rising && (s_pinIrqRising[port % SIM_PORTS] & (1UL << (pin % 32U))))
+    {
+        s_pinIrqFlags[port % SIM_PORTS] |= 1UL << (pin % 32U);
+        if (s_pinIrqHandler != NULL)
+        {
+            s_pinIrqHandler();
+        }
+    }
+}
+
+void RobotBoard_InjectCapture(uint32_t wheel, uint32_t capture)
+{
+    s_capture[wheel % ROBOT_BOARD_WHEELS] = capture;
+    if (s_ctimerCb != NULL)
+    {
+        s_ctimerCb((uint32_t)kCTIMER_Capture0Flag << (wheel % ROBOT_BOARD_WHEELS));
+    }
+}
+
+void RobotBoard_SetCtimerCount(uint32_t count)
+{
+    s_ctimerHeld = true;
+    s_ctimerCount = count;
+}
+
+/*******************************************************************************
+ * GPIO_DRIVER.h / fsl_gpio.h
+ ******************************************************************************/
+void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config)
+{
+    s_pin[(base - GPIO0) % SIM_PORTS][pin % 32U] = config->outputLogic;
+}
+
+#define SIM_PORT_FUNCTIONS(n)                                                   \
+    void PORT##n##_SetOutput(ARM_GPIO_Pin_t pin, uint32_t val)                  \
+    {                                                                           \
+        s_pin[n][pin % 32U] = (val != 0U);                                      \
+    }                                                                           \
+    int32_t PORT##n##_SetDirection(ARM_GPIO_Pin_t pin, uint32_t direction)      \
+    {                                                                           \
+        (void)pin;                                                              \
+        (void)direction;                                                        \
+        return ARM_DRIVER_OK;                                                   \
+    }                                                                           \
+    int32_t PORT##n##_Setup(ARM_GPIO_Pin_t pin, ARM_GPIO_SignalEvent_t cb_event) \
+    {                                                                           \
+        (void)pin;                                                              \
+        (void)cb_event;                                                         \
+        return ARM_DRIVER_OK;                                                   \
+    }
+
+/* One handler for all ports, as GPIO_DRIVER.c (it serves GPIO10 only) */
+void init_interrupts(GPIO_Type *gpio_base, uint32_t *pins, uint32_t number_of_pins, void *handler_ptr)
+{
+    uint32_t port = (uint32_t)(gpio_base - GPIO0) % SIM_PORTS;
+
+    for (uint32_t i = 0; i < number_of_pins; i++)
+    {
+        s_pinIrqRising[port] |= 1UL << (pins[i] % 32U);
+    }
+    s_pinIrqHandler = (void (*)(void))handler_ptr;
+}
+
+uint8_t GPIO_PinGetInterruptFlag(GPIO_Type *base, uint32_t pin)
+{
+    return (s_pinIrqFlags[(uint32_t)(base - GPIO0) % SIM_PORTS] >> (pin % 32U)) & 1U;
+}
+
+void GPIO_PinClearInterruptFlag(GPIO_Type *base, uint32_t pin)
+{
+    s_pinIrqFlags[(uint32_t)(base - GPIO0) % SIM_PORTS] &= ~(1UL << (pin % 32U));
+}
+
+SIM_PORT_FUNCTIONS(0)
+SIM_PORT_FUNCTIONS(1)
+SIM_PORT_FUNCTIONS(2)
+SIM_PORT_FUNCTIONS(3)
+SIM_PORT_FUNCTIONS(4)
+
+/*******************************************************************************
+ * PWM_DRIVER.h / fsl_pwm.h
+ ******************************************************************************/
+int init_pwm(void)
+{
+    return 0;
+}
+
+void PWM_DRV_Init3PhPwm(void)
+{
+}
+
+void PWM_UpdatePwmDutycycleHighAccuracy(PWM_Type *base, pwm_submodule_t subModule,
+                                        pwm_channels_t pwmSignal, pwm_mode_t currPwmMode,
+                                        uint16_t dutyCycle)
+{
+    (void)base;
+    (void)pwmSignal;
+    (void)currPwmMode;
+    s_dutyPending[subModule % SIM_PWM_SUBMODULES] = dutyCycle;
+}
+
+void PWM_SetPwmLdok(PWM_Type *base, uint8_t subModulesToUpdate, bool value)
+{
+    (void)base;
+    if (!value)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < SIM_PWM_SUBMODULES; i++)
+    {
+        if (subModulesToUpdate & (1U << i))
+        {
+            s_duty[i] = s_dutyPending[i];
+        }
+    }
+}
+
+/*******************************************************************************
+ * ADC_DRIVER.h: current sense, MOTOR_ADC_Read() scales by 3.3 / 4095 * 0.14
+ ******************************************************************************/
+void init_ADC(ADC_Type *adc_base, SPC_Type *spc_base, VREF_Type *vref_base, uint32_t user_channel, uint32_t user_cmdid)
+{
+    (void)adc_base;
+    (void)spc_base;
+    (void)vref_base;
+    (void)user_channel;
+    (void)user_cmdid;
+}
+
+/* The calibration is not modelled: done at the first poll */
+bool poll_ADC_calibration(void)
+{
+    return true;
+}
+
+uint32_t read_ADC(ADC_Type *adc_base, uint32_t user_cmdid)
+{
+    (void)adc_base;
+    for (uint32_t i = 0; i < ROBOT_BOARD_WHEELS; i++)
+    {
+        if (s_wheel[i].attached && s_wheel[i].adcCmd == user_cmdid)
+        {
+            float raw = fabsf(s_wheel[i].plant.current) / ((3.3f / 4095.0f) * 0.14f);
+            return (raw > 4095.0f) ? 4095U : (uint32_t)raw;
+        }
+    }
+    return 0;
+}
+
+/*******************************************************************************
+ * fsl_lptmr.h / fsl_ctimer.h
+ ******************************************************************************/
+void LPTMR_SetTimerPeriod(LPTMR_Type *base, uint32_t ticks)
+{
+    s_lptmrPeriod[base->id % SIM_LPTMRS] = ticks;
+}
+
+void LPTMR_StartTimer(LPTMR_Type *base)
+{
+    uint32_t i = base->id % SIM_LPTMRS;
+
+    s_lptmrRunning[i] = (s_lptmrPeriod[i] != 0U);
+    s_lptmrNextNs[i] = s_nowNs + LptmrPeriodNs(i);
+}
+
+void CTIMER_RegisterCallBack(CTIMER_Type *base, ctimer_callback_t *cb_func, ctimer_callback_type_t cb_type)
+{
+    if (base == CTIMER4)
+    {
+        Sim_UsClockRegisterCallBack(cb_func, cb_type);
+        return;
+    }
+    s_ctimerCb = cb_func[0];
+}
+
+uint32_t CTIMER_GetCaptureValue(CTIMER_Type *base, ctimer_capture_channel_t capture)
+{
+    (void)base;
+    return s_capture[capture % ROBOT_BOARD_WHEELS];
+}
+
+/* CTIMER4 is us_clock_now() of either node: the node's own clock */
+uint32_t CTIMER_GetTimerCountValue(CTIMER_Type *base)
+{
+    if (base == CTIMER4)
+    {
+        return (uint32_t)g_simHooks.now_us();
+    }
+    return s_ctimerHeld ? s_ctimerCount : CtimerTicks(s_nowNs);
+}
+
+/*******************************************************************************
+ * mpu9250_driver.h: a robot standing still; the read is the main loop's idle point
+ ******************************************************************************/
+status_t MPU9250_Init(mpu9250_handle_t *handle, LPI2C_Type *base)
+{
+    handle->i2cBase = base;
+    return kStatus_Success;
+}
+
+/* The power-up takes as long as on the board (reset, wake: 100 ms each) */
+status_t MPU9250_InitStart(mpu9250_handle_t *handle, LPI2C_Type *base, uint64_t nowUs)
+{
+    handle->i2cBase = base;
+    handle->initDueUs = nowUs + 200000U;
+    return kStatus_Success;
+}
+
+status_t MPU9250_InitPoll(mpu9250_handle_t *handle, uint64_t nowUs)
+{
+    if (nowUs >= handle->initDueUs)
+    {
+        return kStatus_Success;
+    }
+    /* The main loop spins here while the IMU powers up: its idle point until then */
+    if (g_simHooks.idle != NULL && !g_simHooks.idle(0))
+    {
+        exit(0);
+    }
+    return kStatus_Busy;
+}
+
+void MPU9250_Calibrate(mpu9250_handle_t *handle)
+{
+    memset(handle->accelOffset, 0, sizeof(handle->accelOffset));
+    memset(handle->gyroOffset, 0, sizeof(handle->gyroOffset));
+}
+
+status_t MPU9250_ReadSensor(mpu9250_handle_t *handle)
+{
+    memset(handle->accelRaw, 0, sizeof(handle->accelRaw));
+    memset(handle->gyroRaw, 0, sizeof(handle->gyroRaw));
+    handle->accelRaw[2] = (int16_t)MPU9250_ACCEL_1G;
+
+    if (g_simHooks.idle != NULL && !g_simHooks.idle(0))
+    {
+        exit(0);
+    }
+    return kStatus_Success;
+}
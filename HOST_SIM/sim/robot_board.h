@@ -0,0 +1,66 @@
+/*
+ * robot_board.h
+ *
+ * The robot's MCXN947 and its four wheels, as far as the firmware sees them:
+ * PWM duty + enable pins drive a motor_plant each, the plant's shaft angle
+ * produces the CTIMER encoder captures and the current-sense ADC reading,
+ * and the two LPTMR interrupts (telemetry, PID) fire on simulated time.
+ *
+ * Time only moves in RobotBoard_RunUntil(), so the firmware's interrupt
+ * handlers run back to back at their exact simulated instants however
+ * slowly the host catches up.
+ */
+
+#ifndef ROBOT_BOARD_H_
+#define ROBOT_BOARD_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "omnidriver.h"
+#include "motor_plant.h"
+
+#define ROBOT_BOARD_WHEELS          4U
+#define ROBOT_BOARD_CTIMER_HZ       150000000U  /* CTIMER0 clock (PLL0) */
+#define ROBOT_BOARD_LPTMR_HZ        12000000U   /* LPTMR clock (FRO 12M) */
+#define ROBOT_BOARD_ENCODER_CPR     2249.0f     /* Output shaft, 4 edges per count */
+
+/*! @brief Called after every LPTMR interrupt (0 = telemetry, 1 = PID), for probes */
+typedef void (*robot_board_tick_hook_t)(uint32_t lptmr);
+
+void RobotBoard_Init(const motor_plant_params_t *params);
+
+/*!
+ * @brief Wire wheel n (encoder capture channel n) to a motor of the firmware.
+ * The PWM submodule, the enable pins and the ADC command are taken from it.
+ */
+void RobotBoard_AttachWheel(uint32_t wheel, const MOTOR_T *motor);
+
+void RobotBoard_SetTickHook(robot_board_tick_hook_t hook);
+
+/*! @brief Run the plants and the interrupts up to t_us (simulated time) */
+void RobotBoard_RunUntil(uint64_t t_us);
+
+/*! @brief Simulated time in microseconds since RobotBoard_Init() */
+uint64_t RobotBoard_NowUs(void);
+
+const motor_plant_t *RobotBoard_GetWheel(uint32_t wheel);
+
+/*! @brief Duty (-1..1) the firmware applies to a wheel right now */
+float RobotBoard_GetDuty(uint32_t wheel);
+
+/*!
+ * @brief Drive an input pin (e.g. the bridge's data-ready line). A rising edge on a
+ * pin set up with init_interrupts() runs its handler now, at the current simulated time.
+ */
+void RobotBoard_SetInput(uint32_t port, uint32_t pin, bool level);
+
+/*!
+ * @brief Replay: raise the CTIMER0 capture interrupt of wheel n now, the capture register
+ * reading `capture`. Leave the wheel unattached, or its plant raises captures too.
+ */
+void RobotBoard_InjectCapture(uint32_t wheel, uint32_t capture);
+
+/*! @brief Replay: CTIMER0 reads `count` from now on, instead of the simulated time */
+void RobotBoard_SetCtimerCount(uint32_t count);
+
+#endif /* ROBOT_BOARD_H_ */
@@ -0,0 +1,74 @@
+/*
+ * sim_hooks.h
+ *
+ * What a host tool plugs into the simulated MCU: the clock, the ESP SPI link,
+ * the joystick voltages, the debug console input and the idle loop. One set per process, a tool that
+ * runs several nodes forks and fills them in each child.
+ */
+
+#ifndef SIM_HOOKS_H_
+#define SIM_HOOKS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "mcu_sim.h"
+
+typedef struct {
+    /*! @brief Node time in microseconds (default: CLOCK_MONOTONIC) */
+    uint64_t (*now_us)(void);
+
+    /*! @brief One full-duplex ESP SPI frame, rx may be filled with the slave's answer */
+    void (*spi_xfer)(const uint8_t *tx, uint8_t *rx, uint32_t len);
+
+    /*! @brief One byte of the LPSPI interrupt transport, `first` when PCS was just asserted;
+     *  returns the slave's byte */
+    uint8_t (*spi_byte)(uint8_t tx, bool first);
+
+    /*! @brief Raw 12-bit ADC value of a joystick input (remote LPADC) */
+    uint16_t (*adc_input)(uint32_t channel, bool sideB);
+
+    /*! @brief Next byte typed on the debug console (LPUART), -1 if none yet */
+    int (*console_getchar)(void);
+
+    /*!
+     * @brief Called where the firmware waits (SDK_DelayAtLeastUs, robot main loop).
+     * Advances the node and returns false when the run is over; the node exits then.
+     */
+    bool (*idle)(uint32_t us);
+} SimHooks_t;
+
+extern SimHooks_t g_simHooks;
+
+/*! @brief CLOCK_MONOTONIC in microseconds, shared by all processes of a run */
+uint64_t Sim_MonotonicUs(void);
+
+/*! @brief Duration of one ESP SPI frame on the wire at ESP_SPI_BAUDRATE */
+uint32_t Sim_SpiFrameUs(uint32_t len);
+
+/*!
+ * @brief Shifts up to `bytes` words of the LPSPI TX FIFO on the wire (TCR writes in
+ * between take no time), then raises the LPSPI interrupt (ESP_SPI_MasterIRQHandler)
+ * if the RX FIFO is above its watermark. The shifting stalls on a full RX FIFO, as
+ * with CFGR1 NOSTALL clear: the bytes are the interrupt latency.
+ * @return The words shifted.
+ */
+uint32_t Sim_LpspiClock(LPSPI_Type *base, uint32_t bytes);
+
+typedef struct {
+    uint32_t irqs;          /* LPSPI interrupts raised */
+    uint32_t frames;        /* PCS periods ended */
+    uint32_t pcsDeferred;   /* PCS releases an interrupt wrote before any word */
+    uint32_t txOverflows;   /* Writes to a full TX FIFO (lost) */
+    uint32_t rxUnderflows;  /* Reads of an empty RX FIFO */
+} SimLpspiStats_t;
+
+/*! @brief Counters since the first use of `base` */
+void Sim_LpspiStats(LPSPI_Type *base, SimLpspiStats_t *stats);
+
+/*!
+ * @brief Completes the ESP SPI eDMA transfer once its bytes are off the wire.
+ * Stands for the DMA interrupt: called wherever the node's time moves on.
+ */
+void Sim_DmaService(void);
+
+#endif /* SIM_HOOKS_H_ */
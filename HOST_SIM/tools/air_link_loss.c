@@ -0,0 +1,390 @@
+/*
+ * air_link_loss.c
+ *
+ * air_link.c, built unchanged, over an in-memory channel that drops copies
+ * (independently, or in bursts with -B). The payloads mix the bridge frames
+ * (a 24-byte command, a telemetry frame) and, with -b, fleet beacons up to
+ * AIR_LINK_MAX_PAYLOAD bytes, so the parity groups span frames of different
+ * lengths.
+ *
+ * Every delivered payload is checked byte for byte against the one sent:
+ *   - delivered as sent: same length
+ *   - rebuilt from a parity frame: the length of the longest frame of its
+ *     group, zero past its own, and omni_wire_frame_len() still finds the
+ *     bridge frame in it
+ *   - newer than the one delivered before, rx_lost equal to the gaps
+ * and the frames delivered and rebuilt are exactly those the drops allow:
+ * a frame with a copy through, or the last of a parity group whose other
+ * frames and parity frame came through (the receiver only takes a rebuilt
+ * frame if nothing newer got through). Exits 1 if a check failed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "air_link.h"
+#include "omni_wire.h"
+
+#define LOSS_FRAMES         200000U
+#define LOSS_BEACON_MIN     (OMNI_WIRE_MAX_FRAME + 1U)
+
+typedef struct
+{
+    uint8_t repeat;
+    uint8_t parityGroup;
+    uint32_t lossPct;
+} loss_case_t;
+
+static const loss_case_t s_cases[] = {
+    {1U, 0U, 5U}, {2U, 0U, 5U}, {1U, 4U, 5U}, {1U, 2U, 5U}, {2U, 4U, 5U},
+    {1U, 0U, 20U}, {2U, 0U, 20U}, {1U, 4U, 20U}, {1U, 2U, 20U}, {2U, 4U, 20U},
+};
+
+typedef struct
+{
+    uint32_t delivered;
+    uint32_t recovered;
+    uint32_t padded;            /* Rebuilt longer than sent */
+    uint32_t lost;              /* Gaps at delivery */
+    uint32_t badBytes;
+    uint32_t badLength;
+    uint32_t badBridgeFrame;
+    uint32_t notNewer;
+    uint32_t unexpected;        /* Delivered (or rebuilt) against the prediction, or missing */
+} loss_result_t;
+
+static uint32_t s_frames = LOSS_FRAMES;
+static uint32_t s_burst = 1U;
+static uint32_t s_beaconPct;
+static uint32_t s_seed = 1U;
+
+/* The case running */
+static const loss_case_t *s_case;
+static air_link_t s_tx;
+static air_link_t s_rx;
+static uint32_t s_now;
+static bool s_bad;                  /* Burst channel state */
+static uint32_t s_sending;          /* Frame on its way through air_link_send() */
+
+/* Per frame */
+static uint8_t *s_len;
+static uint8_t *s_arrived;          /* A data copy came through */
+static uint8_t *s_delivered;        /* 1 as sent, 2 rebuilt */
+static uint8_t *s_groupMax;         /* Longest payload of the frame's parity group */
+static uint8_t *s_parityArrived;    /* By group */
+
+static loss_result_t s_res;
+static bool s_haveLast;
+static uint32_t s_lastK;
+static uint32_t s_lastRecovered;
+
+static uint32_t NowUs(void)
+{
+    return s_now;
+}
+
+static uint8_t PayloadByte(uint32_t k, uint32_t i)
+{
+    return (uint8_t)(k * 31U + i * 7U + 1U);
+}
+
+/* Frame k: a bridge frame header (length, counter, type), k, then a pattern */
+static void MakePayload(uint32_t k, uint32_t len, uint8_t *buf)
+{
+    uint8_t type = (len > OMNI_WIRE_MAX_FRAME) ? OMNI_WIRE_TYPE_FLEET
+                   : (len == sizeof(RemoteCommand_t)) ? OMNI_WIRE_TYPE_COMMAND : OMNI_WIRE_TYPE_TELEMETRY;
+    uint32_t header = OMNI_WIRE_HEADER(type, k, len);
+
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + 4, &k, sizeof(k));
+    for (uint32_t i = 8U; i < len; i++)
+    {
+        buf[i] = PayloadByte(k, i);
+    }
+}
+
+static uint32_t PayloadLen(void)
+{
+    if ((uint32_t)(rand() % 100) < s_beaconPct)
+    {
+        return LOSS_BEACON_MIN + (uint32_t)rand() % (AIR_LINK_MAX_PAYLOAD - LOSS_BEACON_MIN + 1U);
+    }
+    return (rand() & 1) ? sizeof(RemoteCommand_t) : sizeof(RobotTelemetry_t);
+}
+
+/* Independent drops, or a two-state channel whose bad state lasts s_burst copies on average */
+static bool Dropped(void)
+{
+    double u = (double)rand() / ((double)RAND_MAX + 1.0);
+    double loss = (double)s_case->lossPct / 100.0;
+
+    if (s_burst <= 1U)
+    {
+        return u < loss;
+    }
+    double leave = 1.0 / (double)s_burst;
+    double enter = loss * leave / (1.0 - loss);
+    s_bad = s_bad ? (u >= leave) : (u < enter);
+    return s_bad;
+}
+
+static int ChannelSend(const uint8_t *frame, size_t len, void *ctx)
+{
+    const air_link_hdr_t *hdr = (const air_link_hdr_t *)frame;
+
+    (void)ctx;
+    if (Dropped())
+    {
+        return 0;
+    }
+    if ((hdr->type & 0x3U) == AIR_LINK_PARITY)
+    {
+        s_parityArrived[s_sending / s_case->parityGroup] = 1U;
+    }
+    else
+    {
+        s_arrived[s_sending] = 1U;
+    }
+    s_now += 10U;
+    (void)air_link_receive(&s_rx, frame, len);
+    return 0;
+}
+
+static void Deliver(const uint8_t *payload, size_t len, void *ctx)
+{
+    uint32_t k;
+    bool recovered = (s_rx.stats.rx_recovered != s_lastRecovered);
+
+    (void)ctx;
+    s_lastRecovered = s_rx.stats.rx_recovered;
+    s_res.delivered++;
+    if (len < 8U)
+    {
+        s_res.badLength++;
+        return;
+    }
+    memcpy(&k, payload + 4, sizeof(k));
+    if (k > s_sending)
+    {
+        s_res.badBytes++;
+        return;
+    }
+
+    if (s_haveLast)
+    {
+        if (k <= s_lastK)
+        {
+            s_res.notNewer++;
+        }
+        else
+        {
+            s_res.lost += k - s_lastK - 1U;
+        }
+    }
+    s_haveLast = true;
+    s_lastK = k;
+
+    uint32_t sent = s_len[k];
+    uint32_t want = recovered ? s_groupMax[k] : sent;
+    uint8_t expect[AIR_LINK_MAX_PAYLOAD];
+
+    if (len != want)
+    {
+        s_res.badLength++;
+    }
+    MakePayload(k, sent, expect);
+    memset(expect + sent, 0, sizeof(expect) - sent);
+    if (memcmp(payload, expect, (len < sizeof(expect)) ? len : sizeof(expect)) != 0)
+    {
+        s_res.badBytes++;
+    }
+    if (sent <= OMNI_WIRE_MAX_FRAME && omni_wire_frame_len(payload, len) != sent)
+    {
+        s_res.badBridgeFrame++;
+    }
+    if (recovered)
+    {
+        s_res.recovered++;
+        s_res.padded += (len > sent) ? 1U : 0U;
+    }
+    s_delivered[k] = recovered ? 2U : 1U;
+}
+
+/* What the drops allow: 1 delivered as sent, 2 rebuilt, 0 neither */
+static uint8_t Predicted(uint32_t k)
+{
+    uint32_t g = s_case->parityGroup;
+
+    if (s_arrived[k])
+    {
+        return 1U;
+    }
+    if (g == 0U || (k % g) != g - 1U || !s_parityArrived[k / g])
+    {
+        return 0U;
+    }
+    for (uint32_t j = k - (g - 1U); j < k; j++)
+    {
+        if (!s_arrived[j])
+        {
+            return 0U;
+        }
+    }
+    return 2U;
+}
+
+static bool RunCase(const loss_case_t *c)
+{
+    const air_link_config_t cfg = {
+        .repeat = c->repeat,
+        .parity_group = c->parityGroup,
+        .send = ChannelSend,
+        .now_us = NowUs,
+        .deliver = Deliver,
+    };
+    uint8_t payload[AIR_LINK_MAX_PAYLOAD];
+    uint32_t frames = s_frames;
+
+    s_case = c;
+    if (c->parityGroup != 0U)
+    {
+        frames -= frames % c->parityGroup; /* Whole groups */
+    }
+    memset(s_arrived, 0, s_frames);
+    memset(s_delivered, 0, s_frames);
+    memset(s_parityArrived, 0, s_frames);
+    s_res = (loss_result_t){0};
+    s_haveLast = false;
+    s_lastRecovered = 0U;
+    s_bad = false;
+    s_now = 0U;
+    srand(s_seed);
+
+    for (uint32_t k = 0; k < frames; k++)
+    {
+        s_len[k] = (uint8_t)PayloadLen();
+    }
+    for (uint32_t k = 0; k < frames; k++)
+    {
+        uint32_t g = (c->parityGroup != 0U) ? c->parityGroup : 1U;
+        uint32_t first = k - k % g;
+        uint8_t longest = 0U;
+
+        for (uint32_t j = first; j < first + g; j++)
+        {
+            if (s_len[j] > longest) longest = s_len[j];
+        }
+        s_groupMax[k] = longest;
+    }
+
+    air_link_init(&s_tx, &cfg);
+    air_link_init(&s_rx, &cfg);
+    for (uint32_t k = 0; k < frames; k++)
+    {
+        s_sending = k;
+        s_now += 1000U;
+        MakePayload(k, s_len[k], payload);
+        (void)air_link_send(&s_tx, payload, s_len[k]);
+    }
+
+    for (uint32_t k = 0; k < frames; k++)
+    {
+        if (s_delivered[k] != Predicted(k))
+        {
+            s_res.unexpected++;
+        }
+    }
+
+    air_link_stats_t rx;
+    air_link_get_stats(&s_rx, &rx);
+    uint32_t failures = s_res.badBytes + s_res.badLength + s_res.badBridgeFrame + s_res.notNewer + s_res.unexpected +
+                        ((rx.rx_lost != s_res.lost) ? 1U : 0U) + ((rx.rx_recovered != s_res.recovered) ? 1U : 0U);
+
+    printf("%6u %6u %5u %% %9u %8.2f %% %9u %7u %8.2f %% %s\n", (unsigned)c->repeat, (unsigned)c->parityGroup,
+           (unsigned)c->lossPct, (unsigned)frames, 100.0 * (double)s_res.delivered / (double)frames,
+           (unsigned)s_res.recovered, (unsigned)s_res.padded, 100.0 * (double)s_res.lost / (double)frames,
+           (failures == 0U) ? "ok" : "FAIL");
+    if (failures != 0U)
+    {
+        printf("  bytes %u, length %u, bridge frame %u, not newer %u, against the prediction %u, "
+               "rx_lost %u / %u, rx_recovered %u / %u\n",
+               (unsigned)s_res.badBytes, (unsigned)s_res.badLength, (unsigned)s_res.badBridgeFrame,
+               (unsigned)s_res.notNewer, (unsigned)s_res.unexpected, (unsigned)rx.rx_lost, (unsigned)s_res.lost,
+               (unsigned)rx.rx_recovered, (unsigned)s_res.recovered);
+    }
+    return failures == 0U;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-n N] [-B N] [-b PCT] [-s SEED] [-r N -g N -l PCT]\n"
+           "  -n N     frames per case (default %u)\n"
+           "  -B N     mean burst of lost copies, 1 = independent (default 1)\n"
+           "  -b PCT   fleet beacons of %u..%u bytes among the frames (default 0)\n"
+           "  -s SEED  random seed (default 1)\n"
+           "  -r N     one case: copies of every frame\n"
+           "  -g N     one case: parity group, 0 = off\n"
+           "  -l PCT   one case: copies lost\n",
+           prog, LOSS_FRAMES, (unsigned)LOSS_BEACON_MIN, (unsigned)AIR_LINK_MAX_PAYLOAD);
+}
+
+int main(int argc, char **argv)
+{
+    loss_case_t one = {1U, 0U, 10U};
+    bool single = false;
+    int failures = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:B:b:s:r:g:l:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': s_frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'B': s_burst = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': s_beaconPct = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': s_seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': one.repeat = (uint8_t)strtoul(optarg, NULL, 0); single = true; break;
+            case 'g': one.parityGroup = (uint8_t)strtoul(optarg, NULL, 0); single = true; break;
+            case 'l': one.lossPct = (uint32_t)strtoul(optarg, NULL, 0); single = true; break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_frames < AIR_LINK_MAX_GROUP || s_beaconPct > 100U || one.lossPct >= 100U || one.repeat == 0U ||
+        one.repeat > AIR_LINK_MAX_REPEAT || one.parityGroup == 1U || one.parityGroup > AIR_LINK_MAX_GROUP)
+    {
+        fprintf(stderr, "-n/-b/-r/-g/-l: see -h\n");
+        return 1;
+    }
+
+    s_len = calloc(s_frames, 1);
+    s_arrived = calloc(s_frames, 1);
+    s_delivered = calloc(s_frames, 1);
+    s_groupMax = calloc(s_frames, 1);
+    s_parityArrived = calloc(s_frames, 1);
+    if (!s_len || !s_arrived || !s_delivered || !s_groupMax || !s_parityArrived)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    printf("burst %u, beacons %u %%, seed %u\n", (unsigned)s_burst, (unsigned)s_beaconPct, (unsigned)s_seed);
+    printf("%6s %6s %7s %9s %10s %9s %7s %10s\n", "repeat", "parity", "loss", "frames", "delivered", "rebuilt",
+           "padded", "lost");
+    if (single)
+    {
+        failures += RunCase(&one) ? 0 : 1;
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++)
+        {
+            failures += RunCase(&s_cases[i]) ? 0 : 1;
+        }
+    }
+    return (failures == 0) ? 0 : 1;
+}
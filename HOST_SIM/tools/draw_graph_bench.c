@@ -0,0 +1,255 @@
+/*
+ * draw_graph_bench.c
+ *
+ * The remote's LVGL built for the host with several software draw units
+ * (lv_conf_draw_units.h: pthreads, DRAW_UNITS units), to check the draw
+ * task dependency graph of lv_draw.c against the linear scan it replaces.
+ * The display is the remote's (480 x 320, rotated 270, partial buffer of
+ * 48 lines by default) with a flush that only hashes the pixels.
+ *
+ *   widgets  400 overlapping styled objects, a quarter of them recoloured
+ *            and the whole screen redrawn every frame
+ *   gui      RobotGUI.c as on the remote: RobotGUI_Update() then a refresh
+ *
+ * The same binary runs the frames -r times: every widgets run must hash
+ * the same, whatever order the draw units took the tasks in (the GUI's
+ * chart keeps its history, so its runs don't start alike). The digest of
+ * the first run's frames is printed so builds can be compared: with
+ * -DLV_DRAW_TASK_GRAPH=0 (the linear scan) and with -DDRAW_UNITS=1 (tasks
+ * in order, no graph) it must be the same. Reports the refresh time per
+ * frame. Exits 1 if a run differs.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl.h"
+#include "src/draw/lv_draw_private.h"     /* LV_DRAW_TASK_GRAPH */
+#include "RobotGUI.h"
+
+#define BENCH_FRAMES        500U
+#define BENCH_RUNS          3U
+#define BENCH_WIDGETS       400U
+#define BENCH_COLS          20U
+#define BENCH_HOR_RES       480         /* As lvgl_support.c: ST7796 height x width, rotated 270 */
+#define BENCH_VER_RES       320
+#define BENCH_BUF_LINES     48          /* Of the panel's 320 pixels, as the remote's buffer */
+
+static uint8_t s_buf[BENCH_HOR_RES * BENCH_VER_RES * 2];    /* Up to a full frame */
+static lv_display_t *s_disp;
+static uint64_t s_hash;
+static uint32_t s_frames = BENCH_FRAMES;
+static uint32_t s_runs = BENCH_RUNS;
+static uint32_t s_bufLines = BENCH_BUF_LINES;
+
+static lv_obj_t *s_widgets[BENCH_WIDGETS];
+static lv_style_t s_widgetStyle;
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t TickMs(void)
+{
+    return (uint32_t)(NowNs() / 1000000U);
+}
+
+/* FNV-1a over the area and its pixels */
+static void Flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t bytes = (uint32_t)lv_area_get_size(area) * 2U;
+    uint64_t h = s_hash;
+
+    h = (h ^ (uint64_t)(uint32_t)area->x1 ^ ((uint64_t)(uint32_t)area->y1 << 32)) * 1099511628211ULL;
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        h = (h ^ px_map[i]) * 1099511628211ULL;
+    }
+    s_hash = h;
+    lv_display_flush_ready(display);
+}
+
+/* Frame k: stick-like values */
+static void Values(uint32_t k, float v[3])
+{
+    v[0] = (float)((int32_t)((k * 37U) % 201U) - 100) / 100.0f;
+    v[1] = (float)((int32_t)((k * 53U + 17U) % 201U) - 100) / 100.0f;
+    v[2] = (float)((int32_t)((k * 11U + 5U) % 401U) - 200) / 100.0f;
+}
+
+/* A grid of rounded, bordered, semi-transparent objects, each overlapping its neighbours */
+static void WidgetsCreate(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+    const int32_t rows = (int32_t)(BENCH_WIDGETS / BENCH_COLS);
+    const int32_t w = BENCH_HOR_RES / (int32_t)BENCH_COLS;
+    const int32_t h = BENCH_VER_RES / rows;
+
+    lv_style_init(&s_widgetStyle);
+    lv_style_set_radius(&s_widgetStyle, 4);
+    lv_style_set_bg_opa(&s_widgetStyle, LV_OPA_70);
+    lv_style_set_border_width(&s_widgetStyle, 1);
+    lv_style_set_border_color(&s_widgetStyle, lv_color_white());
+    lv_style_set_border_opa(&s_widgetStyle, LV_OPA_50);
+
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x1E1E1E), 0);
+    for (uint32_t i = 0; i < BENCH_WIDGETS; i++)
+    {
+        lv_obj_t *o = lv_obj_create(scr);
+        int32_t c = (int32_t)(i % BENCH_COLS);
+        int32_t r = (int32_t)(i / BENCH_COLS);
+
+        lv_obj_remove_style_all(o);
+        lv_obj_set_pos(o, c * w - w / 4, r * h - h / 4);
+        lv_obj_set_size(o, w + w / 2, h + h / 2);
+        lv_obj_add_style(o, &s_widgetStyle, 0);
+        s_widgets[i] = o;
+    }
+    lv_screen_load(scr);
+}
+
+static void WidgetsFrame(uint32_t k)
+{
+    for (uint32_t i = 0; i < BENCH_WIDGETS; i++)
+    {
+        /* Every widget gets a colour from k, a quarter of them change per frame */
+        uint32_t c = ((i + (k + (i & 3U)) / 4U) * 2654435761U) >> 8;
+        lv_obj_set_style_bg_color(s_widgets[i], lv_color_hex(c & 0xFFFFFFU), 0);
+    }
+    lv_obj_invalidate(lv_screen_active());
+}
+
+static void GuiFrame(uint32_t k)
+{
+    float v[3];
+
+    Values(k, v);
+    RobotGUI_Update(v[0], v[1], v[2]);
+}
+
+static int CompareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* s_runs runs of the same frames; returns the runs whose pixels differ from the first */
+static uint32_t Run(const char *name, void (*frame)(uint32_t k), bool compare)
+{
+    uint32_t *ns = malloc(s_frames * s_runs * sizeof(uint32_t));
+    uint64_t *hash = malloc(s_frames * sizeof(uint64_t));
+    uint64_t digest = 14695981039346656037ULL;
+    uint32_t differ = 0U;
+
+    for (uint32_t run = 0; run < s_runs; run++)
+    {
+        bool same = true;
+
+        /* Start every run from a drawn screen, not timed */
+        frame(s_frames);
+        lv_obj_invalidate(lv_screen_active());
+        lv_refr_now(s_disp);
+
+        for (uint32_t k = 0; k < s_frames; k++)
+        {
+            frame(k);
+            s_hash = 14695981039346656037ULL;
+            uint64_t t0 = NowNs();
+            lv_refr_now(s_disp);
+            ns[run * s_frames + k] = (uint32_t)(NowNs() - t0);
+
+            if (run == 0U)
+            {
+                hash[k] = s_hash;
+                digest = (digest ^ s_hash) * 1099511628211ULL;
+            }
+            else if (compare && hash[k] != s_hash)
+            {
+                same = false;
+            }
+        }
+        differ += same ? 0U : 1U;
+    }
+    free(hash);
+
+    uint32_t n = s_frames * s_runs;
+    uint64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        sum += ns[i];
+    }
+    qsort(ns, n, sizeof(uint32_t), CompareU32);
+    printf("%-8s %8.1f %8.1f %8.1f  %016llx %s\n", name, (double)sum / (double)n / 1000.0, ns[n / 2U] / 1000.0,
+           ns[(n * 99U) / 100U] / 1000.0, (unsigned long long)digest,
+           !compare ? "-" : (differ == 0U) ? "same" : "DIFFER");
+    if (differ != 0U)
+    {
+        printf("  %u of %u runs differ from the first\n", (unsigned)differ, (unsigned)s_runs);
+    }
+    free(ns);
+    return differ;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-n N] [-r N] [-b LINES]\n"
+           "  -n N       frames per run (default %u)\n"
+           "  -r N       runs, all must hash the same (default %u)\n"
+           "  -b LINES   buffer lines of the panel's 320 pixels, %u for a full frame (default %u)\n",
+           prog, BENCH_FRAMES, BENCH_RUNS, (unsigned)BENCH_HOR_RES, (unsigned)BENCH_BUF_LINES);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t differ = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:r:b:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': s_frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': s_runs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': s_bufLines = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_frames == 0U || s_runs == 0U || s_bufLines == 0U || s_bufLines > (uint32_t)BENCH_HOR_RES)
+    {
+        fprintf(stderr, "-n/-r/-b: see -h\n");
+        return 1;
+    }
+
+    lv_init();
+    lv_tick_set_cb(TickMs);
+    s_disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    lv_display_set_rotation(s_disp, LV_DISPLAY_ROTATION_270);
+    lv_display_set_flush_cb(s_disp, Flush);
+    lv_display_set_buffers(s_disp, s_buf, NULL, (uint32_t)BENCH_VER_RES * s_bufLines * 2U,
+                           LV_DISPLAY_RENDER_MODE_PARTIAL);
+
+    printf("%u draw units, %s, %u lines buffer, %u frames x %u runs, %ld CPUs, times in us per refresh\n",
+           (unsigned)LV_DRAW_SW_DRAW_UNIT_CNT,
+           (LV_DRAW_SW_DRAW_UNIT_CNT == 1) ? "tasks in order" : LV_DRAW_TASK_GRAPH ? "task graph" : "linear scan",
+           (unsigned)s_bufLines, (unsigned)s_frames, (unsigned)s_runs, sysconf(_SC_NPROCESSORS_ONLN));
+    printf("%-8s %8s %8s %8s  %-16s %s\n", "", "mean", "p50", "p99", "digest", "runs");
+
+    WidgetsCreate();
+    differ += Run("widgets", WidgetsFrame, true);
+
+    lv_screen_load(lv_obj_create(NULL));
+    RobotGUI_Init();
+    differ += Run("gui", GuiFrame, false);
+
+    return (differ == 0U) ? 0 : 1;
+}
@@ -0,0 +1,428 @@
+/*
+ * esp_spi_test.c
+ *
+ * Unit test of the frame queue of ESP_SPI.c, built unchanged, on both of its
+ * transports under the host LPSPI (sim/mcu_sim.c):
+ *
+ *   eDMA       frames complete one frame time apart on a clock of the test's
+ *              own; checked: queue depth and kStatus_LPSPI_Busy, completion
+ *              order and time, buffers, sizes and status in the callbacks,
+ *              NULL buffers refused, a callback queueing the next one.
+ *   interrupt  ESP_SPI_MasterIRQHandler() raised by the LPSPI FIFO model
+ *              (Sim_LpspiClock()) after 1 to 6 bytes of latency; checked:
+ *              every size from 1 to ESP_SPI_TRANSFER_SIZE as one PCS period
+ *              with its bytes both ways, queued frames back to back, the PCS
+ *              release deferred to the next interrupt when the TX FIFO was
+ *              full, no FIFO overflow or underflow.
+ *
+ * The slave answers byte i of its n-th PCS period with a pattern of both, so
+ * every received byte is checked. Exits 1 if a check failed.
+ */
+
+#include "ESP_SPI.h"
+#include "sim_hooks.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_QUEUED         (ESP_SPI_QUEUE_LEN + 2U)
+#define TEST_FRAMES_MAX     64U
+#define TEST_LATENCY_MAX    6U      /* Bytes shifted before the interrupt runs */
+#define TEST_CLOCK_GUARD    100000U
+
+/* A frame as the slave saw it */
+typedef struct
+{
+    uint8_t mosi[ESP_SPI_TRANSFER_SIZE * 2U];
+    uint32_t len;
+} slave_frame_t;
+
+/* A completion callback */
+typedef struct
+{
+    uint8_t *txData;
+    uint8_t *rxData;
+    uint32_t size;
+    status_t status;
+    void *userData;
+    uint64_t us;
+} done_t;
+
+static uint64_t s_nowUs;
+static slave_frame_t s_slave[TEST_FRAMES_MAX];
+static uint32_t s_slaveFrames;
+static done_t s_done[TEST_FRAMES_MAX];
+static uint32_t s_doneCount;
+static uint32_t s_failures;
+static int s_verbose;
+
+/* Frames the callback queues next: ping-pong */
+static uint32_t s_chainLeft;
+static uint8_t s_tx[TEST_QUEUED][ESP_SPI_TRANSFER_SIZE];
+static uint8_t s_rx[TEST_QUEUED][ESP_SPI_TRANSFER_SIZE];
+
+static void Check(bool ok, const char *what, uint32_t a, uint32_t b)
+{
+    if (!ok)
+    {
+        s_failures++;
+        printf("  FAIL: %s (%u, %u)\n", what, (unsigned)a, (unsigned)b);
+    }
+}
+
+static uint64_t NowUs(void)
+{
+    return s_nowUs;
+}
+
+static uint8_t SlaveByte(uint32_t frame, uint32_t i)
+{
+    return (uint8_t)(0xA5U ^ (frame * 7U) ^ (i * 13U));
+}
+
+/* eDMA transport: the whole frame */
+static void SlaveXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    slave_frame_t *f = &s_slave[s_slaveFrames % TEST_FRAMES_MAX];
+
+    memcpy(f->mosi, tx, len);
+    f->len = len;
+    for (uint32_t i = 0; i < len; i++)
+    {
+        rx[i] = SlaveByte(s_slaveFrames, i);
+    }
+    s_slaveFrames++;
+}
+
+/* Interrupt transport: byte by byte */
+static uint8_t SlaveByteHook(uint8_t tx, bool first)
+{
+    if (first)
+    {
+        s_slave[s_slaveFrames % TEST_FRAMES_MAX].len = 0U;
+        s_slaveFrames++;
+    }
+    slave_frame_t *f = &s_slave[(s_slaveFrames - 1U) % TEST_FRAMES_MAX];
+    uint32_t i = f->len;
+
+    if (i < sizeof(f->mosi))
+    {
+        f->mosi[i] = tx;
+        f->len++;
+    }
+    return SlaveByte(s_slaveFrames - 1U, i);
+}
+
+static void Callback(uint8_t *txData, uint8_t *rxData, uint32_t size, status_t status, void *userData)
+{
+    if (s_doneCount < TEST_FRAMES_MAX)
+    {
+        s_done[s_doneCount] = (done_t){txData, rxData, size, status, userData, s_nowUs};
+    }
+    s_doneCount++;
+
+    if (s_chainLeft != 0U)
+    {
+        uint32_t k = s_doneCount % TEST_QUEUED;
+
+        s_chainLeft--;
+        Check(ESP_SPI_QueueTransfer(s_tx[k], s_rx[k], ESP_SPI_TRANSFER_SIZE, Callback, (void *)(uintptr_t)k) ==
+                  kStatus_Success,
+              "callback queues the next frame", s_doneCount, 0U);
+    }
+}
+
+static void Reset(void)
+{
+    s_slaveFrames = 0U;
+    s_doneCount = 0U;
+    s_chainLeft = 0U;
+    for (uint32_t k = 0; k < TEST_QUEUED; k++)
+    {
+        for (uint32_t i = 0; i < ESP_SPI_TRANSFER_SIZE; i++)
+        {
+            s_tx[k][i] = (uint8_t)(k * 40U + i + 1U);
+        }
+        memset(s_rx[k], 0, ESP_SPI_TRANSFER_SIZE);
+    }
+}
+
+/* Slave frame n carried frame k of s_tx, and its answer is in s_rx[k] */
+static void CheckFrame(uint32_t n, uint32_t k, uint32_t size)
+{
+    const slave_frame_t *f = &s_slave[n];
+
+    Check(f->len == size, "PCS period length", f->len, size);
+    Check(memcmp(f->mosi, s_tx[k], size) == 0, "MOSI bytes", n, k);
+    for (uint32_t i = 0; i < size; i++)
+    {
+        if (s_rx[k][i] != SlaveByte(n, i))
+        {
+            Check(false, "MISO byte", n, i);
+            break;
+        }
+    }
+}
+
+static void CheckDone(uint32_t d, uint32_t k, uint32_t size, status_t status)
+{
+    const done_t *done = &s_done[d];
+
+    Check(done->txData == s_tx[k], "callback txData", d, k);
+    Check(done->rxData == s_rx[k], "callback rxData", d, k);
+    Check(done->size == size, "callback size", done->size, size);
+    Check(done->status == status, "callback status", (uint32_t)done->status, (uint32_t)status);
+    Check(done->userData == (void *)(uintptr_t)k, "callback userData", d, k);
+}
+
+/*
+ * eDMA transport
+ */
+static void RunDma(uint64_t untilUs)
+{
+    while (s_nowUs < untilUs)
+    {
+        s_nowUs++;
+        Sim_DmaService();
+    }
+}
+
+static void TestDmaQueue(void)
+{
+    static const uint32_t sizes[ESP_SPI_QUEUE_LEN] = {40U, 28U, 1U, 40U};
+    uint64_t expectUs = s_nowUs;
+
+    printf("eDMA: queue of %u, busy when full, completions back to back\n", (unsigned)ESP_SPI_QUEUE_LEN);
+    Reset();
+    for (uint32_t k = 0; k < ESP_SPI_QUEUE_LEN; k++)
+    {
+        Check(ESP_SPI_QueueTransfer(s_tx[k], s_rx[k], sizes[k], Callback, (void *)(uintptr_t)k) == kStatus_Success,
+              "queue", k, 0U);
+    }
+    Check(ESP_SPI_QueueTransfer(s_tx[4], s_rx[4], 8U, Callback, NULL) == kStatus_LPSPI_Busy, "busy when full",
+          ESP_SPI_GetQueuedCount(), 0U);
+    Check(ESP_SPI_GetQueuedCount() == ESP_SPI_QUEUE_LEN, "queued count", ESP_SPI_GetQueuedCount(),
+          ESP_SPI_QUEUE_LEN);
+    Check(!ESP_SPI_IsTransferCompleted(), "not completed", 0U, 0U);
+    Check(s_slaveFrames == 1U, "only the head is on the bus", s_slaveFrames, 1U);
+
+    RunDma(s_nowUs + 1000U);
+    Check(s_doneCount == ESP_SPI_QUEUE_LEN, "callbacks", s_doneCount, ESP_SPI_QUEUE_LEN);
+    for (uint32_t k = 0; k < ESP_SPI_QUEUE_LEN && k < s_doneCount; k++)
+    {
+        expectUs += Sim_SpiFrameUs(sizes[k]);
+        CheckDone(k, k, sizes[k], kStatus_Success);
+        CheckFrame(k, k, sizes[k]);
+        Check(s_done[k].us == expectUs, "completion time", (uint32_t)s_done[k].us, (uint32_t)expectUs);
+    }
+    Check(ESP_SPI_IsTransferCompleted(), "completed", 0U, 0U);
+    Check(ESP_SPI_GetQueuedCount() == 0U, "queue empty", ESP_SPI_GetQueuedCount(), 0U);
+}
+
+static void TestDmaArguments(void)
+{
+    printf("eDMA: NULL buffers refused at the queue, size 0 clocks the largest frame\n");
+    Reset();
+    Check(ESP_SPI_QueueTransfer(s_tx[0], s_rx[0], 16U, Callback, (void *)0) == kStatus_Success, "queue", 0U, 0U);
+    Check(ESP_SPI_QueueTransfer(NULL, s_rx[1], 16U, Callback, (void *)1) == kStatus_InvalidArgument, "NULL txData",
+          1U, 0U);
+    Check(ESP_SPI_QueueTransfer(s_tx[1], NULL, 16U, Callback, (void *)1) == kStatus_InvalidArgument, "NULL rxData",
+          1U, 0U);
+    Check(ESP_SPI_GetQueuedCount() == 1U, "queued count", ESP_SPI_GetQueuedCount(), 1U);
+    Check(ESP_SPI_QueueTransfer(s_tx[2], s_rx[2], 0U, Callback, (void *)2) == kStatus_Success, "queue", 2U, 0U);
+    RunDma(s_nowUs + 1000U);
+
+    Check(s_doneCount == 2U, "callbacks", s_doneCount, 2U);
+    Check(s_slaveFrames == 2U, "frames on the bus", s_slaveFrames, 2U);
+    if (s_doneCount == 2U && s_slaveFrames == 2U)
+    {
+        CheckDone(0, 0, 16U, kStatus_Success);
+        CheckDone(1, 2, ESP_SPI_TRANSFER_SIZE, kStatus_Success);
+        CheckFrame(0, 0, 16U);
+        CheckFrame(1, 2, ESP_SPI_TRANSFER_SIZE);
+    }
+    Check(ESP_SPI_IsTransferCompleted(), "completed", 0U, 0U);
+}
+
+static void TestDmaChain(void)
+{
+    const uint32_t frames = 20U;
+
+    printf("eDMA: %u frames, each queued from the callback of the one before\n", (unsigned)frames);
+    Reset();
+    s_chainLeft = frames - 1U;
+    Check(ESP_SPI_QueueTransfer(s_tx[0], s_rx[0], ESP_SPI_TRANSFER_SIZE, Callback, (void *)0) == kStatus_Success,
+          "queue", 0U, 0U);
+    RunDma(s_nowUs + frames * Sim_SpiFrameUs(ESP_SPI_TRANSFER_SIZE) + 10U);
+
+    Check(s_doneCount == frames, "callbacks", s_doneCount, frames);
+    Check(s_slaveFrames == frames, "frames on the bus", s_slaveFrames, frames);
+    for (uint32_t d = 1; d < frames && d < s_doneCount; d++)
+    {
+        Check(s_done[d].us - s_done[d - 1U].us == Sim_SpiFrameUs(ESP_SPI_TRANSFER_SIZE), "back to back", d,
+              (uint32_t)(s_done[d].us - s_done[d - 1U].us));
+    }
+    Check(ESP_SPI_IsTransferCompleted(), "completed", 0U, 0U);
+}
+
+/*
+ * Interrupt transport
+ */
+
+/* Clocks until the queue is empty and the PCS released, `latency` bytes per interrupt */
+static void RunIrq(uint32_t latency)
+{
+    uint32_t guard = 0;
+
+    while ((!ESP_SPI_IsTransferCompleted() || LPSPI_GetTxFifoCount(LPSPI1) != 0U) && guard++ < TEST_CLOCK_GUARD)
+    {
+        (void)Sim_LpspiClock(LPSPI1, latency);
+    }
+    (void)Sim_LpspiClock(LPSPI1, latency);
+    Check(guard < TEST_CLOCK_GUARD, "transfer stuck", latency, ESP_SPI_GetQueuedCount());
+}
+
+static void TestIrqSizes(void)
+{
+    SimLpspiStats_t before;
+    SimLpspiStats_t after;
+    uint32_t deferredSizes = 0U;
+    uint32_t irqs40 = 0U;
+
+    printf("interrupt: sizes 1..%u, %u..%u bytes of interrupt latency\n", (unsigned)ESP_SPI_TRANSFER_SIZE, 1U,
+           (unsigned)TEST_LATENCY_MAX);
+    for (uint32_t latency = 1U; latency <= TEST_LATENCY_MAX; latency++)
+    {
+        for (uint32_t size = 1U; size <= ESP_SPI_TRANSFER_SIZE; size++)
+        {
+            Reset();
+            Sim_LpspiStats(LPSPI1, &before);
+            Check(ESP_SPI_QueueTransfer(s_tx[0], s_rx[0], size, Callback, (void *)0) == kStatus_Success, "queue",
+                  size, latency);
+            RunIrq(latency);
+            Sim_LpspiStats(LPSPI1, &after);
+
+            Check(s_doneCount == 1U, "callbacks", s_doneCount, size);
+            Check(s_slaveFrames == 1U, "one PCS period", s_slaveFrames, size);
+            Check(after.frames - before.frames == 1U, "PCS released", after.frames - before.frames, size);
+            if (s_doneCount == 1U && s_slaveFrames == 1U)
+            {
+                CheckDone(0, 0, size, kStatus_Success);
+                CheckFrame(0, 0, size);
+            }
+            if (after.pcsDeferred != before.pcsDeferred)
+            {
+                deferredSizes++;
+            }
+            if (latency == 1U && size == ESP_SPI_TRANSFER_SIZE)
+            {
+                irqs40 = after.irqs - before.irqs;
+            }
+            if (s_verbose)
+            {
+                printf("  latency %u size %2u: %u interrupts%s\n", (unsigned)latency, (unsigned)size,
+                       (unsigned)(after.irqs - before.irqs),
+                       (after.pcsDeferred != before.pcsDeferred) ? ", PCS release deferred" : "");
+            }
+        }
+    }
+    Check(deferredSizes != 0U, "deferred PCS release exercised", deferredSizes, 0U);
+    printf("  PCS release deferred in %u of %u frames; a %u-byte frame takes %u interrupts (eDMA: 1)\n",
+           (unsigned)deferredSizes, (unsigned)(TEST_LATENCY_MAX * ESP_SPI_TRANSFER_SIZE),
+           (unsigned)ESP_SPI_TRANSFER_SIZE, (unsigned)irqs40);
+}
+
+static void TestIrqQueue(void)
+{
+    static const uint32_t sizes[ESP_SPI_QUEUE_LEN] = {40U, 3U, 1U, 28U};
+
+    printf("interrupt: queued frames back to back, each its own PCS period\n");
+    for (uint32_t latency = 1U; latency <= TEST_LATENCY_MAX; latency++)
+    {
+        Reset();
+        for (uint32_t k = 0; k < ESP_SPI_QUEUE_LEN; k++)
+        {
+            Check(ESP_SPI_QueueTransfer(s_tx[k], s_rx[k], sizes[k], Callback, (void *)(uintptr_t)k) ==
+                      kStatus_Success,
+                  "queue", k, latency);
+        }
+        Check(ESP_SPI_QueueTransfer(s_tx[4], s_rx[4], 8U, Callback, NULL) == kStatus_LPSPI_Busy, "busy when full",
+              latency, 0U);
+        RunIrq(latency);
+
+        Check(s_doneCount == ESP_SPI_QUEUE_LEN, "callbacks", s_doneCount, latency);
+        Check(s_slaveFrames == ESP_SPI_QUEUE_LEN, "PCS periods", s_slaveFrames, latency);
+        for (uint32_t k = 0; k < ESP_SPI_QUEUE_LEN && k < s_doneCount && k < s_slaveFrames; k++)
+        {
+            CheckDone(k, k, sizes[k], kStatus_Success);
+            CheckFrame(k, k, sizes[k]);
+        }
+    }
+}
+
+static void TestIrqChain(void)
+{
+    const uint32_t frames = 20U;
+
+    printf("interrupt: %u frames, each queued from the callback of the one before\n", (unsigned)frames);
+    Reset();
+    s_chainLeft = frames - 1U;
+    Check(ESP_SPI_QueueTransfer(s_tx[0], s_rx[0], ESP_SPI_TRANSFER_SIZE, Callback, (void *)0) == kStatus_Success,
+          "queue", 0U, 0U);
+    RunIrq(2U);
+
+    Check(s_doneCount == frames, "callbacks", s_doneCount, frames);
+    Check(s_slaveFrames == frames, "PCS periods", s_slaveFrames, frames);
+    /* Frame n went through buffer n % TEST_QUEUED: the last TEST_QUEUED still hold theirs */
+    for (uint32_t n = frames - TEST_QUEUED; n < frames && n < s_slaveFrames; n++)
+    {
+        CheckFrame(n, n % TEST_QUEUED, ESP_SPI_TRANSFER_SIZE);
+    }
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-v]\n"
+           "  -v   interrupts per frame size and latency\n",
+           prog);
+}
+
+int main(int argc, char **argv)
+{
+    const esp_spi_edma_config_t dma = {DMA0, 0U, 1U, kDma0RequestMuxLpFlexcomm1Rx, kDma0RequestMuxLpFlexcomm1Tx};
+    SimLpspiStats_t stats;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'v': s_verbose = 1; break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    g_simHooks.now_us = NowUs;
+    g_simHooks.spi_xfer = SlaveXfer;
+    g_simHooks.spi_byte = SlaveByteHook;
+
+    ESP_SPI_InitEDMA(LPSPI1, 150000000U, kLPSPI_Pcs0, &dma);
+    TestDmaQueue();
+    TestDmaArguments();
+    TestDmaChain();
+
+    ESP_SPI_Init(LPSPI1, 150000000U, kLPSPI_Pcs0);
+    TestIrqSizes();
+    TestIrqQueue();
+    TestIrqChain();
+
+    Sim_LpspiStats(LPSPI1, &stats);
+    Check(stats.txOverflows == 0U, "TX FIFO overflows", stats.txOverflows, 0U);
+    Check(stats.rxUnderflows == 0U, "RX FIFO underflows", stats.rxUnderflows, 0U);
+
+    printf("%s: %u failed checks\n", (s_failures == 0U) ? "ok" : "FAIL", (unsigned)s_failures);
+    return (s_failures == 0U) ? 0 : 1;
+}
@@ -0,0 +1,317 @@
+/*
+ * glyph_cache_bench.c
+ *
+ * Text draw time of the remote's GUI with the rendered-glyph cache
+ * (lv_font_glyph_cache.c) off and on. LVGL and its lv_conf.h are the
+ * remote's, built for the host; the display is the remote's (480 x 320,
+ * rotated 270, 48-line partial buffer) with a flush that only hashes the
+ * pixels.
+ *
+ *   labels  a screen of value labels in lv_font_montserrat_14, all of them
+ *           rewritten every frame: the text path alone
+ *   gui     RobotGUI.c as on the remote: RobotGUI_Update() then a refresh,
+ *           the chart included
+ *   glyph   one glyph of the labels, what draw_letter() does before blending:
+ *           decoded from the font (off) or looked up in the cache (on)
+ *
+ * The cache is switched with lv_font_glyph_cache_resize() in the same
+ * binary. Off and on run the same frames in alternating blocks, each block
+ * from the same starting screen, so the host's drift hits both alike and
+ * the labels frames must come out with the same pixels. Reports the
+ * refresh time per frame and the cache counters. Exits 1 if a frame
+ * differs.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "lvgl.h"
+#include "RobotGUI.h"
+
+#define BENCH_FRAMES        4000U
+#define BENCH_BLOCK         200U        /* Frames per off / on block */
+#define BENCH_LABELS        12U
+#define BENCH_HOR_RES       480         /* As lvgl_support.c: ST7796 height x width, rotated 270 */
+#define BENCH_VER_RES       320
+#define BENCH_BUF_PIXELS    (320 * 48)
+#define BENCH_GLYPH_ROUNDS  20000U
+
+typedef enum
+{
+    BENCH_OFF,
+    BENCH_ON,
+    BENCH_PASSES
+} bench_pass_t;
+
+static uint8_t s_buf[BENCH_BUF_PIXELS * 2];
+static lv_display_t *s_disp;
+static uint64_t s_hash;
+static uint32_t s_frames = BENCH_FRAMES;
+static uint32_t s_cacheSize = LV_FONT_GLYPH_CACHE_SIZE;
+
+static lv_obj_t *s_labels[BENCH_LABELS];
+static char s_text[BENCH_LABELS][16];
+static volatile uint32_t s_sink;        /* Keeps the glyph reads */
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t TickMs(void)
+{
+    return (uint32_t)(NowNs() / 1000000U);
+}
+
+/* FNV-1a over the area and its pixels */
+static void Flush(lv_display_t *display, const lv_area_t *area, uint8_t *px_map)
+{
+    uint32_t bytes = (uint32_t)lv_area_get_size(area) * 2U;
+    uint64_t h = s_hash;
+
+    h = (h ^ (uint64_t)(uint32_t)area->x1 ^ ((uint64_t)(uint32_t)area->y1 << 32)) * 1099511628211ULL;
+    for (uint32_t i = 0; i < bytes; i++)
+    {
+        h = (h ^ px_map[i]) * 1099511628211ULL;
+    }
+    s_hash = h;
+    lv_display_flush_ready(display);
+}
+
+/* Frame k: stick-like values, the same for both passes */
+static void Values(uint32_t k, float v[3])
+{
+    v[0] = (float)((int32_t)((k * 37U) % 201U) - 100) / 100.0f;
+    v[1] = (float)((int32_t)((k * 53U + 17U) % 201U) - 100) / 100.0f;
+    v[2] = (float)((int32_t)((k * 11U + 5U) % 401U) - 200) / 100.0f;
+}
+
+static void LabelsCreate(void)
+{
+    lv_obj_t *scr = lv_obj_create(NULL);
+
+    lv_obj_set_style_bg_color(scr, lv_color_hex(0x1E1E1E), 0);
+    lv_obj_set_style_text_color(scr, lv_color_white(), 0);
+    for (uint32_t i = 0; i < BENCH_LABELS; i++)
+    {
+        s_labels[i] = lv_label_create(scr);
+        lv_obj_set_style_text_font(s_labels[i], &lv_font_montserrat_14, 0);
+        lv_obj_set_pos(s_labels[i], (int32_t)(10U + (i % 3U) * 100U), (int32_t)(10U + (i / 3U) * 30U));
+    }
+    lv_screen_load(scr);
+}
+
+static void LabelsFrame(uint32_t k)
+{
+    float v[3];
+
+    Values(k, v);
+    for (uint32_t i = 0; i < BENCH_LABELS; i++)
+    {
+        snprintf(s_text[i], sizeof(s_text[i]), "%.2f", (double)(v[i % 3U] * (float)(1U + i / 3U)));
+        lv_label_set_text_static(s_labels[i], s_text[i]);
+    }
+}
+
+static void GuiFrame(uint32_t k)
+{
+    float v[3];
+
+    Values(k, v);
+    RobotGUI_Update(v[0], v[1], v[2]);
+}
+
+static int CompareU32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Alternating off / on blocks of the same frames; returns the frames whose pixels differ */
+static uint32_t Run(const char *name, void (*frame)(uint32_t k), bool compare)
+{
+    uint32_t *ns[BENCH_PASSES];
+    uint64_t *hash = malloc(s_frames * sizeof(uint64_t));
+    uint32_t differ = 0U;
+    lv_font_glyph_cache_stats_t stats = {0};
+
+    for (int p = 0; p < BENCH_PASSES; p++)
+    {
+        ns[p] = malloc(s_frames * sizeof(uint32_t));
+    }
+    for (uint32_t first = 0; first < s_frames; first += BENCH_BLOCK)
+    {
+        uint32_t last = (first + BENCH_BLOCK < s_frames) ? first + BENCH_BLOCK : s_frames;
+
+        for (int p = 0; p < BENCH_PASSES; p++)
+        {
+            lv_font_glyph_cache_resize((p == BENCH_ON) ? s_cacheSize : 0U, true);
+            lv_font_glyph_cache_drop_all();
+
+            /* The same starting screen for both passes, not timed */
+            frame(first + s_frames);
+            lv_obj_invalidate(lv_screen_active());
+            lv_refr_now(s_disp);
+            lv_font_glyph_cache_reset_stats();
+
+            for (uint32_t k = first; k < last; k++)
+            {
+                frame(k);
+                s_hash = 14695981039346656037ULL;
+                uint64_t t0 = NowNs();
+                lv_refr_now(s_disp);
+                ns[p][k] = (uint32_t)(NowNs() - t0);
+
+                if (p == BENCH_OFF)
+                {
+                    hash[k] = s_hash;
+                }
+                else if (compare && hash[k] != s_hash)
+                {
+                    differ++;
+                }
+            }
+            if (p == BENCH_ON)
+            {
+                lv_font_glyph_cache_stats_t block;
+                lv_font_glyph_cache_get_stats(&block);
+                stats.hits += block.hits;
+                stats.misses += block.misses;
+                stats.bypassed += block.bypassed;
+            }
+        }
+    }
+
+    double mean[BENCH_PASSES];
+    uint32_t p50[BENCH_PASSES];
+    uint32_t p99[BENCH_PASSES];
+    for (int p = 0; p < BENCH_PASSES; p++)
+    {
+        uint64_t sum = 0;
+        for (uint32_t k = 0; k < s_frames; k++)
+        {
+            sum += ns[p][k];
+        }
+        mean[p] = (double)sum / (double)s_frames / 1000.0;
+        qsort(ns[p], s_frames, sizeof(uint32_t), CompareU32);
+        p50[p] = ns[p][s_frames / 2U];
+        p99[p] = ns[p][(s_frames * 99U) / 100U];
+        free(ns[p]);
+    }
+    free(hash);
+
+    uint32_t lookups = stats.hits + stats.misses + stats.bypassed;
+    printf("%-7s %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %7.1f %% %6.2f %% %s\n", name, mean[BENCH_OFF],
+           p50[BENCH_OFF] / 1000.0, p99[BENCH_OFF] / 1000.0, mean[BENCH_ON], p50[BENCH_ON] / 1000.0,
+           p99[BENCH_ON] / 1000.0, 100.0 * (1.0 - mean[BENCH_ON] / mean[BENCH_OFF]),
+           (lookups != 0U) ? 100.0 * (double)stats.hits / (double)lookups : 0.0,
+           !compare ? "-" : (differ == 0U) ? "same" : "DIFFER");
+    if (differ != 0U)
+    {
+        printf("  %u of %u frames differ with the cache on\n", (unsigned)differ, (unsigned)s_frames);
+    }
+    return differ;
+}
+
+/* ns per glyph: decode (off) or cache lookup (on) of the labels' characters */
+static void Glyphs(void)
+{
+    static const char chars[] = "0123456789.-";
+    const lv_font_t *font = &lv_font_montserrat_14;
+    lv_draw_buf_t *buf = lv_draw_buf_create(32, 32, LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+    double ns[BENCH_PASSES];
+
+    for (int p = 0; p < BENCH_PASSES; p++)
+    {
+        lv_font_glyph_cache_resize((p == BENCH_ON) ? s_cacheSize : 0U, true);
+        lv_font_glyph_cache_drop_all();
+
+        uint64_t t0 = NowNs();
+        for (uint32_t r = 0; r < BENCH_GLYPH_ROUNDS; r++)
+        {
+            for (const char *c = chars; *c != '\0'; c++)
+            {
+                lv_font_glyph_dsc_t g;
+
+                lv_font_get_glyph_dsc(font, &g, (uint32_t)*c, 0);
+                if (p == BENCH_ON)
+                {
+                    const uint8_t *data = lv_font_glyph_cache_acquire(&g, (uint32_t)*c);
+                    s_sink = (data != NULL) ? data[0] : 0U;
+                    lv_font_glyph_cache_release(&g);
+                }
+                else
+                {
+                    lv_draw_buf_t *shaped = lv_draw_buf_reshape(buf, 0, g.box_w, g.box_h, LV_STRIDE_AUTO);
+                    const lv_draw_buf_t *data = lv_font_get_glyph_bitmap(&g, shaped);
+                    s_sink = (data != NULL) ? data->data[0] : 0U;
+                    lv_font_glyph_release_draw_data(&g);
+                }
+            }
+        }
+        ns[p] = (double)(NowNs() - t0) / (double)(BENCH_GLYPH_ROUNDS * (sizeof(chars) - 1U));
+    }
+    lv_draw_buf_destroy(buf);
+    printf("%-7s %8.0f ns decoded, %.0f ns from the cache per glyph\n", "glyph", ns[BENCH_OFF], ns[BENCH_ON]);
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-n N] [-c BYTES]\n"
+           "  -n N       frames per pass (default %u)\n"
+           "  -c BYTES   cache budget when on (default LV_FONT_GLYPH_CACHE_SIZE, %u)\n",
+           prog, BENCH_FRAMES, (unsigned)LV_FONT_GLYPH_CACHE_SIZE);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t differ = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "n:c:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n': s_frames = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'c': s_cacheSize = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_frames == 0U || s_cacheSize == 0U)
+    {
+        fprintf(stderr, "-n/-c: see -h\n");
+        return 1;
+    }
+
+    lv_init();
+    lv_tick_set_cb(TickMs);
+    s_disp = lv_display_create(BENCH_HOR_RES, BENCH_VER_RES);
+    lv_display_set_rotation(s_disp, LV_DISPLAY_ROTATION_270);
+    lv_display_set_flush_cb(s_disp, Flush);
+    lv_display_set_buffers(s_disp, s_buf, NULL, sizeof(s_buf), LV_DISPLAY_RENDER_MODE_PARTIAL);
+
+    printf("%u frames per pass, cache %u bytes when on, times in us per refresh\n", (unsigned)s_frames,
+           (unsigned)s_cacheSize);
+    printf("%-7s %8s %8s %8s %8s %8s %8s %9s %8s %s\n", "", "off mean", "p50", "p99", "on mean", "p50", "p99",
+           "saved", "hits", "pixels");
+
+    LabelsCreate();
+    differ += Run("labels", LabelsFrame, true);
+
+    lv_screen_load(lv_obj_create(NULL));
+    RobotGUI_Init();
+    differ += Run("gui", GuiFrame, false);
+
+    Glyphs();
+
+    return (differ == 0U) ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+ * imu_calib_replay.c
+ *
+ * Runs the robot's IMU calibration (imu_calib.c) over an IMU trace on Linux.
+ *
+ * Trace: the lines "IMU,t_us,ax,ay,az,gx,gy,gz,still" a robot built with
+ * ROBOT_IMU_TRACE=1 prints on its debug console (other lines are skipped, so
+ * a whole console log can be fed). Without -f a trace is generated: constant
+ * biases with a slow gyro drift (warming up), noise, drives and a pick-up
+ * with the wheels still.
+ *
+ * Reports when the estimate was first usable, its error against the old
+ * blocking calibration (mean of the first CALIB_SAMPLE still samples), the
+ * rejected samples and the noise per axis.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include "imu_calib.h"
+
+#define GEN_RATE_HZ         1000U
+#define GEN_SECONDS         120U
+#define BATCH_SAMPLES       1000U       /* CALIB_SAMPLE of mpu9250_driver.h */
+
+typedef struct {
+    uint64_t t;
+    int16_t raw[IMU_CALIB_AXES];
+    bool still;
+} sample_t;
+
+/* Generated trace, true offsets kept to score the estimate */
+static const float s_bias[IMU_CALIB_AXES] = {120.0f, -80.0f, 16384.0f + 300.0f, -45.0f, 20.0f, 8.0f};
+static const float s_noise[IMU_CALIB_AXES] = {40.0f, 40.0f, 60.0f, 4.0f, 4.0f, 4.0f};
+#define GEN_GYRO_DRIFT      12.0f       /* LSB over the run, all gyro axes */
+
+static uint32_t s_rng = 12345U;
+
+static float Gauss(void)
+{
+    float u1, u2;
+
+    s_rng = s_rng * 1664525U + 1013904223U;
+    u1 = ((s_rng >> 8) + 1U) / 16777217.0f;
+    s_rng = s_rng * 1664525U + 1013904223U;
+    u2 = (s_rng >> 8) / 16777216.0f;
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
+
+static float Bias(uint32_t axis, float s)
+{
+    return s_bias[axis] + ((axis >= 3U) ? GEN_GYRO_DRIFT * s / GEN_SECONDS : 0.0f);
+}
+
+/* Still 0.4 s (boot), drive, still, picked up with the wheels still, still, drive, still ... */
+static void Generate(uint32_t i, sample_t *out)
+{
+    float s = (float)i / GEN_RATE_HZ;
+    uint32_t phase = (uint32_t)s % 20U;
+    bool drive = (s >= 0.4f) && (phase >= 2U && phase < 7U);
+    bool lifted = (phase == 12U);
+
+    out->t = (uint64_t)i * (1000000U / GEN_RATE_HZ);
+    out->still = !drive;
+    for (uint32_t a = 0; a < IMU_CALIB_AXES; a++)
+    {
+        float v = Bias(a, s) + s_noise[a] * Gauss();
+
+        if (drive || lifted)
+        {
+            /* Turning (gyro Z) and bumps / tilt */
+            v += (a == 5U) ? 3000.0f * sinf(s * 2.0f) : ((a >= 3U) ? 800.0f : 2000.0f) * sinf(s * 7.0f + a);
+        }
+        out->raw[a] = (int16_t)lrintf(v);
+    }
+}
+
+static bool ReadTrace(FILE *f, sample_t *out)
+{
+    char line[256];
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        unsigned long long t;
+        int v[IMU_CALIB_AXES], still;
+        const char *p = strstr(line, "IMU,");
+
+        if (p != NULL && sscanf(p, "IMU,%llu,%d,%d,%d,%d,%d,%d,%d", &t, &v[0], &v[1], &v[2], &v[3], &v[4], &v[5],
+                                &still) == 8)
+        {
+            out->t = t;
+            for (uint32_t a = 0; a < IMU_CALIB_AXES; a++)
+            {
+                out->raw[a] = (int16_t)v[a];
+            }
+            out->still = (still != 0);
+            return true;
+        }
+    }
+    return false;
+}
+
+static void PrintOffsets(const char *name, const imu_calib_offsets_t *o)
+{
+    printf("%-22s accel %6d %6d %6d  gyro %5d %5d %5d\n", name, o->accel[0], o->accel[1], o->accel[2], o->gyro[0],
+           o->gyro[1], o->gyro[2]);
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-f trace] [-r seed]\n"
+           "  -f trace   IMU lines of a ROBOT_IMU_TRACE=1 console log, '-' for stdin\n"
+           "             (default: %u s generated at %u Hz)\n"
+           "  -r seed    noise seed of the generated trace\n",
+           prog, GEN_SECONDS, GEN_RATE_HZ);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f = NULL;
+    imu_calib_t calib;
+    imu_calib_offsets_t off, batch;
+    sample_t smp;
+    double batchSum[IMU_CALIB_AXES] = {0};
+    uint32_t batchN = 0, samples = 0, stillSamples = 0, accepted = 0;
+    uint64_t firstUs = 0, validUs = 0, lastUs = 0;
+    bool haveValid = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:r:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                f = (strcmp(optarg, "-") == 0) ? stdin : fopen(optarg, "r");
+                if (f == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                s_rng = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    ImuCalib_Init(&calib);
+
+    for (;;)
+    {
+        if (f != NULL)
+        {
+            if (!ReadTrace(f, &smp)) break;
+        }
+        else
+        {
+            if (samples == GEN_SECONDS * GEN_RATE_HZ) break;
+            Generate(samples, &smp);
+        }
+        if (samples == 0U) firstUs = smp.t;
+        samples++;
+        lastUs = smp.t;
+
+        /* The old MPU9250_Calibrate(): the first samples, the robot held still */
+        if (smp.still)
+        {
+            stillSamples++;
+            if (batchN < BATCH_SAMPLES)
+            {
+                for (uint32_t a = 0; a < IMU_CALIB_AXES; a++) batchSum[a] += smp.raw[a];
+                batchN++;
+            }
+        }
+
+        if (!ImuCalib_Add(&calib, smp.raw, smp.still, smp.t)) continue;
+        accepted++;
+        if (!ImuCalib_Get(&calib, &off)) continue;
+        if (!haveValid)
+        {
+            haveValid = true;
+            validUs = smp.t;
+        }
+    }
+    if (f != NULL && f != stdin) fclose(f);
+
+    printf("samples %u over %.1f s, %u with the wheels still, %u taken, %u rejected (gyro moving)\n", samples,
+           (lastUs - firstUs) / 1e6, stillSamples, accepted, calib.rejected);
+    if (!haveValid)
+    {
+        printf("estimate never reached %u samples\n", IMU_CALIB_MIN_SAMPLES);
+        return 1;
+    }
+    printf("estimate usable after %.2f s\n", (validUs - firstUs) / 1e6);
+
+    (void)ImuCalib_Get(&calib, &off);
+    PrintOffsets("background estimate", &off);
+    if (batchN == BATCH_SAMPLES)
+    {
+        for (uint32_t a = 0; a < 3U; a++)
+        {
+            batch.accel[a] = (int16_t)lrint(batchSum[a] / BATCH_SAMPLES);
+            batch.gyro[a] = (int16_t)lrint(batchSum[3U + a] / BATCH_SAMPLES);
+        }
+        batch.accel[2] = (int16_t)(batch.accel[2] - IMU_CALIB_ACCEL_1G);
+        PrintOffsets("boot batch (old)", &batch);
+    }
+    if (f == NULL)
+    {
+        imu_calib_offsets_t truth;
+        float s = (float)GEN_SECONDS;
+
+        for (uint32_t a = 0; a < 3U; a++)
+        {
+            truth.accel[a] = (int16_t)lrintf(Bias(a, s));
+            truth.gyro[a] = (int16_t)lrintf(Bias(3U + a, s));
+        }
+        truth.accel[2] = (int16_t)(truth.accel[2] - IMU_CALIB_ACCEL_1G);
+        PrintOffsets("true at the end", &truth);
+    }
+    printf("noise (std dev, LSB)   accel %6.1f %6.1f %6.1f  gyro %5.1f %5.1f %5.1f\n", ImuCalib_StdDev(&calib, 0),
+           ImuCalib_StdDev(&calib, 1), ImuCalib_StdDev(&calib, 2), ImuCalib_StdDev(&calib, 3),
+           ImuCalib_StdDev(&calib, 4), ImuCalib_StdDev(&calib, 5));
+    return 0;
+}
@@ -0,0 +1,343 @@
+/*
+ * kinematics_bench.c
+ *
+ * Checks and times the wheel kinematics of COMMON/omni_kinematics.h, for the
+ * layout it is built with (-DOMNI_KIN_LAYOUT=OMNI_KIN_OMNI3, ..., the rover's
+ * mecanum by default):
+ *
+ *   - J+ J against the identity, and inverse then forward kinematics against
+ *     the body velocity they started from
+ *   - random commands up to twice the remote's limits (MAX_LINEAR_SPEED,
+ *     MAX_ANGULAR_SPEED), brought under the wheel limit by clamping each
+ *     wheel and by omni_kin_desaturate(): how far each bends the body
+ *     velocity the wheels give from the commanded one, and how much of its
+ *     speed is left
+ *   - ns and TSC ticks per call of each step of ROBOT_compute_kinematics(),
+ *     and of the mecanum code it replaced (per wheel clamp)
+ *
+ * Header only like the firmware uses it; no SDK, no board.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* omnidriver.h: ROBOT_LX + ROBOT_LY, WHEEL_RADIUS */
+#define OMNI_KIN_L          (0.125f + 0.1575f)
+#define OMNI_KIN_R          0.05f
+#include "omni_kinematics.h"
+
+#define BENCH_MAX_TARGET    10.0f       /* MAX_TARGET_SPEED, rad/s */
+#define BENCH_MAX_LINEAR    0.5f        /* MAX_LINEAR_SPEED, m/s */
+#define BENCH_MAX_ANGULAR   2.0f        /* MAX_ANGULAR_SPEED, rad/s */
+#define BENCH_INPUTS        4096U       /* Power of 2 */
+#define BENCH_CALLS         20000000U
+
+static omni_kin_twist_t s_in[BENCH_INPUTS];
+static float s_wheel[BENCH_INPUTS][OMNI_KIN_WHEELS];   /* omni_kin_inverse(s_in) */
+static uint32_t s_rng = 0x12345678U;
+
+static float Rand11(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (float)(s_rng >> 8) / 8388608.0f - 1.0f;
+}
+
+static void Clamp(float w[OMNI_KIN_WHEELS], float max)
+{
+    for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+    {
+        if (w[i] > max) w[i] = max; else if (w[i] < -max) w[i] = -max;
+    }
+}
+
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+/* ROBOT_compute_kinematics() before omni_kinematics.h, targets in M1..M4 order */
+static void Legacy(const omni_kin_twist_t *v, float w[4], float max)
+{
+    float L = OMNI_KIN_L;
+    float R = OMNI_KIN_R;
+    float t1 = (v->vx - v->vy - v->phi * L) / R;
+    float t2 = (v->vx + v->vy + v->phi * L) / R;
+    float t3 = (v->vx + v->vy - v->phi * L) / R;
+    float t4 = (v->vx - v->vy + v->phi * L) / R;
+
+    if (t1 > max) t1 = max; else if (t1 < -max) t1 = -max;
+    if (t2 > max) t2 = max; else if (t2 < -max) t2 = -max;
+    if (t3 > max) t3 = max; else if (t3 < -max) t3 = -max;
+    if (t4 > max) t4 = max; else if (t4 < -max) t4 = -max;
+
+    w[0] = t1;
+    w[3] = t2;
+    w[1] = t3;
+    w[2] = t4;
+}
+#endif
+
+/*******************************************************************************
+ * Checks
+ ******************************************************************************/
+
+static void CheckMatrices(void)
+{
+    float worst = 0.0f;
+
+    for (unsigned r = 0; r < 3U; r++)
+    {
+        for (unsigned c = 0; c < 3U; c++)
+        {
+            /* (r J+)(J / r) = J+ J */
+            float s = 0.0f;
+            for (unsigned i = 0; i < OMNI_KIN_WHEELS; i++)
+            {
+                s += omni_kin_fwd_matrix[r][i] * omni_kin_inv_matrix[i][c];
+            }
+            worst = fmaxf(worst, fabsf(s - ((r == c) ? 1.0f : 0.0f)));
+        }
+    }
+    printf("Layout %s, %u wheels, L %.4f m, r %.3f m\n", OMNI_KIN_NAME, OMNI_KIN_WHEELS, (double)OMNI_KIN_L,
+           (double)OMNI_KIN_R);
+    printf("  J+ J - I: %.2g at most\n", (double)worst);
+
+    float trip = 0.0f;
+    for (uint32_t k = 0; k < BENCH_INPUTS; k++)
+    {
+        float w[OMNI_KIN_WHEELS];
+        omni_kin_twist_t v;
+
+        omni_kin_inverse(&s_in[k], w);
+        omni_kin_forward(w, &v);
+        trip = fmaxf(trip, fabsf(v.vx - s_in[k].vx));
+        trip = fmaxf(trip, fabsf(v.vy - s_in[k].vy));
+        trip = fmaxf(trip, fabsf(v.phi - s_in[k].phi) * OMNI_KIN_L);
+    }
+    printf("  forward(inverse(v)) - v: %.2g m/s at most\n", (double)trip);
+
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+    float legacy = 0.0f;
+    for (uint32_t k = 0; k < BENCH_INPUTS; k++)
+    {
+        float w[4], old[4];
+
+        omni_kin_inverse(&s_in[k], w);
+        Legacy(&s_in[k], old, INFINITY);
+        for (unsigned i = 0; i < 4U; i++)
+        {
+            legacy = fmaxf(legacy, fabsf(w[i] - old[i]));
+        }
+    }
+    printf("  against the code before, unclamped: %.2g rad/s at most\n", (double)legacy);
+#endif
+}
+
+/* Angle (deg) between the commanded and the achieved body velocity, phi as L phi (m/s),
+ * and the share of the commanded speed achieved */
+static void Bend(const omni_kin_twist_t *cmd, const omni_kin_twist_t *got, float *deg, float *kept)
+{
+    float a[3] = {cmd->vx, cmd->vy, cmd->phi * OMNI_KIN_L};
+    float b[3] = {got->vx, got->vy, got->phi * OMNI_KIN_L};
+    float ab = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    float aa = sqrtf(a[0] * a[0] + a[1] * a[1] + a[2] * a[2]);
+    float bb = sqrtf(b[0] * b[0] + b[1] * b[1] + b[2] * b[2]);
+    float c = (aa > 0.0f && bb > 0.0f) ? ab / (aa * bb) : 1.0f;
+
+    *deg = acosf(fminf(1.0f, fmaxf(-1.0f, c))) * 57.29578f;
+    *kept = (aa > 0.0f) ? bb / aa : 1.0f;
+}
+
+static void CheckSaturation(float max)
+{
+    uint32_t sat = 0;
+    float clampMax = 0.0f, clampSum = 0.0f, clampKept = 0.0f;
+    float desatMax = 0.0f, desatKept = 0.0f;
+
+    for (uint32_t k = 0; k < BENCH_INPUTS; k++)
+    {
+        float wc[OMNI_KIN_WHEELS], wd[OMNI_KIN_WHEELS];
+        omni_kin_twist_t vc, vd;
+        float deg, kept;
+
+        omni_kin_inverse(&s_in[k], wc);
+        memcpy(wd, wc, sizeof(wd));
+        if (omni_kin_desaturate(wd, max) == 1.0f)
+        {
+            continue;
+        }
+        sat++;
+        Clamp(wc, max);
+        omni_kin_forward(wc, &vc);
+        omni_kin_forward(wd, &vd);
+
+        Bend(&s_in[k], &vc, &deg, &kept);
+        clampMax = fmaxf(clampMax, deg);
+        clampSum += deg;
+        clampKept += kept;
+        Bend(&s_in[k], &vd, &deg, &kept);
+        desatMax = fmaxf(desatMax, deg);
+        desatKept += kept;
+    }
+    printf("\nCommands up to %.1f m/s and %.1f rad/s, wheel limit %.1f rad/s: %u of %u saturate\n",
+           (double)(2.0f * BENCH_MAX_LINEAR), (double)(2.0f * BENCH_MAX_ANGULAR), (double)max, (unsigned)sat,
+           (unsigned)BENCH_INPUTS);
+    if (sat == 0U)
+    {
+        return;
+    }
+    printf("  %-22s bends %5.1f deg mean, %5.1f max, keeps %3.0f %% of the speed\n", "clamp per wheel:",
+           (double)(clampSum / sat), (double)clampMax, (double)(100.0f * clampKept / sat));
+    printf("  %-22s bends %5.1f deg max,            keeps %3.0f %% of the speed\n", "omni_kin_desaturate():",
+           (double)desatMax, (double)(100.0f * desatKept / sat));
+}
+
+/*******************************************************************************
+ * Timing
+ ******************************************************************************/
+
+typedef enum {
+    BENCH_INVERSE,
+    BENCH_INVERSE_CLAMP,
+    BENCH_INVERSE_DESAT,
+    BENCH_FORWARD,
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+    BENCH_LEGACY,
+#endif
+    BENCH_COUNT
+} bench_t;
+
+static const char *const s_benchName[BENCH_COUNT] = {
+    "omni_kin_inverse()",
+    "  + clamp per wheel",
+    "  + omni_kin_desaturate()",
+    "omni_kin_forward()",
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+    "mecanum, clamp (before)",
+#endif
+};
+
+static uint64_t Ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0U;
+#endif
+}
+
+static void Time(bench_t b, uint32_t calls, float max)
+{
+    struct timespec t0, t1;
+    volatile float sink = 0.0f;
+    float acc = 0.0f;
+    uint64_t k0, k1;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    k0 = Ticks();
+    for (uint32_t n = 0; n < calls; n++)
+    {
+        const omni_kin_twist_t *v = &s_in[n & (BENCH_INPUTS - 1U)];
+        float w[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        omni_kin_twist_t out;
+
+        switch (b)
+        {
+            case BENCH_INVERSE:
+                omni_kin_inverse(v, w);
+                break;
+            case BENCH_INVERSE_CLAMP:
+                omni_kin_inverse(v, w);
+                Clamp(w, max);
+                break;
+            case BENCH_INVERSE_DESAT:
+                omni_kin_inverse(v, w);
+                (void)omni_kin_desaturate(w, max);
+                break;
+            case BENCH_FORWARD:
+                omni_kin_forward(s_wheel[n & (BENCH_INPUTS - 1U)], &out);
+                w[0] = out.vx + out.vy + out.phi;
+                break;
+#if OMNI_KIN_LAYOUT == OMNI_KIN_MECANUM4
+            case BENCH_LEGACY:
+                Legacy(v, w, max);
+                break;
+#endif
+            default:
+                break;
+        }
+        acc += w[0] + w[OMNI_KIN_WHEELS - 1U];
+    }
+    k1 = Ticks();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    sink = acc;
+    (void)sink;
+
+    double ns = ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / calls;
+    if (k1 != k0)
+    {
+        printf("  %-26s %6.2f ns %6.1f TSC ticks per call\n", s_benchName[b], ns, (double)(k1 - k0) / calls);
+    }
+    else
+    {
+        printf("  %-26s %6.2f ns per call\n", s_benchName[b], ns);
+    }
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-m MAX] [-n N]\n"
+           "  -m MAX   wheel limit, rad/s (default %.1f, MAX_TARGET_SPEED)\n"
+           "  -n N     calls timed per function (default %u)\n"
+           "  build with -DOMNI_KIN_LAYOUT=OMNI_KIN_OMNI3 or OMNI_KIN_OMNI4 for the other layouts\n",
+           prog, (double)BENCH_MAX_TARGET, (unsigned)BENCH_CALLS);
+}
+
+int main(int argc, char **argv)
+{
+    float max = BENCH_MAX_TARGET;
+    uint32_t calls = BENCH_CALLS;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:n:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'm': max = strtof(optarg, NULL); break;
+            case 'n': calls = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (!(max > 0.0f) || calls == 0U)
+    {
+        fprintf(stderr, "-m and -n: see -h\n");
+        return 1;
+    }
+
+    for (uint32_t k = 0; k < BENCH_INPUTS; k++)
+    {
+        s_in[k].vx = 2.0f * BENCH_MAX_LINEAR * Rand11();
+        s_in[k].vy = 2.0f * BENCH_MAX_LINEAR * Rand11();
+        s_in[k].phi = 2.0f * BENCH_MAX_ANGULAR * Rand11();
+        omni_kin_inverse(&s_in[k], s_wheel[k]);
+    }
+
+    CheckMatrices();
+    CheckSaturation(max);
+
+    printf("\nTime on this host, %u calls each (the robot runs one inverse and desaturation per PID tick):\n",
+           (unsigned)calls);
+    for (uint32_t b = 0; b < BENCH_COUNT; b++)
+    {
+        Time((bench_t)b, calls, max);
+    }
+    return 0;
+}
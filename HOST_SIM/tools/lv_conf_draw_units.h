@@ -0,0 +1,27 @@
+/*
+ * lv_conf_draw_units.h
+ *
+ * The remote's lv_conf.h with several software draw units, for
+ * draw_graph_bench.c: more than one unit needs an OS, pthreads on the host.
+ * The heap is larger than the remote's 64 KB, which 400 objects and their
+ * draw tasks don't fit in. Selected with -DLV_CONF_PATH; the unit count
+ * with -DDRAW_UNITS=N.
+ */
+
+#ifndef LV_CONF_DRAW_UNITS_H
+#define LV_CONF_DRAW_UNITS_H
+
+#include "lv_conf.h"
+
+#ifndef DRAW_UNITS
+#define DRAW_UNITS  3
+#endif
+
+#undef LV_USE_OS
+#define LV_USE_OS                   LV_OS_PTHREAD
+#undef LV_DRAW_SW_DRAW_UNIT_CNT
+#define LV_DRAW_SW_DRAW_UNIT_CNT    DRAW_UNITS
+#undef LV_MEM_SIZE
+#define LV_MEM_SIZE                 (1024 * 1024U)
+
+#endif /* LV_CONF_DRAW_UNITS_H */
@@ -0,0 +1,259 @@
+/*
+ * mailbox_stress.c
+ *
+ * Two threads on RemoteMailbox.c, built unchanged for the host, in place of
+ * the remote's two cores: core0 publishes commands, core1 reads them as the
+ * GUI does. Every field of a published command is derived from one counter,
+ * so a read mixing two commands (torn) shows, and the counter of successive
+ * reads must never go back.
+ *
+ * Reports the commands published and read per s, the reads that found a
+ * newer command, the time a read takes (its retries included) and
+ * how many commands the reader was behind. Exits 1 on a torn read or one
+ * going back. With -u the same threads share a plain copy of the command
+ * instead, no sequence counter: the check must find torn reads there.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "RemoteMailbox.h"
+
+#define STRESS_SECONDS  5U
+#define HIST_NS         100000U     /* Read time histogram in 10 ns steps, the last bucket counts everything above */
+#define HIST_STEP_NS    10U
+
+static volatile int s_stop;
+static volatile uint32_t s_published;   /* Counter of the last command published */
+
+static uint32_t s_seconds = STRESS_SECONDS;
+static uint32_t s_writeHz;              /* 0 = flat out */
+static uint32_t s_readHz;
+static int s_unprotected;
+
+/* -u: what the mailbox replaces */
+static volatile RemoteCommand_t s_plain;
+static volatile uint32_t s_plainCount;
+
+/* Results */
+static uint64_t s_reads;
+static uint64_t s_fresh;
+static uint64_t s_torn;
+static uint64_t s_backwards;
+static uint64_t s_behindMax;
+static uint64_t s_behindSum;
+static uint64_t s_readHist[HIST_NS / HIST_STEP_NS + 1U];
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static void SleepUntilNs(uint64_t ns)
+{
+    struct timespec t = {(time_t)(ns / 1000000000U), (long)(ns % 1000000000U)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) != 0)
+    {
+    }
+}
+
+/* Command number k: every field from k */
+static void MakeCommand(RemoteCommand_t *cmd, uint32_t k)
+{
+    cmd->header = k;
+    cmd->vx = (float)(k & 0xFFFFU);
+    cmd->vy = -(float)(k & 0xFFFFU);
+    cmd->phi = 0.5f * (float)(k & 0xFFFFU);
+    cmd->buttons = ~k;
+    cmd->timestamp = k * 2654435761U;
+}
+
+static int Consistent(const RemoteCommand_t *cmd)
+{
+    RemoteCommand_t want;
+
+    MakeCommand(&want, cmd->header);
+    return memcmp(&want, cmd, sizeof(want)) == 0;
+}
+
+static void Publish(const RemoteCommand_t *cmd)
+{
+    if (!s_unprotected)
+    {
+        RemoteMailbox_Publish(cmd);
+        return;
+    }
+    memcpy((void *)&s_plain, cmd, sizeof(RemoteCommand_t));
+    s_plainCount++;
+}
+
+static bool Read(RemoteCommand_t *cmd, uint32_t *lastSeq)
+{
+    if (!s_unprotected)
+    {
+        return RemoteMailbox_Read(cmd, lastSeq);
+    }
+    uint32_t count = s_plainCount;
+    memcpy(cmd, (const void *)&s_plain, sizeof(RemoteCommand_t));
+    bool fresh = (count != *lastSeq);
+    *lastSeq = count;
+    return fresh;
+}
+
+/* Core0: the ADC / SPI loop */
+static void *WriterThread(void *arg)
+{
+    const uint64_t periodNs = (s_writeHz != 0U) ? 1000000000U / s_writeHz : 0U;
+    uint64_t next = NowNs();
+    RemoteCommand_t cmd;
+
+    (void)arg;
+    for (uint32_t k = 1U; !s_stop; k++)
+    {
+        if (periodNs != 0U)
+        {
+            next += periodNs;
+            SleepUntilNs(next);
+        }
+        MakeCommand(&cmd, k);
+        Publish(&cmd);
+        s_published = k;
+    }
+    return NULL;
+}
+
+/* Core1: the GUI loop */
+static void *ReaderThread(void *arg)
+{
+    const uint64_t periodNs = (s_readHz != 0U) ? 1000000000U / s_readHz : 0U;
+    uint64_t next = NowNs();
+    uint32_t lastSeq = 0U;
+    uint32_t lastK = 0U;
+    RemoteCommand_t cmd;
+
+    (void)arg;
+    while (!s_stop)
+    {
+        if (periodNs != 0U)
+        {
+            next += periodNs;
+            SleepUntilNs(next);
+        }
+
+        uint64_t t0 = NowNs();
+        bool fresh = Read(&cmd, &lastSeq);
+        uint64_t ns = NowNs() - t0;
+        uint32_t published = s_published;
+
+        s_reads++;
+        s_readHist[(ns > HIST_NS) ? (HIST_NS / HIST_STEP_NS) : (ns / HIST_STEP_NS)]++;
+        if (lastSeq == 0U)
+        {
+            continue; /* Nothing published yet */
+        }
+        if (!Consistent(&cmd))
+        {
+            s_torn++;
+            continue;
+        }
+        if (cmd.header < lastK)
+        {
+            s_backwards++;
+        }
+        lastK = cmd.header;
+        if (!fresh)
+        {
+            continue;
+        }
+        s_fresh++;
+
+        /* The writer may have published more since, not fewer */
+        uint64_t behind = (published > cmd.header) ? (uint64_t)(published - cmd.header) : 0U;
+        s_behindSum += behind;
+        if (behind > s_behindMax)
+        {
+            s_behindMax = behind;
+        }
+    }
+    return NULL;
+}
+
+static uint64_t HistPctNs(double pct)
+{
+    uint64_t want = (uint64_t)(pct / 100.0 * (double)s_reads);
+    uint64_t sum = 0;
+
+    for (uint32_t i = 0; i <= HIST_NS / HIST_STEP_NS; i++)
+    {
+        sum += s_readHist[i];
+        if (sum > want)
+        {
+            return (uint64_t)i * HIST_STEP_NS;
+        }
+    }
+    return HIST_NS;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-t S] [-w HZ] [-r HZ] [-u]\n"
+           "  -t S    seconds (default %u)\n"
+           "  -w HZ   commands published per s (default flat out; the remote publishes 200)\n"
+           "  -r HZ   reads per s (default flat out; the GUI reads once per frame)\n"
+           "  -u      plain shared command, no mailbox (exit 1 expected)\n",
+           prog, STRESS_SECONDS);
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t writer, reader;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:w:r:uh")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': s_seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'w': s_writeHz = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': s_readHz = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'u': s_unprotected = 1; break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_seconds == 0U)
+    {
+        fprintf(stderr, "-t: see -h\n");
+        return 1;
+    }
+
+    RemoteMailbox_Init();
+    pthread_create(&writer, NULL, WriterThread, NULL);
+    pthread_create(&reader, NULL, ReaderThread, NULL);
+    sleep(s_seconds);
+    s_stop = 1;
+    pthread_join(writer, NULL);
+    pthread_join(reader, NULL);
+
+    double s = (double)s_seconds;
+    printf("%s, %u s, %ld CPUs\n", s_unprotected ? "plain copy" : "RemoteMailbox", (unsigned)s_seconds,
+           sysconf(_SC_NPROCESSORS_ONLN));
+    printf("published %.0f /s, read %.0f /s, %.0f /s of them found a newer command\n",
+           (double)s_published / s, (double)s_reads / s, (double)s_fresh / s);
+    printf("read time p50 %llu ns  p99 %llu ns  p99.99 %llu ns (retries included)\n",
+           (unsigned long long)HistPctNs(50.0), (unsigned long long)HistPctNs(99.0),
+           (unsigned long long)HistPctNs(99.99));
+    printf("commands behind the writer  mean %.2f  max %llu\n",
+           (s_fresh != 0U) ? (double)s_behindSum / (double)s_fresh : 0.0, (unsigned long long)s_behindMax);
+    printf("torn reads %llu, reads going back %llu\n", (unsigned long long)s_torn,
+           (unsigned long long)s_backwards);
+    return (s_torn != 0U || s_backwards != 0U) ? 1 : 0;
+}
@@ -0,0 +1,783 @@
+/*
+ * motor_ident.c
+ *
+ * Fits a model per wheel (motor_model.h) to logged PWM and speed, and writes
+ * them as motor_model_fit.h for the robot's feed-forward and the twin's
+ * motor plants.
+ *
+ * Log: the lines "MOT,t_us,pwm1,mrad_s1,...,pwm4,mrad_s4" a robot built with
+ * ROBOT_MOTOR_TRACE=1 prints on its debug console (other lines are skipped,
+ * so a whole console log can be fed), or the CSV of pid_schedule_sim -c
+ * (wheel 1: its duty and true speed). The telemetry frames carry the speeds
+ * but not the PWM, so they are no use alone. Without -f a log is generated:
+ * the twin's motor plant, a different one per wheel, measured like the
+ * robot's encoders and averaged like the trace, under duty steps, coasting
+ * and slow ramps through the break-away duty.
+ *
+ * The samples are averaged into bins of -d ms; both fits are least squares on
+ * the bins (one pass per dead time tried):
+ *   first order plus dead time   w[k+1] = a w[k] + b u[k-n]
+ *   DC motor, wheel turning      w[k+1] = a w[k] + b u[k-n] - c sgn(w[k])
+ * tau = -dt / ln(a), gain = b / (1 - a), coulomb = c / (1 - a). The deadband
+ * lies between the highest duty a still wheel held and the lowest that
+ * started one. Each model then runs open loop over the log against the
+ * measured speed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include "motor_model.h"
+#include "motor_plant.h"
+
+#define WHEELS              MOTOR_MODEL_WHEELS
+#define PWM_FULL            65535.0f    /* MAX_PWM_DEFINITION */
+#define STILL_RAD_S         0.1f        /* Below it a wheel counts as still */
+#define STICK_HOLD_BINS     30U         /* Still this long under a duty: the duty is below the deadband */
+#define DEADBAND_RESOLVED   0.02f       /* Held and started duties this close: the deadband is known */
+#define DEFAULT_BIN_MS      10.0f       /* ROBOT_MOTOR_TRACE_TICKS */
+#define DEFAULT_MAX_DEAD_MS 50.0f
+
+/* Generated log */
+#define GEN_RATE_HZ         12000U      /* PID_TIMER_FREQ */
+#define GEN_TRACE_TICKS     120U
+#define GEN_COUNTS_CPR      2249.0f     /* OUTPUT_COUNTS_CPR */
+#define GEN_TIMEOUT_S       0.2f        /* TIMEOUT_COUNTS */
+#define GEN_SECONDS         120U
+
+typedef struct {
+    float *u;               /* Duty, -1..1 */
+    float *w;               /* rad/s */
+    uint8_t *gap;           /* Bins missing before this one */
+    uint32_t n, cap;
+
+    /* Bin being filled */
+    bool started;
+    uint64_t start;
+    double su, sw;
+    uint32_t count;
+    bool gapNext;
+} series_t;
+
+typedef struct {
+    bool ok;
+    motor_model_t fopdt;
+    motor_model_t dc;
+    float fopdtRms, fopdtFit;
+    float dcRms, dcFit;
+    float stickMax;         /* Highest duty held still */
+    float breakMin;         /* Lowest duty that started it */
+    uint32_t breakaways;
+    uint32_t moving;        /* Bins in the DC fit */
+} wheel_fit_t;
+
+static series_t s_series[WHEELS];
+static uint64_t s_binUs = (uint64_t)(DEFAULT_BIN_MS * 1000.0f);
+static uint32_t s_lines;
+
+static uint32_t s_rng = 12345U;
+
+static float Uniform(void)
+{
+    s_rng = s_rng * 1664525U + 1013904223U;
+    return (s_rng >> 8) / 16777216.0f;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Samples into bins                                                          */
+/* ------------------------------------------------------------------------- */
+
+static void Push(series_t *s, float u, float w, bool gap)
+{
+    if (s->n == s->cap)
+    {
+        s->cap = s->cap ? s->cap * 2U : 4096U;
+        s->u = realloc(s->u, s->cap * sizeof(float));
+        s->w = realloc(s->w, s->cap * sizeof(float));
+        s->gap = realloc(s->gap, s->cap);
+        if (s->u == NULL || s->w == NULL || s->gap == NULL)
+        {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    s->u[s->n] = u;
+    s->w[s->n] = w;
+    s->gap[s->n] = gap ? 1U : 0U;
+    s->n++;
+}
+
+static void AddSample(uint32_t wheel, uint64_t t, float u, float w)
+{
+    series_t *s = &s_series[wheel];
+
+    if (!s->started)
+    {
+        /* Bin edges half a bin off the samples: a trace's timestamp jitter never crosses one */
+        s->started = true;
+        s->start = (t > s_binUs / 2U) ? t - s_binUs / 2U : 0U;
+    }
+    if (t < s->start)
+    {
+        return;
+    }
+    if (t >= s->start + s_binUs)
+    {
+        uint64_t bins = (t - s->start) / s_binUs;
+
+        if (s->count != 0U)
+        {
+            Push(s, (float)(s->su / s->count), (float)(s->sw / s->count), s->gapNext);
+            s->gapNext = false;
+        }
+        if (bins > 1U || s->count == 0U)
+        {
+            s->gapNext = true;
+        }
+        s->start += bins * s_binUs;
+        s->su = 0.0;
+        s->sw = 0.0;
+        s->count = 0U;
+    }
+    s->su += u;
+    s->sw += w;
+    s->count++;
+}
+
+static void Flush(void)
+{
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        series_t *s = &s_series[i];
+        if (s->count != 0U)
+        {
+            Push(s, (float)(s->su / s->count), (float)(s->sw / s->count), s->gapNext);
+        }
+    }
+}
+
+/* ROBOT_MOTOR_TRACE lines, or pid_schedule_sim -c rows */
+static void ReadLog(FILE *f)
+{
+    char line[256];
+    uint64_t high = 0U;
+    uint32_t last = 0U;
+    bool any = false;
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        const char *p = strstr(line, "MOT,");
+        unsigned long long t;
+        unsigned mode;
+        long v[8];
+        float target, measured, omega, duty;
+
+        if (p != NULL && sscanf(p, "MOT,%llu,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld", &t, &v[0], &v[1], &v[2], &v[3],
+                                &v[4], &v[5], &v[6], &v[7]) == 9)
+        {
+            /* 32 bit microseconds on the robot: wraps every 71 minutes */
+            if (any && (uint32_t)t < last)
+            {
+                high += 1ULL << 32;
+            }
+            last = (uint32_t)t;
+            any = true;
+            for (uint32_t i = 0; i < WHEELS; i++)
+            {
+                AddSample(i, high + (uint32_t)t, v[2U * i] / PWM_FULL, v[2U * i + 1U] / 1000.0f);
+            }
+            s_lines++;
+        }
+        else if (p == NULL && sscanf(line, "%llu,%u,%f,%f,%f,%f", &t, &mode, &target, &measured, &omega, &duty) == 6)
+        {
+            AddSample(0U, t, duty, omega);
+            s_lines++;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Generated log                                                              */
+/* ------------------------------------------------------------------------- */
+
+/* A different plant per wheel, the truth the fits are scored against */
+static void GenPlant(uint32_t wheel, motor_plant_params_t *p)
+{
+    motor_plant_params_t d = MOTOR_PLANT_DEFAULT_PARAMS;
+
+    *p = d;
+    p->noLoadSpeed *= 0.9f + 0.07f * wheel;
+    p->tau *= 1.2f - 0.12f * wheel;
+    p->frictionDuty = 0.04f + 0.015f * wheel;
+}
+
+/* Next duty segment: a step, coasting, or a slow ramp from 0 through the break-away duty */
+static void GenSegment(float *from, float *to, uint32_t *ticks)
+{
+    float r = Uniform();
+
+    if (r < 0.55f)
+    {
+        *from = *to = 2.0f * Uniform() - 1.0f;
+        *ticks = (uint32_t)((0.3f + 0.7f * Uniform()) * GEN_RATE_HZ);
+    }
+    else if (r < 0.75f)
+    {
+        *from = *to = 0.0f;
+        *ticks = (uint32_t)((0.3f + 0.5f * Uniform()) * GEN_RATE_HZ);
+    }
+    else
+    {
+        *from = 0.0f;
+        *to = (Uniform() < 0.5f ? -0.15f : 0.15f);
+        *ticks = 4U * GEN_RATE_HZ;
+    }
+}
+
+static void Generate(uint32_t seconds, FILE *out)
+{
+    motor_plant_t plant[WHEELS];
+    float angle[WHEELS] = {0}, edgeT[WHEELS], speed[WHEELS] = {0};
+    float from[WHEELS], to[WHEELS], pwmSum[WHEELS] = {0}, speedSum[WHEELS] = {0};
+    uint32_t segTicks[WHEELS], segAt[WHEELS];
+    const float dt = 1.0f / GEN_RATE_HZ;
+    const float step = 2.0f * 3.14159265f / GEN_COUNTS_CPR;
+
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        motor_plant_params_t p;
+        GenPlant(i, &p);
+        MotorPlant_Init(&plant[i], &p);
+        edgeT[i] = 0.0f;
+        from[i] = to[i] = 0.0f;
+        segTicks[i] = GEN_RATE_HZ / 2U;
+        segAt[i] = 0U;
+    }
+
+    for (uint32_t k = 0; k < seconds * GEN_RATE_HZ; k++)
+    {
+        float now = k * dt;
+
+        for (uint32_t i = 0; i < WHEELS; i++)
+        {
+            float f, duty;
+
+            if (k - segAt[i] >= segTicks[i])
+            {
+                segAt[i] = k;
+                GenSegment(&from[i], &to[i], &segTicks[i]);
+            }
+            f = (float)(k - segAt[i]) / segTicks[i];
+            /* PWM counts, as the PID applies them */
+            duty = lrintf((from[i] + f * (to[i] - from[i])) * PWM_FULL) / PWM_FULL;
+
+            MotorPlant_Step(&plant[i], duty, dt);
+
+            /* Encoder: the speed is the last edge period, 0 after the timeout, signed */
+            angle[i] += fabsf(plant[i].omega) * dt;
+            if (angle[i] >= step)
+            {
+                angle[i] -= step;
+                speed[i] = step / (now - edgeT[i]);
+                edgeT[i] = now;
+            }
+            else if (now - edgeT[i] > GEN_TIMEOUT_S)
+            {
+                speed[i] = 0.0f;
+            }
+            pwmSum[i] += duty * PWM_FULL;
+            speedSum[i] += copysignf(speed[i], plant[i].omega);
+        }
+
+        if ((k + 1U) % GEN_TRACE_TICKS == 0U)
+        {
+            uint64_t t = (uint64_t)(k + 1U) * 1000000U / GEN_RATE_HZ;
+            long v[8];
+
+            for (uint32_t i = 0; i < WHEELS; i++)
+            {
+                v[2U * i] = lrintf(pwmSum[i] / GEN_TRACE_TICKS);
+                v[2U * i + 1U] = lrintf(speedSum[i] * 1000.0f / GEN_TRACE_TICKS);
+                AddSample(i, t, v[2U * i] / PWM_FULL, v[2U * i + 1U] / 1000.0f);
+                pwmSum[i] = 0.0f;
+                speedSum[i] = 0.0f;
+            }
+            if (out != NULL)
+            {
+                fprintf(out, "MOT,%lu,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld\r\n", (unsigned long)(uint32_t)t, v[0], v[1],
+                        v[2], v[3], v[4], v[5], v[6], v[7]);
+            }
+            s_lines++;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Fits                                                                       */
+/* ------------------------------------------------------------------------- */
+
+typedef struct {
+    double a[3][3];
+    double b[3];
+    double yy;
+    uint32_t n;
+} normal_t;
+
+static void NormalAdd(normal_t *ne, const double *x, uint32_t dim, double y)
+{
+    for (uint32_t r = 0; r < dim; r++)
+    {
+        for (uint32_t c = 0; c < dim; c++)
+        {
+            ne->a[r][c] += x[r] * x[c];
+        }
+        ne->b[r] += x[r] * y;
+    }
+    ne->yy += y * y;
+    ne->n++;
+}
+
+/* Gauss-Jordan with pivoting; returns the residual sum of squares, < 0 if singular */
+static double NormalSolve(const normal_t *ne, uint32_t dim, double *x)
+{
+    double m[3][4];
+    double ss = ne->yy;
+
+    for (uint32_t r = 0; r < dim; r++)
+    {
+        for (uint32_t c = 0; c < dim; c++)
+        {
+            m[r][c] = ne->a[r][c];
+        }
+        m[r][dim] = ne->b[r];
+    }
+    for (uint32_t c = 0; c < dim; c++)
+    {
+        uint32_t piv = c;
+        for (uint32_t r = c + 1U; r < dim; r++)
+        {
+            if (fabs(m[r][c]) > fabs(m[piv][c])) piv = r;
+        }
+        if (fabs(m[piv][c]) < 1e-12 * (ne->a[c][c] + 1e-30)) return -1.0;
+        for (uint32_t k = 0; k <= dim; k++)
+        {
+            double t = m[c][k];
+            m[c][k] = m[piv][k];
+            m[piv][k] = t;
+        }
+        for (uint32_t r = 0; r < dim; r++)
+        {
+            if (r == c) continue;
+            double f = m[r][c] / m[c][c];
+            for (uint32_t k = c; k <= dim; k++)
+            {
+                m[r][k] -= f * m[c][k];
+            }
+        }
+    }
+    for (uint32_t r = 0; r < dim; r++)
+    {
+        x[r] = m[r][dim] / m[r][r];
+        ss -= x[r] * ne->b[r];
+    }
+    return ss;
+}
+
+/* No gap between bin k - delay and k + 1 */
+static bool Continuous(const series_t *s, uint32_t k, uint32_t delay)
+{
+    for (uint32_t j = k - delay + 1U; j <= k + 1U; j++)
+    {
+        if (s->gap[j]) return false;
+    }
+    return true;
+}
+
+static float Sgn(float v)
+{
+    return (v > 0.0f) ? 1.0f : ((v < 0.0f) ? -1.0f : 0.0f);
+}
+
+static bool ToModel(const double *x, double dt, uint32_t delay, motor_model_t *m)
+{
+    if (!(x[0] > 0.0 && x[0] < 1.0)) return false;
+    m->tau = (float)(-dt / log(x[0]));
+    m->gain = (float)(x[1] / (1.0 - x[0]));
+    m->dead_time = (float)(delay * dt);
+    return m->gain > 0.0f;
+}
+
+/* Open loop over the log from the measured speed at every gap; rms error, fit % */
+static void Simulate(const series_t *s, const motor_model_t *m, double dt, float *rms, float *fit)
+{
+    uint32_t delay = (uint32_t)lrintf(m->dead_time / (float)dt);
+    double a = exp(-dt / m->tau);
+    double e2 = 0.0, y = 0.0, y2 = 0.0;
+    float w = 0.0f;
+    uint32_t n = 0;
+
+    for (uint32_t k = 0; k < s->n; k++)
+    {
+        if (k <= delay || s->gap[k])
+        {
+            w = s->w[k];
+        }
+        else
+        {
+            float u = s->u[k - 1U - delay];
+            float drive;
+
+            if (fabsf(w) < STILL_RAD_S && fabsf(u) < m->deadband)
+            {
+                drive = 0.0f;
+                w = 0.0f;
+            }
+            else
+            {
+                float dir = (fabsf(w) < STILL_RAD_S) ? Sgn(u) : Sgn(w);
+                drive = m->gain * u - m->coulomb * dir;
+                float next = (float)(a * w + (1.0 - a) * drive);
+                /* Friction stops a wheel, it never turns it back */
+                w = (m->coulomb > 0.0f && Sgn(next) != dir && fabsf(m->gain * u) < m->coulomb) ? 0.0f : next;
+            }
+        }
+        e2 += (double)(w - s->w[k]) * (w - s->w[k]);
+        y += s->w[k];
+        y2 += (double)s->w[k] * s->w[k];
+        n++;
+    }
+    double var = y2 - y * y / n;
+    *rms = (float)sqrt(e2 / n);
+    *fit = (var > 0.0) ? (float)(100.0 * (1.0 - sqrt(e2 / var))) : 0.0f;
+}
+
+/*
+ * Highest duty a still wheel held for the next STICK_HOLD_BINS (the lowest of
+ * those bins: a ramp climbs through it), lowest that started one: the highest
+ * bin of the dead time before it moved and the one it moved in (a step that
+ * falls late in a bin is averaged down).
+ */
+static void FitDeadband(const series_t *s, uint32_t delay, wheel_fit_t *r)
+{
+    uint32_t still = 0;
+
+    r->stickMax = 0.0f;
+    r->breakMin = 1.0f;
+    r->breakaways = 0U;
+    for (uint32_t k = 0; k < s->n; k++)
+    {
+        if (s->gap[k])
+        {
+            still = 0U;
+        }
+        if (fabsf(s->w[k]) < STILL_RAD_S)
+        {
+            float held = fabsf(s->u[k]);
+            uint32_t j;
+
+            still++;
+            for (j = k + 1U; j < s->n && j <= k + STICK_HOLD_BINS; j++)
+            {
+                if (s->gap[j] || fabsf(s->w[j]) >= STILL_RAD_S) break;
+                held = fminf(held, fabsf(s->u[j]));
+            }
+            if (j > k + STICK_HOLD_BINS && held > r->stickMax)
+            {
+                r->stickMax = held;
+            }
+            continue;
+        }
+        if (still >= 3U && k > delay)
+        {
+            float start = 0.0f;
+            for (uint32_t j = k - 1U - delay; j <= k; j++)
+            {
+                start = fmaxf(start, fabsf(s->u[j]));
+            }
+            r->breakMin = fminf(r->breakMin, start);
+            r->breakaways++;
+        }
+        still = 0U;
+    }
+}
+
+static bool DeadbandResolved(const wheel_fit_t *r)
+{
+    return r->breakaways != 0U && r->breakMin - r->stickMax <= DEADBAND_RESOLVED;
+}
+
+static void FitWheel(const series_t *s, double dt, uint32_t maxDelay, wheel_fit_t *r)
+{
+    double best = -1.0, x[3];
+    uint32_t delay = 0U;
+
+    memset(r, 0, sizeof(*r));
+    if (s->n < 100U)
+    {
+        return;
+    }
+
+    /* First order plus dead time: every dead time up to maxDelay bins, the best residual */
+    for (uint32_t d = 0; d <= maxDelay; d++)
+    {
+        normal_t ne;
+        double xd[3];
+
+        memset(&ne, 0, sizeof(ne));
+        for (uint32_t k = d; k + 1U < s->n; k++)
+        {
+            if (!Continuous(s, k, d)) continue;
+            double reg[2] = {s->w[k], s->u[k - d]};
+            NormalAdd(&ne, reg, 2U, s->w[k + 1U]);
+        }
+        double ss = NormalSolve(&ne, 2U, xd);
+        if (ss >= 0.0 && (best < 0.0 || ss < best) && xd[0] > 0.0 && xd[0] < 1.0)
+        {
+            best = ss;
+            delay = d;
+            memcpy(x, xd, sizeof(x));
+        }
+    }
+    if (best < 0.0 || !ToModel(x, dt, delay, &r->fopdt))
+    {
+        return;
+    }
+
+    /* Deadband first: the DC fit leaves out the duties a still wheel held */
+    FitDeadband(s, delay, r);
+    float band = r->stickMax;
+
+    /* DC motor on the same dead time: turning, driven its way (the PWM off is the bridge's brake or coast) */
+    normal_t ne;
+    memset(&ne, 0, sizeof(ne));
+    for (uint32_t k = delay; k + 1U < s->n; k++)
+    {
+        float u = s->u[k - delay];
+        if (!Continuous(s, k, delay) || fabsf(s->w[k]) < STILL_RAD_S || fabsf(s->w[k + 1U]) < STILL_RAD_S) continue;
+        if (fabsf(u) <= band || Sgn(u) != Sgn(s->w[k])) continue;
+        double reg[3] = {s->w[k], u, -Sgn(s->w[k])};
+        NormalAdd(&ne, reg, 3U, s->w[k + 1U]);
+    }
+    r->moving = ne.n;
+    if (NormalSolve(&ne, 3U, x) < 0.0 || !ToModel(x, dt, delay, &r->dc))
+    {
+        return;
+    }
+    r->dc.coulomb = fmaxf((float)(x[2] / (1.0 - x[0])), 0.0f);
+    /* Only steps started it (no slow starts in the log): the most it held, and a wheel needs
+     * at least the Coulomb friction's duty to start */
+    r->dc.deadband = DeadbandResolved(r) ? r->breakMin : fmaxf(band, r->dc.coulomb / r->dc.gain);
+
+    Simulate(s, &r->fopdt, dt, &r->fopdtRms, &r->fopdtFit);
+    Simulate(s, &r->dc, dt, &r->dcRms, &r->dcFit);
+    r->ok = true;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Output                                                                     */
+/* ------------------------------------------------------------------------- */
+
+static void PrintModel(const char *name, const motor_model_t *m)
+{
+    printf("    %-6s gain %6.2f rad/s  tau %5.1f ms  dead %4.1f ms  coulomb %5.3f rad/s  deadband %5.3f\n", name,
+           m->gain, m->tau * 1000.0f, m->dead_time * 1000.0f, m->coulomb, m->deadband);
+}
+
+static void WriteEntry(FILE *h, const motor_model_t *m, const char *note)
+{
+    fprintf(h, "        { %.3ff, %.4ff, %.4ff, %.3ff, %.3ff },    /* %s */ \\\n", m->gain, m->tau, m->dead_time,
+            m->coulomb, m->deadband, note);
+}
+
+static bool WriteHeader(const char *path, const char *source, const wheel_fit_t *fit)
+{
+    const motor_model_t def = MOTOR_MODEL_DEFAULT;
+    FILE *h = fopen(path, "w");
+    char note[64];
+
+    if (h == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    fprintf(h, "/* MOTOR MODEL FIT, written by HOST_SIM/tools/motor_ident.c from %s\n", source);
+    fprintf(h, " * (%.0f ms bins). Goes next to MCXN947_Project.c, used with ROBOT_MOTOR_MODEL_FIT=1.\n",
+            s_binUs / 1000.0);
+    fprintf(h, " */\n#ifndef MOTOR_MODEL_FIT_H_\n#define MOTOR_MODEL_FIT_H_\n\n#include \"motor_model.h\"\n\n");
+
+    fprintf(h, "/* DC motor fits, wheels M1..M4: { gain, tau, dead_time, coulomb, deadband } */\n");
+    fprintf(h, "#define MOTOR_MODEL_FIT_TABLE    {                                   \\\n");
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        snprintf(note, sizeof(note), fit[i].ok ? "M%u, fit %.1f %%" : "M%u, no data: MOTOR_MODEL_DEFAULT", i + 1U,
+                 fit[i].dcFit);
+        WriteEntry(h, fit[i].ok ? &fit[i].dc : &def, note);
+    }
+    fprintf(h, "    }\n\n");
+
+    fprintf(h, "/* First order plus dead time fits, same order (coulomb and deadband 0) */\n");
+    fprintf(h, "#define MOTOR_MODEL_FIT_FOPDT_TABLE {                                \\\n");
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        snprintf(note, sizeof(note), fit[i].ok ? "M%u, fit %.1f %%" : "M%u, no data: MOTOR_MODEL_DEFAULT", i + 1U,
+                 fit[i].fopdtFit);
+        WriteEntry(h, fit[i].ok ? &fit[i].fopdt : &def, note);
+    }
+    fprintf(h, "    }\n\n#endif /* MOTOR_MODEL_FIT_H_ */\n");
+    fclose(h);
+    return true;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-f log] [-o header] [-d ms] [-D ms] [-t s] [-w log] [-r seed]\n"
+           "  -f log     ROBOT_MOTOR_TRACE console log or pid_schedule_sim -c CSV, '-' for stdin\n"
+           "             (default: %u s generated, plants known)\n"
+           "  -o header  write the fits as motor_model_fit.h\n"
+           "  -d ms      bin (default %.0f, the trace period)\n"
+           "  -D ms      longest dead time tried (default %.0f)\n"
+           "  -t s       length of the generated log\n"
+           "  -w log     also write the generated log, in the trace format\n"
+           "  -r seed    seed of the generated log\n",
+           prog, GEN_SECONDS, DEFAULT_BIN_MS, DEFAULT_MAX_DEAD_MS);
+}
+
+int main(int argc, char **argv)
+{
+    FILE *f = NULL, *genOut = NULL;
+    const char *source = "a generated log", *header = NULL;
+    float maxDeadMs = DEFAULT_MAX_DEAD_MS;
+    uint32_t seconds = GEN_SECONDS;
+    wheel_fit_t fit[WHEELS];
+    struct timespec t0, t1, t2;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:o:d:D:t:w:r:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                f = (strcmp(optarg, "-") == 0) ? stdin : fopen(optarg, "r");
+                if (f == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                source = optarg;
+                break;
+            case 'o':
+                header = optarg;
+                break;
+            case 'd':
+                s_binUs = (uint64_t)(atof(optarg) * 1000.0);
+                if (s_binUs == 0U)
+                {
+                    fprintf(stderr, "-d: bin of at least 1 us\n");
+                    return 1;
+                }
+                break;
+            case 'D':
+                maxDeadMs = (float)atof(optarg);
+                break;
+            case 't':
+                seconds = (uint32_t)atoi(optarg);
+                break;
+            case 'w':
+                genOut = fopen(optarg, "w");
+                if (genOut == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'r':
+                s_rng = (uint32_t)strtoul(optarg, NULL, 0);
+                break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (f != NULL)
+    {
+        ReadLog(f);
+        if (f != stdin) fclose(f);
+    }
+    else
+    {
+        Generate(seconds, genOut);
+        if (genOut != NULL) fclose(genOut);
+    }
+    Flush();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+
+    double dt = s_binUs / 1e6;
+    uint32_t maxDelay = (uint32_t)(maxDeadMs / 1000.0 / dt + 0.5);
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        FitWheel(&s_series[i], dt, maxDelay, &fit[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t2);
+
+    printf("%u log lines, %.0f ms bins; read %.2f s, fit %.2f s\n", s_lines, dt * 1000.0,
+           (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9,
+           (t2.tv_sec - t1.tv_sec) + (t2.tv_nsec - t1.tv_nsec) / 1e9);
+    for (uint32_t i = 0; i < WHEELS; i++)
+    {
+        const series_t *s = &s_series[i];
+        const wheel_fit_t *r = &fit[i];
+
+        printf("\nM%u: %u bins", i + 1U, s->n);
+        if (!r->ok)
+        {
+            printf(", no fit (too few samples, or no steps in them)\n");
+            continue;
+        }
+        printf(", %u turning and driven\n", r->moving);
+        PrintModel("fopdt", &r->fopdt);
+        printf("           open loop: rms %.3f rad/s, fit %.1f %%\n", r->fopdtRms, r->fopdtFit);
+        PrintModel("dc", &r->dc);
+        printf("           open loop: rms %.3f rad/s, fit %.1f %%\n", r->dcRms, r->dcFit);
+        printf("           still up to duty %.3f, started from %.3f (%u starts)%s\n", r->stickMax,
+               (r->breakaways != 0U) ? r->breakMin : 0.0f, r->breakaways,
+               DeadbandResolved(r) ? "" : ", deadband not resolved: drive slow ramps from standstill");
+        if (f == NULL)
+        {
+            motor_plant_params_t p;
+            motor_model_t truth;
+
+            GenPlant(i, &p);
+            truth.gain = p.noLoadSpeed / (1.0f - p.frictionDuty);
+            truth.tau = p.tau;
+            truth.dead_time = 0.0f;
+            truth.coulomb = truth.gain * p.frictionDuty;
+            truth.deadband = p.frictionDuty;
+            PrintModel("true", &truth);
+        }
+        else
+        {
+            motor_plant_params_t p = MOTOR_PLANT_DEFAULT_PARAMS;
+
+            MotorPlant_FromModel(&p, &r->dc);
+            printf("           as a plant: pid_schedule_sim -p %.2f,%.3f,%.1f,%.3f\n", p.noLoadSpeed, p.tau,
+                   p.stallCurrent, p.frictionDuty);
+        }
+    }
+
+    if (header != NULL)
+    {
+        if (!WriteHeader(header, source, fit))
+        {
+            return 1;
+        }
+        printf("\nwrote %s\n", header);
+    }
+    return 0;
+}
@@ -0,0 +1,338 @@
+/*
+ * omni_sync_check.c
+ *
+ * The clock sync estimator (COMMON/omni_sync.h) against clocks whose offset
+ * and drift are known. The remote clock is the reference; the robot clock is
+ * offset + (1 + drift) * remote. Commands go out every 5 ms and telemetry
+ * comes back every 5 ms; each link has a random delay, some outliers (air
+ * retries) and some loss, and the telemetry link is slower by a fixed time
+ * (its frames wait for the remote's next exchange), which the estimator
+ * cannot see. The links keep the frames in order, as the bridges do.
+ *
+ * After every telemetry frame it checks that:
+ *   - the estimated offset is within its bound of the true offset
+ *   - a robot stamp converted with omni_sync_to_remote() is within the bound
+ *     of the remote time it was taken at
+ *   - the one-way command time is within the bound of the true one
+ *   - the offset does not jump, across the 32-bit wrap of either clock or
+ *     the +-2^31 us point of the frames' 32-bit offset
+ * and at the end that the drift is within its bound of the true drift.
+ *
+ * The cases start the remote just before its 32-bit wrap and run past the
+ * next one (71.6 min). Exits 1 if a check failed.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "omni_sync.h"
+
+#define CHECK_SECONDS       4600U           /* Past the next 32-bit wrap of the remote clock */
+#define CHECK_REMOTE_START  4290000000ULL   /* 5 s before its first wrap */
+#define CHECK_PERIOD_US     5000U           /* Commands and telemetry, both ways */
+#define CHECK_SETTLE_US     20000000ULL     /* Bound statistics from here on (20 window minima) */
+#define CHECK_JUMP_US       1000000         /* An offset step this large is a wrap gone wrong */
+#define CHECK_IN_FLIGHT     64U             /* Commands on the link at once (power of two) */
+
+typedef struct
+{
+    int64_t offset_us;      /* Robot clock at remote time 0 */
+    int32_t drift_ppm;
+} check_case_t;
+
+static const check_case_t s_cases[] = {
+    {0, 0},
+    {5000000000LL, 100},                        /* Robot up 83 min longer: it wraps first */
+    {-4000000000LL, -100},                      /* Robot up 67 min less */
+    {2147483648LL - 3000000LL, 1000},           /* Crosses the +2^31 us point of the 32-bit offset */
+    {-2147483648LL + 3000000LL, -1000},         /* Crosses -2^31 */
+    {12345678901LL, 15000},                     /* The two +-1 % clocks of OMNI_SYNC_TOLERANCE_PPB, and more */
+    {-1234567890LL, -15000},
+};
+
+typedef struct
+{
+    uint32_t checks;
+    uint32_t offsetFails;
+    uint32_t convertFails;
+    uint32_t latencyFails;
+    uint32_t jumps;
+    double maxErrUs;
+    double maxBoundUs;
+    double sumBoundUs;
+    uint32_t boundCount;
+} check_result_t;
+
+static uint32_t s_seconds = CHECK_SECONDS;
+static uint32_t s_lossPct = 5U;
+static uint32_t s_outlierPct = 10U;
+static uint32_t s_seed = 1U;
+static uint32_t s_asymmetryUs = 2000U;
+
+static int64_t s_offsetUs;
+static double s_drift;
+
+/* Robot clock at remote time t */
+static uint64_t RobotUs(double t)
+{
+    return (uint64_t)((double)s_offsetUs + t * (1.0 + s_drift) + 0.5);
+}
+
+/* Robot - remote at remote time t, exact */
+static double TrueOffsetUs(double t)
+{
+    return (double)s_offsetUs + t * s_drift;
+}
+
+/* Estimate - truth modulo 2^32: frames carry 32 bits, so does the estimator's offset */
+static double OffsetErrUs(int64_t estimate, double t)
+{
+    int64_t truth = (int64_t)(TrueOffsetUs(t) + ((TrueOffsetUs(t) < 0.0) ? -0.5 : 0.5));
+    return (double)(int32_t)((uint32_t)estimate - (uint32_t)truth) - (TrueOffsetUs(t) - (double)truth);
+}
+
+static double Uniform(double lo, double hi)
+{
+    return lo + (hi - lo) * ((double)rand() / ((double)RAND_MAX + 1.0));
+}
+
+static bool Percent(uint32_t pct)
+{
+    return (uint32_t)(rand() % 100) < pct;
+}
+
+/* One-way link delay: 1 to 5 ms, an outlier 20 to 40 ms more */
+static double LinkDelayUs(double extraUs)
+{
+    double d = extraUs + Uniform(1000.0, 5000.0);
+    return Percent(s_outlierPct) ? d + Uniform(20000.0, 40000.0) : d;
+}
+
+static double Abs(double x)
+{
+    return (x < 0.0) ? -x : x;
+}
+
+static void CheckBound(double err, uint32_t bound, uint32_t *fails)
+{
+    /* +1: the robot clock reads whole microseconds */
+    if (Abs(err) > (double)bound + 1.0)
+    {
+        (*fails)++;
+    }
+}
+
+static bool RunCase(const check_case_t *c, check_result_t *r)
+{
+    const double start = (double)CHECK_REMOTE_START;
+    const double end = start + (double)s_seconds * 1e6;
+    omni_sync_t sync;
+    omni_sync_estimate_t est;
+    bool havePrev = false;
+    int64_t prevOffset = 0;
+
+    /* The robot's last command, as it echoes it */
+    bool robotHasCmd = false;
+    uint16_t robotCmd = 0U;
+    double robotCmdT2 = 0.0;
+    /* Commands on the command link, in order */
+    uint16_t flightCount[CHECK_IN_FLIGHT];
+    double flightT2[CHECK_IN_FLIGHT];
+    uint32_t flightHead = 0U;
+    uint32_t flightTail = 0U;
+    double lastT2 = 0.0;
+    double lastT4 = 0.0;
+    uint16_t count = 0U;
+
+    s_offsetUs = c->offset_us;
+    s_drift = (double)c->drift_ppm * 1e-6;
+    srand(s_seed);
+    omni_sync_init(&sync);
+    *r = (check_result_t){0};
+
+    for (double t = start; t < end; t += CHECK_PERIOD_US)
+    {
+        /* Command out at t1 (low 32 bits on the wire, the sender keeps 64) */
+        double t1 = t;
+        omni_sync_sent(&sync, count, (uint64_t)t1);
+        if (!Percent(s_lossPct))
+        {
+            double t2 = t1 + LinkDelayUs(0.0);
+            if (t2 < lastT2)
+            {
+                t2 = lastT2;
+            }
+            lastT2 = t2;
+            if (flightTail - flightHead < CHECK_IN_FLIGHT)
+            {
+                flightCount[flightTail % CHECK_IN_FLIGHT] = count;
+                flightT2[flightTail % CHECK_IN_FLIGHT] = t2;
+                flightTail++;
+            }
+        }
+        count++;
+
+        /* Telemetry filled at t3, sometime in this period */
+        double t3 = t + Uniform(0.0, (double)CHECK_PERIOD_US);
+        while ((flightHead != flightTail) && (flightT2[flightHead % CHECK_IN_FLIGHT] <= t3))
+        {
+            robotHasCmd = true;
+            robotCmd = flightCount[flightHead % CHECK_IN_FLIGHT];
+            robotCmdT2 = flightT2[flightHead % CHECK_IN_FLIGHT];
+            flightHead++;
+        }
+        if (!robotHasCmd || Percent(s_lossPct))
+        {
+            continue;
+        }
+
+        RobotTelemetry_t tel = {0};
+        uint32_t robotT3 = (uint32_t)RobotUs(t3);
+        tel.timestamp = robotT3;
+        tel.sync_cmd_count = robotCmd;
+        tel.sync_hold_us = omni_sync_hold_us(robotT3, (uint32_t)RobotUs(robotCmdT2));
+
+        double t4 = t3 + LinkDelayUs((double)s_asymmetryUs);
+        if (t4 < lastT4)
+        {
+            t4 = lastT4;
+        }
+        lastT4 = t4;
+
+        /* The estimate omni_sync_receive() measures the one-way times with */
+        const omni_sync_sample_t *base = omni_sync_base(&sync);
+        bool hadEstimate = false;
+        uint32_t t1Bound = 0U;
+        double sentT1 = sync.sent_us[robotCmd % OMNI_SYNC_SENT_SLOTS];
+        if ((base != NULL) && omni_sync_get(&sync, (uint64_t)sentT1, &est))
+        {
+            hadEstimate = true;
+            t1Bound = est.bound_us;
+        }
+
+        if (!omni_sync_receive(&sync, &tel, (uint64_t)t4))
+        {
+            continue;
+        }
+
+        /* robotCmd was sent at sentT1 and arrived at robotCmdT2 */
+        if (hadEstimate)
+        {
+            CheckBound((double)sync.cmd_latency_us - (robotCmdT2 - sentT1), t1Bound + 1U, &r->latencyFails);
+        }
+
+        double now = t4 + 100.0;
+        if (!omni_sync_get(&sync, (uint64_t)now, &est))
+        {
+            continue;
+        }
+        r->checks++;
+
+        double err = OffsetErrUs(est.offset_us, now);
+        CheckBound(err, est.bound_us, &r->offsetFails);
+        if (now - start >= (double)CHECK_SETTLE_US)
+        {
+            if (Abs(err) > r->maxErrUs) r->maxErrUs = Abs(err);
+            if ((double)est.bound_us > r->maxBoundUs) r->maxBoundUs = (double)est.bound_us;
+            r->sumBoundUs += (double)est.bound_us;
+            r->boundCount++;
+        }
+
+        /* The telemetry stamp back on the remote clock: it was filled at t3 */
+        uint64_t remoteT3;
+        if (omni_sync_to_remote(&sync, robotT3, (uint64_t)now, &remoteT3))
+        {
+            CheckBound((double)remoteT3 - t3, est.bound_us + 1U, &r->convertFails);
+        }
+
+        if (havePrev && ((est.offset_us - prevOffset > CHECK_JUMP_US) || (prevOffset - est.offset_us > CHECK_JUMP_US)))
+        {
+            r->jumps++;
+        }
+        prevOffset = est.offset_us;
+        havePrev = true;
+    }
+
+    /* Drift: the slope over the last window minima */
+    bool driftOk = false;
+    if (omni_sync_get(&sync, (uint64_t)end, &est))
+    {
+        double errPpb = (double)est.drift_ppb - (double)c->drift_ppm * 1000.0;
+        driftOk = (Abs(errPpb) <= (double)sync.drift_bound_ppb + 1.0);
+        printf("%14lld %7d %9u %9u %8u %8.0f %8.0f %8.0f %8.0f %6u %s\n", (long long)c->offset_us, (int)c->drift_ppm,
+               (unsigned)sync.samples, (unsigned)sync.unmatched, (unsigned)r->checks, r->maxErrUs,
+               (r->boundCount != 0U) ? r->sumBoundUs / r->boundCount : 0.0, r->maxBoundUs, errPpb,
+               (unsigned)sync.drift_bound_ppb,
+               (r->offsetFails + r->convertFails + r->latencyFails + r->jumps == 0U && driftOk) ? "ok" : "FAIL");
+    }
+    if (r->offsetFails + r->convertFails + r->latencyFails + r->jumps != 0U)
+    {
+        printf("  offset out of bound %u, conversion %u, command time %u, jumps %u\n", (unsigned)r->offsetFails,
+               (unsigned)r->convertFails, (unsigned)r->latencyFails, (unsigned)r->jumps);
+    }
+    return driftOk && (r->offsetFails + r->convertFails + r->latencyFails + r->jumps == 0U);
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-t S] [-a US] [-l PCT] [-j PCT] [-s SEED] [-o US -d PPM]\n"
+           "  -t S     simulated seconds per case (default %u, past the remote's next 32-bit wrap)\n"
+           "  -a US    telemetry link slower than the command link by (default 2000)\n"
+           "  -l PCT   frames lost on each link (default 5)\n"
+           "  -j PCT   frames delayed 20 to 40 ms more (default 10)\n"
+           "  -s SEED  random seed (default 1)\n"
+           "  -o US    one case: robot clock at remote time 0 (default: the built-in cases)\n"
+           "  -d PPM   one case: robot clock rate - remote clock rate\n",
+           prog, CHECK_SECONDS);
+}
+
+int main(int argc, char **argv)
+{
+    check_case_t one = {0, 0};
+    bool single = false;
+    int failures = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t:a:l:j:s:o:d:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 't': s_seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'a': s_asymmetryUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'l': s_lossPct = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'j': s_outlierPct = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 's': s_seed = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'o': one.offset_us = strtoll(optarg, NULL, 0); single = true; break;
+            case 'd': one.drift_ppm = (int32_t)strtol(optarg, NULL, 0); single = true; break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_seconds == 0U || s_lossPct >= 100U || s_outlierPct > 100U)
+    {
+        fprintf(stderr, "-t/-l/-j: see -h\n");
+        return 1;
+    }
+
+    printf("%u s per case, asymmetry %u us, loss %u %%, outliers %u %%, seed %u\n", (unsigned)s_seconds,
+           (unsigned)s_asymmetryUs, (unsigned)s_lossPct, (unsigned)s_outlierPct, (unsigned)s_seed);
+    printf("%14s %7s %9s %9s %8s %8s %8s %8s %8s %6s\n", "offset us", "ppm", "samples", "unmatched", "checks",
+           "max err", "bound", "max bnd", "drift er", "d bnd");
+    if (single)
+    {
+        check_result_t r;
+        failures += RunCase(&one, &r) ? 0 : 1;
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(s_cases) / sizeof(s_cases[0]); i++)
+        {
+            check_result_t r;
+            failures += RunCase(&s_cases[i], &r) ? 0 : 1;
+        }
+    }
+    return (failures == 0) ? 0 : 1;
+}
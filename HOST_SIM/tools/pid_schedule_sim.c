@@ -0,0 +1,448 @@
+/*
+ * pid_schedule_sim.c
+ *
+ * Step responses of the robot's wheel PID across the speed range: the fixed
+ * gains of PID1..4, a speed-scheduled table (omni_gains.h; SIM_GAINS_TABLE
+ * below or -g), and the table with the 2DOF form of pid_compute()
+ * (PID_FORM_2DOF).
+ *
+ * The robot firmware (MCXN947_Project.c, omnidriver.c) runs unchanged on the
+ * simulated board of the twin (robot_board.c, four motor plants), alone and
+ * in simulated time as fast as the host goes; the tool sets ROBOT.vx like a
+ * command would. Every wheel then has the same target. It steps from
+ * standstill to every target, then through zero (a reversal) and to a stop,
+ * and reports the 5 % settling time, the overshoot and the error left at the
+ * end of the hold, for every controller.
+ *
+ * Also times omni_gains_lookup() on the host against the PID period.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_hooks.h"
+#include "robot_board.h"
+#include "omnidriver.h"
+#include "omni_gains.h"
+
+#define SIM_SLICE_US        500U        /* Simulated time per main loop idle */
+#define SIM_BOOT_US         300000U     /* Before the first step (IMU power-up) */
+#define SIM_HOLD_US         1500000U    /* At the target, and at the start speed before a step from it */
+#define SIM_REST_US         1000000U    /* Back at standstill */
+#define SIM_BAND            0.05f       /* Settled: within 5 % of the step */
+#define SIM_TAIL_US         300000U     /* Error: mean over the end of the hold */
+#define SIM_MAX_STEPS       18U
+#define SIM_MODES           3U
+#define SIM_LOOKUPS         20000000U
+
+/* Table tuned on the motor model, a starting point for tuning on the robot
+ * (the robot's default table is its fixed gains). Ki near Kp/tau cancels the
+ * motor's pole; near standstill the encoder sees few edges and the speed
+ * lags, so less gain there. At speed the duty saturates on a step and the
+ * classic integral winds up, so less Ki there. The PID_FORM_2DOF controller
+ * tracks the saturated PWM instead and is faster without the last two
+ * points. { speed rad/s, Kp, Ki, Kd } */
+#define SIM_GAINS_POINTS    4U
+#define SIM_GAINS_TABLE     {                               \
+        { 0.5f,  10000.0f, 100000.0f, 0.1f },               \
+        { 2.0f,  35000.0f, 700000.0f, 0.1f },               \
+        { 6.0f,  50000.0f, 250000.0f, 0.1f },               \
+        { 10.0f, 50000.0f, 150000.0f, 0.1f },               \
+    }
+
+extern int RobotFw_Main(void);
+extern ROBOT_T ROBOT;
+extern MOTOR_T M1, M2, M3, M4;
+extern PID_CONFIG PID1, PID2, PID3, PID4;
+extern omni_gains_t pidGains;
+
+typedef struct {
+    const char *name;
+    bool schedule;
+    PID_FORM form;
+} sim_mode_t;
+
+typedef struct {
+    float from;             /* Wheel speed held before the step (rad/s) */
+    float to;
+} sim_step_t;
+
+typedef struct {
+    float settleMs;         /* < 0: never settled */
+    float overshoot;        /* % of the step, past the target */
+    float error;            /* % of the step, mean over the tail */
+} step_result_t;
+
+static const sim_mode_t s_modes[SIM_MODES] = {
+    {"fixed", false, PID_FORM_CLASSIC},
+    {"scheduled", true, PID_FORM_CLASSIC},
+    {"2dof", true, PID_FORM_2DOF},
+};
+
+/* From standstill, then through zero and to a stop (always run, -s sets the first ones) */
+static sim_step_t s_steps[SIM_MAX_STEPS] = {
+    {0.0f, 0.5f}, {0.0f, 1.0f}, {0.0f, 2.0f}, {0.0f, 3.0f}, {0.0f, 4.0f}, {0.0f, 6.0f}, {0.0f, 8.0f}, {0.0f, 10.0f},
+};
+static uint32_t s_stepCount = 8U;
+static step_result_t s_result[SIM_MODES][SIM_MAX_STEPS];
+static FILE *s_out;
+static omni_gain_table_t s_table = {SIM_GAINS_POINTS, SIM_GAINS_TABLE};    /* Or -g */
+static bool s_haveTable = true;
+static FILE *s_csv;                 /* -c */
+
+/* Script state */
+static uint32_t s_mode;
+static uint32_t s_step;
+static uint64_t s_stepUs;           /* Start of the current step, 0 = not in one */
+static bool s_atStart;              /* Holding the start speed of s_step */
+static uint64_t s_nextUs = SIM_BOOT_US;
+static uint64_t s_lastOutUs;        /* Last tick outside the band */
+static float s_peak;                /* Furthest past the target, towards the step */
+static double s_tailSum;
+static uint32_t s_tailN;
+
+static uint64_t SimNowUs(void)
+{
+    return RobotBoard_NowUs();
+}
+
+static void UseMode(const sim_mode_t *mode)
+{
+    PID_CONFIG *pids[4] = {&PID1, &PID2, &PID3, &PID4};
+
+    for (uint32_t i = 0; i < 4U; i++)
+    {
+        pids[i]->gains = mode->schedule ? &pidGains : NULL;
+        pids[i]->form = mode->form;
+        pids[i]->integral_err = 0.0f;
+        pids[i]->derivative = 0.0f;
+        if (!mode->schedule)
+        {
+            /* Back to the fixed gains of MCXN947_Project.c, the schedule overwrote them */
+            pids[i]->Kp = 35000.0f;
+            pids[i]->Ki = 20000.0f;
+            pids[i]->Kd = 0.1f;
+        }
+    }
+}
+
+/* PID ticks: wheel 0 against its target (all four wheels have the same target) */
+static void SimTick(uint32_t lptmr)
+{
+    const sim_step_t *st = &s_steps[s_step];
+    uint64_t now = RobotBoard_NowUs();
+    float w = RobotBoard_GetWheel(0)->omega;
+    float span = fabsf(st->to - st->from);
+    float past = (st->to > st->from) ? w - st->to : st->to - w;
+
+    if (lptmr != 1U)
+    {
+        return;
+    }
+    if (s_csv != NULL)
+    {
+        fprintf(s_csv, "%llu,%u,%.3f,%.4f,%.4f,%.4f,%.0f,%.0f\n", (unsigned long long)now, (unsigned)s_mode,
+                M1.target, M1.speed, w, RobotBoard_GetDuty(0), PID1.Kp, PID1.Ki);
+    }
+    if (s_stepUs == 0U)
+    {
+        return;
+    }
+    if (fabsf(w - st->to) > SIM_BAND * span)
+    {
+        s_lastOutUs = now;
+    }
+    if (past > s_peak)
+    {
+        s_peak = past;
+    }
+    if (now - s_stepUs >= SIM_HOLD_US - SIM_TAIL_US)
+    {
+        s_tailSum += fabsf(w - st->to);
+        s_tailN++;
+    }
+}
+
+static void EndStep(void)
+{
+    step_result_t *r = &s_result[s_mode][s_step];
+    float span = fabsf(s_steps[s_step].to - s_steps[s_step].from);
+
+    /* Still out of the band at the end of the hold: not settled */
+    r->settleMs = (s_stepUs + SIM_HOLD_US - s_lastOutUs > SIM_TAIL_US) ? (float)(s_lastOutUs - s_stepUs) / 1000.0f
+                                                                       : -1.0f;
+    r->overshoot = 100.0f * s_peak / span;
+    r->error = (s_tailN != 0U) ? 100.0f * (float)(s_tailSum / s_tailN) / span : 0.0f;
+}
+
+static void Report(void)
+{
+    fprintf(s_out, "Wheel steps (rad/s), settled within 5 %% of the step; overshoot and error in %% of the step.\n");
+    fprintf(s_out, "Error: mean over the last %u ms of the %u ms hold.\n\n", SIM_TAIL_US / 1000U, SIM_HOLD_US / 1000U);
+    fprintf(s_out, "  %13s", "");
+    for (uint32_t m = 0; m < SIM_MODES; m++)
+    {
+        fprintf(s_out, " | %-26s", s_modes[m].name);
+    }
+    fprintf(s_out, "\n  %13s", "step");
+    for (uint32_t m = 0; m < SIM_MODES; m++)
+    {
+        fprintf(s_out, " | %10s %7s %7s", "settle ms", "over", "error");
+    }
+    fprintf(s_out, "\n");
+    for (uint32_t i = 0; i < s_stepCount; i++)
+    {
+        fprintf(s_out, "  %5.1f -> %5.1f", s_steps[i].from, s_steps[i].to);
+        for (uint32_t m = 0; m < SIM_MODES; m++)
+        {
+            const step_result_t *r = &s_result[m][i];
+            if (r->settleMs < 0.0f)
+            {
+                fprintf(s_out, " | %10s", "-");
+            }
+            else
+            {
+                fprintf(s_out, " | %10.1f", r->settleMs);
+            }
+            fprintf(s_out, " %7.1f %7.1f", r->overshoot, r->error);
+        }
+        fprintf(s_out, "\n");
+    }
+    fprintf(s_out, "  (settle - : still outside the band at the end of the hold)\n");
+
+    fprintf(s_out, "\nTable in use:\n");
+    const omni_gain_table_t *t = omni_gains_table(&pidGains);
+    for (uint32_t i = 0; i < t->points; i++)
+    {
+        fprintf(s_out, "  %5.2f rad/s  Kp %8.0f  Ki %8.0f  Kd %.3f\n", t->point[i].speed, t->point[i].kp,
+                t->point[i].ki, t->point[i].kd);
+    }
+    fprintf(s_out, "2dof: b %.2f  Tf %.1f ms  Tt %s\n", PID1.b, PID1.Tf * 1000.0f, (PID1.Tt > 0.0f) ? "set" : "Kp/Ki");
+}
+
+static void TimeLookup(void)
+{
+    const omni_gain_table_t *t = omni_gains_table(&pidGains);
+    struct timespec a, b;
+    volatile float sink = 0.0f;
+    omni_gain_point_t g;
+    float speed = 0.0f;
+
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    for (uint32_t i = 0; i < SIM_LOOKUPS; i++)
+    {
+        speed += 0.37f;
+        if (speed > 12.0f)
+        {
+            speed -= 12.0f;
+        }
+        omni_gains_lookup(t, speed, &g);
+        sink += g.kp;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &b);
+
+    double ns = ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / SIM_LOOKUPS;
+    fprintf(s_out, "\nomni_gains_lookup(), %u points: %.1f ns per call on this host, 4 per PID tick of %.1f us\n",
+            (unsigned)t->points, ns, 1e6 / PID_TIMER_FREQ);
+    fprintf(s_out, "(on the robot: build with PID_SCHEDULE_PROFILE=1, it reports the cycles every 5 s)\n");
+    (void)sink;
+}
+
+/* Robot main loop idle: run the board and the script */
+static bool SimIdle(uint32_t us)
+{
+    uint64_t now = RobotBoard_NowUs();
+
+    (void)us;
+    if (now >= s_nextUs)
+    {
+        const sim_step_t *st = &s_steps[s_step];
+
+        if (s_stepUs != 0U)
+        {
+            /* End of a hold: back to standstill */
+            EndStep();
+            s_stepUs = 0U;
+            ROBOT.vx = 0.0f;
+            s_nextUs = now + SIM_REST_US;
+            if (++s_step == s_stepCount)
+            {
+                s_step = 0U;
+                if (++s_mode == SIM_MODES)
+                {
+                    Report();
+                    TimeLookup();
+                    fflush(s_out);
+                    if (s_csv != NULL)
+                    {
+                        fclose(s_csv);
+                    }
+                    return false;
+                }
+            }
+        }
+        else if (st->from != 0.0f && !s_atStart)
+        {
+            /* Get to the start speed first */
+            if (s_step == 0U)
+            {
+                UseMode(&s_modes[s_mode]);
+            }
+            s_atStart = true;
+            ROBOT.vx = st->from * WHEEL_RADIUS;
+            s_nextUs = now + SIM_HOLD_US;
+        }
+        else
+        {
+            if (s_haveTable)
+            {
+                /* main() has set the default table by now */
+                omni_gains_init(&pidGains, &s_table);
+                s_haveTable = false;
+            }
+            if (s_step == 0U && !s_atStart)
+            {
+                UseMode(&s_modes[s_mode]);
+            }
+            s_atStart = false;
+            s_stepUs = now;
+            s_lastOutUs = now;
+            s_peak = 0.0f;
+            s_tailSum = 0.0;
+            s_tailN = 0U;
+            ROBOT.vx = st->to * WHEEL_RADIUS;
+            s_nextUs = now + SIM_HOLD_US;
+        }
+    }
+    RobotBoard_RunUntil(now + SIM_SLICE_US);
+    return true;
+}
+
+/* "s,kp,ki,kd;s,kp,ki,kd;..." */
+static bool ParseTable(const char *arg, omni_gain_table_t *t)
+{
+    const char *p = arg;
+
+    memset(t, 0, sizeof(*t));
+    while (*p != '\0' && t->points < OMNI_GAINS_MAX_POINTS)
+    {
+        omni_gain_point_t *g = &t->point[t->points];
+        int n = 0;
+
+        if (sscanf(p, "%f,%f,%f,%f%n", &g->speed, &g->kp, &g->ki, &g->kd, &n) != 4)
+        {
+            return false;
+        }
+        t->points++;
+        p += n;
+        if (*p == ';')
+        {
+            p++;
+        }
+    }
+    return *p == '\0' && omni_gains_valid(t);
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-g table] [-s speeds] [-p motor] [-c csv] [-v]\n"
+           "  -g s,kp,ki,kd;...  gain table to try instead of SIM_GAINS_TABLE\n"
+           "  -s 0.5,1,2,...     steps from standstill (rad/s), at most %u; 5 -> -5 and 5 -> 0 follow\n"
+           "  -p w,tau,I,f       motor: no-load rad/s, time constant s, stall A, friction duty\n"
+           "  -c file.csv        every PID tick: t_us,mode,target,measured,omega,duty,Kp,Ki (mode 0 fixed, 1 scheduled, 2 2dof)\n"
+           "  -v                 keep the robot's console output\n",
+           prog, SIM_MAX_STEPS - 2U);
+}
+
+int main(int argc, char **argv)
+{
+    motor_plant_params_t motor = MOTOR_PLANT_DEFAULT_PARAMS;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "g:s:p:c:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'g':
+                if (!ParseTable(optarg, &s_table))
+                {
+                    fprintf(stderr, "-g: up to %u points s,kp,ki,kd with increasing s\n", OMNI_GAINS_MAX_POINTS);
+                    return 1;
+                }
+                s_haveTable = true;
+                break;
+            case 's':
+            {
+                char *p = optarg;
+                s_stepCount = 0U;
+                while (*p != '\0' && s_stepCount < SIM_MAX_STEPS - 2U)
+                {
+                    float v = strtof(p, &p);
+                    if (!(v > 0.0f))
+                    {
+                        fprintf(stderr, "-s: positive speeds\n");
+                        return 1;
+                    }
+                    s_steps[s_stepCount].from = 0.0f;
+                    s_steps[s_stepCount++].to = v;
+                    if (*p == ',')
+                    {
+                        p++;
+                    }
+                }
+                break;
+            }
+            case 'p':
+                if (sscanf(optarg, "%f,%f,%f,%f", &motor.noLoadSpeed, &motor.tau, &motor.stallCurrent,
+                           &motor.frictionDuty) != 4)
+                {
+                    fprintf(stderr, "-p: four values\n");
+                    return 1;
+                }
+                break;
+            case 'c':
+                s_csv = fopen(optarg, "w");
+                if (s_csv == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    s_steps[s_stepCount++] = (sim_step_t){5.0f, -5.0f};
+    s_steps[s_stepCount++] = (sim_step_t){5.0f, 0.0f};
+
+    /* The firmware prints on stdout: results go to the real one, the rest away unless -v */
+    s_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+    {
+        return 1;
+    }
+
+    RobotBoard_Init(&motor);
+    RobotBoard_AttachWheel(0U, &M1);
+    RobotBoard_AttachWheel(1U, &M2);
+    RobotBoard_AttachWheel(2U, &M3);
+    RobotBoard_AttachWheel(3U, &M4);
+    RobotBoard_SetTickHook(SimTick);
+
+    g_simHooks.now_us = SimNowUs;
+    g_simHooks.spi_xfer = NULL;
+    g_simHooks.idle = SimIdle;
+
+    RobotFw_Main();
+    return 0;
+}
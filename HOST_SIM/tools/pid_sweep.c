@@ -0,0 +1,577 @@
+/*
+ * pid_sweep.c
+ *
+ * Sweeps the wheel PID (form, Kp, Ki, Kd) and the wheel speed limit of the
+ * kinematics (ROBOT_T.max_target) over a grid on all host cores, and prints
+ * the Pareto front.
+ *
+ * The real pid_compute() and ROBOT_compute_kinematics() (omnidriver.c) run
+ * against four motor plants (motor_plant.c) measured like the encoders
+ * (speed = last edge period, unsigned, 0 after the timeout of
+ * check_stopped_motors()). The body velocity follows from the wheel speeds by
+ * the forward kinematics (omni_kin_forward(), rolling without slip, least
+ * squares over the wheels). No firmware main and no board: the few driver
+ * calls of omnidriver.c are stubbed below.
+ *
+ * Every configuration drives the same script of body velocity steps (forward,
+ * diagonal, turn on the spot, stop) and is scored, worst step of the script:
+ *   rise     10 -> 90 % of the step
+ *   over     overshoot, % of the step
+ *   settle   into 5 % of the step for good (- : never, e.g. limit below the step)
+ *   sat      share of the wheel PID ticks at full PWM, over the script
+ * All four are minimized; the front is every configuration no other one beats
+ * on all four.
+ *
+ * Workers are forked processes (the plants and driver stubs are global state):
+ * they take configurations from a counter in shared memory and write the
+ * scores next to it, so they share nothing else and scale with the cores.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "omnidriver.h"
+#include "GPIO_DRIVER.h"
+#include "PWM_DRIVER.h"
+#include "ADC_DRIVER.h"
+#include "motor_plant.h"
+
+#define SWEEP_WHEELS        4U
+#define SWEEP_MAX_WORKERS   256U
+#define SWEEP_COUNTS_CPR    2249.0f     /* OUTPUT_COUNTS_CPR */
+#define SWEEP_TIMEOUT_S     0.2f        /* TIMEOUT_COUNTS */
+#define SWEEP_BAND          0.05f
+#define SWEEP_PID_B         1.0f        /* ROBOT_PID_B / _TF / _TT of MCXN947_Project.c */
+#define SWEEP_PID_TF        0.001f
+#define SWEEP_PID_TT        0.0f
+#define SWEEP_SHOW          30U
+
+typedef struct {
+    float vx, vy, phi;      /* Command (m/s, m/s, rad/s) */
+    float holdS;
+} sweep_step_t;
+
+/* Forward 0.4 m/s (8 rad/s per wheel), diagonal 0.3 + 0.3 m/s (12 rad/s on two wheels),
+ * turn on the spot 2 rad/s (11.3 rad/s), stop */
+static const sweep_step_t s_script[] = {
+    {0.4f, 0.0f, 0.0f, 1.0f},
+    {0.3f, 0.3f, 0.0f, 1.0f},
+    {0.0f, 0.0f, 2.0f, 1.0f},
+    {0.0f, 0.0f, 0.0f, 1.0f},
+};
+#define SWEEP_STEPS         (sizeof(s_script) / sizeof(s_script[0]))
+
+typedef struct {
+    PID_FORM form;
+    float kp, ki, kd;
+    float limit;            /* rad/s */
+} sweep_config_t;
+
+typedef struct {
+    float rise;             /* ms, INFINITY: never reached 90 % */
+    float over;             /* % */
+    float settle;           /* ms, INFINITY: never */
+    float sat;              /* % */
+    bool done;
+} sweep_score_t;
+
+typedef struct {
+    volatile uint32_t next;
+    sweep_score_t score[];
+} sweep_shared_t;
+
+typedef struct {
+    float from, to;
+    uint32_t n;
+    bool log;
+} sweep_range_t;
+
+static motor_plant_params_t s_motor = MOTOR_PLANT_DEFAULT_PARAMS;
+
+/*******************************************************************************
+ * omnidriver.c's drivers: the duty is read back from PID_CONFIG.last_output
+ ******************************************************************************/
+GPIO_Type g_simGpio[5];
+
+void GPIO_PinInit(GPIO_Type *base, uint32_t pin, const gpio_pin_config_t *config)
+{
+    (void)base;
+    (void)pin;
+    (void)config;
+}
+
+#define SWEEP_PORT_STUBS(n)                                                     \
+    void PORT##n##_SetOutput(ARM_GPIO_Pin_t pin, uint32_t val)                  \
+    {                                                                           \
+        (void)pin;                                                              \
+        (void)val;                                                              \
+    }                                                                           \
+    int32_t PORT##n##_SetDirection(ARM_GPIO_Pin_t pin, uint32_t direction)      \
+    {                                                                           \
+        (void)pin;                                                              \
+        (void)direction;                                                        \
+        return ARM_DRIVER_OK;                                                   \
+    }
+
+SWEEP_PORT_STUBS(0)
+SWEEP_PORT_STUBS(1)
+SWEEP_PORT_STUBS(2)
+SWEEP_PORT_STUBS(3)
+SWEEP_PORT_STUBS(4)
+
+void PWM_UpdatePwmDutycycleHighAccuracy(PWM_Type *base, pwm_submodule_t subModule, pwm_channels_t pwmSignal,
+                                        pwm_mode_t currPwmMode, uint16_t dutyCycle)
+{
+    (void)base;
+    (void)subModule;
+    (void)pwmSignal;
+    (void)currPwmMode;
+    (void)dutyCycle;
+}
+
+void PWM_SetPwmLdok(PWM_Type *base, uint8_t subModulesToUpdate, bool value)
+{
+    (void)base;
+    (void)subModulesToUpdate;
+    (void)value;
+}
+
+void init_ADC(ADC_Type *adc_base, SPC_Type *spc_base, VREF_Type *vref_base, uint32_t user_channel,
+              uint32_t user_cmdid)
+{
+    (void)adc_base;
+    (void)spc_base;
+    (void)vref_base;
+    (void)user_channel;
+    (void)user_cmdid;
+}
+
+uint32_t read_ADC(ADC_Type *adc_base, uint32_t user_cmdid)
+{
+    (void)adc_base;
+    (void)user_cmdid;
+    return 0U;
+}
+
+/*******************************************************************************
+ * One configuration
+ ******************************************************************************/
+
+typedef struct {
+    motor_plant_t plant;
+    float angle;            /* Since the last edge */
+    double edgeT;
+    double lastEdgeT;
+} sweep_wheel_t;
+
+/* Edges at their exact time within the tick, as the CTIMER captures them */
+static void Encoder(sweep_wheel_t *w, MOTOR_T *m, double t, float dt)
+{
+    const float step = 2.0f * 3.14159265f / SWEEP_COUNTS_CPR;
+    float v = fabsf(w->plant.omega);
+
+    w->angle += v * dt;
+    while (w->angle >= step)
+    {
+        w->angle -= step;
+        w->edgeT = t + dt - w->angle / v;
+        if (w->lastEdgeT >= 0.0)
+        {
+            m->speed = step / (float)(w->edgeT - w->lastEdgeT);
+        }
+        w->lastEdgeT = w->edgeT;
+    }
+    if (t + dt - w->lastEdgeT > SWEEP_TIMEOUT_S)
+    {
+        m->speed = 0.0f;
+    }
+}
+
+static void Score(const sweep_config_t *cfg, sweep_score_t *out)
+{
+    static PWM_CTRL_t pwm;
+    static ENABLE_PIN pins[2 * SWEEP_WHEELS];
+    PID_CONFIG pid[SWEEP_WHEELS];
+    MOTOR_T motor[SWEEP_WHEELS];
+    sweep_wheel_t wheel[SWEEP_WHEELS];
+    ROBOT_T robot;
+    const float dt = 1.0f / PID_TIMER_FREQ;
+    const float L = ROBOT_LX + ROBOT_LY;
+    float from[3] = {0.0f, 0.0f, 0.0f};
+    uint64_t ticks = 0, satTicks = 0;
+    double t = 0.0;
+
+    memset(pid, 0, sizeof(pid));
+    memset(motor, 0, sizeof(motor));
+    memset(&robot, 0, sizeof(robot));
+    for (uint32_t i = 0; i < SWEEP_WHEELS; i++)
+    {
+        pid[i].Kp = cfg->kp;
+        pid[i].Ki = cfg->ki;
+        pid[i].Kd = cfg->kd;
+        pid[i].max_integral = MAX_PWM_DEFINITION;
+        pid[i].min_integral = -MAX_PWM_DEFINITION;
+        pid[i].form = cfg->form;
+        pid[i].b = SWEEP_PID_B;
+        pid[i].Tf = SWEEP_PID_TF;
+        pid[i].Tt = SWEEP_PID_TT;
+        motor[i].MINA = &pins[2U * i];
+        motor[i].MINB = &pins[2U * i + 1U];
+        motor[i].PWM = &pwm;
+        motor[i].PID = &pid[i];
+        motor[i].direction = MOTOR_FORWARD;
+        MotorPlant_Init(&wheel[i].plant, &s_motor);
+        wheel[i].angle = 0.0f;
+        wheel[i].lastEdgeT = -1.0;
+    }
+    robot.max_target = cfg->limit;
+    robot.M1 = &motor[0];
+    robot.M2 = &motor[1];
+    robot.M3 = &motor[2];
+    robot.M4 = &motor[3];
+
+    out->rise = 0.0f;
+    out->over = 0.0f;
+    out->settle = 0.0f;
+
+    for (uint32_t s = 0; s < SWEEP_STEPS; s++)
+    {
+        const sweep_step_t *st = &s_script[s];
+        /* Body velocity as (vx, vy, phi * L): all in m/s */
+        float to[3] = {st->vx, st->vy, st->phi * L};
+        float d[3] = {to[0] - from[0], to[1] - from[1], to[2] - from[2]};
+        float span2 = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+        uint32_t n = (uint32_t)(st->holdS * PID_TIMER_FREQ);
+        float t10 = -1.0f, t90 = -1.0f, lastOut = 0.0f, peak = 0.0f;
+
+        robot.vx = st->vx;
+        robot.vy = st->vy;
+        robot.phi = st->phi;
+        for (uint32_t k = 0; k < n; k++)
+        {
+            float w[SWEEP_WHEELS], body[3], frac;
+            omni_kin_twist_t v;
+
+            /* PID_TIMER(): check_stopped_motors() is in Encoder() */
+            for (uint32_t i = 0; i < SWEEP_WHEELS; i++)
+            {
+                Encoder(&wheel[i], &motor[i], t, dt);
+            }
+            ROBOT_compute_kinematics(&robot);
+            for (uint32_t i = 0; i < SWEEP_WHEELS; i++)
+            {
+                pid_compute(&motor[i]);
+                if (fabsf(pid[i].last_output) >= MAX_PWM_DEFINITION)
+                {
+                    satTicks++;
+                }
+                MotorPlant_Step(&wheel[i].plant, pid[i].last_output / MAX_PWM_DEFINITION, dt);
+                w[i] = wheel[i].plant.omega;
+            }
+            ticks += SWEEP_WHEELS;
+            t += dt;
+
+            /* Forward kinematics of ROBOT_compute_kinematics() */
+            omni_kin_forward(w, &v);
+            body[0] = v.vx;
+            body[1] = v.vy;
+            body[2] = v.phi * L;
+
+            /* Share of the step done, along the step */
+            frac = ((body[0] - from[0]) * d[0] + (body[1] - from[1]) * d[1] + (body[2] - from[2]) * d[2]) / span2;
+            if (t10 < 0.0f && frac >= 0.1f) t10 = k * dt;
+            if (t90 < 0.0f && frac >= 0.9f) t90 = k * dt;
+            if (fabsf(frac - 1.0f) > SWEEP_BAND) lastOut = (k + 1U) * dt;
+            if (frac - 1.0f > peak) peak = frac - 1.0f;
+        }
+
+        out->rise = fmaxf(out->rise, (t90 < 0.0f) ? INFINITY : 1000.0f * (t90 - t10));
+        out->over = fmaxf(out->over, 100.0f * peak);
+        /* Still outside the band in the last 10 % of the hold: never settled */
+        out->settle = fmaxf(out->settle, (lastOut > 0.9f * st->holdS) ? INFINITY : 1000.0f * lastOut);
+        memcpy(from, to, sizeof(from));
+    }
+    out->sat = 100.0f * (float)satTicks / (float)ticks;
+    out->done = true;
+}
+
+/*******************************************************************************
+ * Grid, workers, front
+ ******************************************************************************/
+
+static float RangeAt(const sweep_range_t *r, uint32_t i)
+{
+    if (r->n < 2U)
+    {
+        return r->from;
+    }
+    float f = (float)i / (r->n - 1U);
+    return r->log ? r->from * powf(r->to / r->from, f) : r->from + f * (r->to - r->from);
+}
+
+static bool ParseRange(const char *arg, sweep_range_t *r)
+{
+    unsigned n = 1U;
+    int got = sscanf(arg, "%f:%f:%u", &r->from, &r->to, &n);
+
+    if (got == 1)
+    {
+        r->to = r->from;
+        n = 1U;
+    }
+    else if (got != 3 || n == 0U)
+    {
+        return false;
+    }
+    r->n = n;
+    /* Log spacing unless the range starts at 0 */
+    r->log = r->from > 0.0f && r->to > 0.0f;
+    return true;
+}
+
+static bool Dominates(const sweep_score_t *a, const sweep_score_t *b)
+{
+    bool le = a->rise <= b->rise && a->over <= b->over && a->settle <= b->settle && a->sat <= b->sat;
+    bool lt = a->rise < b->rise || a->over < b->over || a->settle < b->settle || a->sat < b->sat;
+    return le && lt;
+}
+
+static const char *FormName(PID_FORM form)
+{
+    return (form == PID_FORM_2DOF) ? "2dof" : "classic";
+}
+
+static void PrintMs(float ms)
+{
+    if (isinf(ms))
+    {
+        printf(" %8s", "-");
+    }
+    else
+    {
+        printf(" %8.1f", ms);
+    }
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-p KP] [-i KI] [-d KD] [-l LIMIT] [-f classic|2dof|both] [-j N] [-m w,tau,I,f]\n"
+           "          [-n N] [-c csv]\n"
+           "  -p/-i/-d/-l FROM:TO:N  Kp, Ki, Kd, wheel limit (rad/s) grids, log spaced unless FROM is 0,\n"
+           "                         or one value (default 5000:100000:10, 20000:2000000:10, 0:0.2:3, 10:14:3)\n"
+           "  -f form                PID forms to sweep (default both)\n"
+           "  -j N                   worker processes (default: the host's cores)\n"
+           "  -m w,tau,I,f           motor: no-load rad/s, time constant s, stall A, friction duty\n"
+           "  -n N                   front rows to print, by settling time (default %u, 0 = all)\n"
+           "  -c file.csv            every configuration: form,kp,ki,kd,limit,rise,over,settle,sat,front\n",
+           prog, SWEEP_SHOW);
+}
+
+int main(int argc, char **argv)
+{
+    sweep_range_t kp = {5000.0f, 100000.0f, 10U, true};
+    sweep_range_t ki = {20000.0f, 2000000.0f, 10U, true};
+    sweep_range_t kd = {0.0f, 0.2f, 3U, false};
+    sweep_range_t lim = {10.0f, 14.0f, 3U, false};
+    PID_FORM forms[2] = {PID_FORM_CLASSIC, PID_FORM_2DOF};
+    uint32_t formCount = 2U, show = SWEEP_SHOW;
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    FILE *csv = NULL;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "p:i:d:l:f:j:m:n:c:h")) != -1)
+    {
+        bool ok = true;
+
+        switch (opt)
+        {
+            case 'p': ok = ParseRange(optarg, &kp); break;
+            case 'i': ok = ParseRange(optarg, &ki); break;
+            case 'd': ok = ParseRange(optarg, &kd); break;
+            case 'l': ok = ParseRange(optarg, &lim); break;
+            case 'f':
+                if (strcmp(optarg, "classic") == 0)
+                {
+                    formCount = 1U;
+                }
+                else if (strcmp(optarg, "2dof") == 0)
+                {
+                    forms[0] = PID_FORM_2DOF;
+                    formCount = 1U;
+                }
+                else
+                {
+                    ok = (strcmp(optarg, "both") == 0);
+                }
+                break;
+            case 'j':
+                workers = atol(optarg);
+                ok = (workers > 0 && workers <= (long)SWEEP_MAX_WORKERS);
+                break;
+            case 'm':
+                ok = (sscanf(optarg, "%f,%f,%f,%f", &s_motor.noLoadSpeed, &s_motor.tau, &s_motor.stallCurrent,
+                             &s_motor.frictionDuty) == 4);
+                break;
+            case 'n': show = (uint32_t)atoi(optarg); break;
+            case 'c':
+                csv = fopen(optarg, "w");
+                if (csv == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+        if (!ok)
+        {
+            fprintf(stderr, "-%c %s: see -h\n", opt, optarg);
+            return 1;
+        }
+    }
+    if (workers < 1)
+    {
+        workers = 1;
+    }
+
+    /* The grid, form outermost */
+    uint32_t count = formCount * kp.n * ki.n * kd.n * lim.n;
+    sweep_config_t *cfg = malloc(count * sizeof(sweep_config_t));
+    uint32_t c = 0;
+    for (uint32_t f = 0; f < formCount; f++)
+        for (uint32_t a = 0; a < kp.n; a++)
+            for (uint32_t b = 0; b < ki.n; b++)
+                for (uint32_t e = 0; e < kd.n; e++)
+                    for (uint32_t l = 0; l < lim.n; l++)
+                    {
+                        cfg[c++] = (sweep_config_t){forms[f], RangeAt(&kp, a), RangeAt(&ki, b), RangeAt(&kd, e),
+                                                    RangeAt(&lim, l)};
+                    }
+
+    size_t shmSize = sizeof(sweep_shared_t) + count * sizeof(sweep_score_t);
+    sweep_shared_t *shm = mmap(NULL, shmSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shm == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    memset(shm, 0, shmSize);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    fflush(stdout);
+    for (long w = 0; w < workers; w++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            for (;;)
+            {
+                uint32_t i = __atomic_fetch_add(&shm->next, 1U, __ATOMIC_RELAXED);
+                if (i >= count)
+                {
+                    _exit(0);
+                }
+                Score(&cfg[i], &shm->score[i]);
+            }
+        }
+        if (pid < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+    }
+    while (wait(NULL) > 0)
+    {
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    double secs = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) / 1e9;
+
+    /* Front: O(n^2), a few ms for ten thousand configurations */
+    bool *front = calloc(count, sizeof(bool));
+    uint32_t *order = malloc(count * sizeof(uint32_t));
+    uint32_t frontCount = 0, missing = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (!shm->score[i].done)
+        {
+            missing++;
+            continue;
+        }
+        front[i] = true;
+        for (uint32_t j = 0; j < count && front[i]; j++)
+        {
+            if (j != i && shm->score[j].done && Dominates(&shm->score[j], &shm->score[i]))
+            {
+                front[i] = false;
+            }
+        }
+        if (front[i])
+        {
+            order[frontCount++] = i;
+        }
+    }
+    /* By settling time, then rise */
+    for (uint32_t i = 1; i < frontCount; i++)
+    {
+        uint32_t v = order[i], j = i;
+        while (j > 0U && (shm->score[order[j - 1U]].settle > shm->score[v].settle ||
+                          (shm->score[order[j - 1U]].settle == shm->score[v].settle &&
+                           shm->score[order[j - 1U]].rise > shm->score[v].rise)))
+        {
+            order[j] = order[j - 1U];
+            j--;
+        }
+        order[j] = v;
+    }
+
+    float scriptS = 0.0f;
+    for (uint32_t s = 0; s < SWEEP_STEPS; s++)
+    {
+        scriptS += s_script[s].holdS;
+    }
+    printf("%u configurations, %ld workers: %.1f s, %.1f configurations/s (%.0f s of robot time each)\n", count,
+           workers, secs, count / secs, scriptS);
+    printf("Script: forward 0.4 m/s, diagonal 0.3+0.3 m/s, turn 2 rad/s, stop; 1 s each. Worst step:\n");
+    printf("rise 10-90 %%, overshoot, settling into 5 %% (- : never), share of wheel ticks at full PWM.\n\n");
+    printf("Pareto front: %u configurations%s\n", frontCount,
+           (show != 0U && frontCount > show) ? ", the fastest to settle:" : "");
+    printf("  %-7s %8s %9s %6s %6s | %8s %8s %8s %6s\n", "form", "Kp", "Ki", "Kd", "limit", "rise ms", "over %",
+           "settle", "sat %");
+    for (uint32_t r = 0; r < frontCount && (show == 0U || r < show); r++)
+    {
+        const sweep_config_t *k = &cfg[order[r]];
+        const sweep_score_t *s = &shm->score[order[r]];
+
+        printf("  %-7s %8.0f %9.0f %6.3f %6.1f |", FormName(k->form), k->kp, k->ki, k->kd, k->limit);
+        PrintMs(s->rise);
+        printf(" %8.1f", s->over);
+        PrintMs(s->settle);
+        printf(" %6.1f\n", s->sat);
+    }
+    if (missing != 0U)
+    {
+        printf("%u configurations not scored (a worker died)\n", missing);
+    }
+
+    if (csv != NULL)
+    {
+        fprintf(csv, "form,kp,ki,kd,limit,rise_ms,overshoot_pct,settle_ms,saturation_pct,front\n");
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const sweep_score_t *s = &shm->score[i];
+            fprintf(csv, "%s,%.0f,%.0f,%.4f,%.2f,%.2f,%.2f,%.2f,%.2f,%d\n", FormName(cfg[i].form), cfg[i].kp,
+                    cfg[i].ki, cfg[i].kd, cfg[i].limit, s->rise, s->over, s->settle, s->sat, front[i] ? 1 : 0);
+        }
+        fclose(csv);
+    }
+    return 0;
+}
@@ -0,0 +1,527 @@
+/*
+ * robot_replay.c
+ *
+ * Replays a recording of the robot's control inputs (COMMON/omni_record.h)
+ * through the robot firmware, and checks that it comes out the same.
+ *
+ * The recording is what a robot built with ROBOT_RECORD=1 prints on its debug
+ * console ("REC,offset,hex" lines, a whole console log can be fed) or the
+ * raw stream. The firmware (MCXN947_Project.c, omnidriver.c, RobotTelemetry.c)
+ * runs unchanged on the simulated board, with no motor plants: the tool fires
+ * its PID interrupt (LPTMR1) once per recorded tick, raises every recorded
+ * encoder capture with the recorded register value, hands every recorded
+ * frame in through an SPI exchange (Robot_SendTelemetry() and the eDMA
+ * completion, as the telemetry poll would) and, on a tick the recording has
+ * its count for, sets CTIMER0 to it. On the other ticks CTIMER0 reads the
+ * latest capture so far (the wheels' captures interleave out of order): a
+ * stopped-wheel timeout that changed anything would have been recorded, and a
+ * count no later than the real one cannot raise one that was not.
+ *
+ * The replayed firmware records again; its stream has to match the original
+ * event by event, state digests included (ROBOT_RECORD_CHECK_TICKS apart).
+ * It runs as fast as the host goes, without the main loop in between, and
+ * reports the time per PID tick: a controller change shows as the first
+ * digest that differs, and its cost against the recorded session.
+ *
+ * Build it with the switches (ROBOT_PID_FORM, ...) of the recording robot.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "sim_hooks.h"
+#include "robot_board.h"
+#include "omnidriver.h"
+#include "omni_record.h"
+#include "RobotTelemetry.h"
+#include "RobotRecord.h"
+
+#if !ROBOT_RECORD
+#error "robot_replay compares the firmware's own recording: build with -DROBOT_RECORD=1"
+#endif
+
+#define REPLAY_TICK_NS      (1000000000ULL / (uint64_t)(PID_TIMER_SRC_FREQ / PID_TIMER_TICKS))
+#define REPLAY_READ_CHUNK   4096U
+#define REPLAY_COMPARE_EVENTS 1024U     /* Events between two comparisons */
+
+extern int RobotFw_Main(void);
+extern void LPTMR1_IRQHandler(void);
+
+typedef struct {
+    uint64_t ticks;
+    uint64_t captures;
+    uint64_t frames;
+    uint64_t counts;
+    uint64_t digests;
+    uint64_t digestsDiffer;
+    uint64_t firstDifferTick;   /* Tick of the first digest that differs */
+    bool ended;                 /* The recorder's buffer ran full */
+    double tickNs;              /* Summed over the PID interrupts */
+    double wallS;
+} replay_stats_t;
+
+static uint8_t *s_rec;              /* Recording */
+static size_t s_recLen;
+static uint8_t *s_again;            /* What the replayed firmware records */
+static size_t s_againLen;
+static size_t s_againCap;
+
+/* Comparison cursors: the original and the new recording, in step */
+static omni_record_state_t s_cmpOrig;
+static size_t s_cmpOrigPos;
+static omni_record_state_t s_cmpAgain;
+static size_t s_cmpAgainPos;
+
+static replay_stats_t s_stats;
+static bool s_keepGoing;            /* -k */
+static double s_budgetNs;           /* -b */
+static FILE *s_out;
+
+/* Board inputs */
+static uint64_t s_clockUs;
+static const uint8_t *s_rxFrame;    /* Answer of the next exchange */
+static uint32_t s_latestCapture;
+static bool s_haveCount;
+static uint32_t s_count;
+
+static double NowS(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static uint64_t ReplayNowUs(void)
+{
+    return s_clockUs;
+}
+
+static void ReplaySpiXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    (void)tx;
+    memset(rx, 0, len);
+    if (s_rxFrame != NULL)
+    {
+        memcpy(rx, s_rxFrame, (s_rxFrame[0] < len) ? s_rxFrame[0] : len);
+    }
+}
+
+/*******************************************************************************
+ * Loading
+ ******************************************************************************/
+static bool AppendBytes(const uint8_t *data, size_t len, size_t *cap)
+{
+    if (s_recLen + len > *cap)
+    {
+        size_t n = (*cap != 0U) ? *cap * 2U : (1U << 20);
+        while (n < s_recLen + len)
+        {
+            n *= 2U;
+        }
+        uint8_t *p = realloc(s_rec, n);
+        if (p == NULL)
+        {
+            return false;
+        }
+        s_rec = p;
+        *cap = n;
+    }
+    memcpy(&s_rec[s_recLen], data, len);
+    s_recLen += len;
+    return true;
+}
+
+static int HexDigit(char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* A raw stream, or the REC lines of a console log: they must follow on from each other,
+ * the recording ends at the first gap */
+static bool Load(FILE *f)
+{
+    char line[512];
+    size_t cap = 0;
+    bool gap = false;
+    int c = fgetc(f);
+
+    if (c == OMNI_RECORD_MAGIC[0])
+    {
+        uint8_t buf[REPLAY_READ_CHUNK];
+        size_t n;
+
+        buf[0] = (uint8_t)c;
+        n = 1U + fread(&buf[1], 1, sizeof(buf) - 1U, f);
+        do
+        {
+            if (!AppendBytes(buf, n, &cap))
+            {
+                return false;
+            }
+        } while ((n = fread(buf, 1, sizeof(buf), f)) > 0U);
+        return true;
+    }
+    if (c != EOF)
+    {
+        ungetc(c, f);
+    }
+
+    while (fgets(line, sizeof(line), f) != NULL)
+    {
+        const char *p = strstr(line, "REC,");
+        uint8_t bytes[sizeof(line) / 2U];
+        size_t n = 0;
+        char *end;
+
+        if (p == NULL || gap)
+        {
+            continue;
+        }
+        unsigned long offset = strtoul(p + 4, &end, 10);
+        if (*end != ',')
+        {
+            continue;
+        }
+        for (p = end + 1; HexDigit(p[0]) >= 0 && HexDigit(p[1]) >= 0; p += 2)
+        {
+            bytes[n++] = (uint8_t)((HexDigit(p[0]) << 4) | HexDigit(p[1]));
+        }
+        if ((size_t)offset + n <= s_recLen)
+        {
+            continue;   /* Seen already */
+        }
+        if ((size_t)offset != s_recLen)
+        {
+            fprintf(stderr, "recording: bytes %zu..%lu missing, replaying what comes before\n", s_recLen, offset);
+            gap = true;
+            continue;
+        }
+        if (!AppendBytes(bytes, n, &cap))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Comparison
+ ******************************************************************************/
+static const char *KindName(omni_record_kind_t kind)
+{
+    switch (kind)
+    {
+        case OMNI_RECORD_TICKS:   return "ticks";
+        case OMNI_RECORD_CAPTURE: return "capture";
+        case OMNI_RECORD_COUNT:   return "timeout count";
+        case OMNI_RECORD_FRAME:   return "frame";
+        case OMNI_RECORD_DIGEST:  return "digest";
+        default:                  return "end";
+    }
+}
+
+/* Takes what the replayed firmware recorded and compares it, event by event, as far as it
+ * goes. false if the inputs themselves came out different: the replay is broken. */
+static bool Compare(void)
+{
+    omni_record_event_t a;
+    omni_record_event_t b;
+
+    for (;;)
+    {
+        if (s_againCap - s_againLen < REPLAY_READ_CHUNK)
+        {
+            s_againCap *= 2U;
+            s_again = realloc(s_again, s_againCap);
+            if (s_again == NULL)
+            {
+                return false;
+            }
+        }
+        uint32_t n = Robot_RecordRead(&s_again[s_againLen], REPLAY_READ_CHUNK);
+        if (n == 0U)
+        {
+            break;
+        }
+        s_againLen += n;
+    }
+
+    if (s_cmpAgainPos == 0U)
+    {
+        s_cmpAgainPos = omni_record_header(s_again, s_againLen);
+        s_cmpOrigPos = omni_record_header(s_rec, s_recLen);
+        if (s_cmpAgainPos == 0U)
+        {
+            return s_againLen < OMNI_RECORD_MAGIC_SIZE;
+        }
+    }
+
+    while (omni_record_next(&s_cmpAgain, s_again, s_againLen, &s_cmpAgainPos, &a))
+    {
+        if (!omni_record_next(&s_cmpOrig, s_rec, s_recLen, &s_cmpOrigPos, &b))
+        {
+            fprintf(s_out, "replay: the firmware recorded a %s past the end of the recording\n", KindName(a.kind));
+            return false;
+        }
+        if (a.kind == OMNI_RECORD_DIGEST && b.kind == OMNI_RECORD_DIGEST && s_cmpAgain.ticks == s_cmpOrig.ticks)
+        {
+            if (a.value != b.value && s_stats.digestsDiffer++ == 0U)
+            {
+                s_stats.firstDifferTick = s_cmpOrig.ticks;
+            }
+            continue;
+        }
+        if (a.kind != b.kind || s_cmpAgain.ticks != s_cmpOrig.ticks || a.wheel != b.wheel || a.value != b.value ||
+            (a.kind == OMNI_RECORD_FRAME && memcmp(a.frame, b.frame, b.frame[0]) != 0))
+        {
+            fprintf(s_out, "replay: at tick %u the recording has a %s, the replay a %s\n", (unsigned)s_cmpOrig.ticks,
+                    KindName(b.kind), KindName(a.kind));
+            return false;
+        }
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Replay
+ ******************************************************************************/
+static void Tick(void)
+{
+    struct timespec t0;
+    struct timespec t1;
+
+    s_stats.ticks++;
+    if (s_clockUs < s_stats.ticks * REPLAY_TICK_NS / 1000U)
+    {
+        s_clockUs = s_stats.ticks * REPLAY_TICK_NS / 1000U;
+    }
+    RobotBoard_SetCtimerCount(s_haveCount ? s_count : s_latestCapture);
+    s_haveCount = false;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    LPTMR1_IRQHandler();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    s_stats.tickNs += (double)(t1.tv_sec - t0.tv_sec) * 1e9 + (double)(t1.tv_nsec - t0.tv_nsec);
+}
+
+static void Exchange(const uint8_t *frame)
+{
+    s_rxFrame = frame;
+    Robot_SendTelemetry();
+    /* Off the wire: the completion applies it */
+    s_clockUs += Sim_SpiFrameUs(OMNI_WIRE_EXCHANGE_SIZE);
+    Sim_DmaService();
+    s_rxFrame = NULL;
+}
+
+/* false if the replay broke off */
+static bool Replay(void)
+{
+    omni_record_state_t st;
+    omni_record_event_t ev;
+    size_t pos = omni_record_header(s_rec, s_recLen);
+    uint32_t events = 0;
+    double t0 = NowS();
+
+    memset(&st, 0, sizeof(st));
+    while (omni_record_next(&st, s_rec, s_recLen, &pos, &ev))
+    {
+        for (uint32_t i = 0; i < ev.ticks; i++)
+        {
+            Tick();
+        }
+
+        switch (ev.kind)
+        {
+            case OMNI_RECORD_CAPTURE:
+                s_stats.captures++;
+                if ((int32_t)(ev.value - s_latestCapture) > 0)
+                {
+                    s_latestCapture = ev.value;
+                }
+                RobotBoard_InjectCapture(ev.wheel, ev.value);
+                break;
+            case OMNI_RECORD_COUNT:
+                s_stats.counts++;
+                s_haveCount = true;
+                s_count = ev.value;
+                break;
+            case OMNI_RECORD_FRAME:
+                s_stats.frames++;
+                Exchange(ev.frame);
+                break;
+            case OMNI_RECORD_DIGEST:
+                s_stats.digests++;
+                break;
+            case OMNI_RECORD_END:
+                s_stats.ended = true;
+                break;
+            default:
+                break;
+        }
+
+        if (++events % REPLAY_COMPARE_EVENTS == 0U)
+        {
+            if (!Compare())
+            {
+                return false;
+            }
+            if (s_stats.digestsDiffer != 0U && !s_keepGoing)
+            {
+                break;
+            }
+        }
+        if (ev.kind == OMNI_RECORD_END)
+        {
+            break;
+        }
+    }
+    if (!Compare())
+    {
+        return false;
+    }
+    s_stats.wallS = NowS() - t0;
+    /* A console log usually ends inside an event; more than one is not a recording */
+    if (s_recLen - pos > OMNI_RECORD_MAX_EVENT && !s_stats.ended && s_stats.digestsDiffer == 0U)
+    {
+        fprintf(s_out, "recording: %zu bytes at the end are not an event, replayed up to them\n", s_recLen - pos);
+    }
+    return true;
+}
+
+static int Report(void)
+{
+    double sessionS = (double)s_stats.ticks * (double)REPLAY_TICK_NS * 1e-9;
+    double tickNs = (s_stats.ticks != 0U) ? s_stats.tickNs / (double)s_stats.ticks : 0.0;
+    int rc = 0;
+
+    fprintf(s_out, "Recording: %zu bytes, %.3f s (%llu PID ticks)%s\n", s_recLen, sessionS,
+            (unsigned long long)s_stats.ticks, s_stats.ended ? ", ends where the robot's buffer ran full" : "");
+    fprintf(s_out, "  %llu captures, %llu frames, %llu timeout counts, %llu digests\n",
+            (unsigned long long)s_stats.captures, (unsigned long long)s_stats.frames,
+            (unsigned long long)s_stats.counts, (unsigned long long)s_stats.digests);
+    fprintf(s_out, "Replay: %.3f s, %.0fx real time; PID interrupt %.0f ns (%.2f %% of its period here)\n",
+            s_stats.wallS, (s_stats.wallS > 0.0) ? sessionS / s_stats.wallS : 0.0, tickNs,
+            100.0 * tickNs / (double)REPLAY_TICK_NS);
+
+    if (s_stats.digestsDiffer == 0U)
+    {
+        fprintf(s_out, "State: all %llu digests match\n", (unsigned long long)s_stats.digests);
+    }
+    else
+    {
+        fprintf(s_out, "State: differs from tick %llu (%.4f s) on%s, %llu digests differ\n",
+                (unsigned long long)s_stats.firstDifferTick,
+                (double)s_stats.firstDifferTick * (double)REPLAY_TICK_NS * 1e-9, s_keepGoing ? "" : " (stopped there)",
+                (unsigned long long)s_stats.digestsDiffer);
+        rc = 1;
+    }
+    if (s_budgetNs > 0.0 && tickNs > s_budgetNs)
+    {
+        fprintf(s_out, "Budget: the PID interrupt takes %.0f ns, over %.0f\n", tickNs, s_budgetNs);
+        rc = (rc != 0) ? rc : 2;
+    }
+    return rc;
+}
+
+/* Robot main loop idle: the first time round, the firmware is up: replay it all */
+static bool ReplayIdle(uint32_t us)
+{
+    int rc;
+
+    (void)us;
+    rc = Replay() ? Report() : 3;
+    fflush(s_out);
+    exit(rc);
+    return false;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-f file] [-k] [-b ns] [-v]\n"
+           "  -f file   console log with the REC lines of a ROBOT_RECORD=1 robot, or the raw record\n"
+           "            (default stdin)\n"
+           "  -k        go on past the first digest that differs, count them all\n"
+           "  -b ns     fail (exit 2) if the PID interrupt takes longer on average\n"
+           "  -v        keep the robot's console output\n"
+           "exit: 0 same state throughout, 1 a digest differs, 2 over the budget, 3 replay broken\n",
+           prog);
+}
+
+int main(int argc, char **argv)
+{
+    motor_plant_params_t motor = MOTOR_PLANT_DEFAULT_PARAMS;
+    FILE *in = stdin;
+    bool verbose = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "f:kb:vh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'f':
+                in = fopen(optarg, "rb");
+                if (in == NULL)
+                {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'k':
+                s_keepGoing = true;
+                break;
+            case 'b':
+                s_budgetNs = atof(optarg);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (!Load(in))
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    if (omni_record_header(s_rec, s_recLen) == 0U)
+    {
+        fprintf(stderr, "no recording in the input\n");
+        return 1;
+    }
+    s_againCap = s_recLen + REPLAY_READ_CHUNK;
+    s_again = malloc(s_againCap);
+    if (s_again == NULL)
+    {
+        return 1;
+    }
+
+    /* The firmware prints on stdout: results go to the real one, the rest away unless -v */
+    s_out = fdopen(dup(STDOUT_FILENO), "w");
+    if (!verbose && freopen("/dev/null", "w", stdout) == NULL)
+    {
+        return 1;
+    }
+
+    /* No wheel attached: the captures come from the recording only */
+    RobotBoard_Init(&motor);
+
+    g_simHooks.now_us = ReplayNowUs;
+    g_simHooks.spi_xfer = ReplaySpiXfer;
+    g_simHooks.idle = ReplayIdle;
+
+    RobotFw_Main();
+    return 0;
+}
@@ -0,0 +1,415 @@
+/*
+ * spi_bridge_master.c
+ *
+ * A simulated SPI master clocking a bridge's slave side: the MISO pool of
+ * spi_bridge (spi_bridge_miso.c, unchanged) and the arming of
+ * spi_bridge_task(), with three threads in place of the robot MCU, the SPI
+ * task and the ESP-NOW callback:
+ *
+ *   master   every 1/rate s, `burst` exchanges back to back of 40 bytes at
+ *            8 MHz (ESP_SPI_BAUDRATE). An exchange takes the oldest armed
+ *            transaction, an exchange finding none is missed.
+ *   task     takes each result, releases its buffer, spends the frame
+ *            handler's time (-w) and arms the transaction again with the
+ *            latest payload, as spi_bridge_task() does.
+ *   writer   publishes a payload every 1/payloads s (spi_bridge_miso_set()).
+ *
+ * The armed queue stands for the spi_slave driver's, which copies the
+ * transaction at queue time: an armed transaction keeps the payload it was
+ * armed with. Reports the missed exchanges, how old the payload of each
+ * exchange was (payloads published since, and the time since it was
+ * replaced) and the time from the end of an exchange to its re-arm.
+ * Exits 1 if an exchange was missed. A stall of this host (one CPU here, two
+ * chips on the boards) of the master or the SPI task stalls both: the misses
+ * after it are counted apart.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "spi_bridge_miso.h"
+
+#define MASTER_RATE_HZ      2400U   /* Robot telemetry loop */
+#define MASTER_SECONDS      10U
+#define MASTER_PAYLOAD_HZ   200U    /* Remote commands over the air */
+#define MASTER_HANDLER_US   60U     /* air_link_send() and esp_now_send() per frame */
+#define MASTER_BAUDRATE     8000000U
+#define MASTER_GAP_US       10U     /* Between the exchanges of a burst */
+
+#define PUB_RING            4096U   /* Publish times by sequence number */
+#define HIST_US             5000U   /* Histograms in us, the last bucket counts everything above */
+
+typedef struct
+{
+    uint32_t seq;
+} payload_t;
+
+static spi_bridge_miso_t s_miso;
+static pthread_mutex_t s_misoLock;     /* portENTER_CRITICAL() on the bridge: priority inheriting here */
+
+/* The driver's queue: armed transactions in, results out */
+static pthread_mutex_t s_queueLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_queueDone = PTHREAD_COND_INITIALIZER;
+static int s_armed[SPI_BRIDGE_TRANS_CNT];
+static uint32_t s_armedHead;
+static uint32_t s_armedCount;
+static int s_done[SPI_BRIDGE_TRANS_CNT];
+static uint64_t s_doneUs[SPI_BRIDGE_TRANS_CNT];
+static uint32_t s_doneHead;
+static uint32_t s_doneCount;
+
+static volatile int s_stop;
+static uint64_t s_pubUs[PUB_RING];
+
+static uint32_t s_rate = MASTER_RATE_HZ;
+static uint32_t s_seconds = MASTER_SECONDS;
+static uint32_t s_payloadHz = MASTER_PAYLOAD_HZ;
+static uint32_t s_handlerUs = MASTER_HANDLER_US;
+static uint32_t s_armedCnt = 1U;
+static uint32_t s_burst = 1U;
+
+/* Results */
+static uint64_t s_exchanges;
+static uint64_t s_missed;
+static uint64_t s_missedLate;             /* Missed after a stall of this host */
+static uint64_t s_behind[4];              /* 0, 1, 2, 3 and more payloads behind */
+static uint64_t s_ageHist[HIST_US + 1U];  /* us since the payload was replaced */
+static uint64_t s_rearmHist[HIST_US + 1U];
+static uint64_t s_lateTicks;              /* This host stalled the master a quarter period */
+static uint64_t s_taskStalls;             /* ... or the SPI task */
+static uint64_t s_lastEndUs;              /* End of the last exchange clocked */
+
+static uint64_t NowNs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t NowUs(void)
+{
+    return NowNs() / 1000U;
+}
+
+static void SpinUs(uint32_t us)
+{
+    uint64_t end = NowUs() + us;
+    while (NowUs() < end)
+    {
+    }
+}
+
+/* The master's time: it is another MCU, it doesn't take this host's CPU */
+static void SleepUs(uint32_t us)
+{
+    struct timespec t = {0, (long)us * 1000L};
+    while (nanosleep(&t, &t) != 0)
+    {
+    }
+}
+
+static void SleepUntilNs(uint64_t ns)
+{
+    struct timespec t = {(time_t)(ns / 1000000000U), (long)(ns % 1000000000U)};
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) != 0)
+    {
+    }
+}
+
+static void MisoLock(void)
+{
+    pthread_mutex_lock(&s_misoLock);
+}
+
+static void MisoUnlock(void)
+{
+    pthread_mutex_unlock(&s_misoLock);
+}
+
+/* The master and the SPI task above everything else on this host, as the
+ * SPI task is on the bridge (its priority is above the WiFi task's) */
+static int RealTime(pthread_t thread, int prio)
+{
+    struct sched_param sp = {.sched_priority = prio};
+    return pthread_setschedparam(thread, SCHED_FIFO, &sp);
+}
+
+static void Hist(uint64_t *hist, uint64_t us)
+{
+    hist[(us > HIST_US) ? HIST_US : us]++;
+}
+
+/* Arm one transaction with the latest payload (queue lock held by the caller) */
+static void Arm(void)
+{
+    uint32_t seq;
+    int idx = spi_bridge_miso_take(&s_miso, &seq);
+
+    s_armed[(s_armedHead + s_armedCount) % SPI_BRIDGE_TRANS_CNT] = idx;
+    s_armedCount++;
+}
+
+/* A miss follows a stall of this host if the SPI task had the handler's time
+ * (-w) and an eighth of a period to wake up since the last exchange: it wakes
+ * in microseconds on the bridge */
+static int TaskStalled(uint64_t now)
+{
+    return now > s_lastEndUs + s_handlerUs + 1000000U / s_rate / 8U;
+}
+
+/* One exchange: the oldest armed transaction is clocked, its result queued */
+static void Exchange(uint32_t frameUs, int late)
+{
+    payload_t got;
+    int idx;
+
+    pthread_mutex_lock(&s_queueLock);
+    if (s_armedCount == 0U)
+    {
+        int stalled = TaskStalled(NowUs());
+        if (late || stalled)
+        {
+            s_taskStalls += (uint64_t)stalled;
+            s_missedLate++;
+        }
+        else
+        {
+            s_missed++;
+        }
+        pthread_mutex_unlock(&s_queueLock);
+        SleepUs(frameUs);
+        return;
+    }
+    idx = s_armed[s_armedHead];
+    s_armedHead = (s_armedHead + 1U) % SPI_BRIDGE_TRANS_CNT;
+    s_armedCount--;
+    pthread_mutex_unlock(&s_queueLock);
+
+    /* The buffer stays referenced until the task releases it */
+    memcpy(&got, s_miso.buf[idx], sizeof(got));
+    SleepUs(frameUs);
+
+    uint64_t now = NowUs();
+    uint32_t latest = s_miso.seq;
+    uint32_t behind = latest - got.seq;
+    s_exchanges++;
+    s_behind[(behind > 3U) ? 3U : behind]++;
+    Hist(s_ageHist, (behind == 0U) ? 0U : now - s_pubUs[(got.seq + 1U) % PUB_RING]);
+
+    pthread_mutex_lock(&s_queueLock);
+    s_done[(s_doneHead + s_doneCount) % SPI_BRIDGE_TRANS_CNT] = idx;
+    s_doneUs[(s_doneHead + s_doneCount) % SPI_BRIDGE_TRANS_CNT] = now;
+    s_lastEndUs = now;
+    s_doneCount++;
+    pthread_cond_signal(&s_queueDone);
+    pthread_mutex_unlock(&s_queueLock);
+}
+
+static void *MasterThread(void *arg)
+{
+    const uint64_t periodNs = 1000000000U / s_rate;
+    const uint32_t frameUs = (SPI_BRIDGE_PAYLOAD_SIZE * 8U * 1000000U + MASTER_BAUDRATE - 1U) / MASTER_BAUDRATE;
+    const uint64_t burstNs = (uint64_t)s_burst * (frameUs + MASTER_GAP_US) * 1000U;
+    const uint64_t ticks = (uint64_t)s_rate * s_seconds;
+    uint64_t next = NowNs();
+
+    (void)arg;
+    for (uint64_t k = 0; k < ticks; k++)
+    {
+        next += periodNs;
+        SleepUntilNs(next);
+        uint64_t start = NowNs();
+        int late = (start > next + periodNs / 4U);
+
+        for (uint32_t b = 0; b < s_burst; b++)
+        {
+            if (b != 0U)
+            {
+                SleepUs(MASTER_GAP_US);
+            }
+            Exchange(frameUs, late);
+        }
+
+        /* The robot's timer doesn't catch up after a stall of this host, at the
+         * wake-up or in the burst: the next burst starts a period after this one */
+        uint64_t end = NowNs();
+        if (late || end > start + burstNs + periodNs / 4U)
+        {
+            s_lateTicks++;
+            next = end - burstNs;
+        }
+    }
+    return NULL;
+}
+
+static void *TaskThread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&s_queueLock);
+    while (!s_stop)
+    {
+        if (s_doneCount == 0U)
+        {
+            pthread_cond_wait(&s_queueDone, &s_queueLock);
+            continue;
+        }
+        int idx = s_done[s_doneHead];
+        uint64_t doneUs = s_doneUs[s_doneHead];
+        s_doneHead = (s_doneHead + 1U) % SPI_BRIDGE_TRANS_CNT;
+        s_doneCount--;
+        pthread_mutex_unlock(&s_queueLock);
+
+        /* transaction_done(), then the frame handler */
+        spi_bridge_miso_release(&s_miso, idx);
+        SpinUs(s_handlerUs);
+
+        pthread_mutex_lock(&s_queueLock);
+        Arm();
+        Hist(s_rearmHist, NowUs() - doneUs);
+    }
+    pthread_mutex_unlock(&s_queueLock);
+    return NULL;
+}
+
+static void *WriterThread(void *arg)
+{
+    const uint64_t periodNs = 1000000000U / s_payloadHz;
+    uint64_t next = NowNs();
+    payload_t p = {0};
+
+    (void)arg;
+    while (!s_stop)
+    {
+        next += periodNs;
+        SleepUntilNs(next);
+        /* Single writer: the next sequence number is ours */
+        p.seq = s_miso.seq + 1U;
+        s_pubUs[p.seq % PUB_RING] = NowUs();
+        (void)spi_bridge_miso_set(&s_miso, &p, sizeof(p));
+    }
+    return NULL;
+}
+
+static uint64_t HistPct(const uint64_t *hist, uint64_t total, double pct)
+{
+    uint64_t want = (uint64_t)(pct / 100.0 * (double)total);
+    uint64_t sum = 0;
+
+    for (uint32_t us = 0; us <= HIST_US; us++)
+    {
+        sum += hist[us];
+        if (sum > want)
+        {
+            return us;
+        }
+    }
+    return HIST_US;
+}
+
+static uint64_t HistMax(const uint64_t *hist)
+{
+    for (uint32_t us = HIST_US; us > 0U; us--)
+    {
+        if (hist[us] != 0U)
+        {
+            return us;
+        }
+    }
+    return 0U;
+}
+
+static void PrintHist(const char *name, const uint64_t *hist, uint64_t total)
+{
+    uint64_t max = HistMax(hist);
+    printf("%-28s p50 %4llu us  p99 %4llu us  max %s%llu us\n", name,
+           (unsigned long long)HistPct(hist, total, 50.0), (unsigned long long)HistPct(hist, total, 99.0),
+           (max == HIST_US) ? ">" : "", (unsigned long long)max);
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s [-r HZ] [-t S] [-a N] [-b N] [-p HZ] [-w US]\n"
+           "  -r HZ   master exchanges (or bursts) per s (default %u, the robot's telemetry loop)\n"
+           "  -t S    seconds (default %u)\n"
+           "  -a N    transactions kept armed, spi_bridge_config_t.trans_armed (default 1, max %u)\n"
+           "  -b N    exchanges back to back per period (default 1; the fleet remote clocks one per robot)\n"
+           "  -p HZ   payloads published per s (default %u)\n"
+           "  -w US   frame handler time per exchange (default %u)\n",
+           prog, MASTER_RATE_HZ, MASTER_SECONDS, (unsigned)SPI_BRIDGE_TRANS_CNT, MASTER_PAYLOAD_HZ,
+           MASTER_HANDLER_US);
+}
+
+int main(int argc, char **argv)
+{
+    pthread_t master, task, writer;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "r:t:a:b:p:w:h")) != -1)
+    {
+        switch (opt)
+        {
+            case 'r': s_rate = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': s_seconds = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'a': s_armedCnt = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'b': s_burst = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'p': s_payloadHz = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'w': s_handlerUs = (uint32_t)strtoul(optarg, NULL, 0); break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+    if (s_rate == 0U || s_seconds == 0U || s_armedCnt == 0U || s_armedCnt > SPI_BRIDGE_TRANS_CNT ||
+        s_burst == 0U || s_payloadHz == 0U)
+    {
+        fprintf(stderr, "-r, -t, -a, -b and -p: see -h\n");
+        return 1;
+    }
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+    pthread_mutex_init(&s_misoLock, &attr);
+    spi_bridge_miso_init(&s_miso, MisoLock, MisoUnlock);
+    pthread_mutex_lock(&s_queueLock);
+    for (uint32_t i = 0; i < s_armedCnt; i++)
+    {
+        Arm();
+    }
+    pthread_mutex_unlock(&s_queueLock);
+
+    pthread_create(&writer, NULL, WriterThread, NULL);
+    pthread_create(&task, NULL, TaskThread, NULL);
+    pthread_create(&master, NULL, MasterThread, NULL);
+    if (RealTime(master, 2) != 0 || RealTime(task, 1) != 0)
+    {
+        fprintf(stderr, "no SCHED_FIFO (needs CAP_SYS_NICE): host scheduling shows up as missed exchanges\n");
+    }
+    pthread_join(master, NULL);
+
+    pthread_mutex_lock(&s_queueLock);
+    s_stop = 1;
+    pthread_cond_signal(&s_queueDone);
+    pthread_mutex_unlock(&s_queueLock);
+    pthread_join(task, NULL);
+    pthread_join(writer, NULL);
+
+    printf("%u Hz x %u exchanges, %u s, %u armed, %u payloads/s, %u us handler\n", (unsigned)s_rate,
+           (unsigned)s_burst, (unsigned)s_seconds, (unsigned)s_armedCnt, (unsigned)s_payloadHz,
+           (unsigned)s_handlerUs);
+    printf("exchanges %llu, missed %llu (and %llu after this host stalled the master %llu times, the SPI task %llu)\n",
+           (unsigned long long)s_exchanges, (unsigned long long)s_missed, (unsigned long long)s_missedLate,
+           (unsigned long long)s_lateTicks, (unsigned long long)s_taskStalls);
+    printf("payloads behind the latest   0: %.2f %%  1: %.2f %%  2: %.2f %%  3+: %.2f %%\n",
+           100.0 * (double)s_behind[0] / (double)s_exchanges, 100.0 * (double)s_behind[1] / (double)s_exchanges,
+           100.0 * (double)s_behind[2] / (double)s_exchanges, 100.0 * (double)s_behind[3] / (double)s_exchanges);
+    PrintHist("time since it was replaced", s_ageHist, s_exchanges);
+    PrintHist("end of exchange to re-arm", s_rearmHist, s_exchanges);
+    return (s_missed != 0U) ? 1 : 0;
+}
@@ -0,0 +1,1343 @@
+/*
+ * telemetry_log.c
+ *
+ * Captures the robot's telemetry into a columnar log and answers the plotting
+ * queries on it: a time range as CSV, or min / max / mean over N buckets.
+ *
+ * Input: the frames as they are on the wire (omni_wire.h), in any byte
+ * stream: a raw SPI or UART dump, hex bytes as a serial terminal or
+ * ESP_LOG_BUFFER_HEX prints them (-x), or the remote's SPI of the twin
+ * (omni_twin -o). Telemetry frames become rows; the last command frame seen
+ * before each one gives its cmd_* fields. A frame repeated by the link
+ * (same header and timestamp) is taken once. Fleet logs: one robot per file
+ * (-R), told apart by the fleet tag behind each frame; an untagged frame is
+ * robot 0's telemetry or a command for every robot.
+ *
+ * Log: a file header with the channel names, then blocks of up to
+ * TLOG_BLOCK_ROWS rows, appended as they fill. A block stores every channel as
+ * its own compressed column, and its time span and every column's
+ * min / max / sum; the chain of block headers is the time index. The file is
+ * read through mmap in place: a query finds its blocks by binary search on the
+ * index and decodes only the columns it asks for, and a bucket a whole block
+ * falls in takes the block's summary without decoding it. A block cut short
+ * (capture killed) ends the log and is dropped on the next append.
+ *
+ * Columns, every block on its own:
+ *   integers      the first value, then the zigzagged delta (or delta of delta for the
+ *                 clock, the counter and the hold time) of every row, packed at the
+ *                 width that fits the block best; a larger one follows an all-ones
+ *                 escape with its length (6 bits). A constant column takes no bits.
+ *   floats        XOR with the previous value: a 0 bit when equal, else the leading
+ *                 zeros (5 bits), the length (5 bits) and the bits in between
+ *
+ * The robot clock of the log always moves forward: it advances by the 32-bit
+ * difference of the robot's timestamps, so it unwraps every 71 minutes and
+ * goes on after a robot reset or across appended captures.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <ctype.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "omni_wire.h"
+
+#define TLOG_MAGIC          "OMNITLOG"
+#define TLOG_VERSION        1U
+#define TLOG_BLOCK_MAGIC    0x4B4C4254U     /* "TBLK" */
+#define TLOG_BLOCK_ROWS     4096U
+#define TLOG_NAME_LEN       16U
+#define TLOG_MAX_CHANNELS   64U
+#define TLOG_READ_CHUNK     (1U << 20)
+
+/* Generated capture (-g) */
+#define GEN_RATE_HZ         2400U           /* LPTMR0 exchange rate */
+#define GEN_CMD_HZ          100U
+#define GEN_STEP_S          2U
+#define GEN_COUNTS_CPR      2249.0f         /* OUTPUT_COUNTS_CPR */
+#define GEN_TAU_S           0.05f
+#define GEN_LOSS            0.005f
+
+typedef enum {
+    TLOG_DOD = 0,           /* int64, delta of delta */
+    TLOG_DELTA = 1,         /* int64, delta */
+    TLOG_XOR = 2,           /* float32 */
+} tlog_enc_t;
+
+typedef struct __attribute__((packed)) {
+    char magic[8];
+    uint32_t version;
+    uint32_t channels;
+    uint32_t blockRows;
+    uint32_t headerBytes;   /* Up to the first block */
+    uint32_t reserved[2];
+} tlog_header_t;
+
+typedef struct __attribute__((packed)) {
+    char name[TLOG_NAME_LEN];
+    uint8_t enc;
+    uint8_t reserved[7];
+} tlog_channel_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t offset;        /* From the start of the block */
+    uint32_t bytes;
+    double min;
+    double max;
+    double sum;
+} tlog_column_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint32_t bytes;         /* Whole block, padded to 8 */
+    uint32_t rows;
+    uint32_t reserved;
+    int64_t tFirst;         /* t_us */
+    int64_t tLast;
+    tlog_column_t col[];
+} tlog_block_t;
+
+_Static_assert(sizeof(tlog_header_t) == 32U, "tlog_header_t");
+_Static_assert(sizeof(tlog_channel_t) == 24U, "tlog_channel_t");
+_Static_assert(sizeof(tlog_column_t) == 32U, "tlog_column_t");
+_Static_assert(sizeof(tlog_block_t) == 32U, "tlog_block_t");
+
+/* Channels this tool writes, in file order */
+enum {
+    CH_T, CH_SEQ,
+    CH_SPEED1, CH_SPEED2, CH_SPEED3, CH_SPEED4,
+    CH_ADC1, CH_ADC2, CH_ADC3, CH_ADC4,
+    CH_SYNC_COUNT, CH_SYNC_HOLD, CH_ROBOT,
+    CH_CMD_VX, CH_CMD_VY, CH_CMD_PHI, CH_CMD_BUTTONS, CH_CMD_COUNT,
+    TLOG_CHANNELS
+};
+
+static const struct {
+    const char *name;
+    tlog_enc_t enc;
+} s_channels[TLOG_CHANNELS] = {
+    {"t_us", TLOG_DOD},           {"seq", TLOG_DOD},
+    {"speed_m1", TLOG_XOR},       {"speed_m2", TLOG_XOR},       {"speed_m3", TLOG_XOR},   {"speed_m4", TLOG_XOR},
+    {"adc_m1", TLOG_DELTA},       {"adc_m2", TLOG_DELTA},       {"adc_m3", TLOG_DELTA},   {"adc_m4", TLOG_DELTA},
+    {"sync_cmd_count", TLOG_DELTA}, {"sync_hold_us", TLOG_DOD}, {"robot_id", TLOG_DELTA},
+    {"cmd_vx", TLOG_XOR},         {"cmd_vy", TLOG_XOR},         {"cmd_phi", TLOG_XOR},
+    {"cmd_buttons", TLOG_DELTA},  {"cmd_count", TLOG_DELTA},
+};
+
+/* Mapped log */
+typedef struct {
+    const uint8_t *map;
+    size_t size;
+    const tlog_header_t *hdr;
+    const tlog_channel_t *chan;
+    uint32_t channels;
+    const tlog_block_t **block;
+    uint32_t blocks;
+    uint64_t rows;
+    size_t end;             /* After the last whole block */
+} tlog_reader_t;
+
+/* Writer: the block being filled, float channels as their bits */
+static FILE *s_out;
+static int64_t s_row[TLOG_CHANNELS][TLOG_BLOCK_ROWS];
+static uint32_t s_rows;
+static uint8_t *s_blockBuf;
+static uint64_t s_written;
+static uint32_t s_blocksWritten;
+
+/* Unwrapping, duplicates and the held command */
+static bool s_haveRow;
+static uint32_t s_lastHeader;
+static uint32_t s_lastTs;
+static int64_t s_t;
+static int64_t s_seq;
+static int64_t s_cmd[TLOG_CHANNELS];
+static uint32_t s_robot;            /* -R */
+static uint64_t s_frames[2];        /* Telemetry, commands */
+static uint64_t s_dups;
+
+/*******************************************************************************
+ * Column coding
+ ******************************************************************************/
+
+typedef struct {
+    uint8_t *p;
+    uint64_t acc;
+    uint32_t n;             /* Bits in acc not written yet */
+} bit_writer_t;
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    uint64_t acc;
+    uint32_t n;
+} bit_reader_t;
+
+static void BitsPut(bit_writer_t *w, uint64_t v, uint32_t bits)
+{
+    if (bits > 32U)
+    {
+        BitsPut(w, v >> 32, bits - 32U);
+        bits = 32U;
+    }
+    w->acc = (w->acc << bits) | (v & ((1ULL << bits) - 1U));
+    w->n += bits;
+    while (w->n >= 8U)
+    {
+        w->n -= 8U;
+        *w->p++ = (uint8_t)(w->acc >> w->n);
+    }
+}
+
+static uint32_t BitsGet(bit_reader_t *r, uint32_t bits)
+{
+    while (r->n < bits)
+    {
+        r->acc = (r->acc << 8) | ((r->p < r->end) ? *r->p++ : 0U);
+        r->n += 8U;
+    }
+    r->n -= bits;
+    return (uint32_t)((r->acc >> r->n) & ((1ULL << bits) - 1U));
+}
+
+static uint64_t BitsGet64(bit_reader_t *r, uint32_t bits)
+{
+    if (bits <= 32U)
+    {
+        return BitsGet(r, bits);
+    }
+    uint64_t hi = BitsGet(r, bits - 32U);
+    return (hi << 32) | BitsGet(r, 32U);
+}
+
+static uint8_t *VarintPut(uint8_t *p, int64_t v)
+{
+    uint64_t z = ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+
+    while (z >= 0x80U)
+    {
+        *p++ = (uint8_t)(z | 0x80U);
+        z >>= 7;
+    }
+    *p++ = (uint8_t)z;
+    return p;
+}
+
+static const uint8_t *VarintGet(const uint8_t *p, const uint8_t *end, int64_t *v)
+{
+    uint64_t z = 0;
+    uint32_t shift = 0;
+
+    while (p < end && shift < 64U)
+    {
+        uint8_t b = *p++;
+        z |= (uint64_t)(b & 0x7FU) << shift;
+        if ((b & 0x80U) == 0U)
+        {
+            break;
+        }
+        shift += 7U;
+    }
+    *v = (int64_t)(z >> 1) ^ -(int64_t)(z & 1U);
+    return p;
+}
+
+/* Bound of an encoded column: 64 bits and an escape of 70 a row at worst */
+#define TLOG_COLUMN_MAX     (17U * TLOG_BLOCK_ROWS + 32U)
+
+static uint64_t WidthMask(uint32_t w)
+{
+    return (w >= 64U) ? UINT64_MAX : (1ULL << w) - 1U;
+}
+
+/* Width with the fewest bits for the block: values of w bits or more are escapes */
+static uint32_t PackWidth(const uint64_t *z, uint32_t n)
+{
+    uint32_t hist[65] = {0}, ones[65] = {0};
+    uint64_t best = UINT64_MAX;
+    uint32_t bestW = 64U;
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        uint32_t len = z[i] ? 64U - (uint32_t)__builtin_clzll(z[i]) : 0U;
+        hist[len]++;
+        ones[len] += (z[i] == WidthMask(len));
+    }
+    if (hist[0] == n)
+    {
+        return 0U;
+    }
+    for (uint32_t w = 1; w <= 64U; w++)
+    {
+        uint64_t cost = (uint64_t)n * w + (uint64_t)ones[w] * (6U + w);
+        for (uint32_t len = w + 1U; len <= 64U; len++)
+        {
+            cost += (uint64_t)hist[len] * (6U + len);
+        }
+        if (cost < best)
+        {
+            best = cost;
+            bestW = w;
+        }
+    }
+    return bestW;
+}
+
+static size_t EncodeColumn(tlog_enc_t enc, const int64_t *v, uint32_t rows, uint8_t *out)
+{
+    if (enc == TLOG_XOR)
+    {
+        bit_writer_t w = {out, 0, 0};
+        uint32_t prev = 0;
+
+        for (uint32_t i = 0; i < rows; i++)
+        {
+            uint32_t bits = (uint32_t)v[i];
+            uint32_t x = bits ^ prev;
+
+            if (i == 0U)
+            {
+                BitsPut(&w, bits, 32U);
+            }
+            else if (x == 0U)
+            {
+                BitsPut(&w, 0U, 1U);
+            }
+            else
+            {
+                uint32_t lz = (uint32_t)__builtin_clz(x);
+                uint32_t tz = (uint32_t)__builtin_ctz(x);
+                uint32_t len = 32U - lz - tz;
+
+                BitsPut(&w, 1U, 1U);
+                BitsPut(&w, lz, 5U);
+                BitsPut(&w, len - 1U, 5U);
+                BitsPut(&w, x >> tz, len);
+            }
+            prev = bits;
+        }
+        if (w.n != 0U)
+        {
+            *w.p++ = (uint8_t)(w.acc << (8U - w.n));
+        }
+        return (size_t)(w.p - out);
+    }
+
+    static uint64_t z[TLOG_BLOCK_ROWS];
+    uint8_t *p = VarintPut(out, v[0]);
+    int64_t prevDelta = 0;
+    for (uint32_t i = 1; i < rows; i++)
+    {
+        int64_t d = v[i] - v[i - 1U];
+        int64_t e = (enc == TLOG_DOD) ? d - prevDelta : d;
+
+        z[i - 1U] = ((uint64_t)e << 1) ^ (uint64_t)(e >> 63);
+        prevDelta = d;
+    }
+
+    uint32_t w = PackWidth(z, rows - 1U);
+    uint64_t mask = WidthMask(w);
+    bit_writer_t bw = {p, 0, 0};
+    *bw.p++ = (uint8_t)w;
+    for (uint32_t i = 0; w != 0U && i < rows - 1U; i++)
+    {
+        if (z[i] >= mask)
+        {
+            uint32_t len = 64U - (uint32_t)__builtin_clzll(z[i]);
+            BitsPut(&bw, mask, w);
+            BitsPut(&bw, len - 1U, 6U);
+            BitsPut(&bw, z[i], len);
+        }
+        else
+        {
+            BitsPut(&bw, z[i], w);
+        }
+    }
+    if (bw.n != 0U)
+    {
+        *bw.p++ = (uint8_t)(bw.acc << (8U - bw.n));
+    }
+    return (size_t)(bw.p - out);
+}
+
+static void DecodeColumn(tlog_enc_t enc, const uint8_t *in, size_t bytes, uint32_t rows, double *out)
+{
+    const uint8_t *end = in + bytes;
+
+    if (enc == TLOG_XOR)
+    {
+        bit_reader_t r = {in, end, 0, 0};
+        uint32_t bits = 0;
+
+        for (uint32_t i = 0; i < rows; i++)
+        {
+            if (i == 0U)
+            {
+                bits = BitsGet(&r, 32U);
+            }
+            else if (BitsGet(&r, 1U) != 0U)
+            {
+                uint32_t lz = BitsGet(&r, 5U);
+                uint32_t len = BitsGet(&r, 5U) + 1U;
+                uint32_t x = BitsGet(&r, len);
+
+                bits ^= (uint32_t)((uint64_t)x << (32U - lz - len));
+            }
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            out[i] = f;
+        }
+        return;
+    }
+
+    int64_t prev, prevDelta = 0;
+    in = VarintGet(in, end, &prev);
+    out[0] = (double)prev;
+    if (rows < 2U || in >= end)
+    {
+        return;
+    }
+
+    uint32_t w = *in++;
+    uint64_t mask = WidthMask(w);
+    bit_reader_t r = {in, end, 0, 0};
+    for (uint32_t i = 1; i < rows; i++)
+    {
+        uint64_t z = (w != 0U) ? BitsGet64(&r, w) : 0U;
+        if (w != 0U && z == mask)
+        {
+            z = BitsGet64(&r, BitsGet(&r, 6U) + 1U);
+        }
+
+        int64_t d = (int64_t)(z >> 1) ^ -(int64_t)(z & 1U);
+        if (enc == TLOG_DOD)
+        {
+            d += prevDelta;
+        }
+        prev += d;
+        prevDelta = d;
+        out[i] = (double)prev;
+    }
+}
+
+static double ChannelValue(tlog_enc_t enc, int64_t v)
+{
+    if (enc == TLOG_XOR)
+    {
+        uint32_t bits = (uint32_t)v;
+        float f;
+        memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+    return (double)v;
+}
+
+/*******************************************************************************
+ * Reader
+ ******************************************************************************/
+
+static size_t BlockHeaderBytes(uint32_t channels)
+{
+    return sizeof(tlog_block_t) + channels * sizeof(tlog_column_t);
+}
+
+static bool ReaderOpen(tlog_reader_t *r, const char *path)
+{
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+
+    memset(r, 0, sizeof(*r));
+    if (fd < 0 || fstat(fd, &st) != 0)
+    {
+        perror(path);
+        return false;
+    }
+    r->size = (size_t)st.st_size;
+    if (r->size < sizeof(tlog_header_t))
+    {
+        fprintf(stderr, "%s: not a telemetry log\n", path);
+        close(fd);
+        return false;
+    }
+    r->map = mmap(NULL, r->size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (r->map == MAP_FAILED)
+    {
+        perror("mmap");
+        return false;
+    }
+
+    r->hdr = (const tlog_header_t *)r->map;
+    if (memcmp(r->hdr->magic, TLOG_MAGIC, 8U) != 0 || r->hdr->version != TLOG_VERSION ||
+        r->hdr->channels == 0U || r->hdr->channels > TLOG_MAX_CHANNELS || r->hdr->blockRows == 0U ||
+        r->hdr->headerBytes < sizeof(tlog_header_t) + r->hdr->channels * sizeof(tlog_channel_t) ||
+        r->hdr->headerBytes > r->size)
+    {
+        fprintf(stderr, "%s: not a telemetry log (version %u)\n", path, TLOG_VERSION);
+        return false;
+    }
+    r->channels = r->hdr->channels;
+    r->chan = (const tlog_channel_t *)(r->map + sizeof(tlog_header_t));
+
+    /* The index: every whole block, in place */
+    size_t pos = r->hdr->headerBytes;
+    size_t hdrBytes = BlockHeaderBytes(r->channels);
+    uint32_t cap = 0;
+    while (pos + hdrBytes <= r->size)
+    {
+        const tlog_block_t *b = (const tlog_block_t *)(r->map + pos);
+        bool ok = b->magic == TLOG_BLOCK_MAGIC && b->bytes >= hdrBytes && b->bytes <= r->size - pos &&
+                  b->rows != 0U && b->rows <= r->hdr->blockRows;
+
+        for (uint32_t c = 0; ok && c < r->channels; c++)
+        {
+            ok = b->col[c].offset >= hdrBytes && b->col[c].bytes <= b->bytes - b->col[c].offset;
+        }
+        if (!ok)
+        {
+            break;
+        }
+        if (r->blocks == cap)
+        {
+            cap = cap ? 2U * cap : 256U;
+            r->block = realloc(r->block, cap * sizeof(*r->block));
+        }
+        r->block[r->blocks++] = b;
+        r->rows += b->rows;
+        pos += b->bytes;
+    }
+    r->end = pos;
+    return true;
+}
+
+static int ReaderChannel(const tlog_reader_t *r, const char *name, size_t len)
+{
+    for (uint32_t c = 0; c < r->channels; c++)
+    {
+        if (strlen(r->chan[c].name) == len && strncmp(r->chan[c].name, name, len) == 0)
+        {
+            return (int)c;
+        }
+    }
+    return -1;
+}
+
+static void ReaderDecode(const tlog_reader_t *r, const tlog_block_t *b, uint32_t c, double *out)
+{
+    DecodeColumn((tlog_enc_t)r->chan[c].enc, (const uint8_t *)b + b->col[c].offset, b->col[c].bytes, b->rows, out);
+}
+
+/* First block that ends at or after t */
+static uint32_t ReaderFind(const tlog_reader_t *r, int64_t t)
+{
+    uint32_t lo = 0, hi = r->blocks;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2U;
+        if (r->block[mid]->tLast < t)
+        {
+            lo = mid + 1U;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*******************************************************************************
+ * Writer
+ ******************************************************************************/
+
+static void FlushBlock(void)
+{
+    size_t hdrBytes = BlockHeaderBytes(TLOG_CHANNELS);
+    tlog_block_t *b = (tlog_block_t *)s_blockBuf;
+    size_t off = hdrBytes;
+
+    if (s_rows == 0U)
+    {
+        return;
+    }
+    memset(s_blockBuf, 0, hdrBytes);
+    b->magic = TLOG_BLOCK_MAGIC;
+    b->rows = s_rows;
+    b->tFirst = s_row[CH_T][0];
+    b->tLast = s_row[CH_T][s_rows - 1U];
+    for (uint32_t c = 0; c < TLOG_CHANNELS; c++)
+    {
+        tlog_column_t *col = &b->col[c];
+        double lo = INFINITY, hi = -INFINITY, sum = 0.0;
+
+        col->offset = (uint32_t)off;
+        col->bytes = (uint32_t)EncodeColumn(s_channels[c].enc, s_row[c], s_rows, s_blockBuf + off);
+        off += col->bytes;
+        for (uint32_t i = 0; i < s_rows; i++)
+        {
+            double v = ChannelValue(s_channels[c].enc, s_row[c][i]);
+            lo = fmin(lo, v);
+            hi = fmax(hi, v);
+            sum += v;
+        }
+        col->min = lo;
+        col->max = hi;
+        col->sum = sum;
+    }
+    while ((off & 7U) != 0U)
+    {
+        s_blockBuf[off++] = 0U;
+    }
+    b->bytes = (uint32_t)off;
+    if (fwrite(s_blockBuf, 1, off, s_out) != off)
+    {
+        perror("write");
+        exit(1);
+    }
+    s_written += s_rows;
+    s_blocksWritten++;
+    s_rows = 0U;
+}
+
+static void AddRow(const int64_t *v)
+{
+    for (uint32_t c = 0; c < TLOG_CHANNELS; c++)
+    {
+        s_row[c][s_rows] = v[c];
+    }
+    if (++s_rows == TLOG_BLOCK_ROWS)
+    {
+        FlushBlock();
+    }
+}
+
+static int64_t FloatBits(float f)
+{
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return (int64_t)bits;
+}
+
+static void TakeTelemetry(const RobotTelemetry_t *tel, uint8_t id)
+{
+    int64_t v[TLOG_CHANNELS];
+    uint16_t count = OMNI_WIRE_HEADER_COUNT(tel->packet_header);
+
+    s_frames[0]++;
+    if (id == OMNI_WIRE_ROBOT_NONE)
+    {
+        id = 0U;
+    }
+    if (id != s_robot)
+    {
+        return;
+    }
+    if (s_haveRow && tel->packet_header == s_lastHeader && tel->timestamp == s_lastTs)
+    {
+        s_dups++;
+        return;
+    }
+    if (s_haveRow)
+    {
+        s_t += (uint32_t)(tel->timestamp - s_lastTs);
+        s_seq += (uint16_t)(count - (uint16_t)s_seq);
+    }
+    else
+    {
+        s_t = tel->timestamp;
+        s_seq = count;
+    }
+    s_haveRow = true;
+    s_lastHeader = tel->packet_header;
+    s_lastTs = tel->timestamp;
+
+    memcpy(v, s_cmd, sizeof(v));
+    v[CH_T] = s_t;
+    v[CH_SEQ] = s_seq;
+    v[CH_SPEED1] = FloatBits(tel->speed_m1);
+    v[CH_SPEED2] = FloatBits(tel->speed_m2);
+    v[CH_SPEED3] = FloatBits(tel->speed_m3);
+    v[CH_SPEED4] = FloatBits(tel->speed_m4);
+    v[CH_ADC1] = tel->adc_m1;
+    v[CH_ADC2] = tel->adc_m2;
+    v[CH_ADC3] = tel->adc_m3;
+    v[CH_ADC4] = tel->adc_m4;
+    v[CH_SYNC_COUNT] = tel->sync_cmd_count;
+    v[CH_SYNC_HOLD] = tel->sync_hold_us;
+    v[CH_ROBOT] = id;
+    AddRow(v);
+}
+
+static void TakeCommand(const RemoteCommand_t *cmd, uint8_t id)
+{
+    s_frames[1]++;
+    if (id == OMNI_WIRE_ROBOT_NONE)
+    {
+        id = OMNI_WIRE_ROBOT_ALL;
+    }
+    if (id != s_robot && id != OMNI_WIRE_ROBOT_ALL)
+    {
+        return;
+    }
+    s_cmd[CH_CMD_VX] = FloatBits(cmd->vx);
+    s_cmd[CH_CMD_VY] = FloatBits(cmd->vy);
+    s_cmd[CH_CMD_PHI] = FloatBits(cmd->phi);
+    s_cmd[CH_CMD_BUTTONS] = cmd->buttons;
+    s_cmd[CH_CMD_COUNT] = OMNI_WIRE_HEADER_COUNT(cmd->header);
+}
+
+/* Frames in buf; returns the bytes used, the rest may be the start of a frame */
+static size_t ScanFrames(const uint8_t *buf, size_t len, bool last)
+{
+    size_t i = 0;
+
+    while (i + OMNI_WIRE_HEADER_SIZE <= len && (last || len - i >= OMNI_WIRE_MAX_FRAME))
+    {
+        const RobotTelemetry_t *tel = omni_wire_telemetry(buf + i, len - i);
+        const RemoteCommand_t *cmd = (tel == NULL) ? omni_wire_command(buf + i, len - i) : NULL;
+        uint8_t id = omni_wire_fleet_id(buf + i, len - i);
+        size_t tag = (id != OMNI_WIRE_ROBOT_NONE) ? sizeof(FleetTag_t) : 0U;
+
+        if (tel != NULL)
+        {
+            TakeTelemetry(tel, id);
+            i += sizeof(*tel) + tag;
+        }
+        else if (cmd != NULL)
+        {
+            TakeCommand(cmd, id);
+            i += sizeof(*cmd) + tag;
+        }
+        else
+        {
+            i++;
+        }
+    }
+    return last ? len : i;
+}
+
+static int HexDigit(int c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    c = tolower(c);
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/* Hex text: the bytes of every whitespace separated token that is all hex
+ * digits, two or an even number of them; "I (123) rx:" and the like are skipped */
+static size_t HexToBytes(const char *line, uint8_t *out)
+{
+    size_t n = 0;
+    const char *p = line;
+
+    while (*p != '\0')
+    {
+        const char *tok;
+        size_t len = 0;
+
+        while (*p != '\0' && isspace((unsigned char)*p)) p++;
+        tok = p;
+        while (*p != '\0' && !isspace((unsigned char)*p)) p++;
+        len = (size_t)(p - tok);
+        if (len < 2U || (len & 1U) != 0U)
+        {
+            continue;
+        }
+        bool hex = true;
+        for (size_t k = 0; k < len && hex; k++)
+        {
+            hex = HexDigit(tok[k]) >= 0;
+        }
+        for (size_t k = 0; hex && k < len; k += 2U)
+        {
+            out[n++] = (uint8_t)(HexDigit(tok[k]) << 4 | HexDigit(tok[k + 1U]));
+        }
+    }
+    return n;
+}
+
+static void Ingest(FILE *in, bool hex)
+{
+    static uint8_t buf[TLOG_READ_CHUNK + OMNI_WIRE_MAX_FRAME];
+    static char line[4096];
+    size_t have = 0;
+
+    for (;;)
+    {
+        size_t got;
+
+        if (hex)
+        {
+            got = 0;
+            while (have + got + sizeof(line) / 2U <= sizeof(buf) && fgets(line, sizeof(line), in) != NULL)
+            {
+                got += HexToBytes(line, buf + have + got);
+            }
+        }
+        else
+        {
+            got = fread(buf + have, 1, TLOG_READ_CHUNK, in);
+        }
+        have += got;
+
+        size_t used = ScanFrames(buf, have, got == 0U);
+        memmove(buf, buf + used, have - used);
+        have -= used;
+        if (got == 0U)
+        {
+            break;
+        }
+    }
+}
+
+/* Appending: drop a cut block, pick up the clock, the counter and the command where the log ends */
+static bool WriterOpen(const char *path)
+{
+    tlog_reader_t r;
+    struct stat st;
+
+    s_blockBuf = malloc(BlockHeaderBytes(TLOG_CHANNELS) + TLOG_CHANNELS * TLOG_COLUMN_MAX + 8U);
+    if (stat(path, &st) != 0 || st.st_size == 0)
+    {
+        tlog_header_t h;
+        tlog_channel_t ch[TLOG_CHANNELS];
+
+        s_out = fopen(path, "wb");
+        if (s_out == NULL)
+        {
+            perror(path);
+            return false;
+        }
+        memset(&h, 0, sizeof(h));
+        memset(ch, 0, sizeof(ch));
+        memcpy(h.magic, TLOG_MAGIC, 8U);
+        h.version = TLOG_VERSION;
+        h.channels = TLOG_CHANNELS;
+        h.blockRows = TLOG_BLOCK_ROWS;
+        h.headerBytes = (uint32_t)(sizeof(h) + sizeof(ch));
+        for (uint32_t c = 0; c < TLOG_CHANNELS; c++)
+        {
+            strncpy(ch[c].name, s_channels[c].name, TLOG_NAME_LEN - 1U);
+            ch[c].enc = (uint8_t)s_channels[c].enc;
+        }
+        fwrite(&h, sizeof(h), 1, s_out);
+        fwrite(ch, sizeof(ch), 1, s_out);
+        return true;
+    }
+
+    if (!ReaderOpen(&r, path))
+    {
+        return false;
+    }
+    bool same = (r.channels == TLOG_CHANNELS && r.hdr->blockRows == TLOG_BLOCK_ROWS);
+    for (uint32_t c = 0; same && c < TLOG_CHANNELS; c++)
+    {
+        same = strcmp(r.chan[c].name, s_channels[c].name) == 0 && r.chan[c].enc == s_channels[c].enc;
+    }
+    if (!same)
+    {
+        fprintf(stderr, "%s: other channels, write a new log\n", path);
+        return false;
+    }
+    if (r.end != r.size)
+    {
+        fprintf(stderr, "%s: dropping %zu bytes of a cut block\n", path, r.size - r.end);
+    }
+    if (r.blocks != 0U)
+    {
+        const tlog_block_t *b = r.block[r.blocks - 1U];
+        double v[TLOG_BLOCK_ROWS];
+
+        for (uint32_t c = 0; c < TLOG_CHANNELS; c++)
+        {
+            ReaderDecode(&r, b, c, v);
+            double last = v[b->rows - 1U];
+            s_cmd[c] = (s_channels[c].enc == TLOG_XOR) ? FloatBits((float)last) : (int64_t)last;
+        }
+        s_t = s_cmd[CH_T];
+        s_seq = s_cmd[CH_SEQ];
+        s_lastTs = (uint32_t)s_t;
+        s_haveRow = true;
+    }
+    munmap((void *)r.map, r.size);
+    free(r.block);
+
+    if (truncate(path, (off_t)r.end) != 0 || (s_out = fopen(path, "ab")) == NULL)
+    {
+        perror(path);
+        return false;
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Generated capture: 2.4 kHz telemetry and 100 Hz commands, as raw frames
+ ******************************************************************************/
+
+static uint32_t s_rng = 0x12345678U;
+
+static float Rand01(void)
+{
+    s_rng ^= s_rng << 13;
+    s_rng ^= s_rng >> 17;
+    s_rng ^= s_rng << 5;
+    return (float)(s_rng >> 8) / 16777216.0f;
+}
+
+static void Generate(double seconds)
+{
+    static const float cmds[][3] = {
+        {0.0f, 0.0f, 0.0f}, {0.4f, 0.0f, 0.0f}, {0.0f, 0.3f, 0.0f}, {0.3f, 0.3f, 0.0f}, {0.0f, 0.0f, 1.5f},
+        {-0.2f, 0.1f, 0.5f},
+    };
+    const float step = 2.0f * 3.14159265f / GEN_COUNTS_CPR;
+    const float L = 0.2825f, R = 0.05f;     /* ROBOT_LX + ROBOT_LY, WHEEL_RADIUS */
+    const float dt = 1.0f / GEN_RATE_HZ;
+    uint64_t rows = (uint64_t)(seconds * GEN_RATE_HZ);
+    RemoteCommand_t cmd;
+    RobotTelemetry_t tel;
+    float w[4] = {0};
+    uint32_t cmdCount = 0, cmdUs = 0, seq = 0;
+    uint32_t setIdx = 0;
+
+    memset(&cmd, 0, sizeof(cmd));
+    memset(&tel, 0, sizeof(tel));
+    for (uint64_t i = 0; i < rows; i++)
+    {
+        uint32_t ts = (uint32_t)(1000000ULL + i * 1000000ULL / GEN_RATE_HZ);
+        const float *c = cmds[setIdx];
+        float target[4];
+
+        if (i % (GEN_RATE_HZ * GEN_STEP_S) == 0U)
+        {
+            setIdx = (uint32_t)(Rand01() * (sizeof(cmds) / sizeof(cmds[0])));
+            c = cmds[setIdx];
+        }
+        if (i % (GEN_RATE_HZ / GEN_CMD_HZ) == 0U)
+        {
+            cmd.header = OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_COMMAND, ++cmdCount, sizeof(cmd));
+            cmd.vx = c[0];
+            cmd.vy = c[1];
+            cmd.phi = c[2];
+            cmd.timestamp = ts;
+            cmdUs = ts;
+            fwrite(&cmd, sizeof(cmd), 1, stdout);
+        }
+
+        /* ROBOT_compute_kinematics(), clamped to 10 rad/s, first order wheels */
+        target[0] = (c[1] + c[0] - c[2] * L) / R;
+        target[1] = (c[1] - c[0] + c[2] * L) / R;
+        target[2] = (c[1] + c[0] + c[2] * L) / R;
+        target[3] = (c[1] - c[0] - c[2] * L) / R;
+        for (uint32_t k = 0; k < 4U; k++)
+        {
+            target[k] = fmaxf(-10.0f, fminf(10.0f, target[k]));
+            w[k] += (target[k] - w[k]) * dt / GEN_TAU_S;
+        }
+
+        /* A lost exchange now and then: the counter skips */
+        seq += (Rand01() < GEN_LOSS) ? 2U : 1U;
+        tel.packet_header = OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_TELEMETRY, seq, sizeof(tel));
+        float speed[4];
+        uint16_t adc[4];
+        for (uint32_t k = 0; k < 4U; k++)
+        {
+            /* Unsigned, from the last edge period captured in us */
+            float a = fabsf(w[k]);
+            float period = (a > 0.05f) ? roundf(step / a * 1e6f) : 0.0f;
+            speed[k] = (period > 0.0f) ? step / (period * 1e-6f) : 0.0f;
+            adc[k] = (uint16_t)(1000.0f + 150.0f * a + 12.0f * (Rand01() - 0.5f));
+        }
+        tel.speed_m1 = speed[0];
+        tel.speed_m2 = speed[1];
+        tel.speed_m3 = speed[2];
+        tel.speed_m4 = speed[3];
+        tel.adc_m1 = adc[0];
+        tel.adc_m2 = adc[1];
+        tel.adc_m3 = adc[2];
+        tel.adc_m4 = adc[3];
+        tel.sync_cmd_count = (uint16_t)cmdCount;
+        tel.sync_hold_us = (uint16_t)(ts - cmdUs);
+        tel.timestamp = ts;
+        fwrite(&tel, sizeof(tel), 1, stdout);
+    }
+}
+
+/*******************************************************************************
+ * Queries
+ ******************************************************************************/
+
+static double Seconds(const struct timespec *a, const struct timespec *b)
+{
+    return (double)(b->tv_sec - a->tv_sec) + (double)(b->tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void PrintValue(const tlog_reader_t *r, uint32_t c, double v)
+{
+    if (r->chan[c].enc == TLOG_XOR)
+    {
+        printf(",%.9g", v);
+    }
+    else
+    {
+        printf(",%.0f", v);
+    }
+}
+
+static void Info(const tlog_reader_t *r, const char *path)
+{
+    uint64_t colBytes[TLOG_MAX_CHANNELS] = {0};
+    double lo[TLOG_MAX_CHANNELS], hi[TLOG_MAX_CHANNELS];
+    int64_t t0 = r->blocks ? r->block[0]->tFirst : 0;
+    int64_t t1 = r->blocks ? r->block[r->blocks - 1U]->tLast : 0;
+
+    for (uint32_t c = 0; c < r->channels; c++)
+    {
+        lo[c] = INFINITY;
+        hi[c] = -INFINITY;
+    }
+    for (uint32_t i = 0; i < r->blocks; i++)
+    {
+        for (uint32_t c = 0; c < r->channels; c++)
+        {
+            colBytes[c] += r->block[i]->col[c].bytes;
+            lo[c] = fmin(lo[c], r->block[i]->col[c].min);
+            hi[c] = fmax(hi[c], r->block[i]->col[c].max);
+        }
+    }
+    printf("%s: %llu rows in %u blocks, %.1f s (robot clock %.3f .. %.3f s)\n", path, (unsigned long long)r->rows,
+           r->blocks, (double)(t1 - t0) / 1e6, (double)t0 / 1e6, (double)t1 / 1e6);
+    printf("  %zu bytes, %.2f per row (telemetry frame: %zu)%s\n", r->end,
+           r->rows ? (double)r->end / (double)r->rows : 0.0, sizeof(RobotTelemetry_t),
+           (r->end != r->size) ? ", then a cut block" : "");
+    printf("  %-16s %12s %9s %16s %16s\n", "channel", "bytes", "bits/row", "min", "max");
+    for (uint32_t c = 0; c < r->channels; c++)
+    {
+        printf("  %-16s %12llu %9.2f %16.12g %16.12g\n", r->chan[c].name, (unsigned long long)colBytes[c],
+               r->rows ? 8.0 * (double)colBytes[c] / (double)r->rows : 0.0, lo[c], hi[c]);
+    }
+}
+
+/* Rows in [from, to) as CSV: t in s from the start of the log, then the channels */
+static uint64_t Range(const tlog_reader_t *r, int64_t from, int64_t to, const uint32_t *sel, uint32_t nsel)
+{
+    double *t = malloc(r->hdr->blockRows * sizeof(double));
+    double *col = malloc((size_t)nsel * r->hdr->blockRows * sizeof(double));
+    int64_t t0 = r->block[0]->tFirst;
+    uint64_t n = 0;
+
+    printf("t_s");
+    for (uint32_t s = 0; s < nsel; s++)
+    {
+        printf(",%s", r->chan[sel[s]].name);
+    }
+    printf("\n");
+    for (uint32_t i = ReaderFind(r, from); i < r->blocks && r->block[i]->tFirst < to; i++)
+    {
+        const tlog_block_t *b = r->block[i];
+
+        ReaderDecode(r, b, CH_T, t);
+        for (uint32_t s = 0; s < nsel; s++)
+        {
+            ReaderDecode(r, b, sel[s], col + (size_t)s * r->hdr->blockRows);
+        }
+        for (uint32_t k = 0; k < b->rows; k++)
+        {
+            if (t[k] < (double)from || t[k] >= (double)to)
+            {
+                continue;
+            }
+            printf("%.6f", (t[k] - (double)t0) / 1e6);
+            for (uint32_t s = 0; s < nsel; s++)
+            {
+                PrintValue(r, sel[s], col[(size_t)s * r->hdr->blockRows + k]);
+            }
+            printf("\n");
+            n++;
+        }
+    }
+    free(t);
+    free(col);
+    return n;
+}
+
+typedef struct {
+    double min, max, sum;
+} bucket_t;
+
+/* [from, to) in n buckets: rows, then min / max / mean of every channel.
+ * A block inside one bucket is merged from its summary. */
+static uint64_t Decimate(const tlog_reader_t *r, int64_t from, int64_t to, uint32_t n, const uint32_t *sel,
+                         uint32_t nsel, uint32_t *decoded)
+{
+    bucket_t *acc = malloc((size_t)n * nsel * sizeof(bucket_t));
+    uint64_t *count = calloc(n, sizeof(uint64_t));
+    double *t = malloc(r->hdr->blockRows * sizeof(double));
+    double *col = malloc((size_t)nsel * r->hdr->blockRows * sizeof(double));
+    int64_t span = to - from;
+    int64_t t0 = r->block[0]->tFirst;
+    uint64_t rows = 0;
+
+    for (size_t k = 0; k < (size_t)n * nsel; k++)
+    {
+        acc[k] = (bucket_t){INFINITY, -INFINITY, 0.0};
+    }
+    *decoded = 0;
+    for (uint32_t i = ReaderFind(r, from); i < r->blocks && r->block[i]->tFirst < to; i++)
+    {
+        const tlog_block_t *b = r->block[i];
+        uint32_t first = (b->tFirst >= from) ? (uint32_t)((b->tFirst - from) * (int64_t)n / span) : UINT32_MAX;
+        uint32_t last = (b->tLast < to) ? (uint32_t)((b->tLast - from) * (int64_t)n / span) : UINT32_MAX;
+
+        if (first != UINT32_MAX && first == last)
+        {
+            for (uint32_t s = 0; s < nsel; s++)
+            {
+                bucket_t *a = &acc[(size_t)first * nsel + s];
+                a->min = fmin(a->min, b->col[sel[s]].min);
+                a->max = fmax(a->max, b->col[sel[s]].max);
+                a->sum += b->col[sel[s]].sum;
+            }
+            count[first] += b->rows;
+            rows += b->rows;
+            continue;
+        }
+
+        (*decoded)++;
+        ReaderDecode(r, b, CH_T, t);
+        for (uint32_t s = 0; s < nsel; s++)
+        {
+            ReaderDecode(r, b, sel[s], col + (size_t)s * r->hdr->blockRows);
+        }
+        for (uint32_t k = 0; k < b->rows; k++)
+        {
+            if (t[k] < (double)from || t[k] >= (double)to)
+            {
+                continue;
+            }
+            uint32_t q = (uint32_t)(((int64_t)t[k] - from) * (int64_t)n / span);
+            for (uint32_t s = 0; s < nsel; s++)
+            {
+                bucket_t *a = &acc[(size_t)q * nsel + s];
+                double v = col[(size_t)s * r->hdr->blockRows + k];
+                a->min = fmin(a->min, v);
+                a->max = fmax(a->max, v);
+                a->sum += v;
+            }
+            count[q]++;
+            rows++;
+        }
+    }
+
+    printf("t_s,rows");
+    for (uint32_t s = 0; s < nsel; s++)
+    {
+        printf(",%s_min,%s_max,%s_mean", r->chan[sel[s]].name, r->chan[sel[s]].name, r->chan[sel[s]].name);
+    }
+    printf("\n");
+    for (uint32_t q = 0; q < n; q++)
+    {
+        if (count[q] == 0U)
+        {
+            continue;
+        }
+        printf("%.6f,%llu", (double)(from - t0 + span * q / n) / 1e6, (unsigned long long)count[q]);
+        for (uint32_t s = 0; s < nsel; s++)
+        {
+            const bucket_t *a = &acc[(size_t)q * nsel + s];
+            PrintValue(r, sel[s], a->min);
+            PrintValue(r, sel[s], a->max);
+            printf(",%.6g", a->sum / (double)count[q]);
+        }
+        printf("\n");
+    }
+    free(acc);
+    free(count);
+    free(t);
+    free(col);
+    return rows;
+}
+
+static void Usage(const char *prog)
+{
+    printf("usage: %s -o log [-x] [-R id] [dump ...]     capture (no dump or -: stdin), appends\n"
+           "       %s -g seconds > dump                  generated raw capture, 2.4 kHz\n"
+           "       %s -f log                             summary\n"
+           "       %s -f log -r FROM:TO [-c ch,...]      rows as CSV, s from the start (FROM: or :TO open)\n"
+           "       %s -f log -m N [-r FROM:TO] [-c ...]  N buckets: rows, min, max, mean\n"
+           "  -x     hex text input (serial terminal, ESP_LOG_BUFFER_HEX)\n"
+           "  -R id  robot of a fleet capture (0)\n"
+           "  -c     channels (default: all), see the summary for the names\n",
+           prog, prog, prog, prog, prog);
+}
+
+int main(int argc, char **argv)
+{
+    const char *outPath = NULL, *logPath = NULL, *range = NULL, *chans = NULL;
+    double genSeconds = 0.0;
+    uint32_t buckets = 0;
+    bool hex = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "o:f:g:r:m:c:R:xh")) != -1)
+    {
+        switch (opt)
+        {
+            case 'o': outPath = optarg; break;
+            case 'f': logPath = optarg; break;
+            case 'g': genSeconds = atof(optarg); break;
+            case 'r': range = optarg; break;
+            case 'm': buckets = (uint32_t)atoi(optarg); break;
+            case 'c': chans = optarg; break;
+            case 'R': s_robot = (uint32_t)atoi(optarg); break;
+            case 'x': hex = true; break;
+            default:
+                Usage(argv[0]);
+                return (opt == 'h') ? 0 : 1;
+        }
+    }
+
+    if (genSeconds > 0.0)
+    {
+        Generate(genSeconds);
+        return 0;
+    }
+
+    struct timespec a, b;
+    clock_gettime(CLOCK_MONOTONIC, &a);
+
+    if (outPath != NULL)
+    {
+        if (!WriterOpen(outPath))
+        {
+            return 1;
+        }
+        if (optind == argc)
+        {
+            Ingest(stdin, hex);
+        }
+        for (int i = optind; i < argc; i++)
+        {
+            FILE *in = (strcmp(argv[i], "-") == 0) ? stdin : fopen(argv[i], hex ? "r" : "rb");
+            if (in == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            Ingest(in, hex);
+            if (in != stdin)
+            {
+                fclose(in);
+            }
+        }
+        FlushBlock();
+        fclose(s_out);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        fprintf(stderr, "%llu telemetry / %llu command frames, %llu repeats: %llu rows in %u blocks, %.2f s\n",
+                (unsigned long long)s_frames[0], (unsigned long long)s_frames[1], (unsigned long long)s_dups,
+                (unsigned long long)s_written, s_blocksWritten, Seconds(&a, &b));
+        return 0;
+    }
+
+    if (logPath == NULL)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    tlog_reader_t r;
+    if (!ReaderOpen(&r, logPath))
+    {
+        return 1;
+    }
+    if (range == NULL && buckets == 0U)
+    {
+        Info(&r, logPath);
+        return 0;
+    }
+    if (r.blocks == 0U)
+    {
+        fprintf(stderr, "%s: empty\n", logPath);
+        return 1;
+    }
+
+    /* Channels */
+    uint32_t sel[TLOG_MAX_CHANNELS], nsel = 0;
+    if (chans == NULL)
+    {
+        for (uint32_t c = 0; c < r.channels; c++)
+        {
+            if (c != CH_T)
+            {
+                sel[nsel++] = c;
+            }
+        }
+    }
+    else
+    {
+        for (const char *p = chans; *p != '\0' && nsel < TLOG_MAX_CHANNELS;)
+        {
+            size_t len = strcspn(p, ",");
+            int c = ReaderChannel(&r, p, len);
+            if (c < 0)
+            {
+                fprintf(stderr, "no channel %.*s\n", (int)len, p);
+                return 1;
+            }
+            sel[nsel++] = (uint32_t)c;
+            p += len + (p[len] == ',');
+        }
+    }
+
+    /* Range, s from the start of the log */
+    int64_t t0 = r.block[0]->tFirst;
+    int64_t from = t0, to = r.block[r.blocks - 1U]->tLast + 1;
+    if (range != NULL)
+    {
+        const char *colon = strchr(range, ':');
+        if (colon == NULL)
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+        if (colon != range)
+        {
+            from = t0 + (int64_t)(atof(range) * 1e6);
+        }
+        if (colon[1] != '\0')
+        {
+            to = t0 + (int64_t)(atof(colon + 1) * 1e6);
+        }
+        if (to <= from)
+        {
+            fprintf(stderr, "empty range\n");
+            return 1;
+        }
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &a);
+    if (buckets != 0U)
+    {
+        uint32_t decoded;
+        uint64_t rows = Decimate(&r, from, to, buckets, sel, nsel, &decoded);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        fprintf(stderr, "%llu rows in %u buckets, %u of the blocks decoded: %.1f ms\n", (unsigned long long)rows,
+                buckets, decoded, Seconds(&a, &b) * 1e3);
+    }
+    else
+    {
+        uint64_t rows = Range(&r, from, to, sel, nsel);
+        clock_gettime(CLOCK_MONOTONIC, &b);
+        fprintf(stderr, "%llu rows: %.1f ms\n", (unsigned long long)rows, Seconds(&a, &b) * 1e3);
+    }
+    return 0;
+}
@@ -0,0 +1,1457 @@
+/*
+ * omni_twin.c
+ *
+ * Digital twin of the whole control chain, as four Linux processes:
+ *
+ *   remote MCU --SPI--> TX bridge ~~air~~> RX bridge --SPI--> robot MCU
+ *              <--SPI--           <~~air~~           <--SPI--
+ *
+ * - remote: lpadc_interrupt.c main loop, the joysticks follow a step script
+ * - robot:  MCXN947_Project.c main with omnidriver.c, RobotTelemetry.c and
+ *           TIMER_DRIVER.c, four motor plants behind the PWM/encoder stand-ins
+ * - bridges: the frame path of ESP32_WIFI (bridge_frames.c: SPI frame -> air_link ->
+ *           ESP-NOW, air -> next MISO payload) with the real air_link.c and the
+ *           MISO pool of spi_bridge (spi_bridge_miso.c)
+ *
+ * SPI links are shared-memory channels that stand in for the spi_slave driver's
+ * queue: the bridge arms its transactions as spi_bridge_task() does (one, the
+ * fleet TX bridge one per robot), each with the MISO payload that was the
+ * latest when it was queued, and gets back what the master clocked with its length. ESP-NOW is UDP on loopback with
+ * loss, delay, jitter and a frame rate cap injected at the sender.
+ *
+ * Built with ROBOT_SPI_DATA_READY=1 the telemetry link follows the ready mode of
+ * spi_bridge instead: the RX bridge arms one transaction when a command lands (or
+ * after the keep-alive), then pulses the data-ready pin of the simulated robot.
+ *
+ * Built with REMOTE_FLEET=1, -n N runs a fleet (fleet_link.h): the remote, the TX
+ * bridge and N RX bridge + robot pairs. The TX bridge broadcasts a beacon with every
+ * robot's command, each RX bridge sends its telemetry in its slot. The air is then
+ * one shared channel: every frame takes its 1 Mbps air time and a sender waits while
+ * the channel is busy (-a models that for the point-to-point link too).
+ *
+ * The joystick alternates between neutral and full forward every half
+ * period. For every step the processes stamp CLOCK_MONOTONIC when the
+ * robot takes the new command, when all wheels are at 90 % of their target
+ * (10 % when stopping) and when the remote sees that in the telemetry.
+ *
+ * The remote's debug console reads the twin's stdin, so its commands (the gain
+ * table, RemoteGains.h) can be piped in: echo "gains" | omni_twin -v
+ *
+ * -o writes the frames on the remote's SPI (every new command and telemetry
+ * frame, as on the wire) for HOST_SIM/tools/telemetry_log.c.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+#include "sim_hooks.h"
+#include "robot_board.h"
+#include "omnidriver.h"
+#include "RobotTelemetry.h"
+#include "ESP_SPI.h"
+#include "air_link.h"
+#include "fleet_link.h"
+#include "bridge_frames.h"
+#include "spi_bridge_miso.h"
+#include "omni_wire.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define TWIN_SPI_ARMED          SPI_BRIDGE_TRANS_CNT
+#define TWIN_MAX_STEPS          1024U
+#define TWIN_AIR_QUEUE          256U
+#define TWIN_ROBOT_SLICE_US     250U    /* Host time between two robot catch-ups */
+#define TWIN_SPI_WAIT_US        5000U   /* See SpiMasterXfer() */
+#define TWIN_BOOT_US            200000U /* Neutral stick before the first half period starts */
+#define TWIN_READY_KEEPALIVE_US 10000U  /* RX main.c: 1000 / TELEMETRY_MIN_HZ ms */
+#define TWIN_MAX_ROBOTS         FLEET_MAX_ROBOTS
+#define TWIN_BRIDGE_POLL_US     2000U   /* Longest bridge wait without SPI or air traffic */
+#define TWIN_AIR_BACKLOG_US     10000U  /* Shared channel: esp_now_send() refuses a frame behind this much air time */
+
+#ifndef REMOTE_FLEET
+#define REMOTE_FLEET            0       /* As lpadc_interrupt.c: the remote firmware in remote_fw.c */
+#endif
+
+/* Remote joystick ADC inputs (lpadc_interrupt.c) */
+#define TWIN_JOY_CHANNEL        1U      /* Side A: vx, side B: vy */
+#define TWIN_ADC_CENTER         2048U
+#define TWIN_ADC_FULL           4095U
+
+/* Links, numbered like the bridges: 0 = remote <-> TX bridge, 1 + r = robot r <-> its RX bridge */
+enum { TWIN_CMD_LINK = 0, TWIN_TELEMETRY_LINK = 1, TWIN_LINKS = 2 };
+#define TWIN_BRIDGES            (1U + TWIN_MAX_ROBOTS)
+
+/* Processes: remote, TX bridge, then an RX bridge and a robot per robot */
+enum { TWIN_REMOTE, TWIN_TX_BRIDGE, TWIN_RX_BRIDGE, TWIN_ROBOT };
+#define TWIN_NODES              (2U + 2U * TWIN_MAX_ROBOTS)
+
+typedef struct {
+    double seconds;
+    double lossPct;
+    uint32_t delayUs;
+    uint32_t jitterUs;
+    uint32_t airFps;            /* 0 = unlimited */
+    uint32_t halfPeriodMs;
+    uint8_t repeat[TWIN_LINKS];
+    uint8_t parityGroup;
+    unsigned seed;
+    bool verbose;
+    uint32_t robots;            /* Fleet size, 0 = the point-to-point link */
+    bool channel;               /* Shared channel with air time */
+    motor_plant_params_t motor;
+    const char *frameLog;       /* -o, NULL = none */
+} twin_options_t;
+
+/* One MCU <-> bridge SPI link; the MCU is the master. The slave side is the spi_slave
+ * driver's queue: armed transactions in the order queued, then done ones until the bridge
+ * takes their result. Armed and done together never exceed TWIN_SPI_ARMED. */
+typedef struct {
+    pthread_mutex_t lock;
+    int eventFd;
+    uint8_t armMiso[TWIN_SPI_ARMED][SPI_BRIDGE_PAYLOAD_SIZE];   /* tx_buffer, as it was when queued */
+    int armBuf[TWIN_SPI_ARMED];                                 /* Its buffer in the bridge's MISO pool */
+    uint32_t armHead;
+    uint32_t armCount;
+    uint8_t ring[TWIN_SPI_ARMED][SPI_BRIDGE_PAYLOAD_SIZE];      /* Done: what the master clocked on MOSI */
+    uint32_t ringLen[TWIN_SPI_ARMED];
+    int ringBuf[TWIN_SPI_ARMED];
+    uint32_t head;
+    uint32_t count;
+    uint64_t frames;
+    uint64_t bytes;             /* Clocked by the master */
+    uint64_t overruns;          /* Clocked with no transaction armed */
+
+    /* Ready mode (spi_bridge_ready_task): one transaction armed at a time */
+    bool readyMode;
+    uint32_t readySeq;          /* Bumped on every data-ready pulse */
+    uint64_t readyRetries;      /* Re-pulsed, the master missed the edge */
+} twin_spi_t;
+
+_Static_assert(ESP_SPI_TRANSFER_SIZE <= SPI_BRIDGE_PAYLOAD_SIZE, "The master's transfer must fit a bridge transaction");
+
+typedef struct {
+    uint64_t cmdUs[TWIN_MAX_ROBOTS];    /* Robot took the new command */
+    uint64_t wheelUs[TWIN_MAX_ROBOTS];  /* All wheels at 90 % (go) / below 10 % (stop) */
+    uint64_t remoteUs[TWIN_MAX_ROBOTS]; /* The remote's telemetry shows it */
+} twin_step_t;
+
+typedef struct {
+    air_link_stats_t stats;     /* Of the bridge's receiver(s), summed */
+    air_link_latency_t latency; /* Worst receiver */
+    uint64_t injectedLoss;
+    uint64_t rateDrops;
+    uint64_t bytes;             /* Handed to the transport, air_link header included */
+    uint64_t channelWaits;      /* Frames that found the channel busy */
+    uint64_t channelWaitUs;
+} twin_air_t;
+
+typedef struct {
+    twin_options_t opt;
+    uint64_t startUs;
+    volatile int stop;
+    twin_spi_t spi[TWIN_BRIDGES];
+    twin_air_t air[TWIN_BRIDGES];   /* Indexed by the bridge that sends */
+    twin_step_t step[TWIN_MAX_STEPS];
+    volatile float wheelTarget[TWIN_MAX_ROBOTS];    /* |target| of the last go step (rad/s) */
+    uint64_t robotLagMaxUs;
+    uint64_t pidTicks;              /* All robots */
+    uint64_t telemetryTicks;
+
+    /* Shared channel (-a, fleet): busy until channelFreeUs */
+    pthread_mutex_t channelLock;
+    uint64_t channelFreeUs;
+    uint64_t channelBusyUs;
+
+    /* Fleet */
+    uint32_t superframeUs;
+    uint64_t remoteTelemetry[TWIN_MAX_ROBOTS];  /* New telemetry frames at the remote MCU */
+    fleet_remote_stats_t fleetRemote;
+    fleet_robot_stats_t fleetRobot[TWIN_MAX_ROBOTS];
+} twin_shm_t;
+
+typedef struct {
+    uint64_t dueUs;
+    uint32_t order;             /* Keeps frames with the same due time in send order */
+    uint32_t to;                /* Bridges it still goes to (bit per bridge) */
+    uint32_t len;
+    uint8_t frame[AIR_LINK_FRAME_SIZE(AIR_LINK_MAX_PAYLOAD)];
+} twin_air_frame_t;
+
+/* Firmware globals (MCXN947_Project.c, lpadc_interrupt.c) */
+extern MOTOR_T M1, M2, M3, M4;
+extern ROBOT_T ROBOT;
+extern int RobotFw_Main(void);
+extern int RemoteFw_Main(void);
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static twin_shm_t *s_shm;
+/* UDP endpoint of every bridge, it sends and receives on it */
+static int s_sock[TWIN_BRIDGES];
+static struct sockaddr_in s_addr[TWIN_BRIDGES];
+
+/* Node-local state */
+static uint32_t s_robot;        /* Robot and RX bridge nodes: robot index */
+static uint64_t s_robotBootUs;
+#if ROBOT_SPI_DATA_READY
+static uint32_t s_robotReadySeq;
+#endif
+static MOTOR_T *const s_motor[ROBOT_BOARD_WHEELS] = {&M1, &M2, &M3, &M4};
+
+static air_link_t s_air;
+static air_link_t s_airRx[TWIN_MAX_ROBOTS];    /* Fleet TX bridge: one receiver per robot bridge */
+static uint32_t s_bridge;
+static bridge_frames_t s_frames;
+static spi_bridge_miso_t s_miso;
+static uint32_t s_misoArmedSeq;     /* Ready mode: payload of the armed transaction */
+static uint32_t s_misoClockedSeq;   /* Ready mode: newest payload the master clocked */
+static uint64_t s_readyUs;          /* Ready mode: armed or re-pulsed, or the last exchange */
+static uint64_t s_fleetDueUs;   /* Next beacon (TX) or our slot (RX), 0 = none */
+static twin_air_frame_t s_airQueue[TWIN_AIR_QUEUE];
+static uint32_t s_airQueued;
+static uint32_t s_airOrder;
+static uint64_t s_airTokensUs;
+static unsigned s_rand;
+
+/*******************************************************************************
+ * Step script
+ ******************************************************************************/
+static int64_t StepIndex(uint64_t nowUs)
+{
+    if (nowUs < s_shm->startUs)
+    {
+        return -1;
+    }
+    int64_t k = (int64_t)((nowUs - s_shm->startUs) / ((uint64_t)s_shm->opt.halfPeriodMs * 1000U));
+    return (k < (int64_t)TWIN_MAX_STEPS) ? k : -1;
+}
+
+/* Odd half periods are "full forward", the first step (k = 1) is a go step */
+static inline bool StepIsGo(int64_t k)
+{
+    return (k & 1) != 0;
+}
+
+static void StampOnce(uint64_t *slot, uint64_t nowUs)
+{
+    if (*slot == 0U)
+    {
+        *slot = nowUs;
+    }
+}
+
+/*******************************************************************************
+ * SPI channels
+ ******************************************************************************/
+static void SpiInit(twin_spi_t *ch)
+{
+    pthread_mutexattr_t attr;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&ch->lock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    ch->eventFd = eventfd(0, EFD_NONBLOCK);
+}
+
+/*
+ * Master side: the frame goes to the next armed transaction, MISO is what the bridge armed.
+ * waitUs: a node that runs behind the host clock (the robot catching up) produces its frames
+ * in a burst that is spread out on the board; give the bridge that much time to re-arm. The
+ * fleet remote clocks one exchange per robot back to back: the ESP re-arms within tens of
+ * microseconds, a bridge process on a busy host does not. The remote's first exchange may
+ * also come before the bridge process has armed anything, where the ESP has long booted.
+ * In ready mode the master only clocks after the data-ready edge, without one it overruns.
+ */
+static void SpiMasterXfer(twin_spi_t *ch, const uint8_t *tx, uint8_t *rx, uint32_t len, uint32_t waitUs)
+{
+    uint64_t one = 1;
+    uint64_t until = Sim_MonotonicUs() + waitUs;
+
+    pthread_mutex_lock(&ch->lock);
+    while (!ch->readyMode && ch->armCount == 0U && Sim_MonotonicUs() < until)
+    {
+        pthread_mutex_unlock(&ch->lock);
+        sched_yield();
+        pthread_mutex_lock(&ch->lock);
+    }
+    if (ch->armCount != 0U)
+    {
+        uint32_t slot = (ch->head + ch->count) % TWIN_SPI_ARMED;
+
+        memcpy(rx, ch->armMiso[ch->armHead], len);
+        memcpy(ch->ring[slot], tx, len);
+        ch->ringLen[slot] = len;
+        ch->ringBuf[slot] = ch->armBuf[ch->armHead];
+        ch->armHead = (ch->armHead + 1U) % TWIN_SPI_ARMED;
+        ch->armCount--;
+        ch->count++;
+    }
+    else
+    {
+        memset(rx, 0, len);
+        ch->overruns++;
+    }
+    ch->frames++;
+    ch->bytes += len;
+    pthread_mutex_unlock(&ch->lock);
+
+    (void)write(ch->eventFd, &one, sizeof(one));
+}
+
+/* arm_transaction() of spi_bridge: the latest payload of the pool, fixed from now on.
+ * Returns its sequence number. */
+static uint32_t SpiSlaveArm(twin_spi_t *ch)
+{
+    uint32_t seq;
+    int idx = spi_bridge_miso_take(&s_miso, &seq);
+
+    pthread_mutex_lock(&ch->lock);
+    uint32_t slot = (ch->armHead + ch->armCount) % TWIN_SPI_ARMED;
+    memcpy(ch->armMiso[slot], s_miso.buf[idx], SPI_BRIDGE_PAYLOAD_SIZE);
+    ch->armBuf[slot] = idx;
+    ch->armCount++;
+    pthread_mutex_unlock(&ch->lock);
+    return seq;
+}
+
+/* spi_slave_get_trans_result(): returns the bytes the master clocked (trans_len), 0 if
+ * nothing is done. The transaction's MISO buffer goes back to the pool. */
+static uint32_t SpiSlavePop(twin_spi_t *ch, uint8_t *frame)
+{
+    uint32_t len = 0;
+    int idx = -1;
+
+    pthread_mutex_lock(&ch->lock);
+    if (ch->count != 0U)
+    {
+        len = ch->ringLen[ch->head];
+        idx = ch->ringBuf[ch->head];
+        memcpy(frame, ch->ring[ch->head], len);
+        ch->head = (ch->head + 1U) % TWIN_SPI_ARMED;
+        ch->count--;
+    }
+    pthread_mutex_unlock(&ch->lock);
+
+    if (idx >= 0)
+    {
+        spi_bridge_miso_release(&s_miso, idx);
+    }
+    return len;
+}
+
+/*
+ * spi_bridge_ready_task(): arm when a payload the master hasn't clocked landed or the master
+ * has been quiet for the keep-alive, re-pulse data-ready if an armed transaction stays
+ * unclocked as long.
+ */
+static void SpiSlaveReady(twin_spi_t *ch)
+{
+    uint64_t now = Sim_MonotonicUs();
+    bool armed;
+
+    pthread_mutex_lock(&ch->lock);
+    armed = (ch->armCount != 0U);
+    pthread_mutex_unlock(&ch->lock);
+
+    if (!armed && (s_miso.seq != s_misoClockedSeq || now - s_readyUs >= TWIN_READY_KEEPALIVE_US))
+    {
+        s_misoArmedSeq = SpiSlaveArm(ch);
+        s_readyUs = now;
+        __atomic_fetch_add(&ch->readySeq, 1U, __ATOMIC_RELEASE);
+    }
+    else if (armed && now - s_readyUs >= TWIN_READY_KEEPALIVE_US)
+    {
+        s_readyUs = now;
+        __atomic_fetch_add(&ch->readySeq, 1U, __ATOMIC_RELEASE);
+        ch->readyRetries++;
+    }
+}
+
+/*******************************************************************************
+ * Remote node
+ ******************************************************************************/
+static uint16_t RemoteAdcInput(uint32_t channel, bool sideB)
+{
+    int64_t k = StepIndex(Sim_MonotonicUs());
+
+    /* Right stick forward (vy); vx and the left stick stay centered */
+    if (k > 0 && StepIsGo(k) && channel == TWIN_JOY_CHANNEL && sideB)
+    {
+        return TWIN_ADC_FULL;
+    }
+    return TWIN_ADC_CENTER;
+}
+
+/* -o: a frame the first time its header goes by */
+static FILE *s_frameLog;
+
+static void RemoteLogFrames(const uint8_t *tx, const uint8_t *rx, uint32_t len, uint32_t id)
+{
+    static uint32_t lastCmd;
+    static uint32_t lastTel[TWIN_MAX_ROBOTS];
+    const RemoteCommand_t *cmd = omni_wire_command(tx, len);
+    const RobotTelemetry_t *tel = omni_wire_telemetry(rx, len);
+
+    /* With the fleet tag behind, as on the wire */
+    if (cmd != NULL && cmd->header != lastCmd)
+    {
+        lastCmd = cmd->header;
+        fwrite(tx, sizeof(*cmd) + ((omni_wire_fleet_id(tx, len) != OMNI_WIRE_ROBOT_NONE) ? sizeof(FleetTag_t) : 0U), 1,
+               s_frameLog);
+    }
+    if (tel != NULL && id < TWIN_MAX_ROBOTS && tel->packet_header != lastTel[id])
+    {
+        lastTel[id] = tel->packet_header;
+        fwrite(rx, sizeof(*tel) + (s_shm->opt.robots ? sizeof(FleetTag_t) : 0U), 1, s_frameLog);
+    }
+}
+
+static void RemoteSpiXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    static uint32_t lastHeader[TWIN_MAX_ROBOTS];
+    const RobotTelemetry_t *tel;
+    uint64_t now;
+    int64_t k;
+    float lo;
+    float hi;
+    float target;
+    uint32_t id;
+
+    SpiMasterXfer(&s_shm->spi[TWIN_CMD_LINK], tx, rx, len, TWIN_SPI_WAIT_US);
+
+    /* Fleet telemetry comes with the robot's tag, the point-to-point link has robot 0 only */
+    tel = omni_wire_telemetry(rx, len);
+    id = s_shm->opt.robots ? omni_wire_fleet_id(rx, len) : 0U;
+    if (s_frameLog != NULL)
+    {
+        RemoteLogFrames(tx, rx, len, id);
+    }
+    if (tel == NULL || id >= TWIN_MAX_ROBOTS)
+    {
+        return;
+    }
+    if (tel->packet_header != lastHeader[id])
+    {
+        lastHeader[id] = tel->packet_header;
+        s_shm->remoteTelemetry[id]++;
+    }
+
+    target = s_shm->wheelTarget[id];
+    if (target <= 0.0f)
+    {
+        return;
+    }
+
+    now = Sim_MonotonicUs();
+    k = StepIndex(now);
+    if (k <= 0)
+    {
+        return;
+    }
+
+    lo = fminf(fminf(tel->speed_m1, tel->speed_m2), fminf(tel->speed_m3, tel->speed_m4));
+    hi = fmaxf(fmaxf(tel->speed_m1, tel->speed_m2), fmaxf(tel->speed_m3, tel->speed_m4));
+    if (StepIsGo(k) ? (lo >= 0.9f * target) : (hi <= 0.1f * target))
+    {
+        StampOnce(&s_shm->step[k].remoteUs[id], now);
+    }
+}
+
+/* Debug console input: stdin, never waits */
+static int RemoteConsoleGetchar(void)
+{
+    static bool eof;
+    struct timeval now = {0, 0};
+    fd_set fds;
+    unsigned char c;
+
+    FD_ZERO(&fds);
+    FD_SET(STDIN_FILENO, &fds);
+    if (eof || select(STDIN_FILENO + 1, &fds, NULL, NULL, &now) <= 0)
+    {
+        return -1;
+    }
+    if (read(STDIN_FILENO, &c, 1) != 1)
+    {
+        eof = true;
+        return -1;
+    }
+    return c;
+}
+
+static bool RemoteIdle(uint32_t us)
+{
+    if (s_shm->stop)
+    {
+        return false;
+    }
+    usleep(us);
+    return true;
+}
+
+static void RemoteNode(void)
+{
+    g_simHooks.now_us = Sim_MonotonicUs;
+    g_simHooks.spi_xfer = RemoteSpiXfer;
+    g_simHooks.adc_input = RemoteAdcInput;
+    g_simHooks.console_getchar = RemoteConsoleGetchar;
+    g_simHooks.idle = RemoteIdle;
+
+    if (s_shm->opt.frameLog != NULL)
+    {
+        s_frameLog = fopen(s_shm->opt.frameLog, "wb");
+        if (s_frameLog == NULL)
+        {
+            perror(s_shm->opt.frameLog);
+        }
+    }
+    RemoteFw_Main();
+    if (s_frameLog != NULL)
+    {
+        fclose(s_frameLog);
+    }
+}
+
+/*******************************************************************************
+ * Robot node
+ ******************************************************************************/
+static uint64_t RobotNowUs(void)
+{
+    return s_robotBootUs + RobotBoard_NowUs();
+}
+
+static void RobotSpiXfer(const uint8_t *tx, uint8_t *rx, uint32_t len)
+{
+    SpiMasterXfer(&s_shm->spi[TWIN_TELEMETRY_LINK + s_robot], tx, rx, len, TWIN_SPI_WAIT_US);
+}
+
+static void RobotTick(uint32_t lptmr)
+{
+    uint64_t now = RobotNowUs();
+    int64_t k = StepIndex(now);
+    float lo = INFINITY;
+    float hi = 0.0f;
+    float target = 0.0f;
+
+    /* Checked on the PID ticks too: with the data-ready line LPTMR0 is off */
+    if (k > 0 && (StepIsGo(k) ? (ROBOT.vy > 0.0f) : (ROBOT.vy == 0.0f)))
+    {
+        StampOnce(&s_shm->step[k].cmdUs[s_robot], now);
+    }
+    if (lptmr == 0U)
+    {
+        __atomic_fetch_add(&s_shm->telemetryTicks, 1U, __ATOMIC_RELAXED);
+        return;
+    }
+
+    __atomic_fetch_add(&s_shm->pidTicks, 1U, __ATOMIC_RELAXED);
+    if (k <= 0)
+    {
+        return;
+    }
+
+    for (uint32_t i = 0; i < ROBOT_BOARD_WHEELS; i++)
+    {
+        float w = fabsf(RobotBoard_GetWheel(i)->omega);
+        float t = fabsf(s_motor[i]->target);
+
+        lo = fminf(lo, (t > 0.0f) ? w / t : 0.0f);
+        hi = fmaxf(hi, w);
+        target = fmaxf(target, t);
+    }
+
+    if (StepIsGo(k))
+    {
+        if (target > 0.0f)
+        {
+            s_shm->wheelTarget[s_robot] = target;
+            if (lo >= 0.9f)
+            {
+                StampOnce(&s_shm->step[k].wheelUs[s_robot], now);
+            }
+        }
+    }
+    else if (s_shm->wheelTarget[s_robot] > 0.0f && hi <= 0.1f * s_shm->wheelTarget[s_robot])
+    {
+        StampOnce(&s_shm->step[k].wheelUs[s_robot], now);
+    }
+}
+
+/* The robot main loop idles in MPU9250_ReadSensor(): catch the board up with the host clock */
+static bool RobotIdle(uint32_t us)
+{
+    uint64_t now = Sim_MonotonicUs();
+    uint64_t lag = now - RobotNowUs();
+
+    (void)us;
+    if (s_shm->stop)
+    {
+        return false;
+    }
+
+    if (lag > s_shm->robotLagMaxUs)
+    {
+        s_shm->robotLagMaxUs = lag;
+    }
+    RobotBoard_RunUntil(now - s_robotBootUs);
+
+#if ROBOT_SPI_DATA_READY
+    /* Data-ready pulses since the last slice: one rising edge, as the pin would show */
+    uint32_t seq = __atomic_load_n(&s_shm->spi[TWIN_TELEMETRY_LINK + s_robot].readySeq, __ATOMIC_ACQUIRE);
+    if (seq != s_robotReadySeq)
+    {
+        s_robotReadySeq = seq;
+        __atomic_fetch_add(&s_shm->telemetryTicks, 1U, __ATOMIC_RELAXED);
+        RobotBoard_SetInput(1U, ROBOT_SPI_READY_PIN, false);
+        RobotBoard_SetInput(1U, ROBOT_SPI_READY_PIN, true);
+    }
+#endif
+    usleep(TWIN_ROBOT_SLICE_US);
+    return true;
+}
+
+static void RobotNode(void)
+{
+    s_robotBootUs = Sim_MonotonicUs();
+    RobotBoard_Init(&s_shm->opt.motor);
+    for (uint32_t i = 0; i < ROBOT_BOARD_WHEELS; i++)
+    {
+        RobotBoard_AttachWheel(i, s_motor[i]);
+    }
+    RobotBoard_SetTickHook(RobotTick);
+
+    g_simHooks.now_us = RobotNowUs;
+    g_simHooks.spi_xfer = RobotSpiXfer;
+    g_simHooks.idle = RobotIdle;
+
+    RobotFw_Main();
+}
+
+/*******************************************************************************
+ * Bridge nodes
+ ******************************************************************************/
+static uint32_t AirNowUs(void)
+{
+    return (uint32_t)Sim_MonotonicUs();
+}
+
+/* Bridges the frame reaches: the TX bridge talks to the RX bridge (or broadcasts to all
+ * of them in a fleet), every RX bridge to the TX bridge */
+static uint32_t AirReceivers(void)
+{
+    if (s_bridge != TWIN_CMD_LINK)
+    {
+        return 1UL << TWIN_CMD_LINK;
+    }
+    if (s_shm->opt.robots == 0U)
+    {
+        return 1UL << TWIN_TELEMETRY_LINK;
+    }
+    return ((1UL << s_shm->opt.robots) - 1U) << TWIN_TELEMETRY_LINK;
+}
+
+static void AirTransmit(const uint8_t *frame, uint32_t len, uint32_t to)
+{
+    for (uint32_t b = 0; b < TWIN_BRIDGES; b++)
+    {
+        if (to & (1UL << b))
+        {
+            (void)sendto(s_sock[s_bridge], frame, len, 0, (const struct sockaddr *)&s_addr[b], sizeof(s_addr[b]));
+        }
+    }
+}
+
+/* Shared channel: the frame goes on air once the channel is free, returns when it is
+ * received, 0 if the sender's buffers are full */
+static uint64_t AirChannel(twin_air_t *air, uint64_t now, size_t len)
+{
+    uint64_t airtime = FLEET_AIRTIME_US(len - AIR_LINK_FRAME_SIZE(0));
+    uint64_t start;
+
+    pthread_mutex_lock(&s_shm->channelLock);
+    start = (s_shm->channelFreeUs > now) ? s_shm->channelFreeUs : now;
+    if (start - now > TWIN_AIR_BACKLOG_US)
+    {
+        pthread_mutex_unlock(&s_shm->channelLock);
+        return 0U;
+    }
+    s_shm->channelFreeUs = start + airtime;
+    s_shm->channelBusyUs += airtime;
+    pthread_mutex_unlock(&s_shm->channelLock);
+
+    if (start > now)
+    {
+        air->channelWaits++;
+        air->channelWaitUs += start - now;
+    }
+    return start + airtime;
+}
+
+/* ESP-NOW stand-in: rate cap (send error), loss per receiver (silent), delay + jitter (may
+ * reorder) and, with the shared channel, air time and waiting for the channel */
+static int AirSend(const uint8_t *frame, size_t len, void *ctx)
+{
+    const twin_options_t *opt = &s_shm->opt;
+    twin_air_t *air = &s_shm->air[s_bridge];
+    uint64_t now = Sim_MonotonicUs();
+    uint32_t to = AirReceivers();
+
+    air->bytes += len;
+
+    (void)ctx;
+    if (opt->airFps != 0U)
+    {
+        uint64_t cost = 1000000U / opt->airFps;
+
+        if (s_airTokensUs < now - 1000000U)
+        {
+            s_airTokensUs = now - 1000000U;
+        }
+        if (s_airTokensUs + cost > now)
+        {
+            air->rateDrops++;
+            return -1;
+        }
+        s_airTokensUs += cost;
+    }
+
+    if (opt->lossPct > 0.0)
+    {
+        for (uint32_t b = 0; b < TWIN_BRIDGES; b++)
+        {
+            if ((to & (1UL << b)) && (rand_r(&s_rand) / (RAND_MAX + 1.0)) * 100.0 < opt->lossPct)
+            {
+                to &= ~(1UL << b);
+                air->injectedLoss++;
+            }
+        }
+    }
+
+    if (!opt->channel && opt->delayUs == 0U && opt->jitterUs == 0U)
+    {
+        AirTransmit(frame, (uint32_t)len, to);
+        return 0;
+    }
+
+    if (s_airQueued == TWIN_AIR_QUEUE)
+    {
+        air->rateDrops++;
+        return -1;
+    }
+
+    /* Lost frames take their air time all the same */
+    uint64_t onAirUs = opt->channel ? AirChannel(air, now, len) : now;
+    if (onAirUs == 0U)
+    {
+        air->rateDrops++;
+        return -1;
+    }
+    if (to == 0U)
+    {
+        return 0;
+    }
+    twin_air_frame_t *q = &s_airQueue[s_airQueued++];
+    q->dueUs = onAirUs + opt->delayUs + (opt->jitterUs ? (uint32_t)rand_r(&s_rand) % (opt->jitterUs + 1U) : 0U);
+    q->order = s_airOrder++;
+    q->to = to;
+    q->len = (uint32_t)len;
+    memcpy(q->frame, frame, len);
+    return 0;
+}
+
+/* Sends what is due in due order, returns the us to the next due frame (or -1) */
+static int64_t AirFlush(void)
+{
+    uint64_t now = Sim_MonotonicUs();
+
+    while (s_airQueued != 0U)
+    {
+        uint32_t first = 0;
+
+        for (uint32_t i = 1; i < s_airQueued; i++)
+        {
+            if (s_airQueue[i].dueUs < s_airQueue[first].dueUs ||
+                (s_airQueue[i].dueUs == s_airQueue[first].dueUs &&
+                 (int32_t)(s_airQueue[i].order - s_airQueue[first].order) < 0))
+            {
+                first = i;
+            }
+        }
+        if (s_airQueue[first].dueUs > now)
+        {
+            return (int64_t)(s_airQueue[first].dueUs - now);
+        }
+        AirTransmit(s_airQueue[first].frame, s_airQueue[first].len, s_airQueue[first].to);
+        s_airQueue[first] = s_airQueue[--s_airQueued];
+    }
+    return -1;
+}
+
+/* spi_bridge_set_miso() */
+static void BridgeSetMiso(const void *data, size_t len, void *ctx)
+{
+    (void)ctx;
+    (void)spi_bridge_miso_set(&s_miso, data, len);
+}
+
+/* RX main.c start_slot(): our slot counted from the beacon's arrival */
+static void BridgeStartSlot(uint32_t inUs, void *ctx)
+{
+    (void)ctx;
+    s_fleetDueUs = Sim_MonotonicUs() + inUs;
+}
+
+/* air_deliver() of the bridges */
+static void AirDeliver(const uint8_t *payload, size_t len, void *ctx)
+{
+    (void)ctx;
+    bridge_frames_air(&s_frames, payload, len);
+}
+
+/* TX main.c fleet_deliver() */
+static void FleetTelemetryDeliver(const uint8_t *payload, size_t len, void *ctx)
+{
+    (void)ctx;
+    bridge_frames_fleet_air(&s_frames, payload, len);
+}
+
+/* Fleet timers (TX beacon_cb(), RX slot_cb()), returns the us to the next one (or -1) */
+static int64_t FleetTimer(void)
+{
+    uint64_t now = Sim_MonotonicUs();
+
+    if (s_fleetDueUs == 0U)
+    {
+        return -1;
+    }
+    if (s_fleetDueUs > now)
+    {
+        return (int64_t)(s_fleetDueUs - now);
+    }
+
+    if (s_bridge == TWIN_CMD_LINK)
+    {
+        /* Periodic: a late beacon does not shift the ones after it */
+        uint32_t superframeUs = bridge_frames_superframe_us(&s_frames);
+
+        s_fleetDueUs += superframeUs;
+        if (s_fleetDueUs <= now)
+        {
+            s_fleetDueUs = now + superframeUs;
+        }
+        (void)bridge_frames_timer(&s_frames);
+        return (int64_t)(s_fleetDueUs - now);
+    }
+
+    s_fleetDueUs = 0U;
+    (void)bridge_frames_timer(&s_frames);
+    return -1;
+}
+
+/* recv_cb() of the bridges; the loopback address and port stand in for the sender's MAC */
+static void BridgeAirFrame(const uint8_t *frame, size_t len, const struct sockaddr_in *from)
+{
+    uint8_t addr[FLEET_ADDR_LEN];
+    air_link_t *link;
+
+    memcpy(addr, &from->sin_addr, 4U);
+    memcpy(addr + 4, &from->sin_port, 2U);
+    link = bridge_frames_receiver(&s_frames, addr);
+    if (link != NULL)
+    {
+        air_link_receive(link, frame, len);
+    }
+}
+
+/* Receiver stats into the shared memory: summed over the fleet receivers, worst latency */
+static void BridgeStats(uint32_t b)
+{
+    twin_air_t *air = &s_shm->air[b];
+
+    if (s_shm->opt.robots == 0U || b != TWIN_CMD_LINK)
+    {
+        air_link_get_stats(&s_air, &air->stats);
+        air_link_get_latency(&s_air, &air->latency);
+    }
+    else
+    {
+        /* The beacons' sender and the robots' receivers */
+        air_link_get_stats(&s_air, &air->stats);
+        for (uint32_t i = 0; i < s_frames.fleet_remote.senders; i++)
+        {
+            air_link_stats_t s;
+            air_link_latency_t l;
+            uint32_t *sum = (uint32_t *)&air->stats;
+            const uint32_t *add = (const uint32_t *)&s;
+
+            air_link_get_stats(&s_airRx[i], &s);
+            for (size_t f = 0; f < sizeof(s) / sizeof(uint32_t); f++)
+            {
+                sum[f] += add[f];
+            }
+            air_link_get_latency(&s_airRx[i], &l);
+            if (l.p99_us >= air->latency.p99_us)
+            {
+                air->latency = l;
+            }
+        }
+        s_shm->fleetRemote = s_frames.fleet_remote.stats;
+    }
+    if (s_shm->opt.robots != 0U && b != TWIN_CMD_LINK)
+    {
+        s_shm->fleetRobot[b - TWIN_TELEMETRY_LINK] = s_frames.fleet_robot.stats;
+    }
+}
+
+/* Bridge b: 0 = TX (the remote's), 1 + r = RX bridge of robot r */
+static void BridgeNode(uint32_t b)
+{
+    twin_spi_t *spi = &s_shm->spi[b];
+    bool fleet = (s_shm->opt.robots != 0U);
+    uint32_t link = (b == TWIN_CMD_LINK) ? TWIN_CMD_LINK : TWIN_TELEMETRY_LINK;
+    air_link_config_t cfg = {
+        .repeat = fleet ? 1U : s_shm->opt.repeat[link],
+        .parity_group = fleet ? 0U : s_shm->opt.parityGroup,
+        .send = AirSend,
+        .now_us = AirNowUs,
+        .deliver = AirDeliver,
+    };
+    bridge_frames_config_t frames = {
+        .role = (b == TWIN_CMD_LINK) ? BRIDGE_REMOTE : BRIDGE_ROBOT,
+        .fleet_robots = (b == TWIN_CMD_LINK) ? (uint8_t)s_shm->opt.robots : 0U,
+        .fleet_id = (fleet && b != TWIN_CMD_LINK) ? (int)(b - TWIN_TELEMETRY_LINK) : -1,
+        .air = &s_air,
+        .fleet_air = s_airRx,
+        .set_miso = BridgeSetMiso,
+        .start_slot = BridgeStartSlot,
+    };
+    uint8_t frame[AIR_LINK_FRAME_SIZE(AIR_LINK_MAX_PAYLOAD)];
+    uint32_t clocked;
+    int maxFd = (spi->eventFd > s_sock[b]) ? spi->eventFd : s_sock[b];
+
+    s_bridge = b;
+    s_rand = s_shm->opt.seed + b;
+    air_link_init(&s_air, &cfg);
+    if (fleet && b == TWIN_CMD_LINK)
+    {
+        /* As TX main.c: one receiver per robot bridge, beacons from now on */
+        cfg.deliver = FleetTelemetryDeliver;
+        for (uint32_t i = 0; i < TWIN_MAX_ROBOTS; i++)
+        {
+            air_link_init(&s_airRx[i], &cfg);
+        }
+        s_fleetDueUs = Sim_MonotonicUs();
+    }
+    bridge_frames_init(&s_frames, &frames);
+
+    /* spi_bridge_start() with trans_armed of TX / RX main.c: the bridge process is one
+     * context, the pool needs no lock */
+    spi_bridge_miso_init(&s_miso, NULL, NULL);
+    for (uint32_t i = 0; i < ((fleet && b == TWIN_CMD_LINK) ? s_shm->opt.robots : 1U) && !spi->readyMode; i++)
+    {
+        (void)SpiSlaveArm(spi);
+    }
+
+    while (!s_shm->stop)
+    {
+        int64_t waitUs = AirFlush();
+        int64_t timerUs = FleetTimer();
+        struct timeval timeout;
+        fd_set fds;
+
+        if (waitUs < 0 || (timerUs >= 0 && timerUs < waitUs))
+        {
+            waitUs = timerUs;
+        }
+        if (waitUs < 0 || waitUs > TWIN_BRIDGE_POLL_US)
+        {
+            waitUs = TWIN_BRIDGE_POLL_US;
+        }
+        /* select(): the fleet timers need microseconds, poll() only has milliseconds */
+        timeout.tv_sec = 0;
+        timeout.tv_usec = (suseconds_t)waitUs;
+        FD_ZERO(&fds);
+        FD_SET(spi->eventFd, &fds);
+        FD_SET(s_sock[b], &fds);
+        if (select(maxFd + 1, &fds, NULL, NULL, &timeout) < 0)
+        {
+            if (errno != EINTR)
+            {
+                break;
+            }
+            FD_ZERO(&fds);
+        }
+
+        if (FD_ISSET(spi->eventFd, &fds))
+        {
+            uint64_t n;
+            (void)read(spi->eventFd, &n, sizeof(n));
+            /* spi_bridge_task(): the frame, then the transaction is armed again */
+            while ((clocked = SpiSlavePop(spi, frame)) != 0U)
+            {
+                (void)bridge_frames_spi(&s_frames, frame, clocked);
+                if (spi->readyMode)
+                {
+                    s_misoClockedSeq = s_misoArmedSeq;
+                    s_readyUs = Sim_MonotonicUs();
+                }
+                else
+                {
+                    (void)SpiSlaveArm(spi);
+                }
+            }
+        }
+
+        for (;;)
+        {
+            struct sockaddr_in from;
+            socklen_t fromLen = sizeof(from);
+            ssize_t n = recvfrom(s_sock[b], frame, sizeof(frame), MSG_DONTWAIT, (struct sockaddr *)&from, &fromLen);
+            if (n <= 0)
+            {
+                break;
+            }
+            BridgeAirFrame(frame, (size_t)n, &from);
+        }
+
+        if (spi->readyMode)
+        {
+            SpiSlaveReady(spi);
+        }
+    }
+
+    BridgeStats(b);
+}
+
+/*******************************************************************************
+ * Report
+ ******************************************************************************/
+static int CompareU64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/* Step latencies of one stamp, pooled over the robots */
+static void PrintLatency(const char *name, bool go, size_t field, int64_t steps)
+{
+    static uint64_t v[TWIN_MAX_STEPS * TWIN_MAX_ROBOTS];
+    uint32_t robots = s_shm->opt.robots ? s_shm->opt.robots : 1U;
+    uint32_t n = 0;
+    uint32_t total = 0;
+    uint64_t halfUs = (uint64_t)s_shm->opt.halfPeriodMs * 1000U;
+
+    for (int64_t k = 1; k < steps; k++)
+    {
+        if (StepIsGo(k) != go)
+        {
+            continue;
+        }
+        for (uint32_t r = 0; r < robots; r++)
+        {
+            total++;
+            uint64_t t = *(const uint64_t *)((const uint8_t *)&s_shm->step[k] + field + r * sizeof(uint64_t));
+            if (t != 0U)
+            {
+                v[n++] = t - (s_shm->startUs + (uint64_t)k * halfUs);
+            }
+        }
+    }
+
+    if (n == 0U)
+    {
+        printf("  %-26s       -        -        -   %u/%u missed\n", name, total, total);
+        return;
+    }
+    qsort(v, n, sizeof(v[0]), CompareU64);
+    printf("  %-26s %7.1f  %7.1f  %7.1f   %u/%u missed\n", name,
+           v[0] / 1000.0, v[n / 2] / 1000.0, v[n - 1] / 1000.0, total - n, total);
+}
+
+/* SPI counters of bridges first .. first + count - 1, added up */
+static void SpiSum(uint32_t first, uint32_t count, twin_spi_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (uint32_t b = first; b < first + count; b++)
+    {
+        out->frames += s_shm->spi[b].frames;
+        out->bytes += s_shm->spi[b].bytes;
+        out->overruns += s_shm->spi[b].overruns;
+        out->readyRetries += s_shm->spi[b].readyRetries;
+        out->readyMode = s_shm->spi[b].readyMode;
+    }
+}
+
+/* Air counters of the same bridges, added up, and the worst receiver latency */
+static void AirSum(uint32_t first, uint32_t count, twin_air_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    for (uint32_t b = first; b < first + count; b++)
+    {
+        const twin_air_t *air = &s_shm->air[b];
+        const uint32_t *add = (const uint32_t *)&air->stats;
+        uint32_t *sum = (uint32_t *)&out->stats;
+
+        for (size_t f = 0; f < sizeof(air->stats) / sizeof(uint32_t); f++)
+        {
+            sum[f] += add[f];
+        }
+        if (air->latency.p99_us >= out->latency.p99_us)
+        {
+            out->latency = air->latency;
+        }
+        out->injectedLoss += air->injectedLoss;
+        out->rateDrops += air->rateDrops;
+        out->bytes += air->bytes;
+        out->channelWaits += air->channelWaits;
+        out->channelWaitUs += air->channelWaitUs;
+    }
+}
+
+static void PrintSpi(const char *name, const twin_spi_t *spi, double seconds)
+{
+    printf("  %-26s %9.1f %9.1f   overruns %llu", name, spi->frames / seconds,
+           spi->bytes / seconds / 1000.0, (unsigned long long)spi->overruns);
+    if (spi->readyMode)
+    {
+        printf(", data-ready re-pulses %llu", (unsigned long long)spi->readyRetries);
+    }
+    printf("\n");
+}
+
+static void PrintAir(const char *name, const twin_air_t *tx, const twin_air_t *rx, double seconds)
+{
+    const air_link_stats_t *s = &rx->stats;
+    uint32_t copies = tx->stats.tx_copies + tx->stats.tx_parity;
+
+    printf("  %-26s %9.1f %9.1f   delivered %.1f/s lost %u dup %u stale %u recovered %u\n", name,
+           copies / seconds, tx->bytes / seconds / 1000.0,
+           s->rx_delivered / seconds, s->rx_lost, s->rx_duplicates, s->rx_stale, s->rx_recovered);
+    printf("  %-26s %9s %9s   injected loss %llu, rate/queue drops %llu, latency p50 %u p99 %u max %u us\n",
+           "", "", "", (unsigned long long)tx->injectedLoss, (unsigned long long)tx->rateDrops,
+           rx->latency.p50_us, rx->latency.p99_us, rx->latency.max_us);
+    if (s_shm->opt.channel)
+    {
+        printf("  %-26s %9s %9s   found the channel busy %llu times, waited %.1f us on average\n", "", "", "",
+               (unsigned long long)tx->channelWaits,
+               tx->channelWaits ? (double)tx->channelWaitUs / (double)tx->channelWaits : 0.0);
+    }
+}
+
+/* Telemetry frames per s and robot: min / average / max over the fleet */
+static void PrintRate(const char *name, const uint64_t *frames, size_t stride, double seconds)
+{
+    uint32_t robots = s_shm->opt.robots;
+    double lo = 1e30;
+    double hi = 0.0;
+    double sum = 0.0;
+
+    for (uint32_t r = 0; r < robots; r++)
+    {
+        double rate = *(const uint64_t *)((const uint8_t *)frames + r * stride) / seconds;
+        lo = (rate < lo) ? rate : lo;
+        hi = (rate > hi) ? rate : hi;
+        sum += rate;
+    }
+    printf("  %-26s %7.1f  %7.1f  %7.1f\n", name, lo, sum / robots, hi);
+}
+
+static void PrintFleet(double seconds)
+{
+    const fleet_remote_stats_t *fr = &s_shm->fleetRemote;
+    uint64_t bridgeIn[TWIN_MAX_ROBOTS];
+    uint64_t lost = 0;
+    uint64_t commands = 0;
+    uint64_t slots = 0;
+    uint64_t empty = 0;
+    uint64_t beacons = 0;
+
+    for (uint32_t r = 0; r < s_shm->opt.robots; r++)
+    {
+        const fleet_robot_stats_t *rs = &s_shm->fleetRobot[r];
+
+        bridgeIn[r] = fr->tel_in[r];
+        beacons += rs->beacons;
+        lost += rs->beacons_lost;
+        commands += rs->commands;
+        slots += rs->slots;
+        empty += rs->slots_empty;
+    }
+
+    printf("\nTelemetry per robot (1/s)       min      avg      max\n");
+    PrintRate("at the TX bridge", bridgeIn, sizeof(bridgeIn[0]), seconds);
+    PrintRate("at the remote MCU", s_shm->remoteTelemetry, sizeof(s_shm->remoteTelemetry[0]), seconds);
+
+    printf("\nFleet: %u robots, superframe %u us, channel busy %.1f %%\n", s_shm->opt.robots, s_shm->superframeUs,
+           100.0 * s_shm->channelBusyUs / (seconds * 1e6 + TWIN_BOOT_US));
+    printf("  TX bridge: %u beacons, %u commands (%u bad), telemetry replaced before the MCU took it %u\n",
+           fr->beacons, fr->cmd_in, fr->cmd_bad, fr->tel_replaced);
+    printf("  RX bridges: %llu beacons (%llu lost), %llu with a command, %llu slots sent, %llu empty\n",
+           (unsigned long long)beacons, (unsigned long long)lost, (unsigned long long)commands,
+           (unsigned long long)slots, (unsigned long long)empty);
+}
+
+static void Report(double seconds)
+{
+    const twin_options_t *o = &s_shm->opt;
+    int64_t steps = StepIndex(s_shm->startUs + (uint64_t)(seconds * 1e6));
+    uint32_t robots = o->robots ? o->robots : 1U;
+    twin_spi_t spi;
+    twin_air_t tx;
+    twin_air_t rx;
+
+    if (steps < 0)
+    {
+        steps = TWIN_MAX_STEPS;
+    }
+
+    printf("OmniRover twin: %.1f s, air loss %.1f %%, delay %u us + %u jitter, rate cap %u/s (0 = none), ",
+           seconds, o->lossPct, o->delayUs, o->jitterUs, o->airFps);
+    if (o->robots != 0U)
+    {
+        printf("fleet of %u\n", o->robots);
+    }
+    else
+    {
+        printf("repeat cmd %u / telemetry %u, parity %u%s\n", o->repeat[TWIN_CMD_LINK],
+               o->repeat[TWIN_TELEMETRY_LINK], o->parityGroup, o->channel ? ", shared channel" : "");
+    }
+
+    printf("\nJoystick step -> (ms)           min      p50      max\n");
+    PrintLatency("go:   robot command", true, offsetof(twin_step_t, cmdUs), steps);
+    PrintLatency("go:   wheels at 90 %", true, offsetof(twin_step_t, wheelUs), steps);
+    PrintLatency("go:   remote telemetry 90 %", true, offsetof(twin_step_t, remoteUs), steps);
+    PrintLatency("stop: robot command", false, offsetof(twin_step_t, cmdUs), steps);
+    PrintLatency("stop: wheels below 10 %", false, offsetof(twin_step_t, wheelUs), steps);
+    PrintLatency("stop: remote telemetry 10 %", false, offsetof(twin_step_t, remoteUs), steps);
+
+    printf("\nLinks                          frames/s      kB/s\n");
+    PrintSpi("SPI remote -> TX bridge", &s_shm->spi[TWIN_CMD_LINK], seconds);
+    SpiSum(TWIN_TELEMETRY_LINK, robots, &spi);
+    PrintSpi(o->robots ? "SPI robots -> RX bridges" : "SPI robot -> RX bridge", &spi, seconds);
+    AirSum(TWIN_TELEMETRY_LINK, robots, &rx);
+    PrintAir(o->robots ? "air beacons (TX -> RXs)" : "air commands (TX -> RX)", &s_shm->air[TWIN_CMD_LINK], &rx,
+             seconds);
+    AirSum(TWIN_TELEMETRY_LINK, robots, &tx);
+    PrintAir(o->robots ? "air telemetry (RXs -> TX)" : "air telemetry (RX -> TX)", &tx, &s_shm->air[TWIN_CMD_LINK],
+             seconds);
+
+    if (o->robots != 0U)
+    {
+        PrintFleet(seconds);
+    }
+    else if (o->channel)
+    {
+        printf("\nShared channel busy %.1f %%\n", 100.0 * s_shm->channelBusyUs / (seconds * 1e6 + TWIN_BOOT_US));
+    }
+
+    printf("\nRobot: %.0f PID / %.0f telemetry interrupts per s%s, max lag behind host clock %llu us\n",
+           s_shm->pidTicks / seconds / robots, s_shm->telemetryTicks / seconds / robots,
+           o->robots ? " and robot" : "", (unsigned long long)s_shm->robotLagMaxUs);
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+static void Usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -t SEC     run time (20)\n"
+            "  -p MS      joystick half period (1000)\n"
+            "  -l PCT     air frame loss (0)\n"
+            "  -d US      air delay (1000)\n"
+            "  -j US      air delay jitter (0)\n"
+            "  -f FPS     air frame rate cap per direction, 0 = none (0)\n"
+            "  -c N       command repeat (2)\n"
+            "  -r N       telemetry repeat (1)\n"
+            "  -g N       parity group, 0 = off (0)\n"
+            "  -w RAD_S   motor no-load speed (15)\n"
+            "  -T SEC     motor time constant (0.05)\n"
+            "  -s SEED    loss/jitter seed (1)\n"
+            "  -n N       fleet of N robots, 1..%u (REMOTE_FLEET build only)\n"
+            "  -a         shared channel with air time (always on for a fleet)\n"
+            "  -o FILE    frames on the remote's SPI, raw (HOST_SIM/tools/telemetry_log.c)\n"
+            "  -v         keep the nodes' console output\n",
+            argv0, TWIN_MAX_ROBOTS);
+}
+
+static int BindLoopback(struct sockaddr_in *addr)
+{
+    socklen_t len = sizeof(*addr);
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+    memset(addr, 0, sizeof(*addr));
+    addr->sin_family = AF_INET;
+    addr->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || bind(fd, (struct sockaddr *)addr, sizeof(*addr)) != 0 ||
+        getsockname(fd, (struct sockaddr *)addr, &len) != 0)
+    {
+        perror("udp");
+        exit(1);
+    }
+    return fd;
+}
+
+int main(int argc, char **argv)
+{
+    twin_options_t opt = {
+        .seconds = 20.0,
+        .delayUs = 1000U,
+        .halfPeriodMs = 1000U,
+        .repeat = {2U, 1U},
+        .seed = 1U,
+        .motor = MOTOR_PLANT_DEFAULT_PARAMS,
+    };
+    pid_t pid[TWIN_NODES];
+    uint32_t nodes = 0;
+    uint32_t robots;
+    pthread_mutexattr_t attr;
+    int c;
+
+    while ((c = getopt(argc, argv, "t:p:l:d:j:f:c:r:g:w:T:s:n:o:avh")) != -1)
+    {
+        switch (c)
+        {
+            case 't': opt.seconds = atof(optarg); break;
+            case 'p': opt.halfPeriodMs = (uint32_t)atoi(optarg); break;
+            case 'l': opt.lossPct = atof(optarg); break;
+            case 'd': opt.delayUs = (uint32_t)atoi(optarg); break;
+            case 'j': opt.jitterUs = (uint32_t)atoi(optarg); break;
+            case 'f': opt.airFps = (uint32_t)atoi(optarg); break;
+            case 'c': opt.repeat[TWIN_CMD_LINK] = (uint8_t)atoi(optarg); break;
+            case 'r': opt.repeat[TWIN_TELEMETRY_LINK] = (uint8_t)atoi(optarg); break;
+            case 'g': opt.parityGroup = (uint8_t)atoi(optarg); break;
+            case 'w': opt.motor.noLoadSpeed = (float)atof(optarg); break;
+            case 'T': opt.motor.tau = (float)atof(optarg); break;
+            case 's': opt.seed = (unsigned)atoi(optarg); break;
+            case 'n': opt.robots = (uint32_t)atoi(optarg); break;
+            case 'o': opt.frameLog = optarg; break;
+            case 'a': opt.channel = true; break;
+            case 'v': opt.verbose = true; break;
+            default: Usage(argv[0]); return 2;
+        }
+    }
+    if (opt.seconds <= 0.0 || opt.halfPeriodMs == 0U || opt.robots > TWIN_MAX_ROBOTS)
+    {
+        Usage(argv[0]);
+        return 2;
+    }
+    /* The remote firmware addresses robots only when built for a fleet */
+    if ((opt.robots != 0U) != (REMOTE_FLEET != 0))
+    {
+        fprintf(stderr, "%s: -n needs a REMOTE_FLEET=1 build, and that build needs -n\n", argv[0]);
+        return 2;
+    }
+    opt.channel = opt.channel || opt.robots != 0U;
+    robots = opt.robots ? opt.robots : 1U;
+
+    s_shm = mmap(NULL, sizeof(twin_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (s_shm == MAP_FAILED)
+    {
+        perror("mmap");
+        return 1;
+    }
+    memset(s_shm, 0, sizeof(*s_shm));
+    s_shm->opt = opt;
+    for (uint32_t b = 0; b < 1U + robots; b++)
+    {
+        SpiInit(&s_shm->spi[b]);
+        s_sock[b] = BindLoopback(&s_addr[b]);
+        s_shm->spi[b].readyMode = (b != TWIN_CMD_LINK) && ROBOT_SPI_DATA_READY;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_mutex_init(&s_shm->channelLock, &attr);
+    pthread_mutexattr_destroy(&attr);
+    if (opt.robots != 0U)
+    {
+        fleet_schedule_t sched = {.slots = (uint8_t)opt.robots, .slot_us = FLEET_SLOT_US, .guard_us = FLEET_GUARD_US};
+        s_shm->superframeUs = fleet_superframe_us(&sched, (uint8_t)(opt.robots + 1U));
+    }
+    s_shm->startUs = Sim_MonotonicUs() + TWIN_BOOT_US;
+
+    /* remote, TX bridge, then RX bridge and robot of every robot */
+    for (uint32_t n = 0; n < 2U + 2U * robots; n++)
+    {
+        uint32_t role = (n < TWIN_RX_BRIDGE) ? n : TWIN_RX_BRIDGE + (n - TWIN_RX_BRIDGE) % 2U;
+
+        pid[n] = fork();
+        if (pid[n] < 0)
+        {
+            perror("fork");
+            return 1;
+        }
+        nodes++;
+        if (pid[n] != 0)
+        {
+            continue;
+        }
+
+        if (!opt.verbose)
+        {
+            int null = open("/dev/null", O_WRONLY);
+            dup2(null, STDOUT_FILENO);
+        }
+        else
+        {
+            /* Whole lines: the nodes share stdout, a file or pipe would cut theirs into each other */
+            setvbuf(stdout, NULL, _IOLBF, 0);
+        }
+        s_robot = (n < TWIN_RX_BRIDGE) ? 0U : (n - TWIN_RX_BRIDGE) / 2U;
+        switch (role)
+        {
+            case TWIN_REMOTE:    RemoteNode(); break;
+            case TWIN_TX_BRIDGE: BridgeNode(TWIN_CMD_LINK); break;
+            case TWIN_RX_BRIDGE: BridgeNode(TWIN_TELEMETRY_LINK + s_robot); break;
+            case TWIN_ROBOT:     RobotNode(); break;
+        }
+        _exit(0);
+    }
+
+    uint64_t endUs = s_shm->startUs + (uint64_t)(opt.seconds * 1e6);
+    while (Sim_MonotonicUs() < endUs)
+    {
+        usleep(10000);
+    }
+    s_shm->stop = 1;
+
+    /* A node the firmware crashed (mcu_sim aborts where the board would fault) fails the run */
+    static const char *const roleName[] = {"remote", "TX bridge", "RX bridge", "robot"};
+    int failed = 0;
+    for (uint32_t n = 0; n < nodes; n++)
+    {
+        uint32_t role = (n < TWIN_RX_BRIDGE) ? n : TWIN_RX_BRIDGE + (n - TWIN_RX_BRIDGE) % 2U;
+        int status;
+
+        waitpid(pid[n], &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "%s (node %u) ended abnormally\n", roleName[role], (unsigned)n);
+            failed = 1;
+        }
+    }
+
+    Report(opt.seconds);
+    return failed;
+}
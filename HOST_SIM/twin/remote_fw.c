@@ -0,0 +1,13 @@
+/*
+ * remote_fw.c
+ *
+ * The remote firmware (lpadc_interrupt.c) built into the twin. The GUI runs
+ * in its core1 configuration so the command path is the one on the board;
+ * LVGL itself is not part of the twin.
+ */
+
+#define REMOTE_GUI_ON_CORE1         1
+#define main                        RemoteFw_Main
+#define LP_FLEXCOMM1_IRQHandler     RemoteFw_LP_FLEXCOMM1_IRQHandler
+
+#include "lpadc_interrupt.c"
@@ -0,0 +1,10 @@
+/*
+ * robot_fw.c
+ *
+ * The robot firmware (MCXN947_Project.c) built into the twin, unchanged.
+ */
+
+#define main                        RobotFw_Main
+#define LP_FLEXCOMM1_IRQHandler     RobotFw_LP_FLEXCOMM1_IRQHandler
+
+#include "MCXN947_Project.c"
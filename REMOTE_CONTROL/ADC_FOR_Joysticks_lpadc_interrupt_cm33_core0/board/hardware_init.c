@@ -36,6 +36,10 @@ void BOARD_InitHardware(void)
     CLOCK_SetClkDiv(kCLOCK_DivAdc0Clk, 1U);
     CLOCK_AttachClk(kFRO_HF_to_ADC0);
 
+    /* attach FRO 12M to CTIMER4 (microsecond clock) */
+    CLOCK_SetClkDiv(kCLOCK_DivCtimer4Clk, 1U);
+    CLOCK_AttachClk(kFRO12M_to_CTIMER4);
+
     //CLOCK_EnableClock(kCLOCK_Flexspi);
     CLOCK_EnableClock(kCLOCK_Port0);
     CLOCK_EnableClock(kCLOCK_Port1);
@@ -27,6 +27,7 @@
 #if  0 && defined(__ASSEMBLY__)
 #include "my_include.h"
 #endif
+#include "omni_place.h"     /*OMNI_PLACE_LVGL_CODE, macros only under __ASSEMBLY__*/
 
 /*====================
    COLOR SETTINGS
@@ -150,6 +151,12 @@
  */
 #define LV_DRAW_THREAD_STACK_SIZE    (8 * 1024)   /*[bytes]*/
 
+/* Size of the arena which stores the draw tasks and their descriptors during a refresh.
+ * It's rewound after every refresh, so they don't fragment the heap.
+ * If a frame needs more, the rest is allocated with `lv_malloc`. 0: always use `lv_malloc`.
+ * Check `lv_draw_arena_get_stats()` to size it. */
+#define LV_DRAW_ARENA_SIZE    (8 * 1024)   /*[bytes]*/
+
 #define LV_USE_DRAW_SW 1
 #if LV_USE_DRAW_SW == 1
 
@@ -386,6 +393,12 @@
  *The main logic is like `LV_CACHE_DEF_SIZE` but for image headers.*/
 #define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
 
+/*Size of the rendered-glyph cache in bytes.
+ *Decoded glyph bitmaps of built-in (`lv_font_fmt_txt`) fonts are kept here keyed by font, code point and bpp
+ *so the glyphs that are redrawn often (digits, signs, units) are not decoded again on every refresh.
+ *The least recently used glyphs are dropped when the budget is exceeded. 0 disables the cache.*/
+#define LV_FONT_GLYPH_CACHE_SIZE (4 * 1024U)
+
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
 #define LV_GRADIENT_MAX_STOPS   2
@@ -469,11 +482,13 @@
 /*Attribute to mark large constant arrays for example font's bitmaps*/
 #define LV_ATTRIBUTE_LARGE_CONST
 
-/*Compiler prefix for a big array declaration in RAM*/
+/*Compiler prefix for a big array declaration in RAM.
+ *The LVGL heap (LV_MEM_SIZE, 64 KB) stays in SRAM: RAMH (32 KB) holds the draw buffer*/
 #define LV_ATTRIBUTE_LARGE_RAM_ARRAY
 
-/*Place performance critical functions into a faster memory (e.g RAM)*/
-#define LV_ATTRIBUTE_FAST_MEM
+/*Place performance critical functions into a faster memory (e.g RAM)
+ *RAMX with OMNI_PLACE_LVGL (omni_place.h): the blend kernels, masks, about 40 KB*/
+#define LV_ATTRIBUTE_FAST_MEM OMNI_PLACE_LVGL_CODE
 
 /*Export integer constant to binding. This macro is used with constants in the form of LV_<CONST> that
  *should also appear on LVGL binding API such as MicroPython.*/
@@ -133,6 +133,12 @@
  */
 #define LV_DRAW_THREAD_STACK_SIZE    (8 * 1024)   /*[bytes]*/
 
+/* Size of the arena which stores the draw tasks and their descriptors during a refresh.
+ * It's rewound after every refresh, so they don't fragment the heap.
+ * If a frame needs more, the rest is allocated with `lv_malloc`. 0: always use `lv_malloc`.
+ * Check `lv_draw_arena_get_stats()` to size it. */
+#define LV_DRAW_ARENA_SIZE    0   /*[bytes]*/
+
 #define LV_USE_DRAW_SW 1
 #if LV_USE_DRAW_SW == 1
 
@@ -369,6 +375,12 @@
  *The main logic is like `LV_CACHE_DEF_SIZE` but for image headers.*/
 #define LV_IMAGE_HEADER_CACHE_DEF_CNT 0
 
+/*Size of the rendered-glyph cache in bytes.
+ *Decoded glyph bitmaps of built-in (`lv_font_fmt_txt`) fonts are kept here keyed by font, code point and bpp
+ *so the glyphs that are redrawn often (digits, signs, units) are not decoded again on every refresh.
+ *The least recently used glyphs are dropped when the budget is exceeded. 0 disables the cache.*/
+#define LV_FONT_GLYPH_CACHE_SIZE 0
+
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
 #define LV_GRADIENT_MAX_STOPS   2
@@ -45,6 +45,7 @@ extern "C" {
 #include "src/font/lv_font.h"
 #include "src/font/lv_binfont_loader.h"
 #include "src/font/lv_font_fmt_txt.h"
+#include "src/misc/cache/lv_font_glyph_cache.h"
 
 #include "src/widgets/animimage/lv_animimage.h"
 #include "src/widgets/arc/lv_arc.h"
@@ -110,6 +111,7 @@ extern "C" {
 
 #include "src/draw/lv_draw.h"
 #include "src/draw/lv_draw_buf.h"
+#include "src/draw/lv_draw_arena.h"
 #include "src/draw/lv_draw_vector.h"
 #include "src/draw/sw/lv_draw_sw.h"
 
@@ -41,6 +41,7 @@ extern "C" {
 
 #include "../tick/lv_tick.h"
 #include "../layouts/lv_layout.h"
+#include "../misc/cache/lv_font_glyph_cache.h"
 
 #include "../misc/lv_types.h"
 
@@ -125,6 +126,9 @@ typedef struct lv_global_t {
     lv_cache_t * img_cache;
     lv_cache_t * img_header_cache;
 
+    lv_cache_t * font_glyph_cache;
+    lv_font_glyph_cache_stats_t font_glyph_cache_stats;
+
     lv_draw_global_info_t draw_info;
 #if defined(LV_DRAW_SW_SHADOW_CACHE_SIZE) && LV_DRAW_SW_SHADOW_CACHE_SIZE > 0
     lv_draw_sw_shadow_cache_t sw_shadow_cache;
@@ -425,6 +425,9 @@ refr_finish:
     lv_draw_sw_mask_cleanup();
 #endif
 
+    /*All draw tasks of this refresh are done, reuse their memory in the next one*/
+    lv_draw_arena_reset();
+
     lv_display_send_event(disp_refr, LV_EVENT_REFR_READY, NULL);
 
     LV_TRACE_REFR("finished");
@@ -31,6 +31,12 @@
  *  STATIC PROTOTYPES
  **********************/
 static bool is_independent(lv_layer_t * layer, lv_draw_task_t * t_check);
+static void task_graph_insert(lv_layer_t * layer, lv_draw_task_t * t);
+static void task_graph_remove(lv_layer_t * layer, lv_draw_task_t * t);
+static void task_graph_push_ready(lv_draw_task_graph_t * g, lv_draw_task_t * t);
+static void task_graph_unlink_ready(lv_draw_task_graph_t * g, lv_draw_task_t * t);
+static void task_graph_check_bucket(lv_draw_task_graph_t * g, uint32_t bucket, lv_draw_task_t * t);
+static void task_graph_add_to_bucket(lv_draw_task_graph_t * g, uint32_t bucket, lv_draw_task_t * t);
 
 static inline uint32_t get_layer_size_kb(uint32_t size_byte)
 {
@@ -57,6 +63,7 @@ void lv_draw_init(void)
 #if LV_USE_OS
     lv_thread_sync_init(&_draw_info.sync);
 #endif
+    lv_draw_arena_init();
 }
 
 void lv_draw_deinit(void)
@@ -74,6 +81,8 @@ void lv_draw_deinit(void)
         lv_free(cur_unit);
     }
     _draw_info.unit_head = NULL;
+
+    lv_draw_arena_deinit();
 }
 
 void * lv_draw_create_unit(size_t size)
@@ -90,7 +99,7 @@ void * lv_draw_create_unit(size_t size)
 lv_draw_task_t * lv_draw_add_task(lv_layer_t * layer, const lv_area_t * coords)
 {
     LV_PROFILER_BEGIN;
-    lv_draw_task_t * new_task = lv_malloc_zeroed(sizeof(lv_draw_task_t));
+    lv_draw_task_t * new_task = lv_draw_arena_alloc_zeroed(sizeof(lv_draw_task_t));
 
     new_task->area = *coords;
     new_task->_real_area = *coords;
@@ -123,6 +132,9 @@ void lv_draw_finalize_task_creation(lv_layer_t * layer, lv_draw_task_t * t)
 
     lv_draw_global_info_t * info = &_draw_info;
 
+    /*Register the dependencies before the event handler could add new tasks after this one*/
+    task_graph_insert(layer, t);
+
     /*Send LV_EVENT_DRAW_TASK_ADDED and dispatch only on the "main" draw_task
      *and not on the draw tasks added in the event.
      *Sending LV_EVENT_DRAW_TASK_ADDED events might cause recursive event sends and besides
@@ -204,6 +216,9 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
             if(t_prev) t_prev->next = t->next;      /*Remove it by assigning the next task to the previous*/
             else layer->draw_task_head = t_next;    /*If it was the head, set the next as head*/
 
+            /*Let the tasks waiting for this one go*/
+            task_graph_remove(layer, t);
+
             /*If it was layer drawing free the layer too*/
             if(t->type == LV_DRAW_TASK_TYPE_LAYER) {
                 lv_draw_image_dsc_t * draw_image_dsc = t->draw_dsc;
@@ -236,12 +251,12 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
             }
             lv_draw_label_dsc_t * draw_label_dsc = lv_draw_task_get_label_dsc(t);
             if(draw_label_dsc && draw_label_dsc->text_local) {
-                lv_free((void *)draw_label_dsc->text);
+                lv_draw_arena_free((void *)draw_label_dsc->text);
                 draw_label_dsc->text = NULL;
             }
 
-            lv_free(t->draw_dsc);
-            lv_free(t);
+            lv_draw_arena_free(t->draw_dsc);
+            lv_draw_arena_free(t);
         }
         else {
             t_prev = t;
@@ -249,6 +264,11 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
         t = t_next;
     }
 
+    if(layer->draw_task_head == NULL && layer->task_graph) {
+        lv_draw_arena_free(layer->task_graph);
+        layer->task_graph = NULL;
+    }
+
     bool task_dispatched = false;
 
     /*This layer is ready, enable blending its buffer*/
@@ -260,6 +280,9 @@ bool lv_draw_dispatch_layer(lv_display_t * disp, lv_layer_t * layer)
                 lv_draw_image_dsc_t * draw_dsc = t_src->draw_dsc;
                 if(draw_dsc->src == layer) {
                     t_src->state = LV_DRAW_TASK_STATE_QUEUED;
+                    if(layer->parent->task_graph && t_src->dep_cnt == 0) {
+                        task_graph_push_ready(layer->parent->task_graph, t_src);
+                    }
                     lv_draw_dispatch_request();
                     break;
                 }
@@ -345,7 +368,29 @@ lv_draw_task_t * lv_draw_get_next_available_task(lv_layer_t * layer, lv_draw_tas
 
     /*Handle the case of multiply draw units*/
 
-    /*If the first task is screen sized, there cannot be independent areas*/
+    /*The dependency graph keeps the queued tasks without unfinished dependencies in a queue*/
+    lv_draw_task_graph_t * g = layer->task_graph;
+    if(g) {
+        lv_draw_task_t * t = t_prev && t_prev->in_ready_queue ? t_prev->ready_next : g->ready_head;
+        while(t) {
+            lv_draw_task_t * t_next = t->ready_next;
+            /*Already taken by a draw unit*/
+            if(t->state != LV_DRAW_TASK_STATE_QUEUED) {
+                task_graph_unlink_ready(g, t);
+            }
+            else if(t->preferred_draw_unit_id == LV_DRAW_UNIT_NONE || t->preferred_draw_unit_id == draw_unit_id) {
+                LV_PROFILER_END;
+                return t;
+            }
+            t = t_next;
+        }
+
+        LV_PROFILER_END;
+        return NULL;
+    }
+
+    /*Without the graph (it couldn't be allocated) check the tasks one by one.
+     *If the first task is screen sized, there cannot be independent areas*/
     if(layer->draw_task_head) {
         int32_t hor_res = lv_display_get_horizontal_resolution(lv_refr_get_disp_refreshing());
         int32_t ver_res = lv_display_get_vertical_resolution(lv_refr_get_disp_refreshing());
@@ -503,3 +548,187 @@ static bool is_independent(lv_layer_t * layer, lv_draw_task_t * t_check)
 
     return true;
 }
+
+/**
+ * Add a new draw task to the dependency graph of its layer.
+ * It depends on all the earlier, not ready tasks whose area overlaps its area.
+ * Only the tasks sharing a bucket of the grid with the new task need to be checked.
+ * @param layer     the layer of the task
+ * @param t         the new task, already added to the end of the layer's task list
+ */
+static void task_graph_insert(lv_layer_t * layer, lv_draw_task_t * t)
+{
+    /*With a single draw unit the tasks are consumed in order anyway*/
+    if(!LV_DRAW_TASK_GRAPH || _draw_info.unit_cnt <= 1) return;
+
+    lv_draw_task_graph_t * g = layer->task_graph;
+    if(g == NULL) {
+        /*Start a new graph only with an empty layer, else the earlier tasks would be missing from it*/
+        if(layer->draw_task_head != t) return;
+
+        g = lv_draw_arena_alloc_zeroed(sizeof(lv_draw_task_graph_t));
+        if(g == NULL) return;
+
+        /*Use square cells, so a few lines high render chunk is not cut into thin stripes*/
+        g->area = layer->buf_area;
+        int32_t cell_w = (lv_area_get_width(&g->area) + LV_DRAW_TASK_GRID_COLS - 1) / LV_DRAW_TASK_GRID_COLS;
+        int32_t cell_h = (lv_area_get_height(&g->area) + LV_DRAW_TASK_GRID_ROWS - 1) / LV_DRAW_TASK_GRID_ROWS;
+        g->cell_size = LV_MAX3(1, cell_w, cell_h);
+        layer->task_graph = g;
+    }
+
+    LV_PROFILER_BEGIN;
+
+    /*Overlapping areas always share at least one bucket, even if they are clamped to the edges*/
+    int32_t c1 = LV_CLAMP(0, (t->_real_area.x1 - g->area.x1) / g->cell_size, LV_DRAW_TASK_GRID_COLS - 1);
+    int32_t c2 = LV_CLAMP(0, (t->_real_area.x2 - g->area.x1) / g->cell_size, LV_DRAW_TASK_GRID_COLS - 1);
+    int32_t r1 = LV_CLAMP(0, (t->_real_area.y1 - g->area.y1) / g->cell_size, LV_DRAW_TASK_GRID_ROWS - 1);
+    int32_t r2 = LV_CLAMP(0, (t->_real_area.y2 - g->area.y1) / g->cell_size, LV_DRAW_TASK_GRID_ROWS - 1);
+    bool wide = (c2 - c1 + 1) * (r2 - r1 + 1) > LV_DRAW_TASK_GRID_WIDE_CELLS;
+    const uint32_t wide_bucket = LV_DRAW_TASK_GRID_COLS * LV_DRAW_TASK_GRID_ROWS;
+
+    g->stamp++;
+    t->graph_stamp = g->stamp;
+
+    /*An overlapping earlier task is either wide or stored in one of the covered buckets*/
+    task_graph_check_bucket(g, wide_bucket, t);
+    int32_t r;
+    int32_t c;
+    for(r = r1; r <= r2; r++) {
+        for(c = c1; c <= c2; c++) {
+            task_graph_check_bucket(g, r * LV_DRAW_TASK_GRID_COLS + c, t);
+        }
+    }
+
+    if(wide) {
+        task_graph_add_to_bucket(g, wide_bucket, t);
+    }
+    else {
+        for(r = r1; r <= r2; r++) {
+            for(c = c1; c <= c2; c++) {
+                task_graph_add_to_bucket(g, r * LV_DRAW_TASK_GRID_COLS + c, t);
+            }
+        }
+    }
+
+    if(t->dep_cnt == 0 && t->state == LV_DRAW_TASK_STATE_QUEUED) {
+        task_graph_push_ready(g, t);
+    }
+
+    LV_PROFILER_END;
+}
+
+/**
+ * Remove a ready draw task from the dependency graph and release the tasks which waited for it.
+ * @param layer     the layer of the task
+ * @param t         the ready task which is about to be freed
+ */
+static void task_graph_remove(lv_layer_t * layer, lv_draw_task_t * t)
+{
+    lv_draw_task_graph_t * g = layer->task_graph;
+    if(g == NULL) return;
+
+    if(t->in_ready_queue) task_graph_unlink_ready(g, t);
+
+    lv_draw_task_cell_t * cell = t->cells;
+    while(cell) {
+        lv_draw_task_cell_t * cell_next = cell->task_next;
+        if(cell->prev) cell->prev->next = cell->next;
+        else g->buckets[cell->bucket] = cell->next;
+        if(cell->next) cell->next->prev = cell->prev;
+
+        lv_draw_arena_free(cell);
+        cell = cell_next;
+    }
+    t->cells = NULL;
+
+    lv_draw_task_link_t * link = t->successors;
+    while(link) {
+        lv_draw_task_link_t * link_next = link->next;
+        lv_draw_task_t * succ = link->task;
+        LV_ASSERT(succ->dep_cnt > 0);
+        succ->dep_cnt--;
+        if(succ->dep_cnt == 0 && succ->state == LV_DRAW_TASK_STATE_QUEUED) {
+            task_graph_push_ready(g, succ);
+        }
+
+        lv_draw_arena_free(link);
+        link = link_next;
+    }
+    t->successors = NULL;
+}
+
+static void task_graph_push_ready(lv_draw_task_graph_t * g, lv_draw_task_t * t)
+{
+    if(t->in_ready_queue) return;
+
+    t->ready_next = NULL;
+    t->ready_prev = g->ready_tail;
+    if(g->ready_tail) g->ready_tail->ready_next = t;
+    else g->ready_head = t;
+    g->ready_tail = t;
+    t->in_ready_queue = 1;
+}
+
+static void task_graph_unlink_ready(lv_draw_task_graph_t * g, lv_draw_task_t * t)
+{
+    if(t->ready_prev) t->ready_prev->ready_next = t->ready_next;
+    else g->ready_head = t->ready_next;
+    if(t->ready_next) t->ready_next->ready_prev = t->ready_prev;
+    else g->ready_tail = t->ready_prev;
+
+    t->ready_prev = NULL;
+    t->ready_next = NULL;
+    t->in_ready_queue = 0;
+}
+
+/**
+ * Make `t` depend on the not ready tasks of a bucket which overlap it
+ * @param g         the dependency graph
+ * @param bucket    index of the bucket
+ * @param t         the new task
+ */
+static void task_graph_check_bucket(lv_draw_task_graph_t * g, uint32_t bucket, lv_draw_task_t * t)
+{
+    /*The buckets are ordered from the newest to the oldest task*/
+    lv_draw_task_cell_t * cell = g->buckets[bucket];
+    while(cell) {
+        lv_draw_task_t * t_prev = cell->task;
+        cell = cell->next;
+
+        /*Not checked yet via an other bucket*/
+        if(t_prev->graph_stamp != g->stamp) {
+            t_prev->graph_stamp = g->stamp;
+
+            lv_area_t a;
+            if(t_prev->state != LV_DRAW_TASK_STATE_READY && lv_area_intersect(&a, &t_prev->_real_area, &t->_real_area)) {
+                lv_draw_task_link_t * link = lv_draw_arena_alloc(sizeof(lv_draw_task_link_t));
+                LV_ASSERT_MALLOC(link);
+                link->task = t;
+                link->next = t_prev->successors;
+                t_prev->successors = link;
+                t->dep_cnt++;
+            }
+        }
+
+        /*The older tasks overlapping `t` overlap `t_prev` too, so `t_prev` already waits for them.
+         *Depending on `t_prev` is enough, it keeps the number of edges low in piles of widgets*/
+        if(lv_area_is_in(&t->_real_area, &t_prev->_real_area, 0)) break;
+    }
+}
+
+static void task_graph_add_to_bucket(lv_draw_task_graph_t * g, uint32_t bucket, lv_draw_task_t * t)
+{
+    lv_draw_task_cell_t * cell = lv_draw_arena_alloc(sizeof(lv_draw_task_cell_t));
+    LV_ASSERT_MALLOC(cell);
+
+    cell->task = t;
+    cell->bucket = bucket;
+    cell->prev = NULL;
+    cell->next = g->buckets[bucket];
+    if(cell->next) cell->next->prev = cell;
+    g->buckets[bucket] = cell;
+
+    cell->task_next = t->cells;
+    t->cells = cell;
+}
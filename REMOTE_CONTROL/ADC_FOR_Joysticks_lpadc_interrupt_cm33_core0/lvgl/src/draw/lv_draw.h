@@ -101,6 +101,9 @@ struct lv_layer_t  {
     /** Linked list of draw tasks */
     lv_draw_task_t * draw_task_head;
 
+    /** Dependencies between the draw tasks, used only if there are multiple draw units */
+    lv_draw_task_graph_t * task_graph;
+
     lv_layer_t * parent;
     lv_layer_t * next;
     bool all_tasks_added;
@@ -0,0 +1,164 @@
+/**
+ * @file lv_draw_arena.c
+ *
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+#include "lv_draw_private.h"
+#include "../core/lv_global.h"
+#include "../stdlib/lv_mem.h"
+#include "../stdlib/lv_string.h"
+#include "../misc/lv_assert.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+#define _arena LV_GLOBAL_DEFAULT()->draw_info.arena
+
+/*Keep every block aligned for the widest member of the draw descriptors*/
+#define ARENA_ALIGN     8
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+static inline bool is_in_arena(const void * p);
+static inline void rewind(void);
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+void lv_draw_arena_init(void)
+{
+    lv_memzero(&_arena, sizeof(lv_draw_arena_t));
+    _arena.stats.size = LV_DRAW_ARENA_SIZE;
+
+#if LV_DRAW_ARENA_SIZE
+    /*A single long-lived block, so the per-frame task churn stays out of the heap*/
+    _arena.buf = lv_malloc(LV_DRAW_ARENA_SIZE);
+    LV_ASSERT_MALLOC(_arena.buf);
+    if(_arena.buf == NULL) _arena.stats.size = 0;
+#endif
+}
+
+void lv_draw_arena_deinit(void)
+{
+    if(_arena.buf) lv_free(_arena.buf);
+    _arena.buf = NULL;
+    _arena.stats.size = 0;
+}
+
+void * lv_draw_arena_alloc(size_t size)
+{
+    size = (size + ARENA_ALIGN - 1) & ~((size_t)ARENA_ALIGN - 1);
+
+    if(_arena.buf && _arena.offset + size <= _arena.stats.size) {
+        void * p = &_arena.buf[_arena.offset];
+        _arena.offset += size;
+        _arena.stats.used = _arena.offset;
+        if(_arena.offset > _arena.stats.high_water) _arena.stats.high_water = _arena.offset;
+        _arena.stats.live_cnt++;
+        return p;
+    }
+
+    if(_arena.buf) {
+        _arena.stats.heap_fallback_cnt++;
+        LV_LOG_TRACE("Draw arena full (%" LV_PRIu32 " bytes), using the heap", _arena.stats.size);
+    }
+
+    void * p = lv_malloc(size);
+    LV_ASSERT_MALLOC(p);
+    return p;
+}
+
+void * lv_draw_arena_alloc_zeroed(size_t size)
+{
+    void * p = lv_draw_arena_alloc(size);
+    if(p) lv_memzero(p, size);
+    return p;
+}
+
+char * lv_draw_arena_strdup(const char * str)
+{
+    size_t len = lv_strlen(str) + 1;
+    char * dst = lv_draw_arena_alloc(len);
+    if(dst == NULL) return NULL;
+
+    lv_memcpy(dst, str, len);
+    return dst;
+}
+
+void lv_draw_arena_free(void * p)
+{
+    if(p == NULL) return;
+
+    if(is_in_arena(p)) {
+        LV_ASSERT(_arena.stats.live_cnt > 0);
+        _arena.stats.live_cnt--;
+
+        /*Nothing points into the arena anymore (e.g. a render chunk is finished), start over*/
+        if(_arena.stats.live_cnt == 0) rewind();
+    }
+    else {
+        lv_free(p);
+    }
+}
+
+void lv_draw_arena_reset(void)
+{
+    if(_arena.buf == NULL || _arena.offset == 0) return;
+
+    /*Tasks of a layer which is not finished yet (e.g. a canvas drawn outside of the refresh)
+     *still point into the arena, keep bumping until they are freed*/
+    if(_arena.stats.live_cnt) {
+        _arena.stats.reset_skip_cnt++;
+        return;
+    }
+
+    rewind();
+}
+
+void lv_draw_arena_get_stats(lv_draw_arena_stats_t * stats)
+{
+    LV_ASSERT_NULL(stats);
+    lv_memcpy(stats, &_arena.stats, sizeof(lv_draw_arena_stats_t));
+}
+
+void lv_draw_arena_reset_stats(void)
+{
+    _arena.stats.high_water = _arena.offset;
+    _arena.stats.heap_fallback_cnt = 0;
+    _arena.stats.reset_cnt = 0;
+    _arena.stats.reset_skip_cnt = 0;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static inline bool is_in_arena(const void * p)
+{
+    const uint8_t * u8 = p;
+    return _arena.buf && u8 >= _arena.buf && u8 < _arena.buf + _arena.stats.size;
+}
+
+static inline void rewind(void)
+{
+    _arena.offset = 0;
+    _arena.stats.used = 0;
+    _arena.stats.reset_cnt++;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file lv_draw_arena.h
+ *
+ */
+
+#ifndef LV_DRAW_ARENA_H
+#define LV_DRAW_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "../lv_conf_internal.h"
+#include "../misc/lv_types.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/** Usage counters of the draw task arena. */
+typedef struct {
+    uint32_t size;              /**< Size of the arena in bytes (`LV_DRAW_ARENA_SIZE`)*/
+    uint32_t used;              /**< Bytes handed out since the last reset*/
+    uint32_t high_water;        /**< The largest `used` value seen so far*/
+    uint32_t live_cnt;          /**< Arena allocations not freed yet*/
+    uint32_t heap_fallback_cnt; /**< Allocations which didn't fit and were served by `lv_malloc`*/
+    uint32_t reset_cnt;         /**< Number of times the arena was rewound (all of its allocations were freed)*/
+    uint32_t reset_skip_cnt;    /**< Refreshes that ended with live allocations, so the arena couldn't be rewound*/
+} lv_draw_arena_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Get the usage counters of the arena which stores the draw tasks and their descriptors.
+ * Use `high_water` and `heap_fallback_cnt` to tune `LV_DRAW_ARENA_SIZE`.
+ * @param stats     store the counters here
+ */
+void lv_draw_arena_get_stats(lv_draw_arena_stats_t * stats);
+
+/**
+ * Clear the high-water mark and the event counters of the draw task arena.
+ */
+void lv_draw_arena_reset_stats(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_ARENA_H*/
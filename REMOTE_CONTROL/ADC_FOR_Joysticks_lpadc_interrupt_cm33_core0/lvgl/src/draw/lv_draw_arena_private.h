@@ -0,0 +1,90 @@
+/**
+ * @file lv_draw_arena_private.h
+ *
+ */
+
+#ifndef LV_DRAW_ARENA_PRIVATE_H
+#define LV_DRAW_ARENA_PRIVATE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lv_draw_arena.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    uint8_t * buf;              /**< `LV_DRAW_ARENA_SIZE` bytes allocated once in `lv_draw_init()`*/
+    uint32_t offset;            /**< Start of the free space in `buf`*/
+    lv_draw_arena_stats_t stats;
+} lv_draw_arena_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Allocate the arena's buffer. Called from `lv_draw_init()`.
+ */
+void lv_draw_arena_init(void);
+
+/**
+ * Free the arena's buffer. Called from `lv_draw_deinit()`.
+ */
+void lv_draw_arena_deinit(void);
+
+/**
+ * Allocate memory for a draw task or draw descriptor.
+ * The memory is taken from the arena by bumping a pointer, or from `lv_malloc` if the arena is full.
+ * @param size      number of bytes
+ * @return          pointer to the allocated memory (never NULL, out of memory is asserted)
+ */
+void * lv_draw_arena_alloc(size_t size);
+
+/**
+ * Same as `lv_draw_arena_alloc()` but the memory is zeroed.
+ * @param size      number of bytes
+ * @return          pointer to the allocated memory
+ */
+void * lv_draw_arena_alloc_zeroed(size_t size);
+
+/**
+ * Copy a string into memory allocated with `lv_draw_arena_alloc()`.
+ * @param str       the string to copy
+ * @return          the copy
+ */
+char * lv_draw_arena_strdup(const char * str);
+
+/**
+ * Free memory returned by `lv_draw_arena_alloc()`.
+ * The arena is rewound when its last live allocation is freed, heap fallbacks are freed immediately.
+ * @param p         pointer to free, NULL is ignored
+ */
+void lv_draw_arena_free(void * p);
+
+/**
+ * Rewind the arena if all of its allocations were freed, otherwise count a skipped reset.
+ * Called at the end of each display refresh.
+ */
+void lv_draw_arena_reset(void);
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_DRAW_ARENA_PRIVATE_H*/
@@ -20,6 +20,7 @@
 #include "../stdlib/lv_mem.h"
 #include "../stdlib/lv_string.h"
 #include "../core/lv_global.h"
+#include "../misc/cache/lv_font_glyph_cache.h"
 
 /*********************
  *      DEFINES
@@ -92,14 +93,14 @@ void LV_ATTRIBUTE_FAST_MEM lv_draw_label(lv_layer_t * layer, const lv_draw_label
     LV_PROFILER_BEGIN;
     lv_draw_task_t * t = lv_draw_add_task(layer, coords);
 
-    t->draw_dsc = lv_malloc(sizeof(*dsc));
+    t->draw_dsc = lv_draw_arena_alloc(sizeof(*dsc));
     lv_memcpy(t->draw_dsc, dsc, sizeof(*dsc));
     t->type = LV_DRAW_TASK_TYPE_LABEL;
 
     /*The text is stored in a local variable so malloc memory for it*/
     if(dsc->text_local) {
         lv_draw_label_dsc_t * new_dsc = t->draw_dsc;
-        new_dsc->text = lv_strdup(dsc->text);
+        new_dsc->text = lv_draw_arena_strdup(dsc->text);
     }
 
     lv_draw_finalize_task_creation(layer, t);
@@ -412,7 +413,14 @@ static void draw_letter(lv_draw_unit_t * draw_unit, lv_draw_glyph_dsc_t * dsc,
         return;
     }
 
-    if(g.resolved_font) {
+    /*Try the rendered-glyph cache first so hot glyphs are not decoded on every redraw*/
+    const void * cached_glyph = g.resolved_font ? lv_font_glyph_cache_acquire(&g, letter) : NULL;
+
+    if(cached_glyph) {
+        dsc->glyph_data = (void *)cached_glyph;
+        dsc->format = g.format;
+    }
+    else if(g.resolved_font) {
         lv_draw_buf_t * draw_buf = NULL;
         if(LV_FONT_GLYPH_FORMAT_NONE < g.format && g.format < LV_FONT_GLYPH_FORMAT_IMAGE) {
             /*Only check draw buf for bitmap glyph*/
@@ -440,7 +448,8 @@ static void draw_letter(lv_draw_unit_t * draw_unit, lv_draw_glyph_dsc_t * dsc,
     dsc->g = &g;
     cb(draw_unit, dsc, NULL, NULL);
 
-    lv_font_glyph_release_draw_data(&g);
+    if(cached_glyph) lv_font_glyph_cache_release(&g);
+    else lv_font_glyph_release_draw_data(&g);
 
     LV_PROFILER_END;
 }
@@ -19,15 +19,62 @@ extern "C" {
  *********************/
 
 #include "lv_draw.h"
+#include "lv_draw_arena_private.h"
 
 /*********************
  *      DEFINES
  *********************/
 
+/** Set to 0 to pick the draw tasks with the linear scan even with multiple draw units*/
+#ifndef LV_DRAW_TASK_GRAPH
+#define LV_DRAW_TASK_GRAPH          1
+#endif
+
+/** Number of buckets of the draw task dependency grid*/
+#define LV_DRAW_TASK_GRID_COLS      8
+#define LV_DRAW_TASK_GRID_ROWS      8
+
+/** Tasks covering more buckets than this are stored in a single list which is checked against every new task*/
+#define LV_DRAW_TASK_GRID_WIDE_CELLS    4
+
 /**********************
  *      TYPEDEFS
  **********************/
 
+typedef struct lv_draw_task_link_t lv_draw_task_link_t;
+typedef struct lv_draw_task_cell_t lv_draw_task_cell_t;
+
+/** Edge of the draw task dependency graph*/
+struct lv_draw_task_link_t {
+    lv_draw_task_t * task;
+    lv_draw_task_link_t * next;
+};
+
+/** Entry of a draw task in a bucket of the dependency grid*/
+struct lv_draw_task_cell_t {
+    lv_draw_task_t * task;
+    lv_draw_task_cell_t * prev;         /**< Neighbors in the bucket*/
+    lv_draw_task_cell_t * next;
+    lv_draw_task_cell_t * task_next;    /**< Next bucket entry of the same task*/
+    uint32_t bucket;
+};
+
+struct lv_draw_task_graph_t {
+    /** The area covered by the grid. Tasks outside of it are put in the edge buckets*/
+    lv_area_t area;
+    int32_t cell_size;
+
+    /** The not finished tasks by bucket. The last bucket holds the tasks covering many buckets*/
+    lv_draw_task_cell_t * buckets[LV_DRAW_TASK_GRID_COLS * LV_DRAW_TASK_GRID_ROWS + 1];
+
+    /** Queued tasks without unfinished dependencies, in drawing order*/
+    lv_draw_task_t * ready_head;
+    lv_draw_task_t * ready_tail;
+
+    /** Incremented on each insertion to check every earlier task only once*/
+    uint32_t stamp;
+};
+
 struct lv_draw_task_t {
     lv_draw_task_t * next;
 
@@ -75,6 +122,22 @@ struct lv_draw_task_t {
      */
     uint8_t preference_score;
 
+    /** Number of earlier, not finished tasks of the layer overlapping this task*/
+    uint32_t dep_cnt;
+
+    /** Later tasks of the layer overlapping this task. Released when this task is ready*/
+    lv_draw_task_link_t * successors;
+
+    /** The buckets of the dependency grid this task is stored in*/
+    lv_draw_task_cell_t * cells;
+
+    /** Neighbors in the layer's ready queue*/
+    lv_draw_task_t * ready_prev;
+    lv_draw_task_t * ready_next;
+
+    uint32_t graph_stamp;
+    uint8_t in_ready_queue;
+
 };
 
 struct lv_draw_mask_t {
@@ -179,6 +242,7 @@ typedef struct {
 #endif
     lv_mutex_t circle_cache_mutex;
     bool task_running;
+    lv_draw_arena_t arena;      /**< Per-frame storage of the draw tasks and their descriptors*/
 } lv_draw_global_info_t;
 
 /**********************
@@ -348,6 +348,18 @@
     #endif
 #endif
 
+/* Size of the arena which stores the draw tasks and their descriptors during a refresh.
+ * It's rewound after every refresh, so they don't fragment the heap.
+ * If a frame needs more, the rest is allocated with `lv_malloc`. 0: always use `lv_malloc`.
+ * Check `lv_draw_arena_get_stats()` to size it. */
+#ifndef LV_DRAW_ARENA_SIZE
+    #ifdef CONFIG_LV_DRAW_ARENA_SIZE
+        #define LV_DRAW_ARENA_SIZE CONFIG_LV_DRAW_ARENA_SIZE
+    #else
+        #define LV_DRAW_ARENA_SIZE    0   /*[bytes]*/
+    #endif
+#endif
+
 #ifndef LV_USE_DRAW_SW
     #ifdef LV_KCONFIG_PRESENT
         #ifdef CONFIG_LV_USE_DRAW_SW
@@ -1096,6 +1108,18 @@
     #endif
 #endif
 
+/*Size of the rendered-glyph cache in bytes.
+ *Decoded glyph bitmaps of built-in (`lv_font_fmt_txt`) fonts are kept here keyed by font, code point and bpp
+ *so the glyphs that are redrawn often (digits, signs, units) are not decoded again on every refresh.
+ *The least recently used glyphs are dropped when the budget is exceeded. 0 disables the cache.*/
+#ifndef LV_FONT_GLYPH_CACHE_SIZE
+    #ifdef CONFIG_LV_FONT_GLYPH_CACHE_SIZE
+        #define LV_FONT_GLYPH_CACHE_SIZE CONFIG_LV_FONT_GLYPH_CACHE_SIZE
+    #else
+        #define LV_FONT_GLYPH_CACHE_SIZE 0
+    #endif
+#endif
+
 /*Number of stops allowed per gradient. Increase this to allow more stops.
  *This adds (sizeof(lv_color_t) + 1) bytes per additional stop*/
 #ifndef LV_GRADIENT_MAX_STOPS
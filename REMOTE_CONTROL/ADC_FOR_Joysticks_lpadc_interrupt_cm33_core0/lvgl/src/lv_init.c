@@ -234,6 +234,8 @@ void lv_init(void)
     lv_image_decoder_init(LV_CACHE_DEF_SIZE, LV_IMAGE_HEADER_CACHE_DEF_CNT);
     lv_bin_decoder_init();  /*LVGL built-in binary image decoder*/
 
+    lv_font_glyph_cache_init(LV_FONT_GLYPH_CACHE_SIZE);
+
 #if LV_USE_DRAW_VG_LITE
     lv_draw_vg_lite_init();
 #endif
@@ -391,6 +393,8 @@ void lv_deinit(void)
     lv_theme_mono_deinit();
 #endif
 
+    lv_font_glyph_cache_deinit();
+
     lv_image_decoder_deinit();
 
     lv_refr_deinit();
@@ -33,6 +33,7 @@ extern "C" {
 #include "libs/gif/lv_gif_private.h"
 #include "draw/lv_draw_triangle_private.h"
 #include "draw/lv_draw_private.h"
+#include "draw/lv_draw_arena_private.h"
 #include "draw/lv_draw_rect_private.h"
 #include "draw/lv_draw_image_private.h"
 #include "draw/lv_image_decoder_private.h"
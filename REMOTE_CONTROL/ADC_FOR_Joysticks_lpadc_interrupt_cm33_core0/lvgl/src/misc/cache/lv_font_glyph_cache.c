@@ -0,0 +1,228 @@
+/**
+* @file lv_font_glyph_cache.c
+*
+ */
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "lv_font_glyph_cache.h"
+#include "lv_cache.h"
+#include "../lv_assert.h"
+#include "../../core/lv_global.h"
+#include "../../draw/lv_draw_buf.h"
+#include "../../font/lv_font_fmt_txt.h"
+#include "../../stdlib/lv_string.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+#define CACHE_NAME  "FONT_GLYPH"
+
+#define glyph_cache_p (LV_GLOBAL_DEFAULT()->font_glyph_cache)
+#define glyph_cache_stats (LV_GLOBAL_DEFAULT()->font_glyph_cache_stats)
+#define font_draw_buf_handlers &(LV_GLOBAL_DEFAULT()->font_draw_buf_handlers)
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+typedef struct {
+    lv_cache_slot_size_t slot;  /**< Must be the first field: the byte budget is accounted with it*/
+
+    const lv_font_t * font;
+    uint32_t letter;
+    uint32_t format;            /**< The glyph's bpp (`lv_font_glyph_format_t`)*/
+
+    lv_draw_buf_t * draw_buf;
+} lv_font_glyph_cache_data_t;
+
+/**********************
+ *  STATIC PROTOTYPES
+ **********************/
+
+static bool glyph_cache_create_cb(lv_font_glyph_cache_data_t * data, void * user_data);
+static void glyph_cache_free_cb(lv_font_glyph_cache_data_t * data, void * user_data);
+static lv_cache_compare_res_t glyph_cache_compare_cb(const lv_font_glyph_cache_data_t * lhs,
+                                                     const lv_font_glyph_cache_data_t * rhs);
+
+/**********************
+ *  GLOBAL VARIABLES
+ **********************/
+
+/**********************
+ *  STATIC VARIABLES
+ **********************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+/**********************
+ *   GLOBAL FUNCTIONS
+ **********************/
+
+lv_result_t lv_font_glyph_cache_init(uint32_t size)
+{
+    if(glyph_cache_p != NULL) {
+        return LV_RESULT_OK;
+    }
+
+    glyph_cache_p = lv_cache_create(&lv_cache_class_lru_rb_size,
+    sizeof(lv_font_glyph_cache_data_t), size, (lv_cache_ops_t) {
+        .compare_cb = (lv_cache_compare_cb_t) glyph_cache_compare_cb,
+        .create_cb = (lv_cache_create_cb_t) glyph_cache_create_cb,
+        .free_cb = (lv_cache_free_cb_t) glyph_cache_free_cb,
+    });
+
+    lv_memzero(&glyph_cache_stats, sizeof(lv_font_glyph_cache_stats_t));
+
+    if(glyph_cache_p == NULL) return LV_RESULT_INVALID;
+
+    lv_cache_set_name(glyph_cache_p, CACHE_NAME);
+    return LV_RESULT_OK;
+}
+
+void lv_font_glyph_cache_deinit(void)
+{
+    if(glyph_cache_p == NULL) return;
+
+    lv_cache_destroy(glyph_cache_p, NULL);
+    glyph_cache_p = NULL;
+}
+
+void lv_font_glyph_cache_resize(uint32_t new_size, bool evict_now)
+{
+    if(glyph_cache_p == NULL) return;
+
+    lv_cache_set_max_size(glyph_cache_p, new_size, NULL);
+    if(evict_now) {
+        lv_cache_reserve(glyph_cache_p, new_size, NULL);
+    }
+}
+
+void lv_font_glyph_cache_drop_all(void)
+{
+    if(glyph_cache_p == NULL) return;
+
+    lv_cache_drop_all(glyph_cache_p, NULL);
+}
+
+bool lv_font_glyph_cache_is_enabled(void)
+{
+    return glyph_cache_p != NULL && lv_cache_is_enabled(glyph_cache_p);
+}
+
+const void * lv_font_glyph_cache_acquire(lv_font_glyph_dsc_t * g_dsc, uint32_t letter)
+{
+    LV_ASSERT_NULL(g_dsc);
+
+    const lv_font_t * font = g_dsc->resolved_font;
+
+    /*Only the built-in format decodes into the provided draw buffer, other fonts manage their own memory*/
+    if(font == NULL || font->get_glyph_bitmap != lv_font_get_bitmap_fmt_txt) return NULL;
+    if(g_dsc->format <= LV_FONT_GLYPH_FORMAT_NONE || g_dsc->format >= LV_FONT_GLYPH_FORMAT_IMAGE) return NULL;
+    if(!lv_font_glyph_cache_is_enabled()) return NULL;
+
+    LV_PROFILER_BEGIN;
+
+    uint32_t stride = lv_draw_buf_width_to_stride_ex(font_draw_buf_handlers, g_dsc->box_w, LV_COLOR_FORMAT_A8);
+
+    lv_font_glyph_cache_data_t search_key;
+    search_key.slot.size = sizeof(lv_draw_buf_t) + stride * g_dsc->box_h;
+    search_key.font = font;
+    search_key.letter = letter;
+    search_key.format = g_dsc->format;
+    search_key.draw_buf = NULL;
+
+    lv_cache_entry_t * entry = lv_cache_acquire(glyph_cache_p, &search_key, NULL);
+    if(entry) {
+        glyph_cache_stats.hits++;
+    }
+    else if(search_key.slot.size > lv_cache_get_max_size(glyph_cache_p, NULL)) {
+        /*Would never fit, don't let the cache evict everything else for it*/
+        glyph_cache_stats.bypassed++;
+    }
+    else {
+        entry = lv_cache_acquire_or_create(glyph_cache_p, &search_key, g_dsc);
+        if(entry) glyph_cache_stats.misses++;
+        else glyph_cache_stats.bypassed++;
+    }
+
+    if(entry == NULL) {
+        LV_PROFILER_END;
+        return NULL;
+    }
+
+    g_dsc->entry = entry;
+    lv_font_glyph_cache_data_t * data = lv_cache_entry_get_data(entry);
+
+    LV_PROFILER_END;
+    return data->draw_buf;
+}
+
+void lv_font_glyph_cache_release(lv_font_glyph_dsc_t * g_dsc)
+{
+    LV_ASSERT_NULL(g_dsc);
+
+    if(g_dsc->entry == NULL) return;
+
+    lv_cache_release(glyph_cache_p, g_dsc->entry, NULL);
+    g_dsc->entry = NULL;
+}
+
+void lv_font_glyph_cache_get_stats(lv_font_glyph_cache_stats_t * stats)
+{
+    LV_ASSERT_NULL(stats);
+    lv_memcpy(stats, &glyph_cache_stats, sizeof(lv_font_glyph_cache_stats_t));
+}
+
+void lv_font_glyph_cache_reset_stats(void)
+{
+    lv_memzero(&glyph_cache_stats, sizeof(lv_font_glyph_cache_stats_t));
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+static bool glyph_cache_create_cb(lv_font_glyph_cache_data_t * data, void * user_data)
+{
+    lv_font_glyph_dsc_t * g_dsc = (lv_font_glyph_dsc_t *)user_data;
+
+    data->draw_buf = lv_draw_buf_create_ex(font_draw_buf_handlers, g_dsc->box_w, g_dsc->box_h,
+                                           LV_COLOR_FORMAT_A8, LV_STRIDE_AUTO);
+    if(data->draw_buf == NULL) return false;
+
+    if(lv_font_get_glyph_bitmap(g_dsc, data->draw_buf) == NULL) {
+        lv_draw_buf_destroy(data->draw_buf);
+        data->draw_buf = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+static void glyph_cache_free_cb(lv_font_glyph_cache_data_t * data, void * user_data)
+{
+    LV_UNUSED(user_data);
+
+    if(data->draw_buf) lv_draw_buf_destroy(data->draw_buf);
+}
+
+static lv_cache_compare_res_t glyph_cache_compare_cb(const lv_font_glyph_cache_data_t * lhs,
+                                                     const lv_font_glyph_cache_data_t * rhs)
+{
+    if(lhs->font != rhs->font) {
+        return lhs->font > rhs->font ? 1 : -1;
+    }
+    if(lhs->letter != rhs->letter) {
+        return lhs->letter > rhs->letter ? 1 : -1;
+    }
+    if(lhs->format != rhs->format) {
+        return lhs->format > rhs->format ? 1 : -1;
+    }
+    return 0;
+}
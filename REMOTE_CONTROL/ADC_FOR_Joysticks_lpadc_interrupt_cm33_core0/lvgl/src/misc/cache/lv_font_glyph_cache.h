@@ -0,0 +1,113 @@
+/**
+* @file lv_font_glyph_cache.h
+*
+ */
+
+#ifndef LV_FONT_GLYPH_CACHE_H
+#define LV_FONT_GLYPH_CACHE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*********************
+ *      INCLUDES
+ *********************/
+
+#include "../../lv_conf_internal.h"
+#include "../lv_types.h"
+#include "../../font/lv_font.h"
+
+/*********************
+ *      DEFINES
+ *********************/
+
+/**********************
+ *      TYPEDEFS
+ **********************/
+
+/** Counters of the rendered-glyph cache. */
+typedef struct {
+    uint32_t hits;       /**< Glyph bitmaps served from the cache*/
+    uint32_t misses;     /**< Glyph bitmaps decoded from the font and added to the cache*/
+    uint32_t bypassed;   /**< Glyph bitmaps that could not be cached (too big, cache full of in-use entries)*/
+} lv_font_glyph_cache_stats_t;
+
+/**********************
+ * GLOBAL PROTOTYPES
+ **********************/
+
+/**
+ * Initialize the rendered-glyph cache.
+ * Decoded (A8) glyph bitmaps of bitmap fonts are kept here keyed by font, code point and bpp,
+ * so frequently redrawn glyphs are not decoded again on every refresh.
+ * @param  size size of the cache in bytes. 0 disables the cache.
+ * @return LV_RESULT_OK: initialization succeeded, LV_RESULT_INVALID: failed.
+ */
+lv_result_t lv_font_glyph_cache_init(uint32_t size);
+
+/**
+ * Free all cached glyphs and delete the cache.
+ */
+void lv_font_glyph_cache_deinit(void);
+
+/**
+ * Resize the glyph cache.
+ * If set to 0, the cache will be disabled.
+ * @param new_size  new size of the cache in bytes.
+ * @param evict_now true: evict the glyphs exceeding the new size now, false: wait for the next cache cleanup.
+ */
+void lv_font_glyph_cache_resize(uint32_t new_size, bool evict_now);
+
+/**
+ * Invalidate all cached glyphs, e.g. after a font was deleted.
+ */
+void lv_font_glyph_cache_drop_all(void);
+
+/**
+ * Return true if the glyph cache is enabled.
+ * @return true: enabled, false: disabled.
+ */
+bool lv_font_glyph_cache_is_enabled(void);
+
+/**
+ * Get the decoded bitmap of a glyph from the cache, decoding and adding it on a miss.
+ * On success the entry is stored in `g_dsc->entry` and has to be released with
+ * `lv_font_glyph_cache_release()` when the bitmap is not used anymore.
+ * @param g_dsc     glyph descriptor returned by `lv_font_get_glyph_dsc()`
+ * @param letter    the code point of the glyph
+ * @return          pointer to an A8 draw buffer, or NULL if the glyph can't be served by the cache.
+ *                  In the latter case the caller should decode the glyph itself.
+ */
+const void * lv_font_glyph_cache_acquire(lv_font_glyph_dsc_t * g_dsc, uint32_t letter);
+
+/**
+ * Release a glyph acquired by `lv_font_glyph_cache_acquire()`.
+ * @param g_dsc     the glyph descriptor passed to `lv_font_glyph_cache_acquire()`
+ */
+void lv_font_glyph_cache_release(lv_font_glyph_dsc_t * g_dsc);
+
+/**
+ * Get the hit/miss counters of the glyph cache.
+ * @param stats     store the counters here
+ */
+void lv_font_glyph_cache_get_stats(lv_font_glyph_cache_stats_t * stats);
+
+/**
+ * Reset the hit/miss counters of the glyph cache.
+ */
+void lv_font_glyph_cache_reset_stats(void);
+
+/*************************
+ *    GLOBAL VARIABLES
+ *************************/
+
+/**********************
+ *      MACROS
+ **********************/
+
+#ifdef __cplusplus
+} /*extern "C"*/
+#endif
+
+#endif /*LV_FONT_GLYPH_CACHE_H*/
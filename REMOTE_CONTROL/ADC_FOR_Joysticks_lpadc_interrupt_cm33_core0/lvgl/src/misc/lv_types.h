@@ -108,6 +108,7 @@ typedef struct lv_display_t lv_display_t;
 typedef struct lv_layer_t lv_layer_t;
 typedef struct lv_draw_unit_t lv_draw_unit_t;
 typedef struct lv_draw_task_t lv_draw_task_t;
+typedef struct lv_draw_task_graph_t lv_draw_task_graph_t;
 
 typedef struct lv_indev_t lv_indev_t;
 
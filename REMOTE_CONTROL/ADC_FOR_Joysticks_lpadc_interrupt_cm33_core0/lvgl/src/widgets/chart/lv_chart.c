@@ -25,6 +25,9 @@
 #define LV_CHART_POINT_CNT_DEF 10
 #define LV_CHART_LABEL_MAX_TEXT_LENGTH 16
 
+/*Separate index ranges invalidated by `lv_chart_set_next_values()` (e.g. the wrap-around)*/
+#define LV_CHART_INV_RANGE_MAX 4
+
 /**********************
  *      TYPEDEFS
  **********************/
@@ -43,6 +46,8 @@ static void draw_series_scatter(lv_obj_t * obj, lv_layer_t * layer);
 static void draw_cursors(lv_obj_t * obj, lv_layer_t * layer);
 static uint32_t get_index_from_x(lv_obj_t * obj, int32_t x);
 static void invalidate_point(lv_obj_t * obj, uint32_t i);
+static void invalidate_points(lv_obj_t * obj, uint32_t first, uint32_t last);
+static bool get_points_area(lv_obj_t * obj, uint32_t first, uint32_t last, lv_area_t * area);
 static void new_points_alloc(lv_obj_t * obj, lv_chart_series_t * ser, uint32_t cnt, int32_t ** a);
 
 /**********************
@@ -486,6 +491,67 @@ void lv_chart_set_next_value(lv_obj_t * obj, lv_chart_series_t * ser, int32_t va
     invalidate_point(obj, ser->start_point);
 }
 
+void lv_chart_set_next_values(lv_obj_t * obj, lv_chart_series_t * const ser[], const int32_t values[], uint32_t cnt)
+{
+    LV_ASSERT_OBJ(obj, MY_CLASS);
+    LV_ASSERT_NULL(ser);
+    LV_ASSERT_NULL(values);
+
+    lv_chart_t * chart  = (lv_chart_t *)obj;
+    uint32_t first[LV_CHART_INV_RANGE_MAX];
+    uint32_t last[LV_CHART_INV_RANGE_MAX];
+    uint32_t range_cnt = 0;
+    uint32_t i;
+    uint32_t r;
+
+    for(i = 0; i < cnt; i++) {
+        LV_ASSERT_NULL(ser[i]);
+        uint32_t id = ser[i]->start_point;
+        ser[i]->y_points[id] = values[i];
+        ser[i]->start_point = (id + 1) % chart->point_cnt;
+
+        /*The written point and the new start point (the gap) changed. They are adjacent unless the series wrapped*/
+        uint32_t span_first[2] = {id, ser[i]->start_point};
+        uint32_t span_last[2] = {ser[i]->start_point, ser[i]->start_point};
+        uint32_t span_cnt = 2;
+        if(ser[i]->start_point == id + 1) {
+            span_cnt = 1;
+        }
+        else {
+            span_last[0] = id;
+        }
+
+        uint32_t s;
+        for(s = 0; s < span_cnt; s++) {
+            /*Merge into a range it overlaps or touches, series usually advance in lockstep*/
+            for(r = 0; r < range_cnt; r++) {
+                if(span_first[s] <= last[r] + 1 && first[r] <= span_last[s] + 1) break;
+            }
+
+            if(r == range_cnt && range_cnt < LV_CHART_INV_RANGE_MAX) {
+                first[r] = span_first[s];
+                last[r] = span_last[s];
+                range_cnt++;
+            }
+            else {
+                if(r == range_cnt) r = range_cnt - 1;
+                first[r] = LV_MIN(first[r], span_first[s]);
+                last[r] = LV_MAX(last[r], span_last[s]);
+            }
+        }
+    }
+
+    /*In shift mode the whole chart changes anyway*/
+    if(chart->update_mode == LV_CHART_UPDATE_MODE_SHIFT || chart->type == LV_CHART_TYPE_SCATTER) {
+        if(cnt) lv_obj_invalidate(obj);
+        return;
+    }
+
+    for(r = 0; r < range_cnt; r++) {
+        invalidate_points(obj, first[r], last[r]);
+    }
+}
+
 void lv_chart_set_next_value2(lv_obj_t * obj, lv_chart_series_t * ser, int32_t x_value, int32_t y_value)
 {
     LV_ASSERT_OBJ(obj, MY_CLASS);
@@ -1251,11 +1317,16 @@ static uint32_t get_index_from_x(lv_obj_t * obj, int32_t x)
 
 static void invalidate_point(lv_obj_t * obj, uint32_t i)
 {
-    lv_chart_t * chart  = (lv_chart_t *)obj;
-    if(i >= chart->point_cnt) return;
+    invalidate_points(obj, i, i);
+}
 
-    int32_t w  = lv_obj_get_content_width(obj);
-    int32_t scroll_left = lv_obj_get_scroll_left(obj);
+/**
+ * Invalidate the part of the chart which shows the points `first`...`last`
+ */
+static void invalidate_points(lv_obj_t * obj, uint32_t first, uint32_t last)
+{
+    lv_chart_t * chart  = (lv_chart_t *)obj;
+    if(first >= chart->point_cnt) return;
 
     /*In shift mode the whole chart changes so the whole object*/
     if(chart->update_mode == LV_CHART_UPDATE_MODE_SHIFT) {
@@ -1263,32 +1334,48 @@ static void invalidate_point(lv_obj_t * obj, uint32_t i)
         return;
     }
 
+    if(chart->type == LV_CHART_TYPE_LINE || chart->type == LV_CHART_TYPE_BAR) {
+        lv_area_t coords;
+        if(get_points_area(obj, first, last, &coords)) lv_obj_invalidate_area(obj, &coords);
+    }
+    else {
+        lv_obj_invalidate(obj);
+    }
+}
+
+/**
+ * Get the columns of a line or bar chart affected by the points `first`...`last`.
+ * On a line chart it includes the line segments leading into and out of the points.
+ * @return false if there is nothing to invalidate
+ */
+static bool get_points_area(lv_obj_t * obj, uint32_t first, uint32_t last, lv_area_t * area)
+{
+    lv_chart_t * chart  = (lv_chart_t *)obj;
+    if(last >= chart->point_cnt) last = chart->point_cnt - 1;
+
+    int32_t w  = lv_obj_get_content_width(obj);
+    int32_t scroll_left = lv_obj_get_scroll_left(obj);
+
     if(chart->type == LV_CHART_TYPE_LINE) {
+        if(chart->point_cnt < 2) return false;
+
         int32_t bwidth = lv_obj_get_style_border_width(obj, LV_PART_MAIN);
         int32_t pleft = lv_obj_get_style_pad_left(obj, LV_PART_MAIN);
         int32_t x_ofs = obj->coords.x1 + pleft + bwidth - scroll_left;
         int32_t line_width = lv_obj_get_style_line_width(obj, LV_PART_ITEMS);
         int32_t point_w = lv_obj_get_style_width(obj, LV_PART_INDICATOR);
 
-        lv_area_t coords;
-        lv_area_copy(&coords, &obj->coords);
-        coords.y1 -= line_width + point_w;
-        coords.y2 += line_width + point_w;
-
-        if(i < chart->point_cnt - 1) {
-            coords.x1 = ((w * i) / (chart->point_cnt - 1)) + x_ofs - line_width - point_w;
-            coords.x2 = ((w * (i + 1)) / (chart->point_cnt - 1)) + x_ofs + line_width + point_w;
-            lv_obj_invalidate_area(obj, &coords);
-        }
+        uint32_t seg_first = first > 0 ? first - 1 : 0;
+        uint32_t seg_last = last < chart->point_cnt - 1 ? last + 1 : chart->point_cnt - 1;
 
-        if(i > 0) {
-            coords.x1 = ((w * (i - 1)) / (chart->point_cnt - 1)) + x_ofs - line_width - point_w;
-            coords.x2 = ((w * i) / (chart->point_cnt - 1)) + x_ofs + line_width + point_w;
-            lv_obj_invalidate_area(obj, &coords);
-        }
+        lv_area_copy(area, &obj->coords);
+        area->y1 -= line_width + point_w;
+        area->y2 += line_width + point_w;
+        area->x1 = ((w * (int32_t)seg_first) / (int32_t)(chart->point_cnt - 1)) + x_ofs - line_width - point_w;
+        area->x2 = ((w * (int32_t)seg_last) / (int32_t)(chart->point_cnt - 1)) + x_ofs + line_width + point_w;
+        return true;
     }
-    else if(chart->type == LV_CHART_TYPE_BAR) {
-        lv_area_t col_a;
+    else {
         /*Gap between the column on ~adjacent X*/
         int32_t block_gap = lv_obj_get_style_pad_column(obj, LV_PART_MAIN);
 
@@ -1296,18 +1383,12 @@ static void invalidate_point(lv_obj_t * obj, uint32_t i)
 
         int32_t bwidth = lv_obj_get_style_border_width(obj, LV_PART_MAIN);
         int32_t x_act;
-        x_act = (int32_t)((int32_t)(block_w) * i) ;
-        x_act += obj->coords.x1 + bwidth + lv_obj_get_style_pad_left(obj, LV_PART_MAIN);
-
-        lv_obj_get_coords(obj, &col_a);
-        col_a.x1 = x_act - scroll_left;
-        col_a.x2 = col_a.x1 + block_w;
-        col_a.x1 -= block_gap;
+        x_act = obj->coords.x1 + bwidth + lv_obj_get_style_pad_left(obj, LV_PART_MAIN) - scroll_left;
 
-        lv_obj_invalidate_area(obj, &col_a);
-    }
-    else {
-        lv_obj_invalidate(obj);
+        lv_obj_get_coords(obj, area);
+        area->x1 = x_act + block_w * (int32_t)first - block_gap;
+        area->x2 = x_act + block_w * (int32_t)last + block_w;
+        return true;
     }
 }
 
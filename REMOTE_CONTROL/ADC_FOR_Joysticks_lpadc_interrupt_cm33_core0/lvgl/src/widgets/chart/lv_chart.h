@@ -266,6 +266,17 @@ void lv_chart_set_all_value(lv_obj_t * obj, lv_chart_series_t * ser, int32_t val
  */
 void lv_chart_set_next_value(lv_obj_t * obj, lv_chart_series_t * ser, int32_t value);
 
+/**
+ * Append one Y value to several series at once, according to the update mode policy.
+ * Same as calling `lv_chart_set_next_value()` for each series, but the changed columns are
+ * invalidated only once, as a single area when the series advance together.
+ * @param obj       pointer to chart object
+ * @param ser       array of `cnt` data series on 'chart'
+ * @param values    array of `cnt` values, `values[i]` is appended to `ser[i]`
+ * @param cnt       number of series
+ */
+void lv_chart_set_next_values(lv_obj_t * obj, lv_chart_series_t * const ser[], const int32_t values[], uint32_t cnt);
+
 /**
  * Set the next point's X and Y value according to the update mode policy.
  * @param obj       pointer to chart object
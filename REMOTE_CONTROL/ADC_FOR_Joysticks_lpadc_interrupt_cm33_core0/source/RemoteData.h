@@ -10,18 +10,10 @@
 
 #include <stdint.h>
 
-#define REMOTE_PACKET_HEADER 0xC5
+/* RemoteCommand_t (Remote MCXN947 -> Remote ESP32, 24 bytes) and the frame
+ * header are shared with the robot and the bridges: COMMON/omni_wire.h */
+#include "omni_wire.h"
 
-/* * Structure sent from Remote MCXN947 -> Remote ESP32
- * Size: 24 Bytes (Fits within ESP_SPI_TRANSFER_SIZE = 40)
- */
-typedef struct __attribute__((packed)) {
-    uint32_t header;        // 0xC5 + Packet Counter
-    float vx;               // Linear Velocity X (m/s)
-    float vy;               // Linear Velocity Y (m/s)
-    float phi;              // Angular Velocity (rad/s)
-    uint32_t buttons;       // Button states (bitmask)
-    uint32_t timestamp;     // Time reference
-} RemoteCommand_t;
+#define REMOTE_PACKET_HEADER OMNI_WIRE_TYPE_COMMAND
 
 #endif /* REMOTE_DATA_H_ */
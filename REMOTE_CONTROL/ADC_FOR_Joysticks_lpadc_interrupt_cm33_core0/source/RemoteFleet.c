@@ -0,0 +1,115 @@
+/*
+ * RemoteFleet.c
+ *
+ * Main loop only: the exchange callbacks just stamp t4, the frames are read
+ * here once the exchanges are done, so nothing is shared with an interrupt.
+ */
+
+#include "RemoteFleet.h"
+#include "fsl_debug_console.h"
+#include <string.h>
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static remote_fleet_robot_t s_fleet[REMOTE_FLEET_MAX];
+static uint64_t s_reportUs;
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void RemoteFleet_Init(void)
+{
+    memset(s_fleet, 0, sizeof(s_fleet));
+    for (uint32_t i = 0; i < REMOTE_FLEET_MAX; i++)
+    {
+        omni_sync_init(&s_fleet[i].sync);
+    }
+    s_reportUs = 0U;
+}
+
+void RemoteFleet_Sent(uint8_t id, uint16_t count, uint64_t t1)
+{
+    if (id < REMOTE_FLEET_MAX)
+    {
+        omni_sync_sent(&s_fleet[id].sync, count, t1);
+    }
+}
+
+bool RemoteFleet_Receive(const uint8_t *rx, uint32_t size, uint64_t t4)
+{
+    const RobotTelemetry_t *tel = omni_wire_telemetry(rx, size);
+    uint8_t id = omni_wire_fleet_id(rx, size);
+
+    if (tel == NULL || t4 == 0U || id >= REMOTE_FLEET_MAX)
+    {
+        return false;
+    }
+
+    remote_fleet_robot_t *robot = &s_fleet[id];
+
+    /* The bridge hands each frame out once; a repeat would be the same robot counter */
+    if (robot->rxUs != 0U && tel->packet_header == robot->tel.packet_header)
+    {
+        return false;
+    }
+    memcpy(&robot->tel, tel, sizeof(RobotTelemetry_t));
+    robot->rxUs = t4;
+    robot->frames++;
+    (void)omni_sync_receive(&robot->sync, tel, t4);
+    return true;
+}
+
+uint32_t RemoteFleet_Online(uint64_t nowUs, uint8_t *ids)
+{
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < REMOTE_FLEET_MAX; i++)
+    {
+        if (s_fleet[i].rxUs != 0U && nowUs - s_fleet[i].rxUs < REMOTE_FLEET_TIMEOUT_US)
+        {
+            ids[n++] = (uint8_t)i;
+        }
+    }
+    return n;
+}
+
+const remote_fleet_robot_t *RemoteFleet_Get(uint8_t id)
+{
+    return (id < REMOTE_FLEET_MAX) ? &s_fleet[id] : NULL;
+}
+
+void RemoteFleet_Report(uint64_t nowUs)
+{
+    uint8_t ids[REMOTE_FLEET_MAX];
+    uint32_t online = RemoteFleet_Online(nowUs, ids);
+    uint64_t spanUs = nowUs - s_reportUs;
+
+    PRINTF("Fleet: %lu robots online\r\n", (unsigned long)online);
+    for (uint32_t i = 0; i < online; i++)
+    {
+        remote_fleet_robot_t *robot = &s_fleet[ids[i]];
+        const RobotTelemetry_t *tel = &robot->tel;
+        uint32_t rate = (s_reportUs != 0U && spanUs != 0U)
+                            ? (uint32_t)((uint64_t)(robot->frames - robot->reportFrames) * 1000000U / spanUs)
+                            : 0U;
+        omni_sync_estimate_t est;
+
+        PRINTF("  robot %u: %lu telemetry/s, age %lu us, wheels %ld %ld %ld %ld mrad/s", (unsigned)ids[i],
+               (unsigned long)rate, (unsigned long)(nowUs - robot->rxUs), (long)(tel->speed_m1 * 1000.0f),
+               (long)(tel->speed_m2 * 1000.0f), (long)(tel->speed_m3 * 1000.0f), (long)(tel->speed_m4 * 1000.0f));
+        if (omni_sync_get(&robot->sync, nowUs, &est))
+        {
+            PRINTF(", clock %ld us +/- %lu us, one-way cmd %ld us", (long)est.offset_us, (unsigned long)est.bound_us,
+                   (long)robot->sync.cmd_latency_us);
+        }
+        PRINTF("\r\n");
+    }
+
+    for (uint32_t i = 0; i < REMOTE_FLEET_MAX; i++)
+    {
+        s_fleet[i].reportFrames = s_fleet[i].frames;
+    }
+    s_reportUs = nowUs;
+}
@@ -0,0 +1,75 @@
+/*
+ * RemoteFleet.h
+ *
+ * Fleet telemetry of the remote (fleet mode of the bridges, fleet_link.h).
+ * The remote bridge returns the telemetry of every robot on MISO, one frame
+ * per exchange, each with the fleet tag of its robot (omni_wire.h). This keeps the newest frame,
+ * the rate and a clock sync estimator (omni_sync.h) per robot, and tells the
+ * main loop which robots are online, so it only addresses those.
+ */
+
+#ifndef REMOTE_FLEET_H_
+#define REMOTE_FLEET_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "RemoteData.h"
+#include "omni_sync.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define REMOTE_FLEET_MAX            16U         /* FLEET_MAX_ROBOTS of the bridges */
+#define REMOTE_FLEET_TIMEOUT_US     500000U     /* Offline after this long without telemetry */
+
+typedef struct {
+    RobotTelemetry_t tel;       /* Newest telemetry */
+    uint64_t rxUs;              /* When it came in (t4), 0 = never */
+    uint32_t frames;            /* Telemetry frames received */
+    uint32_t reportFrames;      /* frames at the last report */
+    omni_sync_t sync;           /* Robot clock vs ours */
+} remote_fleet_robot_t;
+
+/*******************************************************************************
+ * API Prototypes
+ ******************************************************************************/
+
+/*!
+ * @brief Forget all robots.
+ */
+void RemoteFleet_Init(void);
+
+/*!
+ * @brief A command for robot `id` goes out at t1 (clock sync, see omni_sync_sent()).
+ */
+void RemoteFleet_Sent(uint8_t id, uint16_t count, uint64_t t1);
+
+/*!
+ * @brief Feed the MISO data of one exchange.
+ *
+ * @param rx   Received bytes, may be an idle bus (no telemetry waiting at the bridge).
+ * @param size Bytes clocked.
+ * @param t4   When the exchange finished, 0 if it failed.
+ * @return true if it was new telemetry of a robot.
+ */
+bool RemoteFleet_Receive(const uint8_t *rx, uint32_t size, uint64_t t4);
+
+/*!
+ * @brief Robots heard from within REMOTE_FLEET_TIMEOUT_US.
+ *
+ * @param ids Receives their ids, REMOTE_FLEET_MAX entries.
+ * @return Number of robots online.
+ */
+uint32_t RemoteFleet_Online(uint64_t nowUs, uint8_t *ids);
+
+/*!
+ * @brief Entry of robot `id`, NULL if the id is out of range.
+ */
+const remote_fleet_robot_t *RemoteFleet_Get(uint8_t id);
+
+/*!
+ * @brief Print one line per robot on the debug console (integers only).
+ */
+void RemoteFleet_Report(uint64_t nowUs);
+
+#endif /* REMOTE_FLEET_H_ */
@@ -0,0 +1,247 @@
+/*
+ * RemoteGains.c
+ *
+ * Main loop only. The console is read byte by byte from the debug LPUART's
+ * data register, the debug console's own input would block.
+ */
+
+#include "RemoteGains.h"
+#include "fsl_debug_console.h"
+#include "fsl_lpuart.h"
+#include "board.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define REMOTE_GAINS_UART           ((LPUART_Type *)BOARD_DEBUG_UART_BASEADDR)
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+static omni_gain_table_t s_table;
+static uint8_t s_dirty;             /* Points still to send, bit per point */
+static bool s_inFlight;             /* s_point went out as s_seq, not echoed yet */
+static uint8_t s_point;
+static uint8_t s_seq;
+static uint16_t s_sentCount;        /* Header counter it last went out with */
+static uint32_t s_waitLoops;        /* Since it last went out */
+
+static char s_line[REMOTE_GAINS_LINE_MAX];
+static uint32_t s_lineLen;
+static bool s_lineTooLong;
+
+static const omni_gain_table_t s_default = {
+    .points = OMNI_GAINS_DEFAULT_POINTS,
+    .point = OMNI_GAINS_DEFAULT_TABLE,
+};
+
+/*******************************************************************************
+ * Helpers
+ ******************************************************************************/
+
+/* Integers only: the console's printf has no float */
+static void PrintTable(void)
+{
+    PRINTF("Gains: %u points%s\r\n", (unsigned)s_table.points,
+           omni_gains_valid(&s_table) ? "" : " (invalid, the robot keeps its last valid table)");
+    for (uint32_t i = 0; i < s_table.points; i++)
+    {
+        const omni_gain_point_t *p = &s_table.point[i];
+        PRINTF("  %lu: %ld mrad/s Kp %ld Ki %ld Kd/1000 %ld%s\r\n", (unsigned long)i, (long)(p->speed * 1000.0f),
+               (long)p->kp, (long)p->ki, (long)(p->kd * 1000.0f), (s_dirty & (1U << i)) ? " (unsent)" : "");
+    }
+}
+
+/* All of them: each frame carries the point count too */
+static void SendAll(void)
+{
+    s_dirty = (uint8_t)((1U << s_table.points) - 1U);
+}
+
+/* The table changed: the point in flight may carry old values, it goes again with a new seq */
+static void Changed(void)
+{
+    s_inFlight = false;
+    PrintTable();
+}
+
+static void RunLine(char *line)
+{
+    char *end;
+    char *arg[6];
+    uint32_t n = 0;
+
+    for (char *tok = strtok(line, " \t"); tok != NULL && n < 6U; tok = strtok(NULL, " \t"))
+    {
+        arg[n++] = tok;
+    }
+    if (n == 0U)
+    {
+        return;
+    }
+
+    if (strcmp(arg[0], "gains") == 0 && n == 1U)
+    {
+        PrintTable();
+    }
+    else if (strcmp(arg[0], "gains") == 0 && n == 2U && strcmp(arg[1], "send") == 0)
+    {
+        SendAll();
+        Changed();
+    }
+    else if (strcmp(arg[0], "gains") == 0 && n == 2U)
+    {
+        unsigned long points = strtoul(arg[1], &end, 10);
+        if (*end != '\0' || points == 0U || points > OMNI_GAINS_MAX_POINTS)
+        {
+            PRINTF("Gains: 1..%u points\r\n", (unsigned)OMNI_GAINS_MAX_POINTS);
+            return;
+        }
+        s_table.points = (uint8_t)points;
+        SendAll();
+        Changed();
+    }
+    else if (strcmp(arg[0], "gain") == 0 && n == 6U)
+    {
+        float v[4];
+        unsigned long i = strtoul(arg[1], &end, 10);
+        bool ok = (*end == '\0' && i <= s_table.points && i < OMNI_GAINS_MAX_POINTS);
+
+        for (uint32_t k = 0; k < 4U && ok; k++)
+        {
+            v[k] = strtof(arg[2U + k], &end);
+            ok = (*end == '\0');
+        }
+        if (!ok)
+        {
+            PRINTF("Gains: gain I SPEED KP KI KD, I up to %u\r\n", (unsigned)s_table.points);
+            return;
+        }
+        if (i == s_table.points)
+        {
+            s_table.points++;
+            SendAll();
+        }
+        s_table.point[i].speed = v[0];
+        s_table.point[i].kp = v[1];
+        s_table.point[i].ki = v[2];
+        s_table.point[i].kd = v[3];
+        s_dirty |= (uint8_t)(1U << i);
+        Changed();
+    }
+    else
+    {
+        PRINTF("Gains: gains | gains N | gains send | gain I SPEED KP KI KD\r\n");
+    }
+}
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void RemoteGains_Init(void)
+{
+    s_table = s_default;
+    s_dirty = 0U;
+    s_inFlight = false;
+    s_seq = 0U;
+    s_lineLen = 0U;
+    s_lineTooLong = false;
+}
+
+void RemoteGains_Poll(void)
+{
+    uint32_t flags = LPUART_GetStatusFlags(REMOTE_GAINS_UART);
+
+    /* An overrun stops the receiver until it is cleared; the line is lost anyway */
+    if ((flags & (uint32_t)kLPUART_RxOverrunFlag) != 0U)
+    {
+        (void)LPUART_ClearStatusFlags(REMOTE_GAINS_UART, (uint32_t)kLPUART_RxOverrunFlag);
+        s_lineTooLong = true;
+    }
+
+    while ((LPUART_GetStatusFlags(REMOTE_GAINS_UART) & (uint32_t)kLPUART_RxDataRegFullFlag) != 0U)
+    {
+        char c = (char)LPUART_ReadByte(REMOTE_GAINS_UART);
+
+        if (c == '\r' || c == '\n')
+        {
+            if (!s_lineTooLong && s_lineLen != 0U)
+            {
+                s_line[s_lineLen] = '\0';
+                RunLine(s_line);
+            }
+            s_lineLen = 0U;
+            s_lineTooLong = false;
+        }
+        else if (c == '\b' || c == 0x7F)
+        {
+            if (s_lineLen != 0U)
+            {
+                s_lineLen--;
+            }
+        }
+        else if (s_lineLen + 1U < REMOTE_GAINS_LINE_MAX)
+        {
+            s_line[s_lineLen++] = c;
+        }
+        else
+        {
+            s_lineTooLong = true;
+        }
+    }
+}
+
+void RemoteGains_Receive(const RobotTelemetry_t *tel)
+{
+    /* The robot echoes a gain point like a command until the next command lands; an
+     * echo of an earlier copy that came too late only costs one more resend */
+    if (!s_inFlight || tel->sync_cmd_count != s_sentCount)
+    {
+        return;
+    }
+    s_inFlight = false;
+    s_dirty &= (uint8_t)~(1U << s_point);
+    if (s_dirty == 0U)
+    {
+        PRINTF("Gains: robot has the table\r\n");
+    }
+}
+
+bool RemoteGains_Frame(uint8_t *frame, uint32_t counter)
+{
+    RemoteGainPoint_t *out = (RemoteGainPoint_t *)frame;
+
+    if (!s_inFlight)
+    {
+        if (s_dirty == 0U)
+        {
+            return false;
+        }
+        /* Lowest point first, under a new seq: the robot takes each seq once */
+        for (s_point = 0U; (s_dirty & (1U << s_point)) == 0U; s_point++)
+        {
+        }
+        s_seq = (uint8_t)(s_seq + 1U);
+        s_inFlight = true;
+    }
+    else if (++s_waitLoops < REMOTE_GAINS_RESEND_LOOPS)
+    {
+        return false;
+    }
+    s_waitLoops = 0U;
+    s_sentCount = (uint16_t)counter;
+
+    memset(out, 0, sizeof(RemoteGainPoint_t));
+    out->header = OMNI_WIRE_HEADER(OMNI_WIRE_TYPE_GAINS, counter, sizeof(RemoteGainPoint_t));
+    out->seq = s_seq;
+    out->index = s_point;
+    out->points = s_table.points;
+    out->speed = s_table.point[s_point].speed;
+    out->kp = s_table.point[s_point].kp;
+    out->ki = s_table.point[s_point].ki;
+    out->kd = s_table.point[s_point].kd;
+    return true;
+}
@@ -0,0 +1,65 @@
+/*
+ * RemoteGains.h
+ *
+ * The robot's wheel PID gain table (omni_gains.h), changed from the debug
+ * console of the remote and sent to the robot one point per frame:
+ *
+ *   gains                          print the table and what is still unsent
+ *   gain I SPEED KP KI KD          set point I (I = points adds one)
+ *   gains N                        use the first N points
+ *   gains send                     send the whole table again (robot rebooted)
+ *
+ * A point goes out in place of a command every REMOTE_GAINS_RESEND_LOOPS
+ * loops until the robot's telemetry echoes its frame counter in
+ * sync_cmd_count (as for a command), then the next one
+ * (stop and wait). The remote starts from the same default table as the
+ * robot, so only the points typed in are sent.
+ *
+ * Classic link only: the fleet beacons carry commands, not gain points.
+ */
+
+#ifndef REMOTE_GAINS_H_
+#define REMOTE_GAINS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "RemoteData.h"
+#include "omni_gains.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define REMOTE_GAINS_RESEND_LOOPS   4U          /* 20 ms: the frame's round trip with margin */
+#define REMOTE_GAINS_LINE_MAX       64U         /* Console line, longer ones are dropped */
+
+/*******************************************************************************
+ * API Prototypes
+ ******************************************************************************/
+
+/*!
+ * @brief Start from the default table, nothing to send.
+ */
+void RemoteGains_Init(void);
+
+/*!
+ * @brief Read what was typed on the debug console, never waits.
+ *
+ * A complete line is run as one of the commands above.
+ */
+void RemoteGains_Poll(void);
+
+/*!
+ * @brief Telemetry of the robot: takes the point in flight off the list once echoed.
+ */
+void RemoteGains_Receive(const RobotTelemetry_t *tel);
+
+/*!
+ * @brief Gain point to send in this exchange instead of the command.
+ *
+ * @param frame   Receives the RemoteGainPoint_t.
+ * @param counter Frame counter of the header.
+ * @return false if the command goes out (nothing to send, or not yet time to resend).
+ */
+bool RemoteGains_Frame(uint8_t *frame, uint32_t counter);
+
+#endif /* REMOTE_GAINS_H_ */
@@ -0,0 +1,128 @@
+/*
+ * RemoteGuiCore1.c
+ *
+ * GUI loop of the remote when it runs on the second Cortex-M33 core
+ * (REMOTE_GUI_ON_CORE1). Built only by the cm33_core1 companion project,
+ * which is linked to REMOTE_CORE1_BOOT_ADDR and compiled without FPU
+ * (core1 of the MCXN947 has none). Clocks and pins, including the ST7796
+ * ones, are already configured by core0 before it releases core1.
+ */
+
+#if defined(CPU_MCXN947VDF_cm33_core1) || defined(CPU_MCXN947VKL_cm33_core1) || \
+    defined(CPU_MCXN947VNL_cm33_core1) || defined(CPU_MCXN947VPB_cm33_core1)
+
+#include "fsl_common.h"
+#include "RemoteMailbox.h"
+#include "lvgl_support.h"
+#include "lvgl.h"
+#include "RobotGUI.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define GUI_INIT_POLL_MS      5U    /* Panel reset steps polled this often */
+#define GUI_REFRESH_MS        50U   /* Charts and labels at ~20Hz, same as the single core build */
+#define GUI_MAX_SLEEP_MS      100U  /* Heartbeat (RemoteMailbox_GuiAlive) at least this often */
+
+/*******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+
+/* LVGL time base: CTIMER4, core0's 1 MHz us clock (TIMER_DRIVER.c, started before
+ * core1 is), widened here like us_clock_now(); only this loop reads it */
+static uint32_t GuiTickMs(void)
+{
+    static uint32_t high = 0;
+    static uint32_t last = 0;
+    uint32_t low = CTIMER4->TC;
+
+    if (low < last)
+    {
+        high++;
+    }
+    last = low;
+    return (uint32_t)((((uint64_t)high << 32) | low) / 1000U);
+}
+
+/* Core1's own SysTick is the wake-up of GuiSleepMs(), one shot */
+void SysTick_Handler(void)
+{
+    SysTick->CTRL = 0U;
+}
+
+/* WFI for ms, or less: any core1 interrupt (display transfer done) ends it, and
+ * SysTick counts at most 2^24 core clocks (111 ms at 150 MHz) */
+static void GuiSleepMs(uint32_t ms)
+{
+    uint64_t ticks = (uint64_t)ms * (SystemCoreClock / 1000U);
+
+    if (ticks == 0U)
+    {
+        return;
+    }
+    if (ticks > SysTick_LOAD_RELOAD_Msk)
+    {
+        ticks = SysTick_LOAD_RELOAD_Msk;
+    }
+    SysTick->LOAD = (uint32_t)ticks - 1U;
+    SysTick->VAL = 0U;
+    SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk | SysTick_CTRL_ENABLE_Msk;
+    __DSB();
+    __WFI();
+    SysTick->CTRL = 0U;
+}
+
+/*******************************************************************************
+ * Main
+ ******************************************************************************/
+int main(void)
+{
+    RemoteCommand_t cmd;
+    uint32_t cmd_seq = 0;
+    uint32_t refreshMs;
+    bool panelReady = false;
+
+    /* Panel reset waits run behind the LVGL init and the loop, on the LVGL tick */
+    lv_init();
+    lv_tick_set_cb(GuiTickMs);
+    ST7796_InitStart(lv_tick_get() * 1000U);
+    lv_port_disp_init();
+    RobotGUI_Init();
+    refreshMs = lv_tick_get();
+
+    while (1)
+    {
+        uint32_t sleepMs = GUI_MAX_SLEEP_MS;
+
+        RemoteMailbox_GuiAlive();
+
+        if (!panelReady)
+        {
+            panelReady = (ST7796_InitPoll(lv_tick_get() * 1000U) == 0U);
+            sleepMs = GUI_INIT_POLL_MS;
+        }
+
+        /* Only the latest command matters, older ones were simply overwritten */
+        uint32_t sinceRefresh = lv_tick_elaps(refreshMs);
+        if (sinceRefresh >= GUI_REFRESH_MS)
+        {
+            if (RemoteMailbox_Read(&cmd, &cmd_seq))
+            {
+                RobotGUI_Update(cmd.vx, cmd.vy, cmd.phi);
+            }
+            refreshMs = lv_tick_get();
+            sinceRefresh = 0;
+        }
+        sleepMs = MIN(sleepMs, GUI_REFRESH_MS - sinceRefresh);
+
+        /* LVGL says when its next timer (refresh, animation) is due, sleep until then */
+        if (panelReady)
+        {
+            lv_timer_handler();
+            sleepMs = MIN(sleepMs, lv_timer_get_time_until_next());
+        }
+        GuiSleepMs(sleepMs);
+    }
+}
+
+#endif /* cm33_core1 */
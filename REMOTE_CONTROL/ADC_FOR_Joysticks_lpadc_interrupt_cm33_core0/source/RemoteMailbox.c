@@ -0,0 +1,96 @@
+/*
+ * RemoteMailbox.c
+ *
+ * Single writer / single reader sequence lock. The writer makes the counter
+ * odd, copies the command and makes it even again; the reader copies the
+ * command between two reads of the counter and retries if they differ or are
+ * odd. Shared SRAM is not cached on the MCXN947, the barriers only have to
+ * keep the bus order.
+ */
+
+#include "RemoteMailbox.h"
+#include <string.h>
+
+#if defined(__arm__)
+#include "fsl_device_registers.h"
+#define MAILBOX_BARRIER()   __DMB()
+#else
+/* Host build: the two cores are modelled as two threads */
+#define MAILBOX_BARRIER()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+#if defined(REMOTE_MAILBOX_ADDR)
+#define s_mailbox (*(RemoteMailbox_t *)REMOTE_MAILBOX_ADDR)
+#else
+static RemoteMailbox_t s_mailbox;
+#endif
+
+/*******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void RemoteMailbox_Init(void)
+{
+    memset((void *)&s_mailbox, 0, sizeof(RemoteMailbox_t));
+    MAILBOX_BARRIER();
+}
+
+void RemoteMailbox_Publish(const RemoteCommand_t *cmd)
+{
+    uint32_t seq = s_mailbox.seq;
+
+    s_mailbox.seq = seq + 1U;
+    MAILBOX_BARRIER();
+
+    memcpy((void *)&s_mailbox.cmd, cmd, sizeof(RemoteCommand_t));
+
+    MAILBOX_BARRIER();
+    s_mailbox.seq = seq + 2U;
+}
+
+bool RemoteMailbox_Read(RemoteCommand_t *cmd, uint32_t *lastSeq)
+{
+    uint32_t start;
+    uint32_t end;
+
+    do
+    {
+        start = s_mailbox.seq;
+        MAILBOX_BARRIER();
+
+        memcpy(cmd, (const void *)&s_mailbox.cmd, sizeof(RemoteCommand_t));
+
+        MAILBOX_BARRIER();
+        end = s_mailbox.seq;
+    } while ((start & 1U) || (start != end));
+
+    if (lastSeq == NULL)
+    {
+        return start != 0U;
+    }
+
+    bool fresh = (start != *lastSeq);
+    *lastSeq = start;
+    return fresh;
+}
+
+void RemoteMailbox_GuiAlive(void)
+{
+    if (s_mailbox.guiMagic != REMOTE_MAILBOX_MAGIC)
+    {
+        s_mailbox.guiMagic = REMOTE_MAILBOX_MAGIC;
+    }
+    s_mailbox.guiFrames++;
+}
+
+uint32_t RemoteMailbox_GetGuiFrames(void)
+{
+    if (s_mailbox.guiMagic != REMOTE_MAILBOX_MAGIC)
+    {
+        return 0U;
+    }
+    return s_mailbox.guiFrames;
+}
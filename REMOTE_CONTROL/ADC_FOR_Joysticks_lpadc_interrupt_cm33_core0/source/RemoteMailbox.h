@@ -0,0 +1,80 @@
+/*
+ * RemoteMailbox.h
+ *
+ * Lock-free command mailbox between the two Cortex-M33 cores of the remote.
+ * Core0 (ADC + SPI) is the only writer of the command, core1 (LVGL) only reads
+ * it, so a sequence counter is enough: no locks, no HW semaphore, and a slow
+ * GUI frame can never stall the command path.
+ */
+
+#ifndef REMOTE_MAILBOX_H_
+#define REMOTE_MAILBOX_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "RemoteData.h"
+
+/*******************************************************************************
+ * Definitions
+ ******************************************************************************/
+/*
+ * Shared SRAM used by the mailbox. Both the core0 and the core1 project must
+ * leave it out of their RAM regions (start of RAMH by default).
+ * Host builds don't define it and use a static instance instead.
+ */
+#if !defined(REMOTE_MAILBOX_ADDR) && defined(__arm__)
+#define REMOTE_MAILBOX_ADDR       0x20060000U
+#endif
+
+#define REMOTE_MAILBOX_MAGIC      0x52434D42U /* "RCMB" */
+
+typedef struct {
+    /* Written by core0 */
+    volatile uint32_t seq;          /* Odd while the command is being written */
+    RemoteCommand_t cmd;
+
+    /* Written by core1 */
+    volatile uint32_t guiMagic;     /* REMOTE_MAILBOX_MAGIC once the GUI is running */
+    volatile uint32_t guiFrames;    /* Incremented on every GUI loop, used as a heartbeat */
+} RemoteMailbox_t;
+
+/*******************************************************************************
+ * API Prototypes
+ ******************************************************************************/
+
+/*!
+ * @brief Clear the mailbox. Must be called by core0 before core1 is started.
+ */
+void RemoteMailbox_Init(void);
+
+/*!
+ * @brief Publish the latest command (core0 only). Never blocks.
+ *
+ * @param cmd Command to copy into the mailbox.
+ */
+void RemoteMailbox_Publish(const RemoteCommand_t *cmd);
+
+/*!
+ * @brief Read the latest command (core1 only).
+ *
+ * Retries while core0 is in the middle of a write, so the copy is never torn.
+ *
+ * @param cmd     Destination of the command.
+ * @param lastSeq Sequence of the previous read, updated on return. May be NULL.
+ * @return true if a command newer than lastSeq was read, false otherwise.
+ */
+bool RemoteMailbox_Read(RemoteCommand_t *cmd, uint32_t *lastSeq);
+
+/*!
+ * @brief Mark the GUI as running and bump its heartbeat (core1 only).
+ */
+void RemoteMailbox_GuiAlive(void);
+
+/*!
+ * @brief Get the GUI heartbeat (core0).
+ *
+ * @return Number of GUI loops since start, 0 if the GUI core is not running.
+ */
+uint32_t RemoteMailbox_GetGuiFrames(void);
+
+#endif /* REMOTE_MAILBOX_H_ */
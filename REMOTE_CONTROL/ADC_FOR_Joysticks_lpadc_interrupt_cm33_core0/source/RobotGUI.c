@@ -113,9 +113,14 @@ void RobotGUI_Update(float vx, float vy, float phi)
 
     /* 1. Update Chart Series */
     /* Multiply by 100 to convert float 0.50 -> integer 50 for charting */
-    lv_chart_set_next_value(chart, ser_vx,  (int32_t)(vx * 100));
-    lv_chart_set_next_value(chart, ser_vy,  (int32_t)(vy * 100));
-    lv_chart_set_next_value(chart, ser_phi, (int32_t)(phi * 20)); // Scale Phi differently if needed
+    /* All three series in one call: the chart is invalidated once instead of per series */
+    lv_chart_series_t * const series[3] = { ser_vx, ser_vy, ser_phi };
+    int32_t values[3] = {
+        (int32_t)(vx * 100),
+        (int32_t)(vy * 100),
+        (int32_t)(phi * 20) // Scale Phi differently if needed
+    };
+    lv_chart_set_next_values(chart, series, values, 3);
 
     /* 2. Update Text Labels */
     /* Use static buffers to avoid heap fragmentation if using small libc */
@@ -6,6 +6,22 @@
 #include "ST7796_MCX.h"
 #include "board.h"
 
+/*******************************************************************************
+ * Variables
+ ******************************************************************************/
+/* Power-up sequence, one step per wait of the datasheet */
+typedef enum {
+    ST7796_INIT_RESET_LOW,      /* RST low 10 ms */
+    ST7796_INIT_RESET_HIGH,     /* 120 ms after the hard reset */
+    ST7796_INIT_SW_RESET,       /* 120 ms after SW Reset */
+    ST7796_INIT_SLEEP_OUT,      /* 120 ms after Sleep Out */
+    ST7796_INIT_DISPLAY_ON,     /* 10 ms after Display On */
+    ST7796_INIT_DONE
+} st7796_init_step_t;
+
+static st7796_init_step_t s_initStep = ST7796_INIT_DONE;
+static uint32_t s_initDueUs;
+
 /*******************************************************************************
  * Private Helper Functions
  ******************************************************************************/
@@ -74,6 +90,19 @@ static void ST7796_WriteData16(uint16_t data)
  ******************************************************************************/
 
 void ST7796_Init(void)
+{
+    uint32_t now_us = 0;
+    uint32_t wait_us;
+
+    ST7796_InitStart(now_us);
+    while ((wait_us = ST7796_InitPoll(now_us)) != 0U)
+    {
+        SDK_DelayAtLeastUs(wait_us, SystemCoreClock);
+        now_us += wait_us;
+    }
+}
+
+void ST7796_InitStart(uint32_t now_us)
 {
     lpspi_master_config_t masterConfig;
     gpio_pin_config_t outputConfig = {kGPIO_DigitalOutput, 1};
@@ -100,29 +129,63 @@ void ST7796_Init(void)
 
     LPSPI_MasterInit(ST7796_SPI_MASTER_BASE, &masterConfig, ST7796_SPI_SRC_CLK_FREQ);
 
-    /* 3. Hard Reset */
+    /* 3. Hard Reset (the rest runs from ST7796_InitPoll) */
     GPIO_PinWrite(ST7796_GPIO_PORT, ST7796_CS_PIN, 1);
     GPIO_PinWrite(ST7796_GPIO_PORT, ST7796_RST_PIN, 0);
-    SDK_DelayAtLeastUs(10000, SystemCoreClock); /* 10ms */
-    GPIO_PinWrite(ST7796_GPIO_PORT, ST7796_RST_PIN, 1);
-    SDK_DelayAtLeastUs(120000, SystemCoreClock); /* 120ms */
-
-    /* 4. Initialization Sequence */
-    ST7796_WriteCmd(0x01); /* SW Reset */
-    SDK_DelayAtLeastUs(120000, SystemCoreClock);
-
-    ST7796_WriteCmd(0x11); /* Sleep Out */
-    SDK_DelayAtLeastUs(120000, SystemCoreClock);
-
-    ST7796_WriteCmd(0x3A); /* Pixel Format */
-    ST7796_WriteData(0x55); /* 16 bits/pixel */
-
-    ST7796_WriteCmd(0x36); /* Memory Access Control */
-    ST7796_WriteData(0x88); /* MX | BGR (Adjust this 0x48/0x88/0x28 based on rotation) */
+    s_initStep = ST7796_INIT_RESET_LOW;
+    s_initDueUs = now_us + 10000U; /* 10ms */
+}
 
-    //ST7796_WriteCmd(0x21); /* Invertion On */
-    ST7796_WriteCmd(0x29); /* Display On */
-    SDK_DelayAtLeastUs(10000, SystemCoreClock);
+uint32_t ST7796_InitPoll(uint32_t now_us)
+{
+    while (s_initStep != ST7796_INIT_DONE)
+    {
+        int32_t wait_us = (int32_t)(s_initDueUs - now_us);
+        if (wait_us > 0)
+        {
+            return (uint32_t)wait_us;
+        }
+
+        switch (s_initStep)
+        {
+            case ST7796_INIT_RESET_LOW:
+                GPIO_PinWrite(ST7796_GPIO_PORT, ST7796_RST_PIN, 1);
+                s_initStep = ST7796_INIT_RESET_HIGH;
+                s_initDueUs = now_us + 120000U; /* 120ms */
+                break;
+
+            /* 4. Initialization Sequence */
+            case ST7796_INIT_RESET_HIGH:
+                ST7796_WriteCmd(0x01); /* SW Reset */
+                s_initStep = ST7796_INIT_SW_RESET;
+                s_initDueUs = now_us + 120000U;
+                break;
+
+            case ST7796_INIT_SW_RESET:
+                ST7796_WriteCmd(0x11); /* Sleep Out */
+                s_initStep = ST7796_INIT_SLEEP_OUT;
+                s_initDueUs = now_us + 120000U;
+                break;
+
+            case ST7796_INIT_SLEEP_OUT:
+                ST7796_WriteCmd(0x3A); /* Pixel Format */
+                ST7796_WriteData(0x55); /* 16 bits/pixel */
+
+                ST7796_WriteCmd(0x36); /* Memory Access Control */
+                ST7796_WriteData(0x88); /* MX | BGR (Adjust this 0x48/0x88/0x28 based on rotation) */
+
+                //ST7796_WriteCmd(0x21); /* Invertion On */
+                ST7796_WriteCmd(0x29); /* Display On */
+                s_initStep = ST7796_INIT_DISPLAY_ON;
+                s_initDueUs = now_us + 10000U;
+                break;
+
+            default:
+                s_initStep = ST7796_INIT_DONE;
+                break;
+        }
+    }
+    return 0U;
 }
 
 void ST7796_SetWindow(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2)
@@ -43,9 +43,24 @@
 /*!
  * @brief Initialize the LPSPI peripheral and GPIO pins for the screen.
  * Call this after BOARD_InitBootPins() and Clock Setup.
+ * Blocks for the whole power-up sequence (~370 ms), see ST7796_InitStart().
  */
 void ST7796_Init(void);
 
+/*!
+ * @brief Non-blocking init: pins, LPSPI and the hardware reset, then returns.
+ * Call ST7796_InitPoll() until it returns 0; the panel takes no pixels before.
+ * @param now_us Caller's microsecond clock (any origin, only differences count).
+ */
+void ST7796_InitStart(uint32_t now_us);
+
+/*!
+ * @brief Advance the power-up sequence (reset, sleep out, display on) once its wait is over.
+ * @param now_us Same clock as ST7796_InitStart().
+ * @return Microseconds until the next step is due, 0 once the panel is on.
+ */
+uint32_t ST7796_InitPoll(uint32_t now_us);
+
 /*!
  * @brief Set the address window for drawing.
  * @param x1 Start X
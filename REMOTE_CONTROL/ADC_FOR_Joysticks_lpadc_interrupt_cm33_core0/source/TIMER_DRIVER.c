@@ -6,10 +6,35 @@
  */
 
 #include "TIMER_DRIVER.h"
+#include "omni_place.h"
 
 void (*callback_lptmr0)(void* args);
 void (*callback_lptmr1)(void* args);
 
+static CTIMER_Type* us_clock_base = NULL;
+static uint32_t us_clock_high = 0;
+static uint32_t us_clock_last = 0;
+
+static void us_clock_wake_callback(uint32_t flags);
+// The SDK's CTIMER handler calls the instance's callback without checking there is one
+static ctimer_callback_t us_clock_callbacks[] = {us_clock_wake_callback};
+
+typedef struct {
+	const char* name;
+	uint32_t start_us;
+	uint32_t end_us;
+	bool done;
+	bool mark;
+} boot_stage_t;
+
+static boot_stage_t boot_stages[BOOT_STAGES_MAX];
+static uint32_t boot_count = 0;
+static uint32_t boot_time_us = 0;
+static uint32_t boot_last_cycles = 0;
+static uint32_t boot_rem_cycles = 0;
+static uint32_t boot_mhz = 1;
+static bool boot_reported = false;
+
 void init_LPTMR_12MHz(LPTMR_Type* lptmr_base, uint32_t period_ticks){
 
     lptmr_config_t lptmrConfig;
@@ -41,7 +66,7 @@ void init_LPTMR_12MHz(LPTMR_Type* lptmr_base, uint32_t period_ticks){
 
 }
 
-void LPTMR0_IRQHandler(void)
+OMNI_PLACE_ISR_CODE void LPTMR0_IRQHandler(void)
 {
     LPTMR_ClearStatusFlags(LPTMR0, kLPTMR_TimerCompareFlag);
 
@@ -52,7 +77,7 @@ void LPTMR0_IRQHandler(void)
     __ISB();
 }
 
-void LPTMR1_IRQHandler(void)
+OMNI_PLACE_ISR_CODE void LPTMR1_IRQHandler(void)
 {
     LPTMR_ClearStatusFlags(LPTMR1, kLPTMR_TimerCompareFlag);
 
@@ -90,3 +115,200 @@ void lptmr_attach_callback(LPTMR_Type* lptmr_base, void* callback){
 
 
 }
+
+void init_us_clock(CTIMER_Type* ctimer_base, uint32_t src_clock_hz){
+
+	ctimer_config_t config;
+
+	CTIMER_GetDefaultConfig(&config);
+	// The counter advances every prescale + 1 clocks
+	config.prescale = (src_clock_hz / US_CLOCK_HZ) - 1U;
+	CTIMER_Init(ctimer_base, &config);
+
+	us_clock_high = 0;
+	us_clock_last = 0;
+	us_clock_base = ctimer_base;
+	CTIMER_RegisterCallBack(ctimer_base, us_clock_callbacks, kCTIMER_SingleCallback);
+	CTIMER_StartTimer(ctimer_base);
+}
+
+/* Wake match interrupt: it only ends the WFI, the SDK's handler has cleared the flag */
+OMNI_PLACE_ISR_CODE static void us_clock_wake_callback(uint32_t flags){
+	(void)flags;
+}
+
+OMNI_PLACE_ISR_CODE uint64_t us_clock_now(void){
+
+	if(us_clock_base == NULL){
+		return 0;
+	}
+
+	// Callers in several interrupts share the high word
+	uint32_t primask = DisableGlobalIRQ();
+	uint32_t low = CTIMER_GetTimerCountValue(us_clock_base);
+
+	if(low < us_clock_last){
+		us_clock_high++;
+	}
+	us_clock_last = low;
+	uint64_t now = ((uint64_t)us_clock_high << 32) | low;
+
+	EnableGlobalIRQ(primask);
+	return now;
+}
+
+uint32_t us_clock_sleep_until(uint64_t wake_us, volatile bool* event){
+
+	if(us_clock_base == NULL){
+		return 0;
+	}
+
+	ctimer_match_config_t match = {0};
+	match.matchValue = (uint32_t)wake_us;
+	match.outControl = kCTIMER_Output_NoAction;
+	match.enableInterrupt = true;
+
+	// A masked interrupt still ends the WFI, its handler runs at EnableGlobalIRQ()
+	uint32_t primask = DisableGlobalIRQ();
+	uint64_t start = us_clock_now();
+	uint64_t end = start;
+
+	if((event == NULL || !*event) && start < wake_us){
+		CTIMER_SetupMatch(us_clock_base, US_CLOCK_WAKE_MATCH, &match);
+
+		// The match only fires on an equal count: it may have gone by during the setup
+		if(us_clock_now() < wake_us){
+			__DSB();
+			__WFI();
+		}
+		end = us_clock_now();
+
+		// Whatever woke the core, the match is done with: no interrupt from it later on
+		CTIMER_DisableInterrupts(us_clock_base, US_CLOCK_WAKE_MATCH_IRQ);
+		CTIMER_ClearStatusFlags(us_clock_base, US_CLOCK_WAKE_MATCH_FLAG);
+	}
+
+	EnableGlobalIRQ(primask);
+	return (uint32_t)(end - start);
+}
+
+void boot_profile_start(void){
+
+	DCB->DEMCR |= DCB_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+	boot_count = 0;
+	boot_time_us = 0;
+	boot_last_cycles = 0;
+	boot_rem_cycles = 0;
+	boot_mhz = (SystemCoreClock >= 1000000U) ? (SystemCoreClock / 1000000U) : 1U;
+	boot_reported = false;
+}
+
+uint32_t boot_us(void){
+
+	uint32_t primask = DisableGlobalIRQ();
+	uint32_t now = DWT->CYCCNT;
+	// Cycles since the last call at the clock of the last call, the rest carried over
+	uint32_t cycles = (now - boot_last_cycles) + boot_rem_cycles;
+
+	boot_time_us += cycles / boot_mhz;
+	boot_rem_cycles = cycles % boot_mhz;
+	boot_last_cycles = now;
+	boot_mhz = (SystemCoreClock >= 1000000U) ? (SystemCoreClock / 1000000U) : 1U;
+
+	uint32_t us = boot_time_us;
+	EnableGlobalIRQ(primask);
+	return us;
+}
+
+static uint8_t boot_add(const char* name, bool mark){
+
+	uint32_t us = boot_us();
+	uint32_t primask = DisableGlobalIRQ();
+	uint8_t stage = BOOT_STAGE_NONE;
+
+	if(boot_count < BOOT_STAGES_MAX){
+		stage = (uint8_t)boot_count++;
+		boot_stages[stage].name = name;
+		boot_stages[stage].start_us = us;
+		boot_stages[stage].end_us = us;
+		boot_stages[stage].done = mark;
+		boot_stages[stage].mark = mark;
+	}
+	EnableGlobalIRQ(primask);
+	return stage;
+}
+
+uint8_t boot_begin(const char* name){
+	return boot_add(name, false);
+}
+
+void boot_end(uint8_t stage){
+
+	if(stage >= boot_count){
+		return;
+	}
+	boot_stages[stage].end_us = boot_us();
+	boot_stages[stage].done = true;
+}
+
+void boot_mark(const char* name){
+	(void)boot_add(name, true);
+}
+
+void boot_report(void){
+
+	const uint32_t width = 40U;
+	uint32_t now = boot_us();
+	uint32_t span = 1U;
+
+	for(uint32_t i = 0; i < boot_count; i++){
+		uint32_t end = boot_stages[i].done ? boot_stages[i].end_us : now;
+		if(end > span){
+			span = end;
+		}
+	}
+
+	PRINTF("Boot timeline (us since main):\r\n");
+	PRINTF("  %-16s %8s %8s %8s\r\n", "stage", "start", "end", "took");
+	for(uint32_t i = 0; i < boot_count; i++){
+		boot_stage_t* s = &boot_stages[i];
+		uint32_t end = s->done ? s->end_us : now;
+		uint32_t from = (uint32_t)((uint64_t)s->start_us * width / span);
+		uint32_t to = (uint32_t)((uint64_t)end * width / span);
+
+		if(s->mark){
+			PRINTF("  %-16s %8lu %8s %8s  ", s->name, (unsigned long)s->start_us, "", "");
+		} else if(s->done){
+			PRINTF("  %-16s %8lu %8lu %8lu  ", s->name, (unsigned long)s->start_us, (unsigned long)end,
+				(unsigned long)(end - s->start_us));
+		} else {
+			PRINTF("  %-16s %8lu %8s %8s  ", s->name, (unsigned long)s->start_us, "running", "");
+		}
+		for(uint32_t col = 0; col < from; col++){
+			PUTCHAR(' ');
+		}
+		if(s->mark){
+			PUTCHAR('|');
+		} else {
+			/* At least one column, a stage shorter than one still shows */
+			for(uint32_t col = from; col < to || col == from; col++){
+				PUTCHAR('#');
+			}
+		}
+		PRINTF("\r\n");
+	}
+	boot_reported = true;
+}
+
+void boot_report_poll(void){
+
+	if(BOOT_REPORT_US == 0U || boot_reported){
+		return;
+	}
+	if(boot_us() >= BOOT_REPORT_US){
+		boot_report();
+	}
+}
@@ -6,16 +6,23 @@
  * SPDX-License-Identifier: BSD-3-Clause
  */
 
+#include <string.h>
 #include "fsl_debug_console.h"
 #include "board.h"
 #include "app.h"
 #include "fsl_lpadc.h"
 #include "ESP_SPI.h"
+#include "TIMER_DRIVER.h"
 #include "RemoteData.h"
+#include "omni_sync.h"
+#include "omni_place.h"
 #include "ST7796_MCX.h"
 #include "lvgl_support.h"
 #include "lvgl.h"
 #include "RobotGUI.h"
+#include "RemoteMailbox.h"
+#include "RemoteFleet.h"
+#include "RemoteGains.h"
 
 /*******************************************************************************
  * Definitions
@@ -43,6 +50,34 @@
 #define YVALUE_LPADC_USER_CMDID         2U
 #define LEFT_X_LPADC_USER_CMDID         3U
 
+/* Dual core: 1 = LVGL runs on core1 (RemoteGuiCore1.c), core0 only samples and sends */
+#ifndef REMOTE_GUI_ON_CORE1
+#define REMOTE_GUI_ON_CORE1             0
+#endif
+
+/* Vector table of the core1 image (second flash bank), must match its linker config */
+#ifndef REMOTE_CORE1_BOOT_ADDR
+#define REMOTE_CORE1_BOOT_ADDR          0x00100000U
+#endif
+
+/* 1 = drive a fleet (FLEET_ROBOTS in ESP32_WIFI/TX/main/main.c): one command per robot
+ * online each loop, telemetry of all of them in RemoteFleet.c */
+#ifndef REMOTE_FLEET
+#define REMOTE_FLEET                    0
+#endif
+
+/* Command period on the us clock. The main loop sleeps (WFI) in between, until the
+ * next command, the next LVGL timer or an interrupt, whichever comes first */
+#ifndef REMOTE_CMD_PERIOD_US
+#define REMOTE_CMD_PERIOD_US            5000U
+#endif
+
+/* Clock sync report (fleet report with REMOTE_FLEET) and idle time on the debug console
+ * every N commands, 0 = off */
+#ifndef REMOTE_SYNC_REPORT_LOOPS
+#define REMOTE_SYNC_REPORT_LOOPS        1000U
+#endif
+
 /*******************************************************************************
  * Variables
  ******************************************************************************/
@@ -51,21 +86,143 @@ volatile uint32_t ADC_Valx = 0;
 volatile uint32_t ADC_Valy = 0;
 volatile uint32_t ADC_Val_LeftX = 0;
 
+/* LPADC calibration, run in steps from the main loop (PollAdcCalibration()) */
+typedef enum {
+    ADC_CAL_OFFSET,
+    ADC_CAL_GAIN,
+    ADC_CAL_DONE
+} adc_cal_step_t;
+
+static adc_cal_step_t adcCalStep = ADC_CAL_OFFSET;
+
 /* SPI Buffers */
 static uint8_t txBuffer[ESP_SPI_TRANSFER_SIZE] = {0};
-static uint8_t rxBuffer[ESP_SPI_TRANSFER_SIZE] = {0};
 static uint32_t packet_count = 0;
 
+#if REMOTE_FLEET
+/* One exchange per robot, all queued at once: buffers and t4 each (clock sync: RemoteFleet.c) */
+static uint8_t fleetTx[REMOTE_FLEET_MAX][ESP_SPI_TRANSFER_SIZE];
+static uint8_t fleetRx[REMOTE_FLEET_MAX][ESP_SPI_TRANSFER_SIZE];
+static volatile uint64_t fleetRxDoneUs[REMOTE_FLEET_MAX];
+static uint32_t fleetExchanges = 0;
+#else
+static uint8_t rxBuffer[ESP_SPI_TRANSFER_SIZE] = {0};
+static uint8_t gainsBuffer[ESP_SPI_TRANSFER_SIZE] = {0};   /* RemoteGainPoint_t, in place of a command */
+
+/* Clock sync with the robot (omni_sync.h) */
+static omni_sync_t clockSync;
+static volatile uint64_t rxDoneUs = 0;  /* t4 of the last exchange, 0 if it failed */
+#endif
+
+#if OMNI_PLACE_PROFILE
+static omni_place_stat_t placeAdc;      /* LPADC_IRQHandler_Func */
+#endif
+
 /*******************************************************************************
  * Helper Functions
  ******************************************************************************/
 
+#if REMOTE_GUI_ON_CORE1
+/* Start core1 from its own image. CPUCTRL writes need the 0xC0C4 key. */
+static void StartGuiCore(void)
+{
+    SYSCON->CPBOOT = REMOTE_CORE1_BOOT_ADDR & SYSCON_CPBOOT_CPBOOT_MASK;
+
+    SYSCON->CPUCTRL = SYSCON_CPUCTRL_PROT(0xC0C4U) | SYSCON_CPUCTRL_CPU1CLKEN_MASK |
+                      SYSCON_CPUCTRL_CPU1RSTEN_MASK;
+    SYSCON->CPUCTRL = SYSCON_CPUCTRL_PROT(0xC0C4U) | SYSCON_CPUCTRL_CPU1CLKEN_MASK;
+}
+#endif
+
 /* Connect SPI Driver Interrupt */
-void LP_FLEXCOMM1_IRQHandler(void)
+OMNI_PLACE_ISR_CODE void LP_FLEXCOMM1_IRQHandler(void)
 {
     ESP_SPI_MasterIRQHandler();
 }
 
+/* Exchange done (LPSPI or eDMA interrupt): stamp when the telemetry came in, into *userData */
+OMNI_PLACE_ISR_CODE static void Remote_ExchangeDone(uint8_t *txData, uint8_t *rxData, uint32_t size, status_t status,
+                                                    void *userData)
+{
+    volatile uint64_t *doneUs = (volatile uint64_t *)userData;
+
+    (void)txData;
+    (void)rxData;
+    (void)size;
+
+    *doneUs = (status == kStatus_Success) ? us_clock_now() : 0U;
+}
+
+#if REMOTE_SYNC_REPORT_LOOPS && !REMOTE_FLEET
+static void ReportClockSync(void)
+{
+    omni_sync_estimate_t est;
+
+    if (!omni_sync_get(&clockSync, us_clock_now(), &est))
+    {
+        PRINTF("Sync: no telemetry echo yet\r\n");
+        return;
+    }
+    PRINTF("Sync: robot - remote %ld us +/- %lu us, drift %ld ppb, one-way cmd %ld us telemetry %ld us\r\n",
+           (long)est.offset_us, (unsigned long)est.bound_us, (long)est.drift_ppb,
+           (long)clockSync.cmd_latency_us, (long)clockSync.tel_latency_us);
+}
+#endif
+
+#if REMOTE_SYNC_REPORT_LOOPS
+/* Share of the time since the last report the core spent in WFI */
+static void ReportIdle(uint64_t idleUs, uint64_t spanUs)
+{
+    uint32_t permille = (spanUs != 0U) ? (uint32_t)((idleUs * 1000U) / spanUs) : 0U;
+
+    PRINTF("Idle: %lu.%lu %% of %lu ms\r\n", (unsigned long)(permille / 10U), (unsigned long)(permille % 10U),
+           (unsigned long)(spanUs / 1000U));
+}
+#endif
+
+#if REMOTE_SYNC_REPORT_LOOPS && OMNI_PLACE_PROFILE
+/* Cycles of every placed path since the last report, with the bank it runs from (omni_place.h) */
+static void ReportPlace(void)
+{
+    static const struct
+    {
+        const char *name;
+        const char *bank;
+        omni_place_stat_t *stat;
+    } sites[] = {
+        {"adc isr", OMNI_PLACE_ISR_BANK, &placeAdc},
+#if !REMOTE_GUI_ON_CORE1
+        {"lvgl render", OMNI_PLACE_LVGL_BANK "/" OMNI_PLACE_BUFFERS_BANK, &lvgl_place_render},
+        {"lvgl flush", OMNI_PLACE_BUFFERS_BANK, &lvgl_place_flush},
+#endif
+    };
+
+    for (uint32_t i = 0; i < sizeof(sites) / sizeof(sites[0]); i++)
+    {
+        omni_place_stat_t *s = sites[i].stat;
+        uint32_t primask = DisableGlobalIRQ();
+        uint32_t calls = s->calls;
+        uint32_t sum = s->cycles_sum;
+        uint32_t max = s->cycles_max;
+        s->calls = 0;
+        s->cycles_sum = 0;
+        s->cycles_max = 0;
+        EnableGlobalIRQ(primask);
+
+        PRINTF("Place: %-12s %-10s %6lu calls, %5lu avg, %5lu max cycles\r\n", sites[i].name, sites[i].bank,
+               (unsigned long)calls, (unsigned long)(calls ? sum / calls : 0U), (unsigned long)max);
+    }
+}
+#endif
+
+#if !REMOTE_GUI_ON_CORE1
+/* LVGL time base: the us clock, so no tick interrupt has to wake the core */
+static uint32_t Remote_LvTick(void)
+{
+    return (uint32_t)(us_clock_now() / 1000U);
+}
+#endif
+
 /* Map raw ADC to speed with deadzone */
 float MapJoystickToSpeed(uint32_t raw, float max_speed, bool invert)
 {
@@ -92,8 +249,9 @@ float MapJoystickToSpeed(uint32_t raw, float max_speed, bool invert)
     return result * max_speed * (invert ? -1.0f : 1.0f);
 }
 
-void LPADC_IRQHandler_Func(void)
+OMNI_PLACE_ISR_CODE void LPADC_IRQHandler_Func(void)
 {
+    OMNI_PLACE_BEGIN(adc);
     lpadc_conv_result_t tmpResultStruct;
 
     while (LPADC_GetConvResult(DEMO_LPADC_BASE, &tmpResultStruct, 0U))
@@ -114,14 +272,44 @@ void LPADC_IRQHandler_Func(void)
         }
     }
     g_LpadcConversionCompletedFlag = true;
+    OMNI_PLACE_END(adc, &placeAdc);
     SDK_ISR_EXIT_BARRIER;
 }
 
-void DEMO_LPADC_IRQ_HANDLER_FUNC(void)
+OMNI_PLACE_ISR_CODE void DEMO_LPADC_IRQ_HANDLER_FUNC(void)
 {
     LPADC_IRQHandler_Func();
 }
 
+/* LPADC_DoOffsetCalibration() and LPADC_DoAutoCalibration() without their busy waits.
+ * Started by LPADC_EnableOffsetCalibration(); returns true once both are done. */
+static bool PollAdcCalibration(void)
+{
+    switch (adcCalStep)
+    {
+        case ADC_CAL_OFFSET:
+            if ((LPADC_GetStatusFlags(DEMO_LPADC_BASE) & (uint32_t)kLPADC_CalibrationReadyFlag) == 0U)
+            {
+                return false;
+            }
+            LPADC_PrepareAutoCalibration(DEMO_LPADC_BASE);
+            adcCalStep = ADC_CAL_GAIN;
+            return false;
+
+        case ADC_CAL_GAIN:
+            if ((DEMO_LPADC_BASE->GCC[0] & DEMO_LPADC_BASE->GCC[1] & ADC_GCC_RDY_MASK) == 0U)
+            {
+                return false;
+            }
+            (void)LPADC_FinishAutoCalibration(DEMO_LPADC_BASE);
+            adcCalStep = ADC_CAL_DONE;
+            return true;
+
+        default:
+            return true;
+    }
+}
+
 /*******************************************************************************
  * Main
  ******************************************************************************/
@@ -130,26 +318,55 @@ int main(void)
     lpadc_config_t mLpadcConfigStruct;
     lpadc_conv_trigger_config_t mLpadcTriggerConfigStruct;
     lpadc_conv_command_config_t mLpadcCommandConfigStruct;
+    uint8_t stage;
 
     /* 1. Hardware Init */
+    boot_profile_start();
+    stage = boot_begin("board");
     BOARD_InitHardware();
+    boot_end(stage);
     /* --------------------------------------------------------------- */
 
     PRINTF("Remote Control Start\r\n");
 
+    /* Microsecond clock, the command timestamps and the clock sync run on it */
+    init_us_clock(CTIMER4, CLOCK_GetCTimerClkFreq(4U));
+#if REMOTE_FLEET
+    RemoteFleet_Init();
+#else
+    omni_sync_init(&clockSync);
+    RemoteGains_Init();
+#endif
+
+#if !REMOTE_GUI_ON_CORE1
+    /* Panel reset first: its 360 ms of waits run behind the rest of the init (ST7796_InitPoll()) */
+    uint8_t panelStage = boot_begin("panel");
+    bool panelReady = false;
+    bool firstFrame = true;
+    ST7796_InitStart((uint32_t)us_clock_now());
+#endif
+
     /* 2. Initialize SPI Driver (Comms) */
+    stage = boot_begin("spi");
+#if ESP_SPI_USE_EDMA
+    const esp_spi_edma_config_t espDma = {DMA0, 0U, 1U, kDma0RequestMuxLpFlexcomm1Rx, kDma0RequestMuxLpFlexcomm1Tx};
+    ESP_SPI_InitEDMA(REMOTE_LPSPI_BASE, LPSPI_MASTER_CLK_FREQ, REMOTE_LPSPI_PCS, &espDma);
+#else
     ESP_SPI_Init(REMOTE_LPSPI_BASE, LPSPI_MASTER_CLK_FREQ, REMOTE_LPSPI_PCS);
+#endif
     EnableIRQ(REMOTE_LPSPI_IRQN);
+    boot_end(stage);
 
-    /* 3. Initialize LPADC */
+    /* 3. Initialize LPADC; the calibration finishes in the main loop */
+    uint8_t adcStage = boot_begin("adc calibration");
+    bool adcReady = false;
     LPADC_GetDefaultConfig(&mLpadcConfigStruct);
     mLpadcConfigStruct.enableAnalogPreliminary = true;
     mLpadcConfigStruct.powerLevelMode = kLPADC_PowerLevelAlt4;
     mLpadcConfigStruct.referenceVoltageSource = DEMO_LPADC_VREF_SOURCE;
     mLpadcConfigStruct.conversionAverageMode = kLPADC_ConversionAverage128;
     LPADC_Init(DEMO_LPADC_BASE, &mLpadcConfigStruct);
-    LPADC_DoOffsetCalibration(DEMO_LPADC_BASE);
-    LPADC_DoAutoCalibration(DEMO_LPADC_BASE);
+    LPADC_EnableOffsetCalibration(DEMO_LPADC_BASE, true);
 
     /* ADC Commands */
     LPADC_GetDefaultConvCommandConfig(&mLpadcCommandConfigStruct);
@@ -178,53 +395,219 @@ int main(void)
 
     RemoteCommand_t *cmd = (RemoteCommand_t *)txBuffer;
     int ui_refresh_div = 0;
-
+    uint32_t sync_report_div = 0;
+    uint64_t idleUs = 0;                /* In WFI since the last report */
+    uint64_t reportUs = us_clock_now();
+
+#if REMOTE_GUI_ON_CORE1
+    /* 4. GUI runs on core1, it only talks to us through the mailbox */
+    RemoteMailbox_Init();
+    StartGuiCore();
+#else
     /* 4. LVGL Init */
+    stage = boot_begin("lvgl");
     lv_init();
+    lv_tick_set_cb(Remote_LvTick);
     lv_port_disp_init();
 
     /* [FIX] Use the Professional GUI Init we created */
     RobotGUI_Init();
+    boot_end(stage);
+#endif
+
+    uint64_t nextCmdUs = us_clock_now();
 
     while (1)
     {
-        /* A. Trigger ADC */
-        LPADC_DoSoftwareTrigger(DEMO_LPADC_BASE, 1U);
-        while (!g_LpadcConversionCompletedFlag) {}
-        g_LpadcConversionCompletedFlag = false;
-
-        /* B. Process Data */
-        cmd->vy  = MapJoystickToSpeed(ADC_Valy, MAX_LINEAR_SPEED, false);
-        cmd->vx  = MapJoystickToSpeed(ADC_Valx, MAX_LINEAR_SPEED, false);
-        cmd->phi = MapJoystickToSpeed(ADC_Val_LeftX, MAX_ANGULAR_SPEED, false);
-
-        /* C. Prepare Packet */
-        cmd->header = (0xC5 << 24) | (packet_count & 0xFFFFFF);
-        cmd->buttons = 0;
-        cmd->timestamp = packet_count;
-
-        /* D. Send via SPI */
-        if (ESP_SPI_IsTransferCompleted())
+        /* Init steps still running */
+        if (!adcReady && PollAdcCalibration())
         {
-            ESP_SPI_StartTransfer(txBuffer, rxBuffer);
-            packet_count++;
+            adcReady = true;
+            boot_end(adcStage);
         }
+#if !REMOTE_GUI_ON_CORE1
+        if (!panelReady && ST7796_InitPoll((uint32_t)us_clock_now()) == 0U)
+        {
+            panelReady = true;
+            boot_end(panelStage);
+        }
+#endif
+        boot_report_poll();
 
-        // PRINTF("Sent -> VX: %.2f VY: %.2f Phi: %.2f\r\n", cmd->vx, cmd->vy, cmd->phi);
-
-        /* E. Update GUI (Throttled to ~20Hz) */
-        /* [FIX] This logic MUST be inside the while loop */
-        if (ui_refresh_div++ >= 10)
+        /* Woken before the command is due: LVGL timer, SPI or another interrupt */
+        if (us_clock_now() >= nextCmdUs)
         {
-            RobotGUI_Update(cmd->vx, cmd->vy, cmd->phi);
-            ui_refresh_div = 0;
+            /* On the us clock, so the period doesn't stretch with the work done in it;
+             * after a stall (debugger, long GUI frame) it restarts instead of catching up */
+            nextCmdUs += REMOTE_CMD_PERIOD_US;
+            if (nextCmdUs <= us_clock_now())
+            {
+                nextCmdUs = us_clock_now() + REMOTE_CMD_PERIOD_US;
+            }
+
+            /* A. Trigger ADC, sleep through the conversion; sticks read as centred (robot
+             * stopped) until it is calibrated */
+            if (adcReady)
+            {
+                LPADC_DoSoftwareTrigger(DEMO_LPADC_BASE, 1U);
+                while (!g_LpadcConversionCompletedFlag)
+                {
+                    idleUs += us_clock_sleep_until(nextCmdUs, &g_LpadcConversionCompletedFlag);
+                }
+                g_LpadcConversionCompletedFlag = false;
+
+                /* B. Process Data */
+                cmd->vy  = MapJoystickToSpeed(ADC_Valy, MAX_LINEAR_SPEED, false);
+                cmd->vx  = MapJoystickToSpeed(ADC_Valx, MAX_LINEAR_SPEED, false);
+                cmd->phi = MapJoystickToSpeed(ADC_Val_LeftX, MAX_ANGULAR_SPEED, false);
+            }
+
+            /* C. Prepare Packet */
+            cmd->header = OMNI_WIRE_HEADER(REMOTE_PACKET_HEADER, packet_count, sizeof(RemoteCommand_t));
+            cmd->buttons = 0;
+
+#if REMOTE_FLEET
+            /* D. One exchange per robot online, all queued at once; before any robot
+             * reported, a single one that only picks up telemetry */
+            if (ESP_SPI_IsTransferCompleted())
+            {
+                for (uint32_t i = 0; i < fleetExchanges; i++)
+                {
+                    (void)RemoteFleet_Receive(fleetRx[i], OMNI_WIRE_FLEET_EXCHANGE_SIZE, fleetRxDoneUs[i]);
+                }
+
+                uint8_t ids[REMOTE_FLEET_MAX];
+                uint32_t online = RemoteFleet_Online(us_clock_now(), ids);
+                fleetExchanges = (online != 0U) ? online : 1U;
+
+                for (uint32_t i = 0; i < fleetExchanges; i++)
+                {
+                    RemoteCommand_t *out = (RemoteCommand_t *)fleetTx[i];
+                    uint8_t id = (online != 0U) ? ids[i] : OMNI_WIRE_ROBOT_NONE;
+
+                    /* The whole fleet follows the sticks; give each robot its own command here for formations.
+                     * The robot it is for goes in the fleet tag behind the frame. */
+                    memcpy(out, cmd, sizeof(RemoteCommand_t));
+                    out->header = OMNI_WIRE_HEADER(REMOTE_PACKET_HEADER, packet_count, sizeof(RemoteCommand_t));
+                    (void)omni_wire_set_fleet_id(fleetTx[i], id);
+
+                    uint64_t t1 = us_clock_now();
+                    out->timestamp = (uint32_t)t1;
+                    RemoteFleet_Sent(id, (uint16_t)packet_count, t1);
+                    while (ESP_SPI_QueueTransfer(fleetTx[i], fleetRx[i], OMNI_WIRE_FLEET_EXCHANGE_SIZE, Remote_ExchangeDone,
+                                                 (void *)&fleetRxDoneUs[i]) != kStatus_Success)
+                    {
+                        /* ESP_SPI_QUEUE_LEN frames queued: one leaves the bus every 40 us (8 MHz) */
+                        SDK_DelayAtLeastUs(10U, SystemCoreClock);
+                    }
+                    if (packet_count == 0U)
+                    {
+                        boot_mark("first command");
+                    }
+                    packet_count++;
+                }
+            }
+#else
+            /* D. Send via SPI */
+            if (ESP_SPI_IsTransferCompleted())
+            {
+                /* Telemetry of the previous exchange: a clock sync sample if it echoes one of our commands */
+                const RobotTelemetry_t *tel = omni_wire_telemetry(rxBuffer, OMNI_WIRE_EXCHANGE_SIZE);
+                if (tel != NULL && rxDoneUs != 0U)
+                {
+                    (void)omni_sync_receive(&clockSync, tel, rxDoneUs);
+                }
+                if (tel != NULL)
+                {
+                    RemoteGains_Receive(tel);
+                }
+
+                /* Now and then a gain table point instead of the command, the robot keeps the last one */
+                RemoteGains_Poll();
+                uint8_t *tx = txBuffer;
+                if (RemoteGains_Frame(gainsBuffer, packet_count))
+                {
+                    tx = gainsBuffer;
+                }
+                else
+                {
+                    /* t1 right before the bus starts; the queue is empty, so it starts now */
+                    uint64_t t1 = us_clock_now();
+                    cmd->timestamp = (uint32_t)t1;
+                    omni_sync_sent(&clockSync, (uint16_t)packet_count, t1);
+                }
+
+                /* Long enough for the robot's telemetry coming back on MISO */
+                (void)ESP_SPI_QueueTransfer(tx, rxBuffer, OMNI_WIRE_EXCHANGE_SIZE, Remote_ExchangeDone,
+                                            (void *)&rxDoneUs);
+                if (packet_count == 0U)
+                {
+                    boot_mark("first command");
+                }
+                packet_count++;
+            }
+#endif
+
+#if REMOTE_SYNC_REPORT_LOOPS
+            if (++sync_report_div >= REMOTE_SYNC_REPORT_LOOPS)
+            {
+                uint64_t now = us_clock_now();
+
+                sync_report_div = 0;
+#if REMOTE_FLEET
+                RemoteFleet_Report(now);
+#else
+                ReportClockSync();
+#endif
+                ReportIdle(idleUs, now - reportUs);
+#if OMNI_PLACE_PROFILE
+                ReportPlace();
+#endif
+                idleUs = 0;
+                reportUs = now;
+            }
+#else
+            (void)sync_report_div;
+            (void)reportUs;
+#endif
+
+            // PRINTF("Sent -> VX: %.2f VY: %.2f Phi: %.2f\r\n", cmd->vx, cmd->vy, cmd->phi);
+
+#if REMOTE_GUI_ON_CORE1
+            /* E. Hand the command to the GUI core, never waits for it */
+            RemoteMailbox_Publish(cmd);
+            (void)ui_refresh_div;
+#else
+            /* E. Update GUI (Throttled to ~20Hz), once the panel is out of its reset */
+            if (panelReady && ui_refresh_div++ >= 10)
+            {
+                RobotGUI_Update(cmd->vx, cmd->vy, cmd->phi);
+                ui_refresh_div = 0;
+            }
+#endif
         }
 
-        /* F. LVGL Tasks */
-        lv_task_handler();
-        lv_tick_inc(5);
+        /* F. LVGL Tasks: they run on their own timers, on Remote_LvTick() */
+        uint64_t wakeUs = nextCmdUs;
+#if !REMOTE_GUI_ON_CORE1
+        if (panelReady)
+        {
+            lv_timer_handler();
+            if (firstFrame)
+            {
+                firstFrame = false;
+                boot_mark("first frame");
+            }
+
+            uint32_t lvIdleMs = lv_timer_get_time_until_next();
+            if (lvIdleMs != LV_NO_TIMER_READY)
+            {
+                wakeUs = MIN(wakeUs, us_clock_now() + (uint64_t)lvIdleMs * 1000U);
+            }
+        }
+#endif
 
-        /* G. Loop Delay */
-        SDK_DelayAtLeastUs(5000, SystemCoreClock); // 5ms
+        /* G. Sleep until the next command or LVGL timer, an interrupt (SPI, ADC) ends it early */
+        idleUs += us_clock_sleep_until(wakeUs, NULL);
     }
 }
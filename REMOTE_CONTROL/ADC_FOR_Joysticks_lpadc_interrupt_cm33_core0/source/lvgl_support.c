@@ -10,12 +10,21 @@
  ******************************************************************************/
 /* * In LVGL v9, buffers are just raw arrays.
  * We align them to 4 bytes for DMA safety (even if we use blocking SPI).
+ * With OMNI_PLACE_BUFFERS it sits in RAMH, LVGL renders into it and never reads it
+ * before, so it is not zeroed at reset.
  */
-static uint8_t buf1[LVGL_BUF_SIZE_BYTES] __attribute__((aligned(4)));
+static uint8_t buf1[LVGL_BUF_SIZE_BYTES] __attribute__((aligned(4))) OMNI_PLACE_BUFFERS_NOINIT;
 
 /* Display Object Pointer */
 static lv_display_t * disp;
 
+#if OMNI_PLACE_PROFILE
+omni_place_stat_t lvgl_place_render;
+omni_place_stat_t lvgl_place_flush;
+static uint32_t renderStart;
+static uint32_t renderFlush;    /* Flush cycles since renderStart */
+#endif
+
 /*******************************************************************************
  * Code
  ******************************************************************************/
@@ -25,6 +34,10 @@ static lv_display_t * disp;
  */
 void my_disp_flush(lv_display_t * display, const lv_area_t * area, uint8_t * px_map)
 {
+#if OMNI_PLACE_PROFILE
+    uint32_t flushStart = OMNI_PLACE_CYCLES();
+#endif
+
     /* 1. Calculate transfer size */
     uint32_t width = (area->x2 - area->x1 + 1);
     uint32_t height = (area->y2 - area->y1 + 1);
@@ -39,12 +52,33 @@ void my_disp_flush(lv_display_t * display, const lv_area_t * area, uint8_t * px_
 
     /* 4. Tell LVGL we are ready */
     lv_display_flush_ready(display);
+
+#if OMNI_PLACE_PROFILE
+    uint32_t cycles = OMNI_PLACE_CYCLES() - flushStart;
+    omni_place_add(&lvgl_place_flush, cycles);
+    renderFlush += cycles;
+#endif
 }
 
+#if OMNI_PLACE_PROFILE
+/* LV_EVENT_RENDER_START / LV_EVENT_RENDER_READY: only sent for a frame that had something to draw */
+static void lv_port_render_event(lv_event_t * e)
+{
+    if (lv_event_get_code(e) == LV_EVENT_RENDER_START)
+    {
+        renderFlush = 0;
+        renderStart = OMNI_PLACE_CYCLES();
+    }
+    else
+    {
+        omni_place_add(&lvgl_place_render, OMNI_PLACE_CYCLES() - renderStart - renderFlush);
+    }
+}
+#endif
+
 void lv_port_disp_init(void)
 {
-    /* 1. Initialize Low Level Hardware Driver */
-    ST7796_Init();
+    /* 1. Low Level Hardware Driver: started by the caller (ST7796_InitStart()) */
 
     /* 2. Create the Display Object (v9 API) */
     disp = lv_display_create(ST7796_HEIGHT , ST7796_WIDTH);
@@ -63,6 +97,11 @@ void lv_port_disp_init(void)
      */
     lv_display_set_buffers(disp, buf1, NULL, LVGL_BUF_SIZE_BYTES, LV_DISPLAY_RENDER_MODE_PARTIAL);
 
+#if OMNI_PLACE_PROFILE
+    lv_display_add_event_cb(disp, lv_port_render_event, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, lv_port_render_event, LV_EVENT_RENDER_READY, NULL);
+#endif
+
     /* Optional: Rotate if needed */
     /* lv_display_set_rotation(disp, LV_DISPLAY_ROTATION_0); */
 }
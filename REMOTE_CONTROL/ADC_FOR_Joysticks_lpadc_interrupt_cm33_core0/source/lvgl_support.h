@@ -11,6 +11,7 @@
 #include "lvgl.h"
 #include "ST7796_MCX.h"
 #include "fsl_debug_console.h"
+#include "omni_place.h"
 
 /*******************************************************************************
  * Definitions
@@ -26,6 +27,17 @@
 
 
 void my_disp_flush(lv_display_t * display, const lv_area_t * area, uint8_t * px_map);
+
+/* Creates the LVGL display only. The panel is brought up by the caller with
+ * ST7796_InitStart()/ST7796_InitPoll() (or ST7796_Init()); lv_task_handler()
+ * must not run before ST7796_InitPoll() returned 0, it flushes to the panel. */
 void lv_port_disp_init(void);
 
+#if OMNI_PLACE_PROFILE
+/* Cycles per rendered frame: drawing into the buffer (LVGL's FAST_MEM code and buf1),
+ * and the flushes to the panel it did on the way */
+extern omni_place_stat_t lvgl_place_render;
+extern omni_place_stat_t lvgl_place_flush;
+#endif
+
 #endif /* LVGL_SUPPORT_H_ */